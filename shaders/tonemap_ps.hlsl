@@ -0,0 +1,56 @@
+#include "common.hlsli"
+
+// utility::tonemap::Constants, the CPU reference of everything below is in src/utility/ToneMap.hpp
+cbuffer ToneMapConstants : register(b0)
+{
+    uint op;
+    float exposureScale;
+    uint srgb;
+    uint pad;
+};
+
+Texture2D<float4> sourceTexture : register(t0);
+
+float3 acesFilmic(float3 x)
+{
+    const float a = 2.51f;
+    const float b = 0.03f;
+    const float c = 2.43f;
+    const float d = 0.59f;
+    const float e = 0.14f;
+
+    return saturate((x * (a * x + b)) / (x * (c * x + d) + e));
+}
+
+// Source and target are the same size, so the pixel position addresses the source directly.
+float4 ps_main(CommonVertex input) : SV_TARGET
+{
+    float4 color = sourceTexture.Load(int3(input.position.xy, 0));
+
+    if (op == 0)
+    {
+        return color;
+    }
+
+    float3 rgb = color.rgb * exposureScale;
+
+    if (op == 1)
+    {
+        rgb = saturate(rgb);
+    }
+    else if (op == 2)
+    {
+        rgb = rgb / (1.0f + rgb);
+    }
+    else if (op == 3)
+    {
+        rgb = acesFilmic(rgb);
+    }
+
+    if (srgb != 0)
+    {
+        rgb = pow(abs(rgb), 1.0f / 2.2f);
+    }
+
+    return float4(rgb, color.a);
+}
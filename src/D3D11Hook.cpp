@@ -126,7 +126,8 @@ thread_local bool g_inside_d3d11_present = false;
 HRESULT last_d3d11_present_result = S_OK;
 
 HRESULT WINAPI D3D11Hook::present(IDXGISwapChain* swap_chain, UINT sync_interval, UINT flags) {
-    std::scoped_lock _{g_framework->get_hook_monitor_mutex()};
+    // Lock free unless the hook monitor is rehooking right now
+    auto _ = g_framework->enter_present();
 
     auto d3d11 = g_d3d11_hook;
 
@@ -1,9 +1,11 @@
+#include <atomic>
 #include <thread>
 #include <future>
 #include <unordered_set>
 
 #include <mods/VR.hpp>
 #include <spdlog/spdlog.h>
+#include <utility/HotLog.hpp>
 #include <utility/Module.hpp>
 #include <utility/Thread.hpp>
 
@@ -15,6 +17,44 @@
 
 static D3D12Hook* g_d3d12_hook = nullptr;
 
+namespace {
+// Pointer reads for utility::find_command_queue_layout and friends. VirtualQuery instead of IsBadReadPtr,
+// which works by catching access violations, trips guard pages and isn't thread safe.
+// Remembers the last readable region, short lived on purpose since memory can be freed at any time.
+class RegionReader {
+public:
+    std::optional<uintptr_t> operator()(uintptr_t address) {
+        if (address < m_begin || address + sizeof(uintptr_t) > m_end) {
+            constexpr DWORD readable = PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+
+            MEMORY_BASIC_INFORMATION mbi{};
+
+            if (VirtualQuery((LPCVOID)address, &mbi, sizeof(mbi)) == 0 || mbi.State != MEM_COMMIT || (mbi.Protect & (PAGE_GUARD | PAGE_NOACCESS)) != 0
+                || (mbi.Protect & readable) == 0) {
+                return std::nullopt;
+            }
+
+            m_begin = (uintptr_t)mbi.BaseAddress;
+            m_end = m_begin + mbi.RegionSize;
+
+            if (address + sizeof(uintptr_t) > m_end) {
+                return std::nullopt;
+            }
+        }
+
+        return *(const uintptr_t*)address;
+    }
+
+private:
+    uintptr_t m_begin{0};
+    uintptr_t m_end{0};
+};
+
+// Last direct queue that executed on any thread, only used when the swapchain layout wasn't found.
+// Games often submit from worker threads and present from another one.
+std::atomic<ID3D12CommandQueue*> g_last_direct_queue{nullptr};
+}
+
 D3D12Hook::~D3D12Hook() {
     unhook();
 }
@@ -227,70 +267,18 @@ bool D3D12Hook::hook() {
 
     spdlog::info("Finding command queue offset");
 
-    // Find the command queue offset in the swapchain
-    for (auto i = 0; i < 512 * sizeof(void*); i += sizeof(void*)) {
-        const auto base = (uintptr_t)swap_chain1 + i;
-
-        // reached the end
-        if (IsBadReadPtr((void*)base, sizeof(void*))) {
-            break;
-        }
-
-        auto data = *(ID3D12CommandQueue**)base;
+    m_command_queue_layout = utility::find_command_queue_layout((uintptr_t)swap_chain1, (uintptr_t)command_queue, RegionReader{});
+    m_command_queue_swap_chain = nullptr;
+    m_using_proton_swapchain = m_command_queue_layout && m_command_queue_layout->proton_offset.has_value();
 
-        if (data == command_queue) {
-            m_command_queue_offset = i;
-            spdlog::info("Found command queue offset: {:x}", i);
-            break;
-        }
+    if (m_using_proton_swapchain) {
+        spdlog::info("Proton potentially detected");
     }
 
-    // Scan throughout the swapchain for a valid pointer to scan through
-    // this is usually only necessary for Proton
-    if (m_command_queue_offset == 0) {
-        for (auto base = 0; base < 512 * sizeof(void*); base += sizeof(void*)) {
-            const auto pre_scan_base = (uintptr_t)swap_chain1 + base;
-
-            // reached the end
-            if (IsBadReadPtr((void*)pre_scan_base, sizeof(void*))) {
-                break;
-            }
-
-            const auto scan_base = *(uintptr_t*)pre_scan_base;
-
-            if (scan_base == 0 || IsBadReadPtr((void*)scan_base, sizeof(void*))) {
-                continue;
-            }
-
-            for (auto i = 0; i < 512 * sizeof(void*); i += sizeof(void*)) {
-                const auto pre_data = scan_base + i;
-
-                if (IsBadReadPtr((void*)pre_data, sizeof(void*))) {
-                    break;
-                }
-
-                auto data = *(ID3D12CommandQueue**)pre_data;
-
-                if (data == command_queue) {
-                    m_using_proton_swapchain = true;
-                    m_command_queue_offset = i;
-                    m_proton_swapchain_offset = base;
-
-                    spdlog::info("Proton potentially detected");
-                    spdlog::info("Found command queue offset: {:x}", i);
-                    break;
-                }
-            }
-
-            if (m_using_proton_swapchain) {
-                break;
-            }
-        }
-    }
-
-    if (m_command_queue_offset == 0) {
-        spdlog::error("Failed to find command queue offset");
-        return false;
+    if (m_command_queue_layout) {
+        spdlog::info("Found command queue offset: {:x}", m_command_queue_layout->queue_offset);
+    } else {
+        spdlog::warn("Failed to find command queue offset, learning the queue from ExecuteCommandLists instead");
     }
 
     ID3D12CommandAllocator* cmd_allocator{};
@@ -325,12 +313,21 @@ bool D3D12Hook::hook() {
 
         auto& present_fn = (*(void***)swap_chain)[8]; // Present
         m_present_hook = std::make_unique<PointerHook>(&present_fn, (void*)&D3D12Hook::present);
+
+        m_execute_command_lists_hook.reset();
+
+        if (!m_command_queue_layout) {
+            auto& execute_command_lists_fn = (*(void***)command_queue)[10]; // ExecuteCommandLists
+            m_execute_command_lists_hook = std::make_unique<PointerHook>(&execute_command_lists_fn, (void*)&D3D12Hook::execute_command_lists);
+        }
         auto& set_render_targets_fn = (*(void***)cmd_list)[46];
         auto& set_scissor_rects_fn = (*(void***)cmd_list)[22];
         auto& set_viewports_fn = (*(void***)cmd_list)[21];
+        auto& close_command_list_fn = (*(void***)cmd_list)[9];
+        auto& reset_command_list_fn = (*(void***)cmd_list)[10];
+        auto& clear_state_fn = (*(void***)cmd_list)[11];
         auto& create_render_target_view_fn = (*(void***)device)[20];
-        // auto& set_shading_rate_image_fn = (*(void***)cmd_list)[78];
-        // auto& set_shading_rate = (*(void***)cmd_list)[77];
+        auto& create_command_list_fn = (*(void***)device)[12];
 //        auto& set_pipeline_state_fn = (*(void***)cmd_list)[25];
 //        auto Barriers = VtableIndexFinder::getIndexOf(&ID3D12GraphicsCommandList::ResourceBarrier);
 //        spdlog::info("ResourceBarrier offset: {}", Barriers);
@@ -342,6 +339,27 @@ bool D3D12Hook::hook() {
         m_set_render_targets_hook = std::make_unique<PointerHook>(&set_render_targets_fn, (void*)&D3D12Hook::set_render_targets);
         m_on_set_scissor_rects_hook = std::make_unique<PointerHook>(&set_scissor_rects_fn, (void*)&D3D12Hook::set_scissor_rects);
         m_set_viewports_hook = std::make_unique<PointerHook>(&set_viewports_fn, (void*)&D3D12Hook::set_viewports);
+        // the state tracked for the setters above ends with the recording
+        m_close_command_list_hook = std::make_unique<PointerHook>(&close_command_list_fn, (void*)&D3D12Hook::close_command_list);
+        m_reset_command_list_hook = std::make_unique<PointerHook>(&reset_command_list_fn, (void*)&D3D12Hook::reset_command_list);
+        m_clear_state_hook = std::make_unique<PointerHook>(&clear_state_fn, (void*)&D3D12Hook::clear_state);
+        m_create_command_list_hook = std::make_unique<PointerHook>(&create_command_list_fn, (void*)&D3D12Hook::create_command_list);
+
+        // listeners that bind a shading rate only skip it when the game's own binds are seen too
+        m_set_shading_rate_hook.reset();
+        m_set_shading_rate_image_hook.reset();
+
+        if (cmd_list5 != nullptr) {
+            auto& set_shading_rate_fn = (*(void***)cmd_list5)[77];
+            auto& set_shading_rate_image_fn = (*(void***)cmd_list5)[78];
+            m_set_shading_rate_hook = std::make_unique<PointerHook>(&set_shading_rate_fn, (void*)&D3D12Hook::set_shading_rate);
+            m_set_shading_rate_image_hook = std::make_unique<PointerHook>(&set_shading_rate_image_fn, (void*)&D3D12Hook::set_shading_rate_image);
+        }
+
+        // whatever was recorded while unhooked wasn't seen
+        m_command_list_state.invalidate();
+        m_command_list_state.set_observing_shading_rate(m_set_shading_rate_hook != nullptr && m_set_shading_rate_image_hook != nullptr);
+
         m_create_render_target_view_hook = std::make_unique<PointerHook>(&create_render_target_view_fn, (void*)&D3D12Hook::create_render_target_view);
 #endif
         //        m_commandlist_dispatch_hook = std::make_unique<PointerHook>(&(*(void***)cmd_list)[14], (void*)&D3D12Hook::dispatch);
@@ -393,6 +411,8 @@ bool D3D12Hook::unhook() {
 
     m_present_hook.reset();
     m_swapchain_hook.reset();
+    m_execute_command_lists_hook.reset();
+    m_command_queue_swap_chain = nullptr;
 //    m_commandlist_hook.reset();
     m_last_used_dsv_resource = nullptr;
 //    m_last_used_dsv_handle = nullptr;
@@ -407,11 +427,54 @@ bool D3D12Hook::unhook() {
 
 thread_local int32_t g_present_depth = 0;
 
+void D3D12Hook::update_command_queue(IDXGISwapChain3* swap_chain, uintptr_t wrapped_swap_chain) {
+    // A queue of another device is left over from a swapchain or device the game has since replaced
+    const auto on_swap_chain_device = [&](ID3D12CommandQueue* queue) {
+        Microsoft::WRL::ComPtr<ID3D12Device4> queue_device{};
+        return queue != nullptr && SUCCEEDED(queue->GetDevice(IID_PPV_ARGS(&queue_device))) && queue_device.Get() == m_device;
+    };
+
+    ID3D12CommandQueue* queue{nullptr};
+
+    if (m_command_queue_layout) {
+        if (const auto resolved = utility::resolve_command_queue((uintptr_t)swap_chain, *m_command_queue_layout, RegionReader{})) {
+            queue = (ID3D12CommandQueue*)*resolved;
+        }
+    } else {
+        queue = g_last_direct_queue.load(std::memory_order_acquire);
+    }
+
+    if (!on_swap_chain_device(queue)) {
+        queue = nullptr;
+    }
+
+    if (queue != m_command_queue) {
+        spdlog::info("Command queue for swapchain {:x}: {:x}", (uintptr_t)swap_chain, (uintptr_t)queue);
+    }
+
+    // Nothing cached on failure, tried again next present
+    m_command_queue = queue;
+    m_command_queue_swap_chain = queue != nullptr ? swap_chain : nullptr;
+    m_command_queue_wrapped = wrapped_swap_chain;
+}
+
+void D3D12Hook::execute_command_lists(ID3D12CommandQueue* queue, UINT num_command_lists, ID3D12CommandList* const* command_lists) {
+    auto d3d12 = g_d3d12_hook;
+    const auto execute_command_lists_fn = d3d12->m_execute_command_lists_hook->get_original<decltype(D3D12Hook::execute_command_lists)*>();
+
+    if (queue != g_last_direct_queue.load(std::memory_order_relaxed) && queue->GetDesc().Type == D3D12_COMMAND_LIST_TYPE_DIRECT) {
+        g_last_direct_queue.store(queue, std::memory_order_release);
+    }
+
+    execute_command_lists_fn(queue, num_command_lists, command_lists);
+}
+
 
 
 HRESULT WINAPI D3D12Hook::present(IDXGISwapChain3* swap_chain, UINT sync_interval, UINT flags) {
 //    spdlog::info("Present called");
-    std::scoped_lock _{g_framework->get_hook_monitor_mutex()};
+    // Lock free unless the hook monitor is rehooking right now
+    auto _ = g_framework->enter_present();
 
     auto d3d12 = g_d3d12_hook;
 
@@ -441,9 +504,13 @@ HRESULT WINAPI D3D12Hook::present(IDXGISwapChain3* swap_chain, UINT sync_interva
         const auto og_instance = d3d12->m_swapchain_hook->get_instance();
 
         // If the original swapchain instance is invalid, then we should not proceed, and rehook the swapchain
-        if (IsBadReadPtr(og_instance, sizeof(void*)) || IsBadReadPtr(og_instance.deref(), sizeof(void*))) {
+        RegionReader read{};
+        const auto og_vtable = read((uintptr_t)(void*)og_instance);
+
+        if (!og_vtable || !read(*og_vtable)) {
             spdlog::error("Bad read pointer for original swapchain instance, re-hooking");
             d3d12->m_is_phase_1 = true;
+            d3d12->m_command_queue_swap_chain = nullptr;
         }
 
         if (!d3d12->m_is_phase_1) {
@@ -471,24 +538,17 @@ HRESULT WINAPI D3D12Hook::present(IDXGISwapChain3* swap_chain, UINT sync_interva
 
     swap_chain->GetDevice(IID_PPV_ARGS(&d3d12->m_device));
 
-    ID3D12CommandQueue * command_queue = nullptr;
-
+    // Resolved once per swapchain, resize_buffers, rehooking and Proton wrapping the swapchain again start over
     if (d3d12->m_device != nullptr) {
+        uintptr_t wrapped_swap_chain{0};
 
-        auto real_swap_chain = (uintptr_t)swap_chain;
         if (d3d12->m_using_proton_swapchain) {
-            real_swap_chain = *(uintptr_t*)((uintptr_t)swap_chain + d3d12->m_proton_swapchain_offset);
-        }
-        command_queue = *(ID3D12CommandQueue**)(real_swap_chain + d3d12->m_command_queue_offset);
-        if (command_queue == nullptr || IsBadReadPtr(command_queue, sizeof(void*)) && d3d12->m_using_proton_swapchain) {
-            //double wrap issue after alt tab for starfield, don't want to recurse, hope one level is suffitient
-            real_swap_chain = *(uintptr_t*)((uintptr_t)real_swap_chain + d3d12->m_proton_swapchain_offset);
-            command_queue = *(ID3D12CommandQueue**)(real_swap_chain + d3d12->m_command_queue_offset);
+            wrapped_swap_chain = utility::wrapped_swap_chain((uintptr_t)swap_chain, *d3d12->m_command_queue_layout, RegionReader{}).value_or(0);
         }
-    }
 
-    if (command_queue != nullptr && !IsBadReadPtr(command_queue, sizeof(void*))) {
-        d3d12->m_command_queue = command_queue;
+        if (swap_chain != d3d12->m_command_queue_swap_chain || wrapped_swap_chain != d3d12->m_command_queue_wrapped || d3d12->m_command_queue == nullptr) {
+            d3d12->update_command_queue(swap_chain, wrapped_swap_chain);
+        }
     }
 
     if (d3d12->m_swapchain_0 == nullptr) {
@@ -519,7 +579,7 @@ HRESULT WINAPI D3D12Hook::present(IDXGISwapChain3* swap_chain, UINT sync_interva
             --g_present_depth;
 
             if (result != S_OK) {
-                spdlog::error("Present failed: {:x}", result);
+                VR_HOT_LOG(spdlog::level::err, 1.0, 5, "Present failed: {:x}", result);
             }
 
             return result;
@@ -566,7 +626,7 @@ HRESULT WINAPI D3D12Hook::present(IDXGISwapChain3* swap_chain, UINT sync_interva
         result = present_fn(swap_chain, sync_interval, flags);
 
         if (result != S_OK) {
-            spdlog::error("Present failed: {:x}", result);
+            VR_HOT_LOG(spdlog::level::err, 1.0, 5, "Present failed: {:x}", result);
         }
     } else {
         d3d12->m_ignore_next_present = false;
@@ -607,6 +667,7 @@ HRESULT WINAPI D3D12Hook::resize_buffers(IDXGISwapChain3* swap_chain, UINT buffe
     d3d12->m_display_width = width;
     d3d12->m_display_height = height;
     d3d12->m_last_used_dsv_resource = nullptr;
+    d3d12->m_command_queue_swap_chain = nullptr;
 //    d3d12->m_last_used_dsv_handle = nullptr;
 //    d3d12->m_dsv_to_resource.clear();
 //    d3d12->m_dsvs.clear();
@@ -736,9 +797,12 @@ void D3D12Hook::set_render_targets(ID3D12GraphicsCommandList5* cmd_list, UINT Nu
 {
     auto d3d12 = g_d3d12_hook;
     auto set_render_targets_fn = g_d3d12_hook->m_set_render_targets_hook->get_original<decltype(D3D12Hook::set_render_targets)*>();
-    if (d3d12->m_on_set_render_targets) {
-        d3d12->m_on_set_render_targets(*d3d12, cmd_list, NumRenderTargetDescriptors, pRenderTargetDescriptors, RTsSingleHandleToDescriptorRange, depth_stencil_descriptor);
+
+    if (!d3d12->m_on_set_render_targets.empty() &&
+        d3d12->m_command_list_state.set_render_targets(cmd_list, NumRenderTargetDescriptors, pRenderTargetDescriptors, RTsSingleHandleToDescriptorRange != FALSE, depth_stencil_descriptor)) {
+        d3d12->m_on_set_render_targets(cmd_list, NumRenderTargetDescriptors, pRenderTargetDescriptors, RTsSingleHandleToDescriptorRange, depth_stencil_descriptor);
     }
+
     set_render_targets_fn(cmd_list, NumRenderTargetDescriptors, pRenderTargetDescriptors, RTsSingleHandleToDescriptorRange, depth_stencil_descriptor);
 }
 
@@ -776,9 +840,11 @@ void D3D12Hook::set_scissor_rects(ID3D12GraphicsCommandList5* cmd_list, UINT Num
     auto d3d12 = g_d3d12_hook;
 
     auto on_set_scissor_rects_original_fn = d3d12->m_on_set_scissor_rects_hook->get_original<decltype(D3D12Hook::set_scissor_rects)*>();
-    if(d3d12->m_on_set_scissor_rects) {
-        d3d12->m_on_set_scissor_rects(*d3d12, cmd_list, NumRects, pRects);
+
+    if (!d3d12->m_on_set_scissor_rects.empty() && d3d12->m_command_list_state.set_scissor_rects(cmd_list, NumRects, pRects)) {
+        d3d12->m_on_set_scissor_rects(cmd_list, NumRects, pRects);
     }
+
     on_set_scissor_rects_original_fn(cmd_list, NumRects, pRects);
 }
 
@@ -786,21 +852,88 @@ void D3D12Hook::set_viewports(ID3D12GraphicsCommandList5* cmd_list, UINT NumView
     auto d3d12 = g_d3d12_hook;
     auto set_viewports_original_fn = d3d12->m_set_viewports_hook->get_original<decltype(D3D12Hook::set_viewports)*>();
     
-    if(d3d12->m_on_set_viewports) {
-        d3d12->m_on_set_viewports(*d3d12, cmd_list, NumViewports, pViewports);
+    if (!d3d12->m_on_set_viewports.empty() && d3d12->m_command_list_state.set_viewports(cmd_list, NumViewports, pViewports)) {
+        d3d12->m_on_set_viewports(cmd_list, NumViewports, pViewports);
     }
     
     set_viewports_original_fn(cmd_list, NumViewports, pViewports);
 }
 
+HRESULT D3D12Hook::close_command_list(ID3D12GraphicsCommandList* cmd_list) {
+    auto d3d12 = g_d3d12_hook;
+    auto close_command_list_original_fn = d3d12->m_close_command_list_hook->get_original<decltype(D3D12Hook::close_command_list)*>();
+
+    d3d12->m_command_list_state.release(cmd_list);
+
+    return close_command_list_original_fn(cmd_list);
+}
+
+HRESULT D3D12Hook::reset_command_list(ID3D12GraphicsCommandList* cmd_list, ID3D12CommandAllocator* pAllocator, ID3D12PipelineState* pInitialState) {
+    auto d3d12 = g_d3d12_hook;
+    auto reset_command_list_original_fn = d3d12->m_reset_command_list_hook->get_original<decltype(D3D12Hook::reset_command_list)*>();
+
+    d3d12->m_command_list_state.release(cmd_list);
+
+    return reset_command_list_original_fn(cmd_list, pAllocator, pInitialState);
+}
+
+void D3D12Hook::clear_state(ID3D12GraphicsCommandList* cmd_list, ID3D12PipelineState* pPipelineState) {
+    auto d3d12 = g_d3d12_hook;
+    auto clear_state_original_fn = d3d12->m_clear_state_hook->get_original<decltype(D3D12Hook::clear_state)*>();
+
+    d3d12->m_command_list_state.release(cmd_list);
+
+    clear_state_original_fn(cmd_list, pPipelineState);
+}
+
+void D3D12Hook::set_shading_rate(ID3D12GraphicsCommandList5* cmd_list, D3D12_SHADING_RATE base_shading_rate, const D3D12_SHADING_RATE_COMBINER* combiners) {
+    auto d3d12 = g_d3d12_hook;
+    auto set_shading_rate_original_fn = d3d12->m_set_shading_rate_hook->get_original<decltype(D3D12Hook::set_shading_rate)*>();
+
+    CommandListState::ShadingRate rate{(uint32_t)base_shading_rate};
+
+    if (combiners != nullptr) {
+        for (size_t i = 0; i < rate.combiners.size(); ++i) {
+            rate.combiners[i] = (uint32_t)combiners[i];
+        }
+    }
+
+    d3d12->m_command_list_state.observe_shading_rate(cmd_list, rate);
+
+    set_shading_rate_original_fn(cmd_list, base_shading_rate, combiners);
+}
+
+void D3D12Hook::set_shading_rate_image(ID3D12GraphicsCommandList5* cmd_list, ID3D12Resource* shading_rate_image) {
+    auto d3d12 = g_d3d12_hook;
+    auto set_shading_rate_image_original_fn = d3d12->m_set_shading_rate_image_hook->get_original<decltype(D3D12Hook::set_shading_rate_image)*>();
+
+    d3d12->m_command_list_state.observe_shading_rate_image(cmd_list, shading_rate_image);
+
+    set_shading_rate_image_original_fn(cmd_list, shading_rate_image);
+}
+
+// New lists start recording right away, an entry left behind by a list that was freed mid recording
+// at the same address mustn't carry over
+HRESULT D3D12Hook::create_command_list(ID3D12Device* device, UINT node_mask, D3D12_COMMAND_LIST_TYPE type, ID3D12CommandAllocator* allocator,
+                                       ID3D12PipelineState* initial_state, REFIID riid, void** command_list) {
+    auto d3d12 = g_d3d12_hook;
+    auto create_command_list_original_fn = d3d12->m_create_command_list_hook->get_original<decltype(D3D12Hook::create_command_list)*>();
+
+    const auto result = create_command_list_original_fn(device, node_mask, type, allocator, initial_state, riid, command_list);
+
+    if (SUCCEEDED(result) && command_list != nullptr && *command_list != nullptr) {
+        d3d12->m_command_list_state.release(*command_list);
+    }
+
+    return result;
+}
+
 void D3D12Hook::create_render_target_view(ID3D12Device* device, ID3D12Resource* pResource, const D3D12_RENDER_TARGET_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor)
 {
     auto d3d12 = g_d3d12_hook;
     auto create_render_target_view_fn = d3d12->m_create_render_target_view_hook->get_original<decltype(D3D12Hook::create_render_target_view)*>();
     create_render_target_view_fn(device, pResource, pDesc, DestDescriptor);
-    if (d3d12->m_on_create_render_target_view) {
-        d3d12->m_on_create_render_target_view(*d3d12, device, pResource, pDesc, DestDescriptor);
-    }
+    d3d12->m_on_create_render_target_view(device, pResource, pDesc, DestDescriptor);
 }
 
 //HRESULT D3D12Hook::create_graphics_pipeline_state(ID3D12Device* device, const D3D12_GRAPHICS_PIPELINE_STATE_DESC * pDesc, const IID& riid, void** ppPipelineState)
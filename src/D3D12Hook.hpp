@@ -9,6 +9,9 @@
 #include <d3d12.h>
 #include <dxgi1_4.h>
 
+#include "utility/CallbackDispatcher.hpp"
+#include "utility/CommandListStateTracker.hpp"
+#include "utility/CommandQueueLocator.hpp"
 #include "utility/PointerHook.hpp"
 #include "utility/VtableHook.hpp"
 #include <wrl.h>
@@ -21,10 +24,12 @@ public:
     typedef std::function<void(D3D12Hook&)>                                                OnPresentFn;
     typedef std::function<void(D3D12Hook&)>                                                OnResizeBuffersFn;
     typedef std::function<void(D3D12Hook&)>                                                OnResizeTargetFn;
-    typedef std::function<void(D3D12Hook&, ID3D12GraphicsCommandList5*, UINT, const D3D12_CPU_DESCRIPTOR_HANDLE*, BOOL, D3D12_CPU_DESCRIPTOR_HANDLE* )> OnSetRenderTargetsFn;
-    typedef std::function<void(D3D12Hook&, ID3D12GraphicsCommandList5*, UINT, const D3D12_RECT* pRects)> OnSetScissorRectsFn;
-    typedef std::function<void(D3D12Hook&, ID3D12GraphicsCommandList5*, UINT, const D3D12_VIEWPORT*)> OnSetViewportsFn;
-    typedef std::function<void(D3D12Hook&, ID3D12Device*, ID3D12Resource*, const D3D12_RENDER_TARGET_VIEW_DESC*, D3D12_CPU_DESCRIPTOR_HANDLE)> OnCreateRenderTargetViewFn;
+    // Command list and view hooks run far too often for std::function, see utility::CallbackDispatcher
+    using SetRenderTargetsDispatcher = utility::CallbackDispatcher<ID3D12GraphicsCommandList5*, UINT, const D3D12_CPU_DESCRIPTOR_HANDLE*, BOOL, D3D12_CPU_DESCRIPTOR_HANDLE*>;
+    using SetScissorRectsDispatcher = utility::CallbackDispatcher<ID3D12GraphicsCommandList5*, UINT, const D3D12_RECT*>;
+    using SetViewportsDispatcher = utility::CallbackDispatcher<ID3D12GraphicsCommandList5*, UINT, const D3D12_VIEWPORT*>;
+    using CreateRenderTargetViewDispatcher = utility::CallbackDispatcher<ID3D12Device*, ID3D12Resource*, const D3D12_RENDER_TARGET_VIEW_DESC*, D3D12_CPU_DESCRIPTOR_HANDLE>;
+    using CommandListState = utility::CommandListStateTracker<D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_VIEWPORT, D3D12_RECT>;
     typedef std::function<void(D3D12Hook&)>                                                OnCreateSwapChainFn;
 
     D3D12Hook() = default;
@@ -43,21 +48,16 @@ public:
 
     inline void on_resize_target(OnResizeTargetFn fn) { m_on_resize_target = fn; }
 
-    inline void on_set_render_targets(OnSetRenderTargetsFn fn) {
-        m_on_set_render_targets = fn;
-    }
+    inline auto& get_set_render_targets_listeners() { return m_on_set_render_targets; }
 
-    inline void on_set_scissor_rects(OnSetScissorRectsFn fn) {
-        m_on_set_scissor_rects = fn;
-    }
+    inline auto& get_set_scissor_rects_listeners() { return m_on_set_scissor_rects; }
 
-    inline void on_set_viewports(OnSetViewportsFn fn) {
-        m_on_set_viewports = fn;
-    }
+    inline auto& get_set_viewports_listeners() { return m_on_set_viewports; }
 
-    inline void on_create_render_target_view(OnCreateRenderTargetViewFn fn) {
-        m_on_create_render_target_view = fn;
-    }
+    inline auto& get_create_render_target_view_listeners() { return m_on_create_render_target_view; }
+
+    // Listeners of the setters above only run when the command list state changed, see CommandListState
+    inline auto& get_command_list_state() { return m_command_list_state; }
 
     /*void on_create_swap_chain(OnCreateSwapChainFn fn) {
         m_on_create_swap_chain = fn;
@@ -103,8 +103,10 @@ protected:
     UINT                m_render_width{ NULL };
     UINT                m_render_height{ NULL };
 
-    uint32_t m_command_queue_offset{};
-    uint32_t m_proton_swapchain_offset{};
+    // Found on the dummy swapchain, the queue is read out of each real swapchain once through it
+    std::optional<utility::CommandQueueLayout> m_command_queue_layout{};
+    IDXGISwapChain3* m_command_queue_swap_chain{ nullptr }; // what m_command_queue was resolved for
+    uintptr_t m_command_queue_wrapped{ 0 }; // and the object it wrapped at the time, Proton only
 
     std::optional<uint32_t> m_next_present_interval{};
 
@@ -122,6 +124,13 @@ protected:
     std::unique_ptr<PointerHook> m_create_depth_stencil_view_hook{};
     std::unique_ptr<PointerHook> m_create_render_target_view_hook{};
     std::unique_ptr<PointerHook> m_create_commited_resource_hook{};
+    std::unique_ptr<PointerHook> m_execute_command_lists_hook{}; // only when no layout was found
+    std::unique_ptr<PointerHook> m_close_command_list_hook{};
+    std::unique_ptr<PointerHook> m_reset_command_list_hook{};
+    std::unique_ptr<PointerHook> m_clear_state_hook{};
+    std::unique_ptr<PointerHook> m_create_command_list_hook{};
+    std::unique_ptr<PointerHook> m_set_shading_rate_hook{};
+    std::unique_ptr<PointerHook> m_set_shading_rate_image_hook{};
     // std::unique_ptr<FunctionHook> m_create_swap_chain_hook{};
 
     std::unordered_map<SIZE_T, D3D12_RESOURCE_DESC> m_dsvs{};
@@ -131,13 +140,17 @@ protected:
     OnPresentFn          m_on_post_present{ nullptr };
     OnResizeBuffersFn    m_on_resize_buffers{ nullptr };
     OnResizeTargetFn     m_on_resize_target{ nullptr };
-    OnSetRenderTargetsFn m_on_set_render_targets{ nullptr };
-    OnSetScissorRectsFn m_on_set_scissor_rects{ nullptr };
-    OnSetViewportsFn m_on_set_viewports{ nullptr };
-    OnCreateRenderTargetViewFn m_on_create_render_target_view{ nullptr };
+    SetRenderTargetsDispatcher m_on_set_render_targets{};
+    SetScissorRectsDispatcher m_on_set_scissor_rects{};
+    SetViewportsDispatcher m_on_set_viewports{};
+    CreateRenderTargetViewDispatcher m_on_create_render_target_view{};
+    CommandListState m_command_list_state{};
     // OnCreateSwapChainFn m_on_create_swap_chain{ nullptr };
 
+    void update_command_queue(IDXGISwapChain3* swap_chain, uintptr_t wrapped_swap_chain);
+
     static HRESULT WINAPI            present(IDXGISwapChain3* swap_chain, UINT sync_interval, UINT flags);
+    static void STDMETHODCALLTYPE    execute_command_lists(ID3D12CommandQueue* queue, UINT num_command_lists, ID3D12CommandList* const* command_lists);
     static HRESULT WINAPI            resize_buffers(IDXGISwapChain3* swap_chain, UINT buffer_count, UINT width, UINT height, DXGI_FORMAT new_format, UINT swap_chain_flags);
     static HRESULT WINAPI            resize_target(IDXGISwapChain3* swap_chain, const DXGI_MODE_DESC* new_target_parameters);
     static void STDMETHODCALLTYPE    set_render_targets(ID3D12GraphicsCommandList5* cmd_list, UINT NumRenderTargetDescriptors,
@@ -145,6 +158,13 @@ protected:
                                                         D3D12_CPU_DESCRIPTOR_HANDLE* depth_stencil_descriptor);
     static void STDMETHODCALLTYPE    set_scissor_rects(ID3D12GraphicsCommandList5* cmd_list, _In_ UINT NumRects, _In_reads_(NumRects) const D3D12_RECT* pRects);
     static void STDMETHODCALLTYPE    set_viewports(ID3D12GraphicsCommandList5* cmd_list, _In_ UINT NumViewports, _In_reads_(NumViewports) const D3D12_VIEWPORT* pViewports);
+    static HRESULT STDMETHODCALLTYPE close_command_list(ID3D12GraphicsCommandList* cmd_list);
+    static HRESULT STDMETHODCALLTYPE reset_command_list(ID3D12GraphicsCommandList* cmd_list, ID3D12CommandAllocator* pAllocator, ID3D12PipelineState* pInitialState);
+    static void STDMETHODCALLTYPE    clear_state(ID3D12GraphicsCommandList* cmd_list, ID3D12PipelineState* pPipelineState);
+    static void STDMETHODCALLTYPE    set_shading_rate(ID3D12GraphicsCommandList5* cmd_list, D3D12_SHADING_RATE base_shading_rate, const D3D12_SHADING_RATE_COMBINER* combiners);
+    static void STDMETHODCALLTYPE    set_shading_rate_image(ID3D12GraphicsCommandList5* cmd_list, ID3D12Resource* shading_rate_image);
+    static HRESULT STDMETHODCALLTYPE create_command_list(ID3D12Device* device, UINT node_mask, D3D12_COMMAND_LIST_TYPE type, ID3D12CommandAllocator* allocator,
+                                                         ID3D12PipelineState* initial_state, REFIID riid, void** command_list);
 //    static void STDMETHODCALLTYPE    dispatch(ID3D12GraphicsCommandList* cmd_list, _In_ UINT ThreadGroupCountX, _In_ UINT ThreadGroupCountY, UINT ThreadGroupCountZ);
 //    static void STDMETHODCALLTYPE    execute_indirect(ID3D12GraphicsCommandList* cmd_list, _In_ ID3D12CommandSignature* pCommandSignature, _In_ UINT MaxCommandCount,
 //                                                      _In_ ID3D12Resource* pArgumentBuffer, _In_ UINT64 ArgumentBufferOffset, _In_opt_ ID3D12Resource* pCountBuffer,
@@ -1,100 +1,236 @@
 #include <windows.h>
 #include <DbgHelp.h>
+#include <Psapi.h>
 #include <ShlObj.h>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
 #include <spdlog/spdlog.h>
 
 #include "utility/Module.hpp"
 #include "utility/Scan.hpp"
 #include "utility/Patch.hpp"
+#include "utility/CrashCapture.hpp"
 
 #include "ExceptionHandler.hpp"
 #include "Framework.hpp"
 
-void dump_call_stack(EXCEPTION_POINTERS* exception) {
+// Preallocated so the filter doesn't have to allocate while the heap may be the thing that's broken.
+static utility::CrashCapture g_crash_capture{};
+static char g_crash_report[32 * 1024]{};
+// Resolved up front in setup_exception_handler, the filter doesn't build paths
+static wchar_t g_crash_capture_path[MAX_PATH]{};
+static wchar_t g_crash_report_path[MAX_PATH]{};
+
+// VirtualQuery and GetMappedFileName only ask the memory manager, unlike GetModuleHandleEx and
+// GetModuleFileName they don't need the loader lock, which the crashing thread or a stuck one may hold.
+static void capture_module(utility::CrashCapture& capture, uint64_t address) {
+    if (capture.find_module(address) != nullptr) {
+        return;
+    }
+
+    MEMORY_BASIC_INFORMATION mbi{};
+
+    if (VirtualQuery((LPCVOID)address, &mbi, sizeof(mbi)) == 0 || mbi.Type != MEM_IMAGE || mbi.AllocationBase == nullptr) {
+        return;
+    }
+
+    const auto module = (uintptr_t)mbi.AllocationBase;
+    const auto dos = (const IMAGE_DOS_HEADER*)module;
+
+    if (dos->e_magic != IMAGE_DOS_SIGNATURE) {
+        return;
+    }
+
+    const auto nt = (const IMAGE_NT_HEADERS*)(module + dos->e_lfanew);
+
+    auto entry = capture.add_module((uint64_t)module, nt->OptionalHeader.SizeOfImage, nt->FileHeader.TimeDateStamp, nt->OptionalHeader.SizeOfImage, {});
+
+    if (entry != nullptr) {
+        // \Device\HarddiskVolumeN\... form, turned back into a drive path when symbolizing
+        GetMappedFileNameA(GetCurrentProcess(), (LPVOID)module, entry->path, sizeof(entry->path));
+    }
+}
+
+// Raw addresses and module ranges only, no symbol lookups in here.
+static void capture_crash(EXCEPTION_POINTERS* ei, utility::CrashCapture& capture) {
+    capture.reset();
+
+    const auto ctx = ei->ContextRecord;
+
+    capture.code = ei->ExceptionRecord->ExceptionCode;
+    capture.ip = ctx->Rip;
+    capture.thread_id = GetCurrentThreadId();
+
+    capture.add_register("RIP", ctx->Rip);
+    capture.add_register("RSP", ctx->Rsp);
+    capture.add_register("RBP", ctx->Rbp);
+    capture.add_register("RAX", ctx->Rax);
+    capture.add_register("RBX", ctx->Rbx);
+    capture.add_register("RCX", ctx->Rcx);
+    capture.add_register("RDX", ctx->Rdx);
+    capture.add_register("RSI", ctx->Rsi);
+    capture.add_register("RDI", ctx->Rdi);
+    capture.add_register("R8", ctx->R8);
+    capture.add_register("R9", ctx->R9);
+    capture.add_register("R10", ctx->R10);
+    capture.add_register("R11", ctx->R11);
+    capture.add_register("R12", ctx->R12);
+    capture.add_register("R13", ctx->R13);
+    capture.add_register("R14", ctx->R14);
+    capture.add_register("R15", ctx->R15);
+    capture.add_register("EFLAGS", ctx->EFlags);
+
+    void* stack[utility::CrashCapture::MAX_FRAMES]{};
+    const auto depth = RtlCaptureStackBackTrace(0, (DWORD)std::size(stack), stack, nullptr);
+
+    for (auto i = 0; i < depth; ++i) {
+        capture.add_frame((uint64_t)stack[i]);
+        capture_module(capture, (uint64_t)stack[i]);
+    }
+
+    capture_module(capture, capture.ip);
+}
+
+static bool write_crash_file(const wchar_t* path, const void* header, size_t header_size, const void* data, size_t size) {
+    if (path[0] == L'\0') {
+        return false;
+    }
+
+    const auto f = CreateFileW(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (f == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    DWORD written{};
+    auto ok = header_size == 0 || WriteFile(f, header, (DWORD)header_size, &written, nullptr);
+    ok = ok && WriteFile(f, data, (DWORD)size, &written, nullptr);
+
+    CloseHandle(f);
+    return ok;
+}
+
+// GetMappedFileName hands out \Device\HarddiskVolumeN\..., dbghelp wants C:\...
+static std::string to_dos_path(std::string_view path) {
+    char drive[] = "A:";
+    char device[MAX_PATH]{};
+
+    for (char letter = 'A'; letter <= 'Z'; ++letter) {
+        drive[0] = letter;
+
+        if (QueryDosDeviceA(drive, device, (DWORD)std::size(device)) == 0) {
+            continue;
+        }
+
+        const auto prefix = std::string_view{device};
+
+        if (path.size() > prefix.size() && path.starts_with(prefix) && path[prefix.size()] == '\\') {
+            return std::string{drive} + std::string{path.substr(prefix.size())};
+        }
+    }
+
+    return std::string{path};
+}
+
+// Runs on the next start from what the filter wrote. The modules are loaded into dbghelp at the
+// bases they had in the crashed process, so nothing of that process is needed anymore.
+static void symbolize_previous_crash(std::filesystem::path capture_path, std::filesystem::path report_path) {
+    std::string data{};
+
+    {
+        std::ifstream file{capture_path, std::ios::binary};
+
+        if (!file) {
+            return;
+        }
+
+        data.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+    }
+
+    // One attempt only, if dbghelp falls over on it this must not repeat on every start
+    std::error_code ec{};
+    std::filesystem::remove(capture_path, ec);
+
+    const auto capture = utility::read_crash_capture(data.data(), data.size());
+
+    if (!capture) {
+        spdlog::warn("Discarding unreadable crash capture from the previous run");
+        return;
+    }
+
     const auto dbghelp = LoadLibraryA("dbghelp.dll");
 
     if (dbghelp == nullptr) {
         spdlog::error("Failed to load dbghelp.dll");
+        return;
     }
 
-    const auto sym_initialize = (decltype(&SymInitialize))(dbghelp != nullptr ? GetProcAddress(dbghelp, "SymInitialize") : nullptr);
-    const auto sym_from_addr = (decltype(&SymFromAddr))(dbghelp != nullptr ? GetProcAddress(dbghelp, "SymFromAddr") : nullptr);
-    const auto sym_set_options = (decltype(&SymSetOptions))(dbghelp != nullptr ? GetProcAddress(dbghelp, "SymSetOptions") : nullptr);
-    const auto sym_get_line_from_addr64 = (decltype(&SymGetLineFromAddr))(dbghelp != nullptr ? GetProcAddress(dbghelp, "SymGetLineFromAddr64") : nullptr);
-    
-    const auto pid = GetCurrentProcessId();
-    const auto process = OpenProcess(PROCESS_ALL_ACCESS, FALSE, pid);
+    const auto sym_initialize = (decltype(&SymInitialize))GetProcAddress(dbghelp, "SymInitialize");
+    const auto sym_cleanup = (decltype(&SymCleanup))GetProcAddress(dbghelp, "SymCleanup");
+    const auto sym_from_addr = (decltype(&SymFromAddr))GetProcAddress(dbghelp, "SymFromAddr");
+    const auto sym_set_options = (decltype(&SymSetOptions))GetProcAddress(dbghelp, "SymSetOptions");
+    const auto sym_load_module_ex = (decltype(&SymLoadModuleEx))GetProcAddress(dbghelp, "SymLoadModuleEx");
+    const auto sym_get_line_from_addr64 = (decltype(&SymGetLineFromAddr64))GetProcAddress(dbghelp, "SymGetLineFromAddr64");
+
+    // Not a real process, only has to be unique to dbghelp
+    const auto process = (HANDLE)&capture;
 
     if (sym_set_options != nullptr) {
-        sym_set_options(SYMOPT_LOAD_LINES | SYMOPT_UNDNAME | SYMOPT_DEFERRED_LOADS);
+        sym_set_options(SYMOPT_LOAD_LINES | SYMOPT_UNDNAME);
     }
 
-    bool initialized = false;
-
-    if (sym_initialize != nullptr) {
-        initialized = sym_initialize(process, NULL, TRUE);
-        if (!initialized) {
-            spdlog::error("Failed to initialize symbol handler");
-        }
+    if (sym_initialize == nullptr || sym_from_addr == nullptr || sym_load_module_ex == nullptr || !sym_initialize(process, NULL, FALSE)) {
+        spdlog::error("Failed to initialize symbol handler");
+        return;
     }
 
-    constexpr auto max_stack_depth = 100;
-    uintptr_t stack[max_stack_depth]{};
+    for (uint32_t i = 0; i < capture->module_count; ++i) {
+        const auto& m = capture->modules[i];
+        const auto path = to_dos_path(m.path);
 
-    const auto depth = RtlCaptureStackBackTrace(0, max_stack_depth, (void**)stack, nullptr);
+        sym_load_module_ex(process, nullptr, path.c_str(), nullptr, m.base, (DWORD)m.size, nullptr, 0);
+    }
 
-    char symbol_data[sizeof(SYMBOL_INFO) + (256 * sizeof(char))]{};
-    SYMBOL_INFO* symbol = (SYMBOL_INFO*)symbol_data;
+    utility::CachedSymbolizer symbolizer{[&](uint64_t address, const utility::CrashModule*) -> std::optional<utility::CachedSymbolizer::Symbol> {
+        char symbol_data[sizeof(SYMBOL_INFO) + (256 * sizeof(char))]{};
+        SYMBOL_INFO* symbol = (SYMBOL_INFO*)symbol_data;
 
-    symbol->MaxNameLen = 255;
-    symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+        symbol->MaxNameLen = 255;
+        symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
 
-    spdlog::error("Call stack:");
-    std::string stack_message{"\n"};
-    for (auto i = 0; i < depth; ++i) {
-        bool symbol_found = false;
-        const auto module_within = utility::get_module_within(stack[i]);
+        DWORD64 displacement{};
 
-        if (sym_from_addr != nullptr && initialized) {
-            symbol_found = sym_from_addr(process, (DWORD64)stack[i], 0, symbol);
+        if (!sym_from_addr(process, (DWORD64)address, &displacement, symbol)) {
+            return std::nullopt;
         }
 
-        std::string symbol_name = symbol_found ? symbol->Name : "Unknown symbol";
+        utility::CachedSymbolizer::Symbol out{symbol->Name, {}, 0, displacement};
 
-        if (sym_get_line_from_addr64 != nullptr && initialized && symbol_found) {
-            DWORD displacement = 0;
+        if (sym_get_line_from_addr64 != nullptr) {
+            DWORD line_displacement = 0;
             IMAGEHLP_LINE64 line{};
-
             line.SizeOfStruct = sizeof(IMAGEHLP_LINE64);
 
-            if (sym_get_line_from_addr64(process, (DWORD64)stack[i], &displacement, &line)) {
-                symbol_name += " (";
-                symbol_name += line.FileName;
-                symbol_name += ":";
-                symbol_name += std::to_string(line.LineNumber);
-                symbol_name += ")";
+            if (sym_get_line_from_addr64(process, (DWORD64)address, &line_displacement, &line)) {
+                out.file = line.FileName;
+                out.line = line.LineNumber;
             }
         }
-        
-        if (module_within) {
-            const auto module_path = utility::get_module_path(*module_within);
-            const auto relative = stack[i] - (uintptr_t)*module_within;
-
-            if (module_path) {
-                stack_message += fmt::format(" {}\n  {} + 0x{:x}\n\n", symbol_name, *module_path, relative);
-                continue;
-            }
 
-            stack_message += fmt::format(" {}\n  0x{:x} + 0x{:x}\n\n", symbol_name, (uintptr_t)*module_within, relative);
-            continue;
-        }
+        return out;
+    }};
 
-        stack_message += fmt::format(" {}\n  0x{:x}\n\n", symbol_name, stack[i]);
-    }
+    const auto report = utility::format_crash_report(*capture, &symbolizer);
+
+    spdlog::error("Symbolized crash report of the previous run:\n{}", report);
+    std::ofstream{report_path} << report;
 
-    spdlog::error(stack_message);
-    CloseHandle(process);
+    if (sym_cleanup != nullptr) {
+        sym_cleanup(process);
+    }
 }
 
 LONG WINAPI gowvr::global_exception_handler(struct _EXCEPTION_POINTERS* ei) {
@@ -103,33 +239,17 @@ LONG WINAPI gowvr::global_exception_handler(struct _EXCEPTION_POINTERS* ei) {
 
     spdlog::flush_on(spdlog::level::err);
 
-    spdlog::error("Exception occurred: {:x}", ei->ExceptionRecord->ExceptionCode);
-    spdlog::error("RIP: {:x}", ei->ContextRecord->Rip);
-    spdlog::error("RSP: {:x}", ei->ContextRecord->Rsp);
-    spdlog::error("RCX: {:x}", ei->ContextRecord->Rcx);
-    spdlog::error("RDX: {:x}", ei->ContextRecord->Rdx);
-    spdlog::error("R8: {:x}", ei->ContextRecord->R8);
-    spdlog::error("R9: {:x}", ei->ContextRecord->R9);
-    spdlog::error("R10: {:x}", ei->ContextRecord->R10);
-    spdlog::error("R11: {:x}", ei->ContextRecord->R11);
-    spdlog::error("R12: {:x}", ei->ContextRecord->R12);
-    spdlog::error("R13: {:x}", ei->ContextRecord->R13);
-    spdlog::error("R14: {:x}", ei->ContextRecord->R14);
-    spdlog::error("R15: {:x}", ei->ContextRecord->R15);
-    spdlog::error("RAX: {:x}", ei->ContextRecord->Rax);
-    spdlog::error("RBX: {:x}", ei->ContextRecord->Rbx);
-    spdlog::error("RBP: {:x}", ei->ContextRecord->Rbp);
-    spdlog::error("RSI: {:x}", ei->ContextRecord->Rsi);
-    spdlog::error("RDI: {:x}", ei->ContextRecord->Rdi);
-    spdlog::error("EFLAGS: {:x}", ei->ContextRecord->EFlags);
-    spdlog::error("CS: {:x}", ei->ContextRecord->SegCs);
-    spdlog::error("DS: {:x}", ei->ContextRecord->SegDs);
-    spdlog::error("ES: {:x}", ei->ContextRecord->SegEs);
-    spdlog::error("FS: {:x}", ei->ContextRecord->SegFs);
-    spdlog::error("GS: {:x}", ei->ContextRecord->SegGs);
-    spdlog::error("SS: {:x}", ei->ContextRecord->SegSs);
-
-    dump_call_stack(ei);
+    capture_crash(ei, g_crash_capture);
+
+    // Raw and unsymbolized, written without allocating before anything else can go wrong.
+    // The next start symbolizes it, see symbolize_previous_crash.
+    const utility::CrashCaptureHeader header{};
+    const auto report_size = utility::format_crash_report(g_crash_capture, g_crash_report, sizeof(g_crash_report));
+
+    write_crash_file(g_crash_capture_path, &header, sizeof(header), &g_crash_capture, sizeof(g_crash_capture));
+    write_crash_file(g_crash_report_path, nullptr, 0, g_crash_report, report_size);
+
+    spdlog::error("Exception 0x{:x} at 0x{:x}, crash report written to vrframework_crash.txt", g_crash_capture.code, g_crash_capture.ip);
 
     const auto module_within = utility::get_module_within(ei->ContextRecord->Rip);
 
@@ -216,5 +336,18 @@ LONG WINAPI gowvr::global_exception_handler(struct _EXCEPTION_POINTERS* ei) {
 }
 
 void gowvr::setup_exception_handler() {
+    static std::once_flag once{};
+
+    std::call_once(once, [] {
+        const auto capture_path = Framework::get_persistent_dir("vrframework_crash.bin");
+        const auto report_path = Framework::get_persistent_dir("vrframework_crash.txt");
+
+        wcsncpy_s(g_crash_capture_path, capture_path.c_str(), _TRUNCATE);
+        wcsncpy_s(g_crash_report_path, report_path.c_str(), _TRUNCATE);
+
+        // Symbol lookups can take seconds with big PDBs, off the thread that's starting up
+        std::thread{symbolize_previous_crash, capture_path, report_path}.detach();
+    });
+
     SetUnhandledExceptionFilter(global_exception_handler);
 }
@@ -1,4 +1,5 @@
 #include <chrono>
+#include <condition_variable>
 #include <filesystem>
 #include <fstream>
 
@@ -31,6 +32,7 @@ extern "C" {
 #include "utility/Scan.hpp"
 #include "utility/String.hpp"
 #include "utility/Thread.hpp"
+#include "utility/ImGui.hpp"
 
 #include "Mods.hpp"
 //#include "mods/PluginLoader.hpp"
@@ -39,8 +41,10 @@ extern "C" {
 //#include "sdk/SDK.hpp"
 
 #include "ExceptionHandler.hpp"
+#include "ModuleWatcher.hpp"
 //#include "LicenseStrings.hpp"
 #include "mods/VRConfig.hpp"
+#include "memory/memory_mul.h"
 //#include "mods/IntegrityCheckBypass.hpp"
 #include "Framework.hpp"
 
@@ -51,95 +55,81 @@ extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg
 
 std::unique_ptr<Framework> g_framework{};
 
-void Framework::hook_monitor() {
+std::chrono::steady_clock::time_point Framework::hook_monitor() {
     std::scoped_lock _{ m_hook_monitor_mutex };
 
+    const auto now = std::chrono::steady_clock::now();
+
     if (g_framework == nullptr) {
-        return;
+        return now + std::chrono::seconds(1);
     }
 
-    const auto now = std::chrono::steady_clock::now();
-
     auto& d3d11 = get_d3d11_hook();
     auto& d3d12 = get_d3d12_hook();
 
     const auto renderer_type = get_renderer_type();
 
-    if (d3d11 == nullptr || d3d12 == nullptr 
-        || (renderer_type == Framework::RendererType::D3D11 && d3d11 != nullptr && !d3d11->is_inside_present())
-        || (renderer_type == Framework::RendererType::D3D12 && d3d12 != nullptr && !d3d12->is_inside_present()))
-    {
-        // check if present time is more than 5 seconds ago
-        if (now - m_last_present_time > std::chrono::seconds(5)) {
-            if (m_has_last_chance) {
-                // the purpose of this is to make sure that the game is not frozen
-                // e.g. if we are debugging the game, so we don't rehook anything on accident
-                m_has_last_chance = false;
-                m_last_chance_time = now;
-
-                spdlog::info("Last chance encountered for hooking");
-            }
+    utility::HookWatchdog::Inputs inputs{};
+    inputs.last_present = m_present_heartbeat.last();
+    inputs.last_message = m_message_heartbeat.last();
+    inputs.inside_present = d3d11 != nullptr && d3d12 != nullptr
+        && ((renderer_type == Framework::RendererType::D3D11 && d3d11->is_inside_present())
+        || (renderer_type == Framework::RendererType::D3D12 && d3d12->is_inside_present()));
+    inputs.message_hook_active = m_initialized && m_wnd != 0;
+    inputs.message_hook_intact = inputs.message_hook_active && m_windows_message_hook != nullptr && m_windows_message_hook->is_hook_intact();
 
-            if (!m_has_last_chance && now - m_last_chance_time > std::chrono::seconds(1)) {
-                spdlog::info("Sending rehook request for D3D");
+    const auto prev_stats = m_hook_watchdog.get_stats();
+    const auto actions = m_hook_watchdog.evaluate(inputs, now);
 
-                // hook_d3d12 always gets called first.
-                if (m_is_d3d11) {
-                    hook_d3d11();
-                } else {
-                    hook_d3d12();
-                }
+    if (m_hook_watchdog.get_stats().last_chances != prev_stats.last_chances) {
+        spdlog::info("Last chance encountered for hooking");
+    }
 
-                // so we don't immediately go and hook it again
-                // add some additional time to it to give it some leeway
-                m_last_present_time = std::chrono::steady_clock::now() + std::chrono::seconds(5);
-                m_last_message_time = std::chrono::steady_clock::now() + std::chrono::seconds(5);
-                m_last_chance_time = std::chrono::steady_clock::now() + std::chrono::seconds(1);
-                m_has_last_chance = true;
-            }
-        } else {
-            m_last_chance_time = std::chrono::steady_clock::now();
-            m_has_last_chance = true;
-        }
+    if (m_hook_watchdog.get_stats().intact_checks != prev_stats.intact_checks) {
+        spdlog::info("Windows message hook is still intact, ignoring...");
+    }
+
+    if (actions & utility::HookWatchdog::REHOOK_D3D) {
+        spdlog::info("Sending rehook request for D3D");
 
-        if (m_initialized && m_wnd != 0 && now - m_last_message_time > std::chrono::seconds(5)) {
-            if (m_windows_message_hook != nullptr && m_windows_message_hook->is_hook_intact()) {
-                spdlog::info("Windows message hook is still intact, ignoring...");
-                m_last_message_time = now;
-                m_last_sendmessage_time = now;
-                m_sent_message = false;
-                return;
+        // Presents can still be in flight on another thread, don't pull the hook out from under them
+        const auto rehooked = m_present_gate.run_exclusive([this] {
+            // hook_d3d12 always gets called first.
+            if (m_is_d3d11) {
+                hook_d3d11();
+            } else {
+                hook_d3d12();
             }
+        });
 
-            // send dummy message to window to check if our hook is still intact
-            if (!m_sent_message) {
-                spdlog::info("Sending initial message hook test");
+        if (!rehooked) {
+            spdlog::warn("Presents did not drain, skipping D3D rehook");
+        }
+    }
 
-                auto proc = (WNDPROC)GetWindowLongPtr(m_wnd, GWLP_WNDPROC);
+    if (actions & utility::HookWatchdog::SEND_MESSAGE_PROBE) {
+        // send dummy message to window to check if our hook is still intact
+        spdlog::info("Sending initial message hook test");
 
-                if (proc != nullptr) {
-                    const auto ret = CallWindowProc(proc, m_wnd, WM_NULL, 0, 0);
+        auto proc = (WNDPROC)GetWindowLongPtr(m_wnd, GWLP_WNDPROC);
 
-                    spdlog::info("Hook test message sent");
-                }
+        if (proc != nullptr) {
+            const auto ret = CallWindowProc(proc, m_wnd, WM_NULL, 0, 0);
 
-                m_last_sendmessage_time = std::chrono::steady_clock::now();
-                m_sent_message = true;
-            } else if (now - m_last_sendmessage_time > std::chrono::seconds(1)) {
-                spdlog::info("Sending reinitialization request for message hook");
+            spdlog::info("Hook test message sent");
+        }
+    }
 
-                // if we don't get a message for 5 seconds, assume the hook is broken
-                //m_initialized = false; // causes the hook to be re-initialized next frame
-                m_message_hook_requested = true;
-                m_last_message_time = std::chrono::steady_clock::now() + std::chrono::seconds(5);
-                m_last_present_time = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    if (actions & utility::HookWatchdog::REHOOK_MESSAGES) {
+        spdlog::info("Sending reinitialization request for message hook");
 
-                m_sent_message = false;
-            }
-        } else {
-            m_sent_message = false;
-        }
+        // if we don't get a message for 5 seconds, assume the hook is broken
+        //m_initialized = false; // causes the hook to be re-initialized next frame
+        m_message_hook_requested = true;
     }
+
+    // Presents only move the deadline later, so waking up at the old one just means re-evaluating early
+    return std::clamp(m_hook_watchdog.next_deadline(), now + std::chrono::milliseconds(50), now + std::chrono::seconds(5));
 }
 
 typedef NTSTATUS (WINAPI* PFN_LdrLockLoaderLock)(ULONG Flags, ULONG *State, ULONG_PTR *Cookie);
@@ -165,6 +155,9 @@ Framework::Framework(HMODULE module)
     spdlog::set_pattern("[%S.%e] [%L] [tid:%t] %v");
     spdlog::flush_on(spdlog::level::info);
 
+    m_hot_log = std::make_unique<utility::HotLog>(m_logger);
+    utility::g_hot_log.publish(m_hot_log.get());
+
     if (s_fallback_appdata) {
         spdlog::warn("Failed to write to current directory, falling back to appdata folder");
     }
@@ -244,15 +237,21 @@ Framework::Framework(HMODULE module)
 
     std::scoped_lock _{m_hook_monitor_mutex};
 
-    m_last_present_time = std::chrono::steady_clock::now();
-    m_last_message_time = std::chrono::steady_clock::now();
+    m_present_heartbeat.beat();
+    m_message_heartbeat.beat();
     m_d3d_monitor_thread = std::make_unique<std::jthread>([this](std::stop_token stop_token) {
         // Load the plugins early right after executable unpacking
         //PluginLoader::get()->early_init();
 
+        std::mutex wait_mtx{};
+        std::condition_variable_any wait_cv{};
+
         while (!stop_token.stop_requested() && !m_terminating) {
-            this->hook_monitor();
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            const auto deadline = this->hook_monitor();
+
+            // Sleeps until the watchdog's next deadline instead of polling, wakes right away on stop
+            std::unique_lock lock{wait_mtx};
+            wait_cv.wait_until(lock, stop_token, deadline, [] { return false; });
         }
     });
 }
@@ -295,6 +294,8 @@ bool Framework::hook_d3d12() {
         return hook_d3d11();
     }
 
+    std::unique_lock listeners_lock{m_d3d12_listeners_mtx};
+
     //if (m_d3d12_hook == nullptr) {
         m_d3d12_hook.reset();
         m_d3d12_hook = std::make_unique<D3D12Hook>();
@@ -302,21 +303,9 @@ bool Framework::hook_d3d12() {
         m_d3d12_hook->on_post_present([this](D3D12Hook& hook) { on_post_present_d3d12(); });
         m_d3d12_hook->on_resize_buffers([this](D3D12Hook& hook) { on_reset(); });
         m_d3d12_hook->on_resize_target([this](D3D12Hook& hook) { on_reset(); });
-        m_d3d12_hook->on_set_render_targets([this](D3D12Hook& hook, ID3D12GraphicsCommandList5* cmd_list, UINT num_rtvs, 
-            const D3D12_CPU_DESCRIPTOR_HANDLE* rtvs, BOOL single_handle, D3D12_CPU_DESCRIPTOR_HANDLE* dsv) {
-            on_d3d12_set_render_targets(cmd_list, num_rtvs, rtvs, single_handle, dsv);
-        });
-        m_d3d12_hook->on_set_scissor_rects([this](D3D12Hook& hook, ID3D12GraphicsCommandList5* cmd_list, UINT num_rects, const D3D12_RECT* rects) {
-            on_d3d12_set_scissor_rects(cmd_list, num_rects, rects);
-        });
-        m_d3d12_hook->on_set_viewports([this](D3D12Hook& hook, ID3D12GraphicsCommandList5* cmd_list, UINT num_viewports, const D3D12_VIEWPORT* viewports) {
-            on_d3d12_set_viewports(cmd_list, num_viewports, viewports);
-        });
-        m_d3d12_hook->on_create_render_target_view([this](D3D12Hook& hook, ID3D12Device* device, ID3D12Resource* pResource, 
-            const D3D12_RENDER_TARGET_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) {
-            on_d3d12_create_render_target_view(device, pResource, pDesc, DestDescriptor);
-        });
+        attach_d3d12_listeners();
     //}
+    listeners_lock.unlock();
     //m_d3d12_hook->on_create_swap_chain([this](D3D12Hook& hook) { m_d3d12.command_queue = m_d3d12_hook->get_command_queue(); });
 
     // Making sure D3D11 is not hooked
@@ -355,6 +344,14 @@ Framework::~Framework() {
 
     m_d3d_monitor_thread.reset();
 
+    // flushes any pending config write
+    m_config_writer.reset();
+    m_config_watcher.reset();
+    memory::SaveProfiles();
+
+    // the patch doesn't restore SetCursorPos by itself
+    remove_set_cursor_pos_patch();
+
     if (m_is_d3d11) {
         deinit_d3d11();
     }
@@ -368,6 +365,10 @@ Framework::~Framework() {
     if (m_initialized) {
         ImGui::DestroyContext();
     }
+
+    // VR_HOT_LOG goes back to logging directly, calls already pushing are waited for, then whatever is queued is written out
+    utility::g_hot_log.unpublish();
+    m_hot_log.reset();
 }
 
 void Framework::run_imgui_frame(bool from_present) {
@@ -389,12 +390,21 @@ void Framework::run_imgui_frame(bool from_present) {
     // from_present is so we don't accidentally
     // run script/game code within the present thread.
     if (is_init_ok && !from_present) {
+        reload_changed_config();
+
         // Run mod frame callbacks.
         m_mods->on_pre_imgui_frame();
     }
 
     ImGui::NewFrame();
 
+    // Typed text (IME included) is the one source of new glyphs we can see without the caller's help
+    if (m_lazy_glyphs) {
+        for (const auto c : ImGui::GetIO().InputQueueCharacters) {
+            add_used_glyph(c);
+        }
+    }
+
     if (!from_present) {
         call_on_frame();
     }
@@ -502,9 +512,7 @@ void Framework::on_frame_d3d11() {
 
 void Framework::on_post_present_d3d11() {
     if (!m_error.empty() || !m_initialized || !m_game_data_initialized) {
-        if (m_last_present_time <= std::chrono::steady_clock::now()){
-            m_last_present_time = std::chrono::steady_clock::now();
-        }
+        m_present_heartbeat.beat();
 
         return;
     }
@@ -513,9 +521,7 @@ void Framework::on_post_present_d3d11() {
         mod->on_post_present();
     }
 
-    if (m_last_present_time <= std::chrono::steady_clock::now()){
-        m_last_present_time = std::chrono::steady_clock::now();
-    }
+    m_present_heartbeat.beat();
 }
 
 // D3D12 Draw funciton
@@ -563,7 +569,9 @@ void Framework::on_frame_d3d12() {
 
     //if (!m_has_frame) {
         //if (!is_init_ok) {
-            //update_fonts();
+            // Rebuild before the backends recreate their device objects, so glyphs added
+            // this frame don't get drawn with the previous font texture
+            update_fonts();
 
             ImGui::GetIO().BackendRendererUserData = m_d3d12.imgui_backend_datas[0];
             const auto prev_cleanup = m_wants_device_object_cleanup;
@@ -593,6 +601,27 @@ void Framework::on_frame_d3d12() {
         return;
     }
 
+    auto draw_data = ImGui::GetDrawData();
+
+    // The UI render target keeps its contents between frames, so it's only recorded again
+    // (or just the part that changed) when the draw data differs from last frame.
+    // The back buffer is new every frame and only skipped when there's nothing to draw.
+    const auto ui = draw_data != nullptr ? imgui::digest_draw_data(draw_data, m_ui_draw_cache) : utility::UiDrawCache::Decision{};
+    const bool draw_ui_rt = draw_data != nullptr && ui.action != utility::UiDrawCache::Action::SKIP;
+    const bool draw_backbuffer = draw_data != nullptr && !ui.empty;
+
+    if (!draw_ui_rt && !draw_backbuffer) {
+        if (draw_data != nullptr) {
+            m_ui_draw_cache.record_skipped_submission();
+        }
+
+        if (is_init_ok) {
+            m_mods->on_post_frame();
+        }
+
+        return;
+    }
+
     auto& cmd_ctx = m_d3d12.cmd_ctxs[m_d3d12.cmd_ctx_index++ % m_d3d12.cmd_ctxs.size()];
 
     if (cmd_ctx == nullptr) {
@@ -600,58 +629,89 @@ void Framework::on_frame_d3d12() {
     }
 
     cmd_ctx->wait(INFINITE);
-    if (auto draw_data = ImGui::GetDrawData(); draw_data != nullptr) {
+    {
         std::scoped_lock _{ cmd_ctx->mtx };
         cmd_ctx->has_commands = true;
 
-        // Draw to our render target.
         D3D12_RESOURCE_BARRIER barrier{};
         barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
         barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-        barrier.Transition.pResource = m_d3d12.get_rt(D3D12::RTV::IMGUI).Get();
         barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
-        cmd_ctx->cmd_list->ResourceBarrier(1, &barrier);
 
-        float clear_color[]{0.0f, 0.0f, 0.0f, 0.0f};
         D3D12_CPU_DESCRIPTOR_HANDLE rts[1]{};
-        cmd_ctx->cmd_list->ClearRenderTargetView(m_d3d12.get_cpu_rtv(device, D3D12::RTV::IMGUI), clear_color, 0, nullptr);
-        rts[0] = m_d3d12.get_cpu_rtv(device, D3D12::RTV::IMGUI);
-        cmd_ctx->cmd_list->OMSetRenderTargets(1, rts, FALSE, NULL);
-        cmd_ctx->cmd_list->SetDescriptorHeaps(1, m_d3d12.srv_desc_heap.GetAddressOf());
 
-        ImGui::GetIO().BackendRendererUserData = m_d3d12.imgui_backend_datas[1];
-        ImGui_ImplDX12_RenderDrawData(draw_data, cmd_ctx->cmd_list.Get());
+        // Draw to our render target.
+        if (draw_ui_rt) {
+            const auto record_start = std::chrono::steady_clock::now();
+            const bool partial = ui.action == utility::UiDrawCache::Action::REDRAW_DIRTY;
+
+            barrier.Transition.pResource = m_d3d12.get_rt(D3D12::RTV::IMGUI).Get();
+            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
+            cmd_ctx->cmd_list->ResourceBarrier(1, &barrier);
+
+            float clear_color[]{0.0f, 0.0f, 0.0f, 0.0f};
+
+            if (partial) {
+                const auto& origin = draw_data->DisplayPos;
+                const D3D12_RECT dirty_rect{
+                    (LONG)std::floor(ui.dirty.min_x - origin.x), (LONG)std::floor(ui.dirty.min_y - origin.y),
+                    (LONG)std::ceil(ui.dirty.max_x - origin.x), (LONG)std::ceil(ui.dirty.max_y - origin.y)
+                };
+
+                cmd_ctx->cmd_list->ClearRenderTargetView(m_d3d12.get_cpu_rtv(device, D3D12::RTV::IMGUI), clear_color, 1, &dirty_rect);
+                imgui::clip_draw_data(draw_data, ui.dirty, m_ui_saved_clip_rects);
+            } else {
+                cmd_ctx->cmd_list->ClearRenderTargetView(m_d3d12.get_cpu_rtv(device, D3D12::RTV::IMGUI), clear_color, 0, nullptr);
+            }
 
-        for (auto& mod : m_mods->get_mods()) {
             rts[0] = m_d3d12.get_cpu_rtv(device, D3D12::RTV::IMGUI);
-            mod->on_post_render_vr_framework_dx12(cmd_ctx->cmd_list.Get(), m_d3d12.get_rt(D3D12::RTV::IMGUI).Get(), &rts[0]);
-        }
+            cmd_ctx->cmd_list->OMSetRenderTargets(1, rts, FALSE, NULL);
+            cmd_ctx->cmd_list->SetDescriptorHeaps(1, m_d3d12.srv_desc_heap.GetAddressOf());
 
-        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
-        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
-        cmd_ctx->cmd_list->ResourceBarrier(1, &barrier);
+            ImGui::GetIO().BackendRendererUserData = m_d3d12.imgui_backend_datas[1];
+            ImGui_ImplDX12_RenderDrawData(draw_data, cmd_ctx->cmd_list.Get());
+
+            if (partial) {
+                imgui::restore_clip_rects(draw_data, m_ui_saved_clip_rects);
+            }
+
+            for (auto& mod : m_mods->get_mods()) {
+                rts[0] = m_d3d12.get_cpu_rtv(device, D3D12::RTV::IMGUI);
+                mod->on_post_render_vr_framework_dx12(cmd_ctx->cmd_list.Get(), m_d3d12.get_rt(D3D12::RTV::IMGUI).Get(), &rts[0]);
+            }
+
+            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+            cmd_ctx->cmd_list->ResourceBarrier(1, &barrier);
+
+            if (!partial) {
+                m_ui_draw_cache.record_full_time(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - record_start).count());
+            }
+        }
 
         // Draw to the back buffer.
-        auto swapchain = m_d3d12_hook->get_swap_chain();
-        auto bb_index = swapchain->GetCurrentBackBufferIndex();
-        barrier.Transition.pResource = m_d3d12.rts[bb_index].Get();
-        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
-        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
-        cmd_ctx->cmd_list->ResourceBarrier(1, &barrier);
-        rts[0] = m_d3d12.get_cpu_rtv(device, (D3D12::RTV)bb_index);
-        cmd_ctx->cmd_list->OMSetRenderTargets(1, rts, FALSE, NULL);
-        cmd_ctx->cmd_list->SetDescriptorHeaps(1, m_d3d12.srv_desc_heap.GetAddressOf());
-
-        ImGui::GetIO().BackendRendererUserData = m_d3d12.imgui_backend_datas[0];
-        ImGui_ImplDX12_RenderDrawData(draw_data, cmd_ctx->cmd_list.Get());
-
-        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
-        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
-        cmd_ctx->cmd_list->ResourceBarrier(1, &barrier);
+        if (draw_backbuffer) {
+            auto swapchain = m_d3d12_hook->get_swap_chain();
+            auto bb_index = swapchain->GetCurrentBackBufferIndex();
+            barrier.Transition.pResource = m_d3d12.rts[bb_index].Get();
+            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
+            cmd_ctx->cmd_list->ResourceBarrier(1, &barrier);
+            rts[0] = m_d3d12.get_cpu_rtv(device, (D3D12::RTV)bb_index);
+            cmd_ctx->cmd_list->OMSetRenderTargets(1, rts, FALSE, NULL);
+            cmd_ctx->cmd_list->SetDescriptorHeaps(1, m_d3d12.srv_desc_heap.GetAddressOf());
+
+            ImGui::GetIO().BackendRendererUserData = m_d3d12.imgui_backend_datas[0];
+            ImGui_ImplDX12_RenderDrawData(draw_data, cmd_ctx->cmd_list.Get());
+
+            barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
+            barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
+            cmd_ctx->cmd_list->ResourceBarrier(1, &barrier);
+        }
 
         cmd_ctx->execute();
+        m_ui_draw_cache.record_submission();
     }
 
     if (is_init_ok) {
@@ -661,9 +721,7 @@ void Framework::on_frame_d3d12() {
 
 void Framework::on_post_present_d3d12() {
     if (!m_error.empty() || !m_initialized || !m_game_data_initialized) {
-        if (m_last_present_time <= std::chrono::steady_clock::now()){
-            m_last_present_time = std::chrono::steady_clock::now();
-        }
+        m_present_heartbeat.beat();
 
         return;
     }
@@ -671,36 +729,16 @@ void Framework::on_post_present_d3d12() {
         mod->on_post_present();
     }
 
-    if (m_last_present_time <= std::chrono::steady_clock::now()){
-        m_last_present_time = std::chrono::steady_clock::now();
-    }
-}
-
-void Framework::on_d3d12_set_render_targets(ID3D12GraphicsCommandList5* cmd_list, UINT num_rtvs, 
-    const D3D12_CPU_DESCRIPTOR_HANDLE* rtvs, BOOL single_handle, D3D12_CPU_DESCRIPTOR_HANDLE* dsv) {
-    if (m_game_data_initialized) {
-        m_mods->on_d3d12_set_render_targets(cmd_list, num_rtvs, rtvs, single_handle, dsv);
-    }
-}
-
-void Framework::on_d3d12_set_scissor_rects(ID3D12GraphicsCommandList5* cmd_list, UINT num_rects, const D3D12_RECT* rects) {
-    if (m_game_data_initialized) {
-        m_mods->on_d3d12_set_scissor_rects(cmd_list, num_rects, rects);
-    }
+    m_present_heartbeat.beat();
 }
 
+// Mods initialize on their own thread, so whichever of the hook and the mods comes last attaches them.
+// A rehook creates a new D3D12Hook with empty dispatchers.
+void Framework::attach_d3d12_listeners() {
+    std::scoped_lock _{m_d3d12_listeners_mtx};
 
-void Framework::on_d3d12_create_render_target_view(ID3D12Device* device, ID3D12Resource* pResource, const D3D12_RENDER_TARGET_VIEW_DESC* pDesc,
-                                                   D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor)
-{
-    if (m_game_data_initialized) {
-        m_mods->on_d3d12_create_render_target_view(device, pResource, pDesc, DestDescriptor);
-    }
-}
-
-void Framework::on_d3d12_set_viewports(ID3D12GraphicsCommandList5* cmd_list, UINT num_viewports, const D3D12_VIEWPORT* viewports) {
-    if (m_game_data_initialized) {
-        m_mods->on_d3d12_set_viewports(cmd_list, num_viewports, viewports);
+    if (m_d3d12_hook != nullptr && m_mods != nullptr && m_game_data_initialized) {
+        m_mods->attach_d3d12_listeners(*m_d3d12_hook);
     }
 }
 
@@ -741,7 +779,17 @@ void Framework::patch_set_cursor_pos() {
 
         if (set_cursor_pos_addr != 0) {
             spdlog::info("Patching SetCursorPos");
-            m_set_cursor_pos_patch = Patch::create(set_cursor_pos_addr, {0xC3});
+
+            auto patch = std::make_unique<utility::PatchTransaction>(memory::ProcessMemory());
+            patch->add(set_cursor_pos_addr, {0xC3});
+
+            if (patch->commit()) {
+                const auto& stats = patch->get_stats();
+                spdlog::info("Patched SetCursorPos, {} pages, {} protection changes", stats.pages, stats.protection_changes);
+                m_set_cursor_pos_patch = std::move(patch);
+            } else {
+                spdlog::error("Failed to patch SetCursorPos");
+            }
         }
     }
 }
@@ -751,6 +799,10 @@ void Framework::remove_set_cursor_pos_patch() {
 
     if (m_set_cursor_pos_patch.get() != nullptr) {
         spdlog::info("Removing SetCursorPos patch");
+
+        if (!m_set_cursor_pos_patch->rollback()) {
+            spdlog::error("Failed to restore SetCursorPos");
+        }
     }
 
     m_set_cursor_pos_patch.reset();
@@ -827,7 +879,7 @@ void Framework::on_adjust_window_rect(auto result, auto wnd, auto rect, auto men
 
 
 bool Framework::on_message(HWND wnd, UINT message, WPARAM w_param, LPARAM l_param) {
-    m_last_message_time = std::chrono::steady_clock::now();
+    m_message_heartbeat.beat();
 
     if (!m_initialized) {
         return true;
@@ -1022,23 +1074,62 @@ std::filesystem::path Framework::get_persistent_dir() {
 }
 
 void Framework::save_config() {
-    std::scoped_lock _{m_config_mtx};
+    SCOPE_PROFILER();
 
     m_wants_save_config = false;
 
-    spdlog::info("Saving config vr_config.txt");
+    // Only marks the config dirty, the snapshot (every mod's on_config_save) and the disk I/O
+    // happen on m_config_writer's thread once saves have settled.
+    if (m_config_writer == nullptr) {
+        m_config_writer = std::make_unique<utility::AsyncConfigWriter<utility::ConfigStore>>(
+            [this](utility::ConfigStore& snapshot) { write_config(snapshot); },
+            [this] { return build_config(); });
+    }
+
+    m_config_writer->request();
+}
 
-    utility::Config cfg{};
+// Runs on m_config_writer's thread. Mods expect on_config_save outside of a frame, same as the UI sees them.
+// Holding m_imgui_mtx means a frame that starts during the build waits for it, but that's once per
+// settled burst of changes instead of on every frame of a slider drag.
+std::optional<utility::ConfigStore> Framework::build_config() {
+    std::scoped_lock _{m_imgui_mtx, m_config_mtx};
+
+    // Starts from what was loaded so options this build doesn't know (newer/older builds, disabled mods) are kept.
+    auto cfg = m_mods->get_loaded_config();
 
     for (auto& mod : m_mods->get_mods()) {
         mod->on_config_save(cfg);
     }
 
+    return cfg;
+}
+
+// vr_config.txt edited by hand while the game runs
+void Framework::reload_changed_config() {
+    if (m_config_watcher == nullptr) {
+        return;
+    }
+
+    auto cfg = m_config_watcher->take();
+
+    if (!cfg) {
+        return;
+    }
+
+    SCOPE_PROFILER();
+    std::scoped_lock _{m_config_mtx};
+
+    spdlog::info("vr_config.txt changed on disk, reloading");
+    m_mods->on_config_reload(std::move(*cfg));
+}
+
+void Framework::write_config(utility::ConfigStore& cfg) {
+    const auto path = get_persistent_dir() / "vr_config.txt";
+    std::string text{};
+
     try {
-        if (!cfg.save((get_persistent_dir() / "vr_config.txt").string())) {
-            spdlog::error("Failed to save config");
-            return;
-        }
+        cfg.serialize(text);
     } catch(const std::exception& e) {
         spdlog::error("Failed to save config: {}", e.what());
         return;
@@ -1047,7 +1138,21 @@ void Framework::save_config() {
         return;
     }
 
-    spdlog::info("Saved config");
+    switch (utility::commit_file(text, path, m_last_config_hash)) {
+    case utility::CommitResult::WRITTEN:
+        spdlog::info("Saved config vr_config.txt");
+
+        if (m_config_watcher != nullptr) {
+            m_config_watcher->note_written(m_last_config_hash);
+        }
+
+        break;
+    case utility::CommitResult::UNCHANGED:
+        break;
+    default:
+        spdlog::error("Failed to replace vr_config.txt");
+        break;
+    }
 }
 
 void Framework::set_draw_ui(bool state, bool should_save) {
@@ -1089,47 +1194,190 @@ int Framework::add_font(const std::filesystem::path& filepath, int size, const s
     return m_additional_fonts.size() - 1;
 }
 
+void Framework::request_glyphs(std::string_view utf8) {
+    if (!m_lazy_glyphs || utf8.empty()) {
+        return;
+    }
+
+    if (m_used_glyphs.add_text(utf8, &m_glyph_universe) > 0) {
+        m_used_glyphs_dirty = true;
+        m_glyphs_pending = true;
+    }
+}
+
+void Framework::add_used_glyph(uint32_t codepoint) {
+    if (m_glyph_universe.contains(codepoint) && m_used_glyphs.add(codepoint)) {
+        m_used_glyphs_dirty = true;
+        m_glyphs_pending = true;
+    }
+}
+
+void Framework::load_used_glyphs() {
+    if (std::exchange(m_used_glyphs_loaded, true)) {
+        return;
+    }
+
+    std::ifstream file{get_persistent_dir("vr_fonts") / "used_glyphs.txt"};
+    uint32_t first{}, last{};
+
+    while (file >> std::hex >> first >> last) {
+        if (m_glyph_universe.contains(first) && m_glyph_universe.contains(last)) {
+            m_used_glyphs.add_range(first, last);
+        }
+    }
+}
+
+void Framework::save_used_glyphs() {
+    if (!std::exchange(m_used_glyphs_dirty, false)) {
+        return;
+    }
+
+    std::error_code ec{};
+    std::filesystem::create_directories(get_persistent_dir("vr_fonts"), ec);
+
+    std::ofstream file{get_persistent_dir("vr_fonts") / "used_glyphs.txt", std::ios::trunc};
+
+    for (const auto& [first, last] : m_used_glyphs.ranges()) {
+        file << std::hex << first << ' ' << last << '\n';
+    }
+}
+
 void Framework::update_fonts() {
+    const auto start = std::chrono::steady_clock::now();
+
+    // Every rebuild re-rasterizes the atlas and recreates the device objects,
+    // so new glyphs are collected for a while instead of rebuilding for each one
+    if (m_glyphs_pending && start - m_last_glyph_rebuild >= GLYPH_REBUILD_INTERVAL) {
+        m_fonts_need_updating = true;
+    }
+
     if (!m_fonts_need_updating) {
         return;
     }
 
     m_fonts_need_updating = false;
+    m_glyphs_pending = false;
+    m_last_glyph_rebuild = start;
+
+    SCOPE_PROFILER();
 
     auto& fonts = ImGui::GetIO().Fonts;
-    fonts->Clear();
+
+    if (m_font_cache == nullptr) {
+        m_font_cache = std::make_unique<utility::FontAtlasCache>(get_persistent_dir("vr_fonts"));
+    }
 
     // using 'vr_pictographic.mode' file to
     // replace '?' to most flag in WorldObjectsViewer
-    ImFontConfig custom_icons{};
-    custom_icons.FontDataOwnedByAtlas = false;
-    ImFont* fsload = (INVALID_FILE_ATTRIBUTES != ::GetFileAttributesA("vr_pictographic.mode"))
-        ? fonts->AddFontFromMemoryTTF((void*)af_baidu_ptr, af_baidu_size, (float)m_font_size, &custom_icons, fonts->GetGlyphRangesChineseFull())
-        : fonts->AddFontFromMemoryCompressedTTF(RobotoMedium_compressed_data, RobotoMedium_compressed_size, (float)m_font_size);
-
-    // https://fontawesome.com/
-    custom_icons.PixelSnapH = true;
-    custom_icons.MergeMode = true;
-    custom_icons.FontDataOwnedByAtlas = false;
+    // Baking all of GetGlyphRangesChineseFull is tens of thousands of glyphs, with set_lazy_glyphs only the
+    // default ranges plus whatever was requested so far (also in earlier sessions) get baked.
+    const bool pictographic = INVALID_FILE_ATTRIBUTES != ::GetFileAttributesA("vr_pictographic.mode");
+
+    m_lazy_glyphs = m_lazy_glyphs && m_lazy_glyphs_enabled;
+
+    if (pictographic && m_lazy_glyphs_enabled && !m_lazy_glyphs) {
+        m_lazy_glyphs = true;
+        m_glyph_universe = utility::GlyphRangeSet{fonts->GetGlyphRangesChineseFull()};
+        // Same always-on blocks ImGui bakes for CJK: punctuation, kana, half/fullwidth forms
+        static const ImWchar base_ranges[] = {0x0020, 0x00FF, 0x2000, 0x206F, 0x3000, 0x30FF, 0x31F0, 0x31FF, 0xFF00, 0xFFEF, 0xFFFD, 0xFFFD, 0};
+        m_used_glyphs.add_ranges(base_ranges);
+        load_used_glyphs();
+    }
+
+    if (m_lazy_glyphs) {
+        m_primary_glyph_ranges = m_used_glyphs.to_flat<ImWchar>();
+        save_used_glyphs();
+    }
+
+    const auto primary_ranges = m_lazy_glyphs ? m_primary_glyph_ranges.data() : fonts->GetGlyphRangesChineseFull();
+
     static const ImWchar icon_ranges[] = {0xF000, 0xF976, 0}; // ICON_MIN_FA ICON_MAX_FA
-    fonts->AddFontFromMemoryTTF((void*)af_faprolight_ptr, af_faprolight_size, (float)m_font_size, &custom_icons, icon_ranges);
 
-    for (auto& font : m_additional_fonts) {
-        const ImWchar* ranges = nullptr;
+    // Everything that affects the baked result goes into the cache key
+    auto key = utility::FontAtlasCache::hash(pictographic ? "baidu" : "roboto");
+    key = utility::FontAtlasCache::hash_value(pictographic ? af_baidu_size : RobotoMedium_compressed_size, key);
+    key = utility::FontAtlasCache::hash_value(af_faprolight_size, key);
+    key = utility::FontAtlasCache::hash_value(m_font_size, key);
+    key = utility::FontAtlasCache::hash_value(fonts->Flags, key);
+#ifndef IMGUI_HAS_TEXTURES
+    key = utility::FontAtlasCache::hash_value(fonts->TexDesiredWidth, key);
+#endif
+    key = utility::FontAtlasCache::hash_value(fonts->TexGlyphPadding, key);
+    key = utility::FontAtlasCache::hash_value(m_lazy_glyphs, key);
+    key = m_lazy_glyphs ? m_used_glyphs.hash(key) : key;
+
+    // Index of each additional font in the atlas, 0 (the main font) if its file is missing
+    std::vector<int> font_indices{};
+    int next_font_index = 1;
 
-        if (!font.ranges.empty()) {
-            ranges = font.ranges.data();
+    for (const auto& font : m_additional_fonts) {
+        std::error_code ec{};
+        const bool exists = fs::exists(font.filepath, ec);
+
+        key = utility::FontAtlasCache::hash(font.filepath.string(), key);
+        key = utility::FontAtlasCache::hash_value(font.size, key);
+        key = utility::GlyphRangeSet{font.ranges.empty() ? nullptr : font.ranges.data()}.hash(key);
+
+        if (exists) {
+            key = utility::FontAtlasCache::hash_value(fs::file_size(font.filepath, ec), key);
+            key = utility::FontAtlasCache::hash_value(fs::last_write_time(font.filepath, ec).time_since_epoch().count(), key);
         }
 
-        if (fs::exists(font.filepath)) {
-            font.font = fonts->AddFontFromFileTTF(font.filepath.string().c_str(), (float)font.size, nullptr, ranges);
+        font_indices.push_back(exists ? next_font_index++ : 0);
+    }
+
+    const bool from_cache = m_font_cache->load(fonts, key);
+
+    if (!from_cache) {
+        fonts->Clear();
+
+        ImFontConfig custom_icons{};
+        custom_icons.FontDataOwnedByAtlas = false;
+
+        if (pictographic) {
+            fonts->AddFontFromMemoryTTF((void*)af_baidu_ptr, af_baidu_size, (float)m_font_size, &custom_icons, primary_ranges);
         } else {
-            font.font = fsload; // fonts->AddFontFromMemoryCompressedTTF(RobotoMedium_compressed_data, RobotoMedium_compressed_size, (float)font.size, nullptr, ranges);
+            fonts->AddFontFromMemoryCompressedTTF(RobotoMedium_compressed_data, RobotoMedium_compressed_size, (float)m_font_size);
+        }
+
+        // https://fontawesome.com/
+        custom_icons.PixelSnapH = true;
+        custom_icons.MergeMode = true;
+        custom_icons.FontDataOwnedByAtlas = false;
+        fonts->AddFontFromMemoryTTF((void*)af_faprolight_ptr, af_faprolight_size, (float)m_font_size, &custom_icons, icon_ranges);
+
+        for (size_t i = 0; i < m_additional_fonts.size(); ++i) {
+            const auto& font = m_additional_fonts[i];
+
+            if (font_indices[i] != 0) {
+                const auto ranges = font.ranges.empty() ? nullptr : font.ranges.data();
+                fonts->AddFontFromFileTTF(font.filepath.string().c_str(), (float)font.size, nullptr, ranges);
+            }
+        }
+
+        fonts->Build();
+
+        if (!m_font_cache->store(fonts, key)) {
+            spdlog::warn("[Fonts] Failed to cache font atlas");
         }
     }
 
-    fonts->Build();
+    for (size_t i = 0; i < m_additional_fonts.size(); ++i) {
+        const auto index = font_indices[i];
+        m_additional_fonts[i].font = index < fonts->Fonts.Size ? fonts->Fonts[index] : fonts->Fonts[0];
+    }
+
+    const auto elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+#ifdef IMGUI_HAS_TEXTURES
+    // Glyphs are rasterized on demand there, nothing to report yet
+    spdlog::info("[Fonts] Atlas set up in {:.2f} ms", elapsed);
+#else
+    spdlog::info("[Fonts] Atlas {}x{} ({} KB), {} glyphs, {} in {:.2f} ms", fonts->TexWidth, fonts->TexHeight, fonts->TexWidth * fonts->TexHeight / 1024,
+        fonts->Fonts[0]->Glyphs.Size, from_cache ? "loaded from cache" : "built", elapsed);
+#endif
+
     m_wants_device_object_cleanup = true;
+    m_ui_draw_cache.invalidate(); // same texture ids, different contents
 }
 
 void Framework::invalidate_device_objects() {
@@ -1618,6 +1866,17 @@ bool Framework::initialize_game_data() {
             m_game_data_initialized = true;
             spdlog::error("Initialization of mods failed. Reason: exception thrown.");
         }
+
+        // Also when a mod failed, the others still run
+        attach_d3d12_listeners();
+
+        // Mods resolve their patterns while initializing, one write for all of them
+        memory::SaveProfiles();
+
+        const auto watcher_cpu = ModuleWatcher::get().get_cpu_time();
+        spdlog::info("Late module hooks: {}us CPU in callbacks, {}us on the watcher thread, {} still waiting",
+            watcher_cpu.callbacks.count(), watcher_cpu.worker.count(), ModuleWatcher::get().pending());
+
         spdlog::info("Game data initialization thread finished");
     });
 
@@ -1652,7 +1911,10 @@ bool Framework::initialize_windows_message_hook() {
     }
 
     if (m_first_frame || m_message_hook_requested || m_windows_message_hook == nullptr) {
-        m_last_message_time = std::chrono::steady_clock::now();
+        // The hook monitor looks at the hook too, and presents no longer hold its mutex
+        std::scoped_lock _{m_hook_monitor_mutex};
+
+        m_message_heartbeat.beat();
         m_windows_message_hook.reset();
         m_windows_message_hook = std::make_unique<WindowsMessageHook>(m_wnd);
         m_windows_message_hook->on_message = [this](auto wnd, auto msg, auto w_param, auto l_param) {
@@ -1711,6 +1973,8 @@ bool Framework::first_frame_initialize() {
         m_mods_fully_initialized = false;
         return false;
     } else {
+        m_config_watcher = std::make_unique<utility::ConfigWatcher>(get_persistent_dir() / "vr_config.txt");
+
         // Do an initial config save to set the default values for the frontend
         save_config();
         m_mods_fully_initialized = true;
@@ -1980,6 +2244,7 @@ bool Framework::init_d3d12() {
         m_d3d12.rt_height = (uint32_t)desc.Height;
 
         m_last_rt_size = {desc.Width, desc.Height};
+        m_ui_draw_cache.invalidate(); // fresh render target, nothing to reuse
     }
 
     spdlog::info("[D3D12] Initializing ImGui...");
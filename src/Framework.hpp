@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <unordered_set>
 #include <filesystem>
 
@@ -19,6 +20,15 @@ class Mods;
 #include "DInputHook.hpp"
 #include "WindowsMessageHook.hpp"
 #include "math/Math.hpp"
+#include "utility/AsyncConfigWriter.hpp"
+#include "utility/ConfigStore.hpp"
+#include "utility/ConfigWatcher.hpp"
+#include "utility/FontAtlasCache.hpp"
+#include "utility/GlyphRangeSet.hpp"
+#include "utility/HookWatchdog.hpp"
+#include "utility/HotLog.hpp"
+#include "utility/PatchTransaction.hpp"
+#include "utility/UiDrawCache.hpp"
 
 
 
@@ -26,7 +36,8 @@ class Mods;
 class Framework
 {
 private:
-    void hook_monitor();
+    // Returns when it wants to run again
+    std::chrono::steady_clock::time_point hook_monitor();
     std::atomic<uint32_t> m_do_not_hook_d3d_count{0};
 
 public:
@@ -77,12 +88,7 @@ public:
     void on_post_present_d3d12();
     void on_reset();
 
-    void on_d3d12_set_render_targets(ID3D12GraphicsCommandList5* cmd_list, UINT num_rtvs, 
-        const D3D12_CPU_DESCRIPTOR_HANDLE* rtvs, BOOL single_handle, D3D12_CPU_DESCRIPTOR_HANDLE* dsv);
-    void on_d3d12_set_scissor_rects(ID3D12GraphicsCommandList5* cmd_list, UINT num_rects, const D3D12_RECT* rects);
-    void on_d3d12_set_viewports(ID3D12GraphicsCommandList5* cmd_list, UINT num_viewports, const D3D12_VIEWPORT* viewports);
-    void on_d3d12_create_render_target_view(ID3D12Device* device, ID3D12Resource* pResource, 
-        const D3D12_RENDER_TARGET_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor);
+    void attach_d3d12_listeners();
 
     void patch_set_cursor_pos();
     void remove_set_cursor_pos_patch();
@@ -129,6 +135,15 @@ public:
         return m_hook_monitor_mutex;
     }
 
+    // Taken by present hooks instead of the hook monitor mutex, see utility::PresentGate
+    auto enter_present() {
+        return m_present_gate.enter();
+    }
+
+    const auto& get_present_heartbeat() const {
+        return m_present_heartbeat;
+    }
+
     void set_font_size(int size) {
         if (m_font_size != size) {
             m_font_size = size;
@@ -140,6 +155,23 @@ public:
 
     int add_font(const std::filesystem::path& filepath, int size, const std::vector<ImWchar>& ranges = {});
 
+    // With vr_pictographic.mode the whole CJK range gets baked, unless the game project or the user
+    // (VRConfig_LazyGlyphs) opts into lazy baking here. Only do that if every non-ASCII string drawn goes
+    // through request_glyphs, anything else shows up as '?'.
+    void set_lazy_glyphs(bool enabled) {
+        if (m_lazy_glyphs_enabled != enabled) {
+            m_lazy_glyphs_enabled = enabled;
+            m_fonts_need_updating = true;
+        }
+    }
+
+    // Makes sure the glyphs used by `utf8` end up in the atlas when baking lazily.
+    // Requests are batched, missing glyphs show up within GLYPH_REBUILD_INTERVAL.
+    // Call from within the ImGui frame.
+    void request_glyphs(std::string_view utf8);
+
+    static constexpr std::chrono::milliseconds GLYPH_REBUILD_INTERVAL{250};
+
     ImFont* get_font(int index) const {
         if (index >= 0 && index < m_additional_fonts.size()) {
             return m_additional_fonts[index].font;
@@ -169,10 +201,25 @@ public:
         m_has_engine_thread = true;
     }
 
+    // The D3D12 UI render target is only re-recorded when the ImGui draw data changes, or where it
+    // shows a texture other than the font atlas (those are redrawn every frame).
+    // Call this when something drawn into it changed without the draw data changing,
+    // e.g. what a mod draws in on_post_render_vr_framework_dx12.
+    void invalidate_ui_cache() {
+        m_ui_draw_cache.invalidate();
+    }
+
+    const auto& get_ui_cache_stats() const {
+        return m_ui_draw_cache.get_stats();
+    }
+
     friend class ShaderDebugOverlay;
 
 private:
         void save_config();
+    std::optional<utility::ConfigStore> build_config();
+    void write_config(utility::ConfigStore& cfg);
+    void reload_changed_config();
     void consume_input();
     void update_fonts();
     void invalidate_device_objects();
@@ -216,6 +263,11 @@ private:
     bool m_has_frame{false};
     bool m_wants_device_object_cleanup{false};
     bool m_wants_save_config{false};
+
+    // Written by m_config_writer's thread only
+    uint64_t m_last_config_hash{0};
+    std::unique_ptr<utility::AsyncConfigWriter<utility::ConfigStore>> m_config_writer{};
+    std::unique_ptr<utility::ConfigWatcher> m_config_watcher{}; // set before m_config_writer exists
     bool m_draw_ui{true};
     bool m_last_draw_ui{m_draw_ui};
     bool m_is_ui_focused{false};
@@ -235,10 +287,29 @@ private:
         ImFont* font{};
     };
 
+    utility::UiDrawCache m_ui_draw_cache{};
+    std::vector<ImVec4> m_ui_saved_clip_rects{};
+
     bool m_fonts_need_updating{true};
     int m_font_size{16};
     std::vector<AdditionalFont> m_additional_fonts{};
 
+    // vr_pictographic.mode with set_lazy_glyphs: only the glyphs seen so far get baked instead of the whole CJK range
+    void load_used_glyphs();
+    void save_used_glyphs();
+    void add_used_glyph(uint32_t codepoint);
+
+    bool m_lazy_glyphs_enabled{false};
+    bool m_lazy_glyphs{false};
+    bool m_glyphs_pending{false}; // new glyphs waiting for the next batched rebuild
+    std::chrono::steady_clock::time_point m_last_glyph_rebuild{};
+    bool m_used_glyphs_loaded{false};
+    bool m_used_glyphs_dirty{false};
+    utility::GlyphRangeSet m_glyph_universe{}; // what the font can provide
+    utility::GlyphRangeSet m_used_glyphs{};    // what gets baked
+    std::vector<ImWchar> m_primary_glyph_ranges{}; // referenced by the atlas until the next rebuild
+    std::unique_ptr<utility::FontAtlasCache> m_font_cache{};
+
     std::mutex m_input_mutex{};
     std::recursive_mutex m_config_mtx{};
     std::recursive_mutex m_imgui_mtx{};
@@ -256,7 +327,8 @@ private:
     std::unique_ptr<DInputHook> m_dinput_hook;
     std::unique_ptr<XInputHook> m_xinput_hook{};
     std::shared_ptr<spdlog::logger> m_logger;
-    Patch::Ptr m_set_cursor_pos_patch{};
+    std::unique_ptr<utility::HotLog> m_hot_log{}; // published in utility::g_hot_log
+    std::unique_ptr<utility::PatchTransaction> m_set_cursor_pos_patch{};
 
     std::string m_error{""};
 
@@ -265,17 +337,16 @@ private:
 
     std::recursive_mutex m_hook_monitor_mutex{};
     std::recursive_mutex m_startup_mutex{};
+    std::recursive_mutex m_d3d12_listeners_mtx{}; // m_d3d12_hook replacement vs. attaching mod listeners
     std::unique_ptr<std::jthread> m_d3d_monitor_thread{};
-    std::chrono::steady_clock::time_point m_last_present_time{};
-    std::chrono::steady_clock::time_point m_last_message_time{};
-    std::chrono::steady_clock::time_point m_last_sendmessage_time{};
-    std::chrono::steady_clock::time_point m_last_chance_time{};
+    utility::Heartbeat m_present_heartbeat{};
+    utility::Heartbeat m_message_heartbeat{};
+    utility::PresentGate m_present_gate{m_hook_monitor_mutex};
+    utility::HookWatchdog m_hook_watchdog{}; // monitor thread only
     uint32_t m_frames_since_init{0};
-    bool m_has_last_chance{true};
     bool m_first_initialize{true};
 
-    bool m_sent_message{false};
-    bool m_message_hook_requested{false};
+    std::atomic<bool> m_message_hook_requested{false}; // set by the hook monitor
     bool m_has_engine_thread{false};
 
     RendererType m_renderer_type{RendererType::D3D11};
@@ -4,6 +4,7 @@
 #define DIRECTINPUT_VERSION 0x0800
 #include <dinput.h>
 
+#include <functional>
 #include <vector>
 #include <windows.h>
 #include <Xinput.h>
@@ -12,7 +13,7 @@
 #include <memory>
 
 #include <imgui.h>
-#include <utility/Config.hpp>
+#include "utility/ConfigStore.hpp"
 
 //#include <sdk/Math.hpp>
 //#include <sdk/UGameEngine.hpp>
@@ -23,16 +24,49 @@
 class IModValue {
 public:
     using Ptr = std::unique_ptr<IModValue>;
+    using ChangeCallback = std::function<void(IModValue&)>;
+
+    // What a value needs after vr_config.txt changed it on disk, gathered over the whole reload and done once.
+    enum Rebuild : uint32_t {
+        REBUILD_NONE = 0,
+        REBUILD_RESOURCES = 1 << 0, // see Mod::on_config_rebuild
+    };
 
     virtual ~IModValue() {};
     virtual bool draw(std::string_view name) = 0;
     virtual void draw_value(std::string_view name) = 0;
-    virtual void config_load(const utility::Config& cfg, bool set_defaults) = 0;
-    virtual void config_save(utility::Config& cfg) = 0;
+    virtual void config_load(const utility::ConfigStore& cfg, bool set_defaults) = 0;
+    virtual void config_save(utility::ConfigStore& cfg) = 0;
+    virtual bool config_differs(const utility::ConfigStore& cfg) const = 0;
     virtual void set(const std::string& value) = 0;
     virtual std::string get() const = 0;
     virtual std::string get_config_name() const = 0;
     virtual std::string_view get_config_name_view() const = 0;
+
+    // Only called for changes coming from a config reload, the UI applies its edits itself.
+    IModValue& on_change(ChangeCallback callback) {
+        m_on_change.push_back(std::move(callback));
+        return *this;
+    }
+
+    IModValue& requires_rebuild(uint32_t rebuild) {
+        m_rebuild |= rebuild;
+        return *this;
+    }
+
+    void notify_changed() {
+        for (auto& callback : m_on_change) {
+            callback(*this);
+        }
+    }
+
+    uint32_t get_rebuild() const {
+        return m_rebuild;
+    }
+
+protected:
+    std::vector<ChangeCallback> m_on_change{};
+    uint32_t m_rebuild{REBUILD_NONE};
 };
 
 // Convenience classes for imgui
@@ -55,20 +89,20 @@ public:
 
     virtual ~ModValue() override {};
 
-    virtual void config_load(const utility::Config& cfg, bool set_defaults) override {
+    virtual void config_load(const utility::ConfigStore& cfg, bool set_defaults) override {
         if (set_defaults) {
             m_value = m_default_value;
             return;
         }
 
         if constexpr (std::is_same_v<T, std::string>) {
-            auto v = cfg.get(m_config_name);
+            auto v = cfg.get(config_key());
 
             if (v) {
                 m_value = *v;
             }
         } else {
-            auto v = cfg.get<T>(m_config_name);
+            auto v = cfg.get<T>(config_key());
 
             if (v) {
                 m_value = *v;
@@ -76,14 +110,25 @@ public:
         }
     };
 
-    virtual void config_save(utility::Config& cfg) override {
+    virtual void config_save(utility::ConfigStore& cfg) override {
         if constexpr (std::is_same_v<T, std::string>) {
-            cfg.set(m_config_name, m_value);
+            cfg.set(config_key(), m_value);
         } else {
-            cfg.set<T>(m_config_name, m_value);
+            cfg.set<T>(config_key(), m_value);
         }
     };
 
+    // Keys missing from `cfg` don't count, a reload never resets a value to its default.
+    virtual bool config_differs(const utility::ConfigStore& cfg) const override {
+        if constexpr (std::is_same_v<T, std::string>) {
+            const auto v = cfg.get_text(config_key());
+            return v && *v != m_value;
+        } else {
+            const auto v = cfg.get<T>(config_key());
+            return v && *v != m_value;
+        }
+    }
+
     virtual std::string get() const override {
         if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>) {
             return m_value;
@@ -142,6 +187,10 @@ public:
         return m_config_name;
     }
 
+    utility::ConfigKey config_key() const {
+        return { m_config_hash, m_config_name };
+    }
+
     void context_menu_logic() {
         if (ImGui::BeginPopupContextItem()) {
             reset_to_default_value_logic();
@@ -159,6 +208,7 @@ protected:
     T m_value{};
     const T m_default_value{};
     const std::string m_config_name{ "Default_ModValue" };
+    const uint64_t m_config_hash{ utility::hash_config_key(m_config_name) };
     const bool m_advanced_option{false};
 };
 
@@ -354,7 +404,7 @@ public:
         ImGui::Text("%s: %s", name.data(), m_options[m_value]);
     }
 
-    void config_load(const utility::Config& cfg, bool set_defaults) override {
+    void config_load(const utility::ConfigStore& cfg, bool set_defaults) override {
         ModValue<int32_t>::config_load(cfg, set_defaults);
 
         if (m_value >= (int32_t)m_options.size()) {
@@ -514,13 +564,13 @@ public:
         ImGui::Text("%s: %s", name.data(), m_value.c_str());
     }
 
-    void config_load(const utility::Config& cfg, bool set_defaults) override {
+    void config_load(const utility::ConfigStore& cfg, bool set_defaults) override {
         if (set_defaults) {
             m_value = m_default_value;
             return;
         }
 
-        auto v = cfg.get(m_config_name);
+        auto v = cfg.get(config_key());
 
         if (v) {
             m_value = *v;
@@ -529,6 +579,27 @@ public:
 };
 
 class ModComponent;
+class Mod;
+
+// Handed to Mod::on_d3d12_attach_listeners for every new D3D12Hook. Each call makes the mod a listener on
+// one of the hook's command list dispatchers, which then calls the matching on_d3d12_* override.
+class D3D12Listeners {
+public:
+    D3D12Listeners(D3D12Hook& hook, Mod& mod) : m_hook{hook}, m_mod{mod} {}
+
+    void set_render_targets();
+    void set_scissor_rects();
+    void set_viewports();
+    void create_render_target_view();
+
+    // False if a dispatcher was full and the mod misses a callback
+    bool ok() const { return m_ok; }
+
+private:
+    D3D12Hook& m_hook;
+    Mod& m_mod;
+    bool m_ok{true};
+};
 
 class Mod {
 public:
@@ -562,8 +633,13 @@ public:
     virtual void on_xinput_set_state(uint32_t* retval, uint32_t user_index, XINPUT_VIBRATION* vibration) {};
 
     virtual void on_post_render_vr_framework_dx11(ID3D11DeviceContext* context, ID3D11Texture2D* tex, ID3D11RenderTargetView* rtv) {};
+    // Only called when the UI render target is redrawn, see Framework::invalidate_ui_cache
     virtual void on_post_render_vr_framework_dx12(ID3D12GraphicsCommandList* command_list, ID3D12Resource* tex, D3D12_CPU_DESCRIPTOR_HANDLE* rtv) {};
 
+    // The on_d3d12_* command list callbacks below run for every intercepted call and are only called for
+    // the mods that listen to them, register the ones you override here.
+    virtual void on_d3d12_attach_listeners(D3D12Listeners& listeners) {};
+
     virtual void on_d3d12_set_render_targets(ID3D12GraphicsCommandList5* cmd_list, UINT num_rtvs, 
         const D3D12_CPU_DESCRIPTOR_HANDLE* rtvs, BOOL single_handle, D3D12_CPU_DESCRIPTOR_HANDLE* dsv) {};
     virtual void on_d3d12_set_scissor_rects(ID3D12GraphicsCommandList5* cmd_list, UINT num_rects, const D3D12_RECT* rects) {};
@@ -571,8 +647,14 @@ public:
     virtual void on_d3d12_create_render_target_view(ID3D12Device* device, ID3D12Resource* pResource, 
         const D3D12_RENDER_TARGET_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) {};
 
-    virtual void on_config_load(const utility::Config& cfg, bool set_defaults);
-    virtual void on_config_save(utility::Config& cfg);
+    virtual void on_config_load(const utility::ConfigStore& cfg, bool set_defaults);
+    virtual void on_config_save(utility::ConfigStore& cfg);
+
+    // vr_config.txt was edited while running. Loads only the values that differ from `cfg`
+    // and runs their change callbacks, returns the IModValue::Rebuild flags they asked for.
+    virtual uint32_t on_config_reload(const utility::ConfigStore& cfg);
+    // Once per reload that changed a REBUILD_RESOURCES value of this mod, after all values are in.
+    virtual void on_config_rebuild() {};
 
     virtual IModValue* get_value(std::string_view name) const;
 
@@ -591,6 +673,8 @@ public:
 //    virtual void on_post_viewport_client_draw(void* viewport_client, void* viewport, void* canvas) {};
 
 protected:
+    static uint32_t apply_config_changes(const ValueList& options, const utility::ConfigStore& cfg);
+
     ValueList m_options{};
     std::vector<ModComponent*> m_components{};
 };
@@ -600,7 +684,7 @@ public:
     // todo?
 };
 
-inline void Mod::on_config_load(const utility::Config& cfg, bool set_defaults) {
+inline void Mod::on_config_load(const utility::ConfigStore& cfg, bool set_defaults) {
     for (auto& value : m_options) {
         value.get().config_load(cfg, set_defaults);
     }
@@ -610,7 +694,7 @@ inline void Mod::on_config_load(const utility::Config& cfg, bool set_defaults) {
     }
 }
 
-inline void Mod::on_config_save(utility::Config& cfg) {
+inline void Mod::on_config_save(utility::ConfigStore& cfg) {
     for (const auto& value : m_options) {
         value.get().config_save(cfg);
     }
@@ -620,6 +704,36 @@ inline void Mod::on_config_save(utility::Config& cfg) {
     }
 }
 
+inline uint32_t Mod::apply_config_changes(const ValueList& options, const utility::ConfigStore& cfg) {
+    uint32_t rebuild = IModValue::REBUILD_NONE;
+
+    for (auto& option : options) {
+        auto& value = option.get();
+
+        if (!value.config_differs(cfg)) {
+            continue;
+        }
+
+        spdlog::info("[Config] {} changed on disk to {}", value.get_config_name_view(), *cfg.get_text(value.get_config_name_view()));
+
+        value.config_load(cfg, false);
+        value.notify_changed();
+        rebuild |= value.get_rebuild();
+    }
+
+    return rebuild;
+}
+
+inline uint32_t Mod::on_config_reload(const utility::ConfigStore& cfg) {
+    auto rebuild = apply_config_changes(m_options, cfg);
+
+    for (auto& component : m_components) {
+        rebuild |= component->on_config_reload(cfg);
+    }
+
+    return rebuild;
+}
+
 inline IModValue* Mod::get_value(std::string_view name) const {
     auto it = std::find_if(m_options.begin(), m_options.end(), [&name](const auto& v) {
         return v.get().get_config_name_view() == name;
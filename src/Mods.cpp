@@ -36,12 +36,43 @@ std::optional<std::string> Mods::on_initialize_d3d_thread() const {
 }
 
 void Mods::reload_config(bool set_defaults) const {
-    utility::Config cfg{ (Framework::get_persistent_dir() / "vr_config.txt").string() };
+    utility::ConfigStore cfg{ Framework::get_persistent_dir() / "vr_config.txt" };
+
+    if (cfg.get_version() < utility::ConfigStore::CURRENT_VERSION) {
+        spdlog::info("Importing vr_config.txt from config version {}", cfg.get_version());
+    }
 
     for (auto& mod : m_mods) {
         spdlog::info("{:s}::on_config_load()", mod->get_name().data());
         mod->on_config_load(cfg, set_defaults);
     }
+
+    std::scoped_lock _{m_loaded_config_mtx};
+    m_loaded_config = std::move(cfg);
+}
+
+void Mods::on_config_reload(utility::ConfigStore cfg) const {
+    std::vector<Mod*> rebuilds{};
+
+    for (auto& mod : m_mods) {
+        if (mod->on_config_reload(cfg) & IModValue::REBUILD_RESOURCES) {
+            rebuilds.push_back(mod.get());
+        }
+    }
+
+    // One rebuild per reload no matter how many of the values involved changed
+    for (auto mod : rebuilds) {
+        spdlog::info("{:s}::on_config_rebuild()", mod->get_name().data());
+        mod->on_config_rebuild();
+    }
+
+    std::scoped_lock _{m_loaded_config_mtx};
+    m_loaded_config = std::move(cfg);
+}
+
+utility::ConfigStore Mods::get_loaded_config() const {
+    std::scoped_lock _{m_loaded_config_mtx};
+    return m_loaded_config;
 }
 
 void Mods::on_pre_imgui_frame() const {
@@ -92,28 +123,39 @@ void Mods::on_d3d11_initialize(ID3D11Device* pDevice, D3D11_TEXTURE2D_DESC& desc
     }
 }
 
-void Mods::on_d3d12_set_render_targets(ID3D12GraphicsCommandList5* cmd_list, UINT num_rtvs, 
-    const D3D12_CPU_DESCRIPTOR_HANDLE* rtvs, BOOL single_handle, D3D12_CPU_DESCRIPTOR_HANDLE* dsv) const {
+void Mods::attach_d3d12_listeners(D3D12Hook& hook) const {
     for (auto& mod : m_mods) {
-        mod->on_d3d12_set_render_targets(cmd_list, num_rtvs, rtvs, single_handle, dsv);
+        D3D12Listeners listeners{hook, *mod};
+        mod->on_d3d12_attach_listeners(listeners);
+
+        if (!listeners.ok()) {
+            spdlog::error("[Mods] Too many D3D12 command list listeners, {} misses some", mod->get_name());
+        }
     }
 }
 
-void Mods::on_d3d12_set_scissor_rects(ID3D12GraphicsCommandList5* cmd_list, UINT num_rects, const D3D12_RECT* rects) const {
-    for (auto& mod : m_mods) {
-        mod->on_d3d12_set_scissor_rects(cmd_list, num_rects, rects);
-    }
+void D3D12Listeners::set_render_targets() {
+    m_ok &= m_hook.get_set_render_targets_listeners().add([](void* user, ID3D12GraphicsCommandList5* cmd_list, UINT num_rtvs,
+        const D3D12_CPU_DESCRIPTOR_HANDLE* rtvs, BOOL single_handle, D3D12_CPU_DESCRIPTOR_HANDLE* dsv) {
+        ((Mod*)user)->on_d3d12_set_render_targets(cmd_list, num_rtvs, rtvs, single_handle, dsv);
+    }, &m_mod);
 }
 
-void Mods::on_d3d12_set_viewports(ID3D12GraphicsCommandList5* cmd_list, UINT num_viewports, const D3D12_VIEWPORT* viewports) const {
-    for (auto& mod : m_mods) {
-        mod->on_d3d12_set_viewports(cmd_list, num_viewports, viewports);
-    }
+void D3D12Listeners::set_scissor_rects() {
+    m_ok &= m_hook.get_set_scissor_rects_listeners().add([](void* user, ID3D12GraphicsCommandList5* cmd_list, UINT num_rects, const D3D12_RECT* rects) {
+        ((Mod*)user)->on_d3d12_set_scissor_rects(cmd_list, num_rects, rects);
+    }, &m_mod);
 }
 
-void Mods::on_d3d12_create_render_target_view(ID3D12Device* device, ID3D12Resource* pResource, 
-    const D3D12_RENDER_TARGET_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) const {
-    for (auto& mod : m_mods) {
-        mod->on_d3d12_create_render_target_view(device, pResource, pDesc, DestDescriptor);
-    }
+void D3D12Listeners::set_viewports() {
+    m_ok &= m_hook.get_set_viewports_listeners().add([](void* user, ID3D12GraphicsCommandList5* cmd_list, UINT num_viewports, const D3D12_VIEWPORT* viewports) {
+        ((Mod*)user)->on_d3d12_set_viewports(cmd_list, num_viewports, viewports);
+    }, &m_mod);
+}
+
+void D3D12Listeners::create_render_target_view() {
+    m_ok &= m_hook.get_create_render_target_view_listeners().add([](void* user, ID3D12Device* device, ID3D12Resource* pResource,
+        const D3D12_RENDER_TARGET_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) {
+        ((Mod*)user)->on_d3d12_create_render_target_view(device, pResource, pDesc, DestDescriptor);
+    }, &m_mod);
 }
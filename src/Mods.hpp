@@ -11,6 +11,13 @@ public:
     std::optional<std::string> on_initialize_d3d_thread() const;
     void reload_config(bool set_defaults = false) const;
 
+    // What vr_config.txt contained at the last reload, including keys no mod asked for.
+    utility::ConfigStore get_loaded_config() const;
+
+    // Applies an edited vr_config.txt without a restart, only values that changed are touched.
+    // Call from the frame thread.
+    void on_config_reload(utility::ConfigStore cfg) const;
+
     void on_pre_imgui_frame() const;
     void on_frame() const;
     void on_present() const;
@@ -20,12 +27,8 @@ public:
     void on_d3d12_initialize(ID3D12Device4* pDevice4, D3D12_RESOURCE_DESC& desc) const;
     void on_d3d11_initialize(ID3D11Device* pDevice, D3D11_TEXTURE2D_DESC& desc) const;
     
-    void on_d3d12_set_render_targets(ID3D12GraphicsCommandList5* cmd_list, UINT num_rtvs, 
-        const D3D12_CPU_DESCRIPTOR_HANDLE* rtvs, BOOL single_handle, D3D12_CPU_DESCRIPTOR_HANDLE* dsv) const;
-    void on_d3d12_set_scissor_rects(ID3D12GraphicsCommandList5* cmd_list, UINT num_rects, const D3D12_RECT* rects) const;
-    void on_d3d12_set_viewports(ID3D12GraphicsCommandList5* cmd_list, UINT num_viewports, const D3D12_VIEWPORT* viewports) const;
-    void on_d3d12_create_render_target_view(ID3D12Device* device, ID3D12Resource* pResource, 
-        const D3D12_RENDER_TARGET_VIEW_DESC* pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) const;
+    // Lets every mod register its command list callbacks with the hook's dispatchers (Mod::on_d3d12_attach_listeners).
+    void attach_d3d12_listeners(D3D12Hook& hook) const;
 
     const auto& get_mods() const {
         return m_mods;
@@ -33,4 +36,7 @@ public:
 
 private:
     std::vector<std::shared_ptr<Mod>> m_mods;
+
+    mutable std::mutex m_loaded_config_mtx{};
+    mutable utility::ConfigStore m_loaded_config{};
 };
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include <winternl.h>
+
+#include "ModuleWatcher.hpp"
+
+namespace {
+// Not in the SDK headers, see LdrRegisterDllNotification on MSDN.
+constexpr ULONG LDR_DLL_NOTIFICATION_REASON_LOADED = 1;
+
+struct LDR_DLL_LOADED_NOTIFICATION_DATA {
+    ULONG Flags;
+    const UNICODE_STRING* FullDllName;
+    const UNICODE_STRING* BaseDllName;
+    void* DllBase;
+    ULONG SizeOfImage;
+};
+
+using PLDR_DLL_NOTIFICATION_FUNCTION = void(CALLBACK*)(ULONG reason, const void* data, void* context);
+using LdrRegisterDllNotification_t = NTSTATUS(NTAPI*)(ULONG flags, PLDR_DLL_NOTIFICATION_FUNCTION callback, void* context, void** cookie);
+using LdrUnregisterDllNotification_t = NTSTATUS(NTAPI*)(void* cookie);
+
+std::chrono::microseconds thread_cpu_time(HANDLE thread) {
+    FILETIME creation{}, exit{}, kernel{}, user{};
+
+    if (thread == nullptr || !GetThreadTimes(thread, &creation, &exit, &kernel, &user)) {
+        return {};
+    }
+
+    const auto to_100ns = [](const FILETIME& t) { return ((uint64_t)t.dwHighDateTime << 32) | t.dwLowDateTime; };
+
+    return std::chrono::microseconds{(to_100ns(kernel) + to_100ns(user)) / 10};
+}
+}
+
+// To prevent usage of statics (TLS breaks the present thread...?)
+std::unique_ptr<ModuleWatcher> g_module_watcher{};
+
+ModuleWatcher& ModuleWatcher::get() {
+    if (g_module_watcher == nullptr) {
+        g_module_watcher = std::make_unique<ModuleWatcher>();
+    }
+
+    return *g_module_watcher;
+}
+
+ModuleWatcher::ModuleWatcher()
+    : m_registry{[](std::string_view name) -> utility::ModuleLoadRegistry::Handle {
+          return GetModuleHandleA(std::string{name}.c_str());
+      }}
+{
+    m_worker = std::jthread{[this](std::stop_token s) {
+        while (!s.stop_requested()) {
+            std::pair<std::string, HMODULE> loaded{};
+
+            {
+                std::unique_lock lock{m_queue_mtx};
+
+                if (!m_queue_cv.wait(lock, s, [this] { return !m_queue.empty(); })) {
+                    break;
+                }
+
+                loaded = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+
+            if (m_registry.notify_loaded(loaded.first, loaded.second) > 0) {
+                spdlog::info("[ModuleWatcher] {} loaded, waited {}ms", loaded.first,
+                    std::chrono::duration_cast<std::chrono::milliseconds>(m_registry.get_last_wait()).count());
+            }
+        }
+    }};
+
+    const auto ntdll = GetModuleHandleW(L"ntdll.dll");
+    const auto register_fn = ntdll != nullptr ? (LdrRegisterDllNotification_t)GetProcAddress(ntdll, "LdrRegisterDllNotification") : nullptr;
+
+    if (register_fn == nullptr || register_fn(0, &ModuleWatcher::on_dll_notification, this, &m_cookie) != 0) {
+        m_cookie = nullptr;
+        spdlog::error("[ModuleWatcher] Failed to register for DLL notifications, late modules will not be hooked");
+    }
+}
+
+ModuleWatcher::~ModuleWatcher() {
+    if (m_cookie != nullptr) {
+        const auto ntdll = GetModuleHandleW(L"ntdll.dll");
+        const auto unregister_fn = (LdrUnregisterDllNotification_t)GetProcAddress(ntdll, "LdrUnregisterDllNotification");
+
+        if (unregister_fn != nullptr) {
+            unregister_fn(m_cookie);
+        }
+    }
+
+    m_worker.request_stop();
+
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+void ModuleWatcher::on_load(std::string_view name, Callback callback) {
+    const auto ran = m_registry.on_load(name, [this, name = std::string{name}, callback = std::move(callback)](utility::ModuleLoadRegistry::Handle handle) {
+        const auto start = thread_cpu_time(GetCurrentThread());
+        callback((HMODULE)handle);
+        const auto spent = thread_cpu_time(GetCurrentThread()) - start;
+
+        m_callback_cpu_us += spent.count();
+        spdlog::info("[ModuleWatcher] Hooks for {} took {}us CPU", name, spent.count());
+    });
+
+    if (!ran) {
+        spdlog::info("[ModuleWatcher] Waiting for {}", name);
+    }
+}
+
+ModuleWatcher::CpuTime ModuleWatcher::get_cpu_time() const {
+    return CpuTime{
+        std::chrono::microseconds{m_callback_cpu_us.load()},
+        thread_cpu_time(const_cast<std::jthread&>(m_worker).native_handle()),
+    };
+}
+
+void CALLBACK ModuleWatcher::on_dll_notification(ULONG reason, const void* data, void* context) {
+    if (reason != LDR_DLL_NOTIFICATION_REASON_LOADED || data == nullptr || context == nullptr) {
+        return;
+    }
+
+    // We're holding the loader lock here, so only copy the name out and let the worker do the rest.
+    const auto loaded = (const LDR_DLL_LOADED_NOTIFICATION_DATA*)data;
+    const auto& base_name = *loaded->BaseDllName;
+
+    std::string name(base_name.Length / sizeof(wchar_t), '\0');
+
+    for (size_t i = 0; i < name.size(); ++i) {
+        // module names are ASCII
+        name[i] = (char)base_name.Buffer[i];
+    }
+
+    auto watcher = (ModuleWatcher*)context;
+
+    {
+        std::scoped_lock _{watcher->m_queue_mtx};
+        watcher->m_queue.emplace_back(std::move(name), (HMODULE)loaded->DllBase);
+    }
+
+    watcher->m_queue_cv.notify_one();
+}
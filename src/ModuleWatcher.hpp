@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Windows.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "utility/ModuleLoadRegistry.hpp"
+
+// Runs callbacks once a given DLL is loaded, instead of every late-binding hook
+// spinning on GetModuleHandle until it shows up.
+// Backed by the loader's DLL notifications. Callbacks are dispatched on a worker thread,
+// never under the loader lock, so they can safely install hooks.
+class ModuleWatcher {
+public:
+    static ModuleWatcher& get();
+
+public:
+    using Callback = std::function<void(HMODULE)>;
+
+    ModuleWatcher();
+    virtual ~ModuleWatcher();
+
+    // Runs the callback immediately (on the calling thread) if the module is already loaded.
+    void on_load(std::string_view name, Callback callback);
+
+    size_t pending() const {
+        return m_registry.pending();
+    }
+
+    // CPU time (user + kernel) spent in callbacks, on whichever thread ran them, and on the worker thread overall.
+    // What the spinning waits used to burn while the game was starting is what the worker doesn't.
+    struct CpuTime {
+        std::chrono::microseconds callbacks{};
+        std::chrono::microseconds worker{};
+    };
+
+    CpuTime get_cpu_time() const;
+
+private:
+    static void CALLBACK on_dll_notification(ULONG reason, const void* data, void* context);
+
+    utility::ModuleLoadRegistry m_registry;
+
+    void* m_cookie{nullptr};
+    std::atomic<int64_t> m_callback_cpu_us{0};
+
+    std::mutex m_queue_mtx{};
+    std::condition_variable_any m_queue_cv{};
+    std::deque<std::pair<std::string, HMODULE>> m_queue{};
+    std::jthread m_worker{};
+};
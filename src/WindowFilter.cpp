@@ -11,82 +11,113 @@ WindowFilter& WindowFilter::get() {
     return *g_window_filter;
 }
 
-WindowFilter::WindowFilter() {
-    // We create a job thread because GetWindowTextA can actually deadlock inside
-    // the present thread...
-    m_job_thread = std::make_unique<std::jthread>([this](std::stop_token s){
-        while (!s.stop_requested()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds{100});
-
-            m_last_job_tick = std::chrono::steady_clock::now();
-
-            std::vector<HWND> jobs_copy;
-            {
-                std::scoped_lock _{m_mutex};
-                if (m_window_jobs.empty()) {
-                    continue;
-                }
-                jobs_copy.assign(m_window_jobs.begin(), m_window_jobs.end());
-                m_window_jobs.clear();
-            }
+WindowFilter::WindowFilter()
+    : m_filter{[](utility::WindowFilterSet::WindowId window) { return get_window_title((HWND)window); },
+               utility::WindowFilterSet::parse_patterns(DEFAULT_PATTERNS),
+               [this]() {
+                   // Before the thread has a queue it drains the pending windows itself
+                   if (const auto thread_id = m_event_thread_id.load(); thread_id != 0) {
+                       PostThreadMessageW(thread_id, WM_CLASSIFY_PENDING, 0, 0);
+                   }
+               }}
+{
+    m_event_thread = std::jthread{[this](std::stop_token s) {
+        // Out of context hooks are delivered through this thread's message queue,
+        // so make sure it exists before anything can post to it.
+        MSG msg{};
+        PeekMessageW(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+
+        const auto thread_id = GetCurrentThreadId();
+        const auto process_id = GetCurrentProcessId();
+
+        m_event_thread_id = thread_id;
+        m_filter.classify_pending();
+
+        // Two hooks instead of one range so we don't get flooded by show/location events.
+        const auto lifetime_hook = SetWinEventHook(EVENT_OBJECT_CREATE, EVENT_OBJECT_DESTROY, nullptr, &WindowFilter::on_win_event, process_id, 0, WINEVENT_OUTOFCONTEXT);
+        const auto name_hook = SetWinEventHook(EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE, nullptr, &WindowFilter::on_win_event, process_id, 0, WINEVENT_OUTOFCONTEXT);
+
+        if (lifetime_hook == nullptr || name_hook == nullptr) {
+            spdlog::error("[WindowFilter] Failed to install window event hooks, titles will only be checked on first use");
+        }
+
+        // Runs right away if a stop was already requested.
+        std::stop_callback on_stop{s, [thread_id]() {
+            PostThreadMessageW(thread_id, WM_QUIT, 0, 0);
+        }};
 
-            for (const auto hwnd : jobs_copy) {
-                if (is_filtered_nocache(hwnd)) {
-                    filter_window(hwnd);
-                }
+        while (GetMessageW(&msg, nullptr, 0, 0) > 0) {
+            if (msg.hwnd == nullptr && msg.message == WM_CLASSIFY_PENDING) {
+                m_filter.classify_pending();
+                continue;
             }
+
+            TranslateMessage(&msg);
+            DispatchMessageW(&msg);
+        }
+
+        if (lifetime_hook != nullptr) {
+            UnhookWinEvent(lifetime_hook);
         }
-    });
+
+        if (name_hook != nullptr) {
+            UnhookWinEvent(name_hook);
+        }
+
+        m_event_thread_id = 0;
+    }};
 }
 
 WindowFilter::~WindowFilter() {
-    m_job_thread->request_stop();
-    m_job_thread->join();
+    m_event_thread.request_stop();
+
+    if (m_event_thread.joinable()) {
+        m_event_thread.join();
+    }
 }
 
 bool WindowFilter::is_filtered(HWND hwnd) {
     if (hwnd == nullptr) {
         return true;
     }
-    
-    std::scoped_lock _{m_mutex};
 
-    if (m_filtered_windows.find(hwnd) != m_filtered_windows.end()) {
-        return true;
-    }
+    return m_filter.is_filtered(hwnd);
+}
 
-    // If there is a job for this window, filter it until the job is done
-    if (m_window_jobs.find(hwnd) != m_window_jobs.end()) {
-        // If the thread is dead for some reason, do not filter it.
-        return std::chrono::steady_clock::now() - m_last_job_tick <= std::chrono::seconds{2};
+void CALLBACK WindowFilter::on_win_event(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG id_object, LONG id_child, DWORD event_thread, DWORD event_time) {
+    if (hwnd == nullptr || id_object != OBJID_WINDOW || id_child != CHILDID_SELF || g_window_filter == nullptr) {
+        return;
     }
 
-    // if we havent even seen this window yet, add it to the job queue
-    // and return true;
-    if (m_seen_windows.find(hwnd) == m_seen_windows.end()) {
-        m_seen_windows.insert(hwnd);
-        m_window_jobs.insert(hwnd);
-        return true;
+    auto& filter = g_window_filter->m_filter;
+
+    switch (event) {
+    case EVENT_OBJECT_CREATE:
+    case EVENT_OBJECT_NAMECHANGE:
+        filter.classify(hwnd);
+        break;
+    case EVENT_OBJECT_DESTROY:
+        // handles get recycled, don't let a new window inherit the old verdict
+        filter.forget(hwnd);
+        break;
+    default:
+        break;
     }
-
-    return false;
 }
 
-bool WindowFilter::is_filtered_nocache(HWND hwnd) {
-    // get window name
-    char window_name[256]{};
-    GetWindowTextA(hwnd, window_name, sizeof(window_name));
+std::string WindowFilter::get_window_title(HWND hwnd) {
+    // InternalGetWindowText reads the title directly instead of sending WM_GETTEXT,
+    // so unlike GetWindowTextA it can't deadlock when called from the present thread.
+    wchar_t window_name[256]{};
+    const auto len = InternalGetWindowText(hwnd, window_name, (int)std::size(window_name));
 
-    const auto sv = std::string_view{window_name};
-
-    if (sv.find("UE4SS") != std::string_view::npos) {
-        return true;
+    if (len <= 0) {
+        return {};
     }
 
-    if (sv.find("PimaxXR") != std::string_view::npos) {
-        return true;
-    }
+    const auto size = WideCharToMultiByte(CP_UTF8, 0, window_name, len, nullptr, 0, nullptr, nullptr);
+    std::string out(size, '\0');
+    WideCharToMultiByte(CP_UTF8, 0, window_name, len, out.data(), size, nullptr, nullptr);
 
-    // TODO: more problematic windows
-    return false;
-}
\ No newline at end of file
+    return out;
+}
@@ -2,12 +2,13 @@
 
 #include <Windows.h>
 
+#include <atomic>
+#include <string>
 #include <string_view>
-#include <unordered_set>
 #include <thread>
 #include <vector>
-#include <mutex>
-#include <chrono>
+
+#include "utility/WindowFilterSet.hpp"
 
 class WindowFilter {
 public:
@@ -17,21 +18,31 @@ public:
     WindowFilter();
     virtual ~WindowFilter();
 
+    // Lock-free after the first call for a given window. A window seen for the first time counts
+    // as filtered until the event thread read its title.
     bool is_filtered(HWND hwnd);
 
     void filter_window(HWND hwnd) {
-        std::scoped_lock _{m_mutex};
-        m_filtered_windows.insert(hwnd);
+        m_filter.force_filter(hwnd);
+    }
+
+    // Comma separated list of title substrings.
+    void set_patterns(std::string_view patterns) {
+        m_filter.set_patterns(utility::WindowFilterSet::parse_patterns(patterns));
     }
 
+    static constexpr std::string_view DEFAULT_PATTERNS{"UE4SS,PimaxXR"};
+
 private:
-    bool is_filtered_nocache(HWND hwnd);
+    static std::string get_window_title(HWND hwnd);
+    static void CALLBACK on_win_event(HWINEVENTHOOK hook, DWORD event, HWND hwnd, LONG id_object, LONG id_child, DWORD event_thread, DWORD event_time);
+
+    // Posted to the event thread when is_filtered queued windows it didn't know yet
+    static constexpr UINT WM_CLASSIFY_PENDING = WM_APP + 1;
 
-    std::recursive_mutex m_mutex{};
-    std::unordered_set<HWND> m_window_jobs{};
-    std::unique_ptr<std::jthread> m_job_thread{};
+    utility::WindowFilterSet m_filter;
 
-    std::unordered_set<HWND> m_seen_windows{};
-    std::unordered_set<HWND> m_filtered_windows{};
-    std::chrono::time_point<std::chrono::steady_clock> m_last_job_tick{};
-};
\ No newline at end of file
+    // Only blocks in GetMessage, woken by create/destroy/rename events of our own windows.
+    std::jthread m_event_thread{};
+    std::atomic<DWORD> m_event_thread_id{0};
+};
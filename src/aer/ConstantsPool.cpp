@@ -1,5 +1,10 @@
 #include "ConstantsPool.h"
+#include "CorrectionMatrix.hpp"
 #include "sl_consts.h"
+#include <DirectXMath.h>
+#include <array>
+#include <atomic>
+#include <cstring>
 #include <glm/ext/matrix_transform.hpp>
 #include <mods/vr/runtimes/OpenXR.hpp>
 #include <sl_matrix_helpers.h>
@@ -7,54 +12,92 @@
 namespace GlobalPool
 {
     using namespace sl;
-    Constants g_constants[CONSTANTS_HISTORY_SIZE]{};
+    using namespace DirectX;
+    ConstantsHistory g_constants{};
+    uint64_t g_revision{0};
     static glm::mat4 permutationRHToLH = glm::scale(glm::mat4(1.0f), glm::vec3(1.0f, 1.0f, -1.0f));
 
-    float4x4 rebuildOrthogonalLHRotationMatrix(const glm::mat4& cur_view) {
-        float3 cameraRight = { cur_view[0].x, cur_view[0].y, cur_view[0].z };
-        float3 cameraFwd    = { cur_view[2].x, cur_view[2].y, cur_view[2].z };
-        float3 cameraPos  = { cur_view[3].x, cur_view[3].y, cur_view[3].z };
-        float3 cameraUp;
-        vectorNormalize(cameraRight);
-        vectorNormalize(cameraFwd);
-        vectorCrossProduct(cameraUp, cameraFwd, cameraRight);
-        vectorNormalize(cameraUp);
-        float4x4 cameraViewToWorld = {
-            float4(cameraRight.x, cameraRight.y, cameraRight.z, 0.f),
-            float4(cameraUp.x,    cameraUp.y,    cameraUp.z,    0.f),
-            float4(cameraFwd.x,   cameraFwd.y,   cameraFwd.z,   0.f),
-            float4(cameraPos.x,   cameraPos.y,   cameraPos.z,   1.f)
-        };
-        return cameraViewToWorld;
+    static const XMFLOAT4X4& as_xm(const glm::mat4& m) {
+        return *(const XMFLOAT4X4*)&m;
     }
 
-    float4x4 getFinalViewToWorldMatrix(int frame) {
-//        const glm::mat4 finalViewRH  = get_final_view(frame);
-//        auto cur_view = permutationRHToLH * finalViewRH * permutationRHToLH;
-//        auto cur_view = finalViewRH;
-        return rebuildOrthogonalLHRotationMatrix(get_final_view(frame));
+    static glm::mat4 compute_correction_matrix(const Constants& current, const Constants& past) {
+        const auto clip_to_prev_clip = aer::correction::clip_to_prev_clip(as_xm(current.projection), as_xm(current.finalView), as_xm(past.projection), as_xm(past.finalView));
+
+        glm::mat4 out;
+        std::memcpy(&out, &clip_to_prev_clip, sizeof(out));
+        return out;
     }
 
+    // Every dispatch asks for (frame, frame - 1) and (frame, frame - 2), and each upscaler evaluate
+    // asks again. Each eye (frame parity) keeps the pairs of its last frame in its own slot, an entry
+    // is only reused while neither frame's projection or view was submitted again since (see
+    // Constants::revision). A slot is taken without waiting: if another thread has it, the matrix
+    // is computed without the cache.
+    namespace {
+        struct CorrectionEntry {
+            int frame{};
+            int past_frame{};
+            uint64_t revision{};
+            uint64_t past_revision{};
+            glm::mat4 matrix{1.0f};
+        };
+
+        struct CorrectionSlot {
+            std::atomic_flag busy{};
+            std::array<CorrectionEntry, 2> entries{}; // by frame - past_frame
+        };
+
+        std::array<CorrectionSlot, 2> g_correction_slots{};
+        std::atomic<uint64_t> g_correction_hits{0};
+        std::atomic<uint64_t> g_correction_misses{0};
+        std::atomic<uint64_t> g_correction_unavailable{0};
+    }
 
     glm::mat4 get_correction_matrix(int frame, int past_frame) {
         //[Important] this call happening with same frame count as engine, however in real it is one off frame ( GOW )
 
-        auto cameraViewToClip = *(float4x4*)&get_projection(frame);
-        auto cameraViewToClipPrev = *(float4x4*)&get_projection(past_frame);
-        auto cameraViewToWorld = getFinalViewToWorldMatrix(frame);
-        auto cameraViewToWorldPrev = getFinalViewToWorldMatrix(past_frame);
+        const auto current = get_constants(frame);
+        const auto past = get_constants(past_frame);
+
+        if (!current || !past || !current->has(PROJECTION | FINAL_VIEW) || !past->has(PROJECTION | FINAL_VIEW)) {
+            g_correction_unavailable.fetch_add(1, std::memory_order_relaxed);
+            return glm::mat4{1.0f};
+        }
 
-        float4x4 clipToCameraView;
-        matrixFullInvert(clipToCameraView, cameraViewToClip);
+        auto& slot = g_correction_slots[utility::frame_slot<2>(frame)];
 
-        float4x4 cameraViewToPrevCameraView;
-        calcCameraToPrevCamera(cameraViewToPrevCameraView, cameraViewToWorld, cameraViewToWorldPrev);
+        if (slot.busy.test_and_set(std::memory_order_acquire)) {
+            g_correction_misses.fetch_add(1, std::memory_order_relaxed);
+            return compute_correction_matrix(*current, *past);
+        }
 
-        float4x4 clipToPrevCameraView;
-        matrixMul(clipToPrevCameraView, clipToCameraView, cameraViewToPrevCameraView);
-        glm::mat4 clipToPrevClip;
-        matrixMul(*(float4x4*)&clipToPrevClip, clipToPrevCameraView, cameraViewToClipPrev);
-        return clipToPrevClip;
+        auto& entry = slot.entries[utility::frame_slot<2>(frame - past_frame)];
+
+        if (entry.revision != 0 && entry.frame == frame && entry.past_frame == past_frame && entry.revision == current->revision && entry.past_revision == past->revision) {
+            g_correction_hits.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            g_correction_misses.fetch_add(1, std::memory_order_relaxed);
+
+            entry.frame = frame;
+            entry.past_frame = past_frame;
+            entry.revision = current->revision;
+            entry.past_revision = past->revision;
+            entry.matrix = compute_correction_matrix(*current, *past);
+        }
+
+        const auto matrix = entry.matrix;
+        slot.busy.clear(std::memory_order_release);
+
+        return matrix;
+    }
+
+    CorrectionStats get_correction_stats() {
+        return CorrectionStats{
+            g_correction_hits.load(std::memory_order_relaxed),
+            g_correction_misses.load(std::memory_order_relaxed),
+            g_correction_unavailable.load(std::memory_order_relaxed),
+        };
     }
 
 
@@ -3,10 +3,68 @@
 #include <openxr/openxr.h>
 #include <openvr.h>
 
+#include <cmath>
+#include <optional>
+#include <type_traits>
+
+#include "EyeContexts.hpp"
+#include <utility/FrameHistory.hpp>
+
+namespace utility
+{
+    // Position lerped, orientation slerped along the shorter arc
+    template <>
+    struct FrameLerp<XrPosef> {
+        static XrPosef lerp(const XrPosef& a, const XrPosef& b, double t) {
+            const auto& qa = a.orientation;
+            auto qb = b.orientation;
+            auto cos_theta = (double)qa.x * qb.x + (double)qa.y * qb.y + (double)qa.z * qb.z + (double)qa.w * qb.w;
+
+            if (cos_theta < 0.0) {
+                qb = XrQuaternionf{ -qb.x, -qb.y, -qb.z, -qb.w };
+                cos_theta = -cos_theta;
+            }
+
+            // Nearly the same orientation, lerp (normalized below) avoids dividing by sin(~0)
+            auto wa = 1.0 - t;
+            auto wb = t;
+
+            if (cos_theta < 0.9995) {
+                const auto theta = std::acos(cos_theta);
+                const auto sin_theta = std::sin(theta);
+                wa = std::sin((1.0 - t) * theta) / sin_theta;
+                wb = std::sin(t * theta) / sin_theta;
+            }
+
+            XrQuaternionf q{ (float)(wa * qa.x + wb * qb.x), (float)(wa * qa.y + wb * qb.y), (float)(wa * qa.z + wb * qb.z), (float)(wa * qa.w + wb * qb.w) };
+            const auto length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+
+            if (length > 0.0f) {
+                q = XrQuaternionf{ q.x / length, q.y / length, q.z / length, q.w / length };
+            }
+
+            const auto& pa = a.position;
+            const auto& pb = b.position;
+            const auto ft = (float)t;
+
+            return XrPosef{ q, XrVector3f{ pa.x + (pb.x - pa.x) * ft, pa.y + (pb.y - pa.y) * ft, pa.z + (pb.z - pa.z) * ft } };
+        }
+    };
+}
+
 namespace GlobalPool
 {
     static const int CONSTANTS_HISTORY_SIZE = 10;
 
+    // Constants::submitted bits
+    enum Submitted : uint32_t {
+        PROJECTION  = 1 << 0,
+        FINAL_VIEW  = 1 << 1,
+        OPENXR_POSE = 1 << 2,
+        OPENXR_FOV  = 1 << 3,
+        OPENVR_POSE = 1 << 4,
+    };
+
     struct Constants
     {
         glm::mat4     projection{ 1.0 };
@@ -20,20 +78,66 @@ namespace GlobalPool
         struct OpenVR {
             vr::HmdMatrix34_t pose{};
         } openvr;
+
+        uint64_t revision{0}; // bumped whenever projection or finalView is submitted
+        uint32_t submitted{0}; // Submitted bits, what was set for this frame (the rest is default)
+
+        bool has(uint32_t parts) const { return (submitted & parts) == parts; }
     };
 
-    extern Constants g_constants[CONSTANTS_HISTORY_SIZE];
+    // Written by the game's render thread and VR::update_hmd_state, read by the upscalers and the presenter
+    using ConstantsHistory = utility::SharedFrameHistory<Constants, CONSTANTS_HISTORY_SIZE>;
+    extern ConstantsHistory g_constants;
 
+    extern uint64_t g_revision;
+
+    // Memoized per frame pair, recomputed only after either frame's projection or view was submitted again.
+    // Identity (no correction) if either frame's projection or view isn't in the history.
     glm::mat4 get_correction_matrix(int frame, int past_frame);
 
+    struct CorrectionStats {
+        uint64_t hits{};
+        uint64_t misses{};
+        uint64_t unavailable{}; // frames without projection and view, not corrected
+    };
+
+    CorrectionStats get_correction_stats();
+
+    // Nothing for a frame that already left the history or that nothing was submitted for
+    inline std::optional<Constants> get_constants(int frame)
+    {
+        return g_constants.get(frame);
+    }
+
+    // What `get(constants)` returns, if that part was submitted for the frame
+    template <typename Get>
+    inline auto get_submitted(int frame, uint32_t part, Get&& get) -> std::optional<std::decay_t<decltype(get(std::declval<const Constants&>()))>>
+    {
+        const auto constants = get_constants(frame);
+
+        if (!constants || !constants->has(part)) {
+            return std::nullopt;
+        }
+
+        return get(*constants);
+    }
+
     inline void submit_projection(glm::mat4& projection, int frame)
     {
-        g_constants[frame % CONSTANTS_HISTORY_SIZE].projection = projection;
+        g_constants.update(frame, [&](Constants& constants) {
+            constants.projection = projection;
+            constants.revision = ++g_revision;
+            constants.submitted |= PROJECTION;
+        });
     }
 
     inline void submit_final_view(glm::mat4& finalView, int frame)
     {
-        g_constants[frame % CONSTANTS_HISTORY_SIZE].finalView = finalView;
+        g_constants.update(frame, [&](Constants& constants) {
+            constants.finalView = finalView;
+            constants.revision = ++g_revision;
+            constants.submitted |= FINAL_VIEW;
+        });
     }
 //
 //    inline void submit_camera_view(glm::mat4& cameraView, int frame)
@@ -46,42 +150,87 @@ namespace GlobalPool
 //        return g_constants[frame % CONSTANTS_HISTORY_SIZE].cameraView;
 //    }
 
-    inline auto& get_projection(int frame)
+    inline std::optional<glm::mat4> get_projection(int frame)
     {
-        return g_constants[frame % CONSTANTS_HISTORY_SIZE].projection;
+        return get_submitted(frame, PROJECTION, [](const Constants& c) { return c.projection; });
     }
 
-    inline const auto& get_final_view(int frame)
+    inline std::optional<glm::mat4> get_final_view(int frame)
     {
-        return g_constants[frame % CONSTANTS_HISTORY_SIZE].finalView;
+        return get_submitted(frame, FINAL_VIEW, [](const Constants& c) { return c.finalView; });
+    }
+
+    // Camera position and forward axis of the frame, see rebuildOrthogonalLHRotationMatrix
+    inline std::optional<aer::EyePose> get_eye_pose(int frame)
+    {
+        const auto view = get_final_view(frame);
+
+        if (!view) {
+            return std::nullopt;
+        }
+
+        const auto& v = *view;
+        return aer::EyePose{{v[3].x, v[3].y, v[3].z}, {v[2].x, v[2].y, v[2].z}};
     }
 
     inline void submit_openxr_pose(XrPosef& pose, int frame) {
-        g_constants[frame % CONSTANTS_HISTORY_SIZE].openxr.pose = pose;
+        g_constants.update(frame, [&](Constants& constants) {
+            constants.openxr.pose = pose;
+            constants.submitted |= OPENXR_POSE;
+        });
+    }
+
+    inline std::optional<XrPosef> get_openxr_pose(int frame) {
+        return get_submitted(frame, OPENXR_POSE, [](const Constants& c) { return c.openxr.pose; });
     }
 
-    inline const auto& get_openxr_pose(int frame) {
-        return g_constants[frame % CONSTANTS_HISTORY_SIZE].openxr.pose;
+    // Pose between two frames' poses, t = 0 is frame_a and t = 1 frame_b. Nothing unless both were submitted.
+    inline std::optional<XrPosef> get_openxr_pose(int frame_a, int frame_b, double t) {
+        const auto a = get_openxr_pose(frame_a);
+        const auto b = get_openxr_pose(frame_b);
+
+        if (!a || !b) {
+            return std::nullopt;
+        }
+
+        return utility::FrameLerp<XrPosef>::lerp(*a, *b, t);
     }
 
     inline void submit_openxr_fov(XrFovf& fov, int frame) {
-        g_constants[frame % CONSTANTS_HISTORY_SIZE].openxr.fov = fov;
+        g_constants.update(frame, [&](Constants& constants) {
+            constants.openxr.fov = fov;
+            constants.submitted |= OPENXR_FOV;
+        });
     }
 
-    inline const auto& get_openxr_fov(int frame) {
-        return g_constants[frame % CONSTANTS_HISTORY_SIZE].openxr.fov;
+    inline std::optional<XrFovf> get_openxr_fov(int frame) {
+        return get_submitted(frame, OPENXR_FOV, [](const Constants& c) { return c.openxr.fov; });
     }
 
-    inline const auto& get_xr_constants(int frame) {
-        return g_constants[frame % CONSTANTS_HISTORY_SIZE].openxr;
+    inline std::optional<Constants::OpenXR> get_xr_constants(int frame) {
+        return get_submitted(frame, OPENXR_POSE | OPENXR_FOV, [](const Constants& c) { return c.openxr; });
     }
 
     inline void submit_openvr_pose(const vr::HmdMatrix34_t& pose, int frame) {
-        g_constants[frame % CONSTANTS_HISTORY_SIZE].openvr.pose = pose;
+        g_constants.update(frame, [&](Constants& constants) {
+            constants.openvr.pose = pose;
+            constants.submitted |= OPENVR_POSE;
+        });
+    }
+
+    inline std::optional<vr::HmdMatrix34_t> get_openvr_pose(int frame) {
+        return get_submitted(frame, OPENVR_POSE, [](const Constants& c) { return c.openvr.pose; });
     }
 
-    inline const auto& get_openvr_pose(int frame) {
-        return g_constants[frame % CONSTANTS_HISTORY_SIZE].openvr.pose;
+    // Puts `pose` on the texture and returns the Submit flags for it. Without a pose (the frame left the
+    // history before it was presented) the texture goes out without one and the compositor uses its own.
+    inline vr::EVRSubmitFlags attach_openvr_pose(vr::VRTextureWithPose_t& texture, const std::optional<vr::HmdMatrix34_t>& pose) {
+        if (!pose) {
+            return vr::Submit_Default;
+        }
+
+        texture.mDeviceToAbsoluteTracking = *pose;
+        return vr::Submit_TextureWithPose;
     }
 
 //    XrPosef calculate_xr_pose_compensation(int reference_frame, int current_frame);
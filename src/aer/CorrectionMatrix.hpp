@@ -0,0 +1,56 @@
+#pragma once
+
+#include <DirectXMath.h>
+
+namespace aer {
+// Matrix math of the motion vector correction, on DirectXMath's SIMD kernels.
+// Matrices are in sl's row vector convention, which is also glm's column memory layout, so a glm::mat4
+// can be used as an XMFLOAT4X4 as is.
+namespace correction {
+// Same camera to world matrix as sl's rebuildOrthogonalLHRotationMatrix built from a final view: right,
+// up = fwd x right, fwd and position. Rotation only, the position is returned separately so the
+// translation can be made relative.
+inline DirectX::XMMATRIX camera_rotation(const DirectX::XMFLOAT4X4& view, DirectX::XMVECTOR& position) {
+    using namespace DirectX;
+
+    const auto right = XMVector3Normalize(XMVectorSet(view.m[0][0], view.m[0][1], view.m[0][2], 0.0f));
+    const auto fwd = XMVector3Normalize(XMVectorSet(view.m[2][0], view.m[2][1], view.m[2][2], 0.0f));
+    const auto up = XMVector3Normalize(XMVector3Cross(fwd, right));
+
+    position = XMVectorSet(view.m[3][0], view.m[3][1], view.m[3][2], 1.0f);
+    return XMMATRIX{right, up, fwd, g_XMIdentityR3};
+}
+
+// What calcCameraToPrevCamera does, relative to the current camera position so large world coordinates
+// don't eat the precision. The previous camera is orthonormal, so its inverse is the transposed rotation
+// and the translation rotated back instead of a full 4x4 inverse.
+inline DirectX::XMMATRIX camera_to_prev_camera(const DirectX::XMFLOAT4X4& view, const DirectX::XMFLOAT4X4& view_prev) {
+    using namespace DirectX;
+
+    XMVECTOR position{};
+    XMVECTOR position_prev{};
+    const auto rotation = camera_rotation(view, position);
+    const auto rotation_prev = camera_rotation(view_prev, position_prev);
+
+    auto world_to_prev_camera = XMMatrixTranspose(rotation_prev);
+    const auto relative_prev = XMVectorSubtract(position_prev, position);
+    world_to_prev_camera.r[3] = XMVectorSelect(g_XMIdentityR3, XMVectorNegate(XMVector3TransformNormal(relative_prev, world_to_prev_camera)), g_XMSelect1110);
+
+    return XMMatrixMultiply(rotation, world_to_prev_camera);
+}
+
+// Clip space of the current frame to clip space of the previous one. The projection isn't orthonormal,
+// it gets the general inverse.
+inline DirectX::XMFLOAT4X4 clip_to_prev_clip(const DirectX::XMFLOAT4X4& projection, const DirectX::XMFLOAT4X4& view,
+                                             const DirectX::XMFLOAT4X4& projection_prev, const DirectX::XMFLOAT4X4& view_prev) {
+    using namespace DirectX;
+
+    const auto clip_to_camera = XMMatrixInverse(nullptr, XMLoadFloat4x4(&projection));
+    const auto camera_to_prev = camera_to_prev_camera(view, view_prev);
+
+    XMFLOAT4X4 out;
+    XMStoreFloat4x4(&out, XMMatrixMultiply(XMMatrixMultiply(clip_to_camera, camera_to_prev), XMLoadFloat4x4(&projection_prev)));
+    return out;
+}
+} // namespace correction
+} // namespace aer
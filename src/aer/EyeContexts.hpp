@@ -0,0 +1,237 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace aer {
+// Where the camera was for a frame, enough to spot teleports and recenters.
+struct EyePose {
+    float position[3]{};
+    float forward[3]{0.0f, 0.0f, 1.0f};
+};
+
+// One temporal upscaler history per eye under alternate eye rendering.
+// The game owns a single context (DLSS viewport, FSR context) and dispatches it every frame. Frames of one
+// parity stay on it (NATIVE), the others get redirected to a context we own (EXTRA), so each history only
+// ever accumulates frames of its own eye.
+// Every dispatch goes through begin(), which says whether that eye's history has to be thrown away:
+// its context is new, the game asked for a reset (applied to the other eye as well, on its next frame),
+// the camera jumped since that eye's last frame, or the eye wasn't dispatched for a while.
+// Backends can set constants more than once per frame, further begin() calls for the same frame
+// repeat the first decision instead of comparing the frame against itself.
+// Doesn't know about Streamline or FidelityFX, Context is whatever identifies a context for the backend.
+template <typename Context>
+class EyeContexts {
+public:
+    enum Eye : uint32_t {
+        NATIVE,
+        EXTRA,
+        EYE_COUNT
+    };
+
+    enum ResetReason : uint32_t {
+        RESET_NONE = 0,
+        RESET_NEW_CONTEXT = 1 << 0,
+        RESET_REQUESTED = 1 << 1,   // by the game, for this frame
+        RESET_OTHER_EYE = 1 << 2,   // the game asked for a reset on the other eye's frame
+        RESET_TRANSLATION = 1 << 3,
+        RESET_ROTATION = 1 << 4,
+        RESET_FRAME_GAP = 1 << 5,
+    };
+
+    struct Thresholds {
+        float max_translation{0.0f};    // world units between two frames of the same eye, game specific so 0 = off
+        float max_rotation_deg{45.0f};  // 0 = off
+        uint32_t max_frame_gap{8};      // frames since the eye was last dispatched
+    };
+
+    struct EyeState {
+        bool has_frame{false};
+        uint64_t last_frame{};
+        EyePose last_pose{};
+        bool has_pose{false};
+        float jitter[2]{};
+        uint32_t pending_reset{RESET_NONE};
+        uint32_t frame_reset{RESET_NONE}; // what the eye's last frame was dispatched with
+        uint32_t last_reset_reason{RESET_NONE};
+        uint64_t dispatches{};
+        uint64_t resets{};
+    };
+
+    struct Dispatch {
+        Eye eye{NATIVE};
+        uint32_t reset{RESET_NONE}; // ResetReason bits, none = keep the history
+
+        bool should_reset() const {
+            return reset != RESET_NONE;
+        }
+    };
+
+    // `native_parity` is the frame parity that stays on the game's own context.
+    explicit EyeContexts(uint32_t native_parity, Thresholds thresholds = {})
+        : m_native_parity{native_parity % 2},
+          m_thresholds{thresholds}
+    {
+    }
+
+    Eye eye_for_frame(uint64_t frame) const {
+        return frame % 2 == m_native_parity ? NATIVE : EXTRA;
+    }
+
+    void set_extra(Context context) {
+        m_extra = context;
+        m_eyes[EXTRA].pending_reset |= RESET_NEW_CONTEXT;
+    }
+
+    void clear_extra() {
+        m_extra.reset();
+        m_eyes[EXTRA] = EyeState{};
+    }
+
+    Context* get_extra() {
+        return m_extra ? &*m_extra : nullptr;
+    }
+
+    // Both histories start over on their next dispatch, e.g. after the backend reallocated its resources.
+    void invalidate() {
+        for (auto& eye : m_eyes) {
+            eye.pending_reset |= RESET_NEW_CONTEXT;
+            eye.has_frame = false;
+        }
+    }
+
+    // Without a pose for the frame the camera checks are skipped and the eye keeps its last known pose.
+    Dispatch begin(uint64_t frame, const std::optional<EyePose>& pose, bool reset_requested, float jitter_x = 0.0f, float jitter_y = 0.0f) {
+        Dispatch out{};
+        out.eye = eye_for_frame(frame);
+
+        auto& state = m_eyes[out.eye];
+        auto& other = m_eyes[out.eye == NATIVE ? EXTRA : NATIVE];
+
+        if (state.has_frame && state.last_frame == frame) {
+            if (reset_requested && (state.frame_reset & RESET_REQUESTED) == 0) {
+                other.pending_reset |= RESET_OTHER_EYE;
+                count_reset(state, state.frame_reset | RESET_REQUESTED);
+            }
+
+            out.reset = state.frame_reset;
+            return out;
+        }
+
+        out.reset = state.pending_reset;
+
+        if (reset_requested) {
+            out.reset |= RESET_REQUESTED;
+            other.pending_reset |= RESET_OTHER_EYE;
+        }
+
+        if (state.has_frame) {
+            if (frame - state.last_frame > m_thresholds.max_frame_gap) {
+                out.reset |= RESET_FRAME_GAP;
+            }
+
+            if (pose && state.has_pose) {
+                out.reset |= discontinuity(state.last_pose, *pose);
+            }
+        }
+
+        state.frame_reset = RESET_NONE;
+        count_reset(state, out.reset);
+
+        state.pending_reset = RESET_NONE;
+        state.has_frame = true;
+        state.last_frame = frame;
+
+        if (pose) {
+            state.last_pose = *pose;
+            state.has_pose = true;
+        }
+
+        state.jitter[0] = jitter_x;
+        state.jitter[1] = jitter_y;
+        ++state.dispatches;
+
+        return out;
+    }
+
+    const EyeState& state(Eye eye) const {
+        return m_eyes[eye];
+    }
+
+    Thresholds& thresholds() {
+        return m_thresholds;
+    }
+
+    uint32_t discontinuity(const EyePose& a, const EyePose& b) const {
+        uint32_t out = RESET_NONE;
+
+        float distance_sq = 0.0f;
+
+        for (int i = 0; i < 3; ++i) {
+            const auto d = b.position[i] - a.position[i];
+            distance_sq += d * d;
+        }
+
+        if (m_thresholds.max_translation > 0.0f && distance_sq > m_thresholds.max_translation * m_thresholds.max_translation) {
+            out |= RESET_TRANSLATION;
+        }
+
+        const auto len_a = std::sqrt(a.forward[0] * a.forward[0] + a.forward[1] * a.forward[1] + a.forward[2] * a.forward[2]);
+        const auto len_b = std::sqrt(b.forward[0] * b.forward[0] + b.forward[1] * b.forward[1] + b.forward[2] * b.forward[2]);
+
+        if (m_thresholds.max_rotation_deg > 0.0f && len_a > 0.0f && len_b > 0.0f) {
+            const auto cos_angle = (a.forward[0] * b.forward[0] + a.forward[1] * b.forward[1] + a.forward[2] * b.forward[2]) / (len_a * len_b);
+
+            if (cos_angle < std::cos(m_thresholds.max_rotation_deg * 0.017453292f)) {
+                out |= RESET_ROTATION;
+            }
+        }
+
+        return out;
+    }
+
+private:
+    static void count_reset(EyeState& state, uint32_t reset) {
+        if (reset != RESET_NONE && state.frame_reset == RESET_NONE) {
+            ++state.resets;
+        }
+
+        if (reset != RESET_NONE) {
+            state.last_reset_reason = reset;
+        }
+
+        state.frame_reset = reset;
+    }
+
+    uint32_t m_native_parity{0};
+    Thresholds m_thresholds{};
+    std::optional<Context> m_extra{};
+    std::array<EyeState, EYE_COUNT> m_eyes{};
+};
+
+// Copy of a backend's input pointer array with some entries swapped, e.g. the viewport handle of the
+// other eye. The storage is kept, so redirecting a dispatch doesn't allocate once it has seen the largest one.
+template <typename T>
+class InputRemap {
+public:
+    // `replace(input)` returns what to put in its place, or nullptr to keep it.
+    template <typename Replace>
+    T** remap(T** inputs, uint32_t count, Replace&& replace) {
+        m_inputs.assign(inputs, inputs + count);
+
+        for (auto& input : m_inputs) {
+            if (auto replacement = replace(input); replacement != nullptr) {
+                input = replacement;
+            }
+        }
+
+        return m_inputs.data();
+    }
+
+private:
+    std::vector<T*> m_inputs{};
+};
+} // namespace aer
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace aer {
+// Remembers which resources a per-frame pass already ran on, so a pass that modifies its input in place
+// (motion vector correction) runs once per resource and frame, however many times the game evaluates
+// the upscaler (DLSS and DLSS-RR, several evaluates, ...).
+// Only the current frame is kept, a new frame number drops everything recorded for older ones.
+class FramePassLedger {
+public:
+    static constexpr size_t MAX_ENTRIES = 16;
+
+    struct Key {
+        uintptr_t resource{};
+        uint32_t subresource{};
+
+        bool operator==(const Key& other) const = default;
+    };
+
+    struct Stats {
+        uint64_t processed{};
+        uint64_t skipped{};
+        uint64_t overflowed{}; // more distinct resources in one frame than MAX_ENTRIES, processed untracked
+    };
+
+    // True if the pass has to run for `key` on `frame`, which also records it as done.
+    bool claim(const Key& key, uint64_t frame) {
+        if (frame != m_frame || m_count == 0) {
+            m_frame = frame;
+            m_count = 0;
+        }
+
+        const auto end = m_entries.begin() + m_count;
+
+        if (std::find(m_entries.begin(), end, key) != end) {
+            ++m_stats.skipped;
+            return false;
+        }
+
+        if (m_count < m_entries.size()) {
+            m_entries[m_count++] = key;
+        } else {
+            ++m_stats.overflowed;
+        }
+
+        ++m_stats.processed;
+        return true;
+    }
+
+    // Takes back a claim of `frame` whose pass couldn't run after all (e.g. no views for the resource),
+    // so the next call on that frame tries again.
+    void release(const Key& key, uint64_t frame) {
+        if (frame != m_frame) {
+            return;
+        }
+
+        const auto end = m_entries.begin() + m_count;
+
+        if (const auto it = std::find(m_entries.begin(), end, key); it != end) {
+            std::copy(it + 1, end, it);
+            --m_count;
+            --m_stats.processed;
+        }
+    }
+
+    bool was_processed(const Key& key, uint64_t frame) const {
+        const auto end = m_entries.begin() + m_count;
+        return frame == m_frame && std::find(m_entries.begin(), end, key) != end;
+    }
+
+    // e.g. the resources went away with the device
+    void clear() {
+        m_count = 0;
+    }
+
+    const Stats& get_stats() const {
+        return m_stats;
+    }
+
+private:
+    std::array<Key, MAX_ENTRIES> m_entries{};
+    size_t m_count{0};
+    uint64_t m_frame{};
+    Stats m_stats{};
+};
+} // namespace aer
@@ -52,8 +52,8 @@
 //
 //    std::optional<std::string> on_initialize() override;
 //    void on_draw_ui() override;
-//    void on_config_load(const utility::Config& cfg, bool set_defaults) override;
-//    void on_config_save(utility::Config& cfg) override;
+//    void on_config_load(const utility::ConfigStore& cfg, bool set_defaults) override;
+//    void on_config_save(utility::ConfigStore& cfg) override;
 //    void on_device_reset() override;
 //
 //    UpscalerFsr2Module() = default;
@@ -1,5 +1,7 @@
 #include "UpscalerFsr31Module.h"
 
+#include <ModuleWatcher.hpp>
+#include <aer/ConstantsPool.h>
 #include <experimental/DebugUtils.h>
 #include <imgui.h>
 #ifdef _DEBUG
@@ -18,24 +20,22 @@ UpscalerFsr31Module::~UpscalerFsr31Module() {
 
 std::optional<std::string> UpscalerFsr31Module::on_initialize() {
     spdlog::info("[FSR3.1] Initializing AMD FSR 3.1 Upscaler AFR Module");
-    if (!install_hooks()) {
-        spdlog::warn("[FSR3.1] Failed to install hooks, module disabled");
-        return std::nullopt;
-    }
-    spdlog::info("[FSR3.1] Module initialized successfully");
+
+    // Not an error if it never loads - the game may load FSR3 later or not at all
+    ModuleWatcher::get().on_load(FSR31_DLL_NAME, [this](HMODULE module) {
+        if (!install_hooks(module)) {
+            spdlog::warn("[FSR3.1] Failed to install hooks, module disabled");
+            return;
+        }
+
+        spdlog::info("[FSR3.1] Module initialized successfully");
+    });
+
     return std::nullopt;
 }
 
-bool UpscalerFsr31Module::install_hooks() {
-    // Try to find the FSR3.1 DLL
-    auto m_fsr3_module = GetModuleHandleA(FSR31_DLL_NAME);
-    if (m_fsr3_module != nullptr) {
-        spdlog::info("[FSR3.1] Found FSR3.1 DLL: {}", FSR31_DLL_NAME);
-    } else {
-        spdlog::info("[FSR3.1] FSR3.1 DLL ({}) not loaded yet, will attempt hook installation later", FSR31_DLL_NAME);
-        // Not an error - game may load FSR3 later or not at all
-        return false;
-    }
+bool UpscalerFsr31Module::install_hooks(HMODULE m_fsr3_module) {
+    spdlog::info("[FSR3.1] Found FSR3.1 DLL: {}", FSR31_DLL_NAME);
 
 //    typedef ffxReturnCode_t(*PFN_ffxCreateContext)(ffxContext* context, const ffxCreateContextDescHeader* desc, const ffxAllocationCallbacks* allocators);
 //    typedef ffxReturnCode_t(*PFN_ffxDispatch)(ffxContext* context, const ffxDispatchDescHeader* desc);
@@ -88,7 +88,7 @@ void UpscalerFsr31Module::remove_hooks() {
     m_create_hook.reset();
     m_dispatch_hook.reset();
     m_destroy_hook.reset();
-    m_context_right = {nullptr};
+    m_eyes.clear_extra();
     m_primary_context_ptr = nullptr;
 }
 
@@ -107,13 +107,16 @@ ffxReturnCode_t UpscalerFsr31Module::on_ffxCreateContext(ffxContext* context, co
         // Create right eye context
         // We reuse the same description and allocators
         // The backend creation is handled internally by FSR 3.1 using the description
-        auto result_right = instance->m_create_hook.call<ffxReturnCode_t>(&instance->m_context_right, desc, allocators);
+        ffxContext context_right{nullptr};
+        auto result_right = instance->m_create_hook.call<ffxReturnCode_t>(&context_right, desc, allocators);
         
         if (result_right != FFX_API_RETURN_OK) {
             spdlog::error("[FSR3.1] Failed to create right eye context: {}", result_right);
-            instance->m_context_right = {nullptr};
+            instance->m_eyes.clear_extra();
         } else {
             spdlog::info("[FSR3.1] Successfully created right eye context for AER");
+            instance->m_eyes.set_extra(context_right);
+            instance->m_eyes.invalidate();
         }
     }
     
@@ -126,20 +129,22 @@ ffxReturnCode_t UpscalerFsr31Module::on_ffxDispatch(ffxContext* context, const f
     static auto vr = VR::get();
     // Check if this is the primary upscaling context and if we should intervene
     if (instance->m_enabled->value() && 
-        instance->m_context_right != nullptr &&
+        instance->m_eyes.get_extra() != nullptr &&
         *context == instance->m_primary_context_ptr &&
         desc && desc->type == FFX_API_DISPATCH_DESC_TYPE_UPSCALE /*&& vr->is_hmd_active()*/) {
 
         instance->ReprojectMotionVectors((ffxDispatchDescUpscale*)desc);
 
-        ffxContext* target_context;
-        if (vr->m_render_frame_count % 2 == 0) {
-            target_context = context;
-        } else {
-            target_context = &instance->m_context_right;
-        }
-        
-        return instance->m_dispatch_hook.call<ffxReturnCode_t>(target_context, desc);
+        // Copy, the reset flag may differ from what the game asked for on this frame
+        auto upscale_desc = *(const ffxDispatchDescUpscale*)desc;
+        instance->m_eyes.thresholds().max_translation = instance->m_history_reset_distance->value();
+        const auto dispatch = instance->m_eyes.begin(vr->m_render_frame_count, GlobalPool::get_eye_pose(vr->m_render_frame_count), upscale_desc.reset,
+            upscale_desc.jitterOffset.x, upscale_desc.jitterOffset.y);
+
+        upscale_desc.reset = dispatch.should_reset();
+
+        ffxContext* target_context = dispatch.eye == EyeContexts::EXTRA ? instance->m_eyes.get_extra() : context;
+        return instance->m_dispatch_hook.call<ffxReturnCode_t>(target_context, &upscale_desc.header);
     }
 
     return instance->m_dispatch_hook.call<ffxReturnCode_t>(context, desc);
@@ -171,7 +176,7 @@ void UpscalerFsr31Module::ReprojectMotionVectors(ffxDispatchDescUpscale* upscale
         static auto shader_debug_overlay = ShaderDebugOverlay::Get();
         if(DebugUtils::config.debugShaders && ShaderDebugOverlay::ValidateResource(mv_native_resource, shader_debug_overlay->m_motion_vector_buffer)) {
             ShaderDebugOverlay::SetMvecScale(upscalerDesc->motionVectorScale.x / (float)mvTag.description.width , upscalerDesc->motionVectorScale.y / (float)mvTag.description.height);
-            ShaderDebugOverlay::CopyResource(command_list, mv_native_resource, shader_debug_overlay->m_motion_vector_buffer[vr->m_render_frame_count % 4].Get(), mv_state, D3D12_RESOURCE_STATE_GENERIC_READ);
+            ShaderDebugOverlay::CopyResource(command_list, mv_native_resource, shader_debug_overlay->m_motion_vector_buffer.retag(vr->m_render_frame_count).Get(), mv_state, D3D12_RESOURCE_STATE_GENERIC_READ);
         }
 #endif
     }
@@ -182,12 +187,12 @@ ffxReturnCode_t UpscalerFsr31Module::on_ffxDestroyContext(ffxContext* context, c
     
     if (*context == instance->m_primary_context_ptr) {
         spdlog::info("[FSR3.1] Destroying primary context, also destroying right eye context");
-        if (instance->m_context_right != nullptr) {
-            auto result_right = instance->m_destroy_hook.call<ffxReturnCode_t>(&instance->m_context_right, allocators);
+        if (auto context_right = instance->m_eyes.get_extra(); context_right != nullptr) {
+            auto result_right = instance->m_destroy_hook.call<ffxReturnCode_t>(context_right, allocators);
             if (result_right != FFX_API_RETURN_OK) {
                 spdlog::warn("[FSR3.1] Failed to destroy right eye context: {}", result_right);
             }
-            instance->m_context_right = {nullptr};
+            instance->m_eyes.clear_extra();
         }
         instance->m_primary_context_ptr = nullptr;
     }
@@ -212,6 +217,17 @@ void UpscalerFsr31Module::on_draw_ui() {
 
 
     m_motion_vector_fix->draw("Motion Vector Reprojection Fix");
+
+    const auto& pass_stats = m_motion_vector_reprojection.get_pass_stats();
+    ImGui::Text("Motion vector passes: %llu run, %llu skipped", (unsigned long long)pass_stats.processed, (unsigned long long)pass_stats.skipped);
+    const auto& view_stats = m_motion_vector_reprojection.get_view_stats();
+    ImGui::Text("Motion vector views: %llu hits, %llu created", (unsigned long long)view_stats.hits, (unsigned long long)view_stats.misses);
+    const auto correction_stats = GlobalPool::get_correction_stats();
+    ImGui::Text("Correction matrices: %llu reused, %llu computed, %llu uncorrected", (unsigned long long)correction_stats.hits, (unsigned long long)correction_stats.misses,
+        (unsigned long long)correction_stats.unavailable);
+    m_history_reset_distance->draw("History Reset Distance (0 = off)");
+    ImGui::Text("History resets: left %llu, right %llu",
+        (unsigned long long)m_eyes.state(EyeContexts::NATIVE).resets, (unsigned long long)m_eyes.state(EyeContexts::EXTRA).resets);
 //    m_auto_detect->draw("Auto-detect FSR 3.1");
 //    ImGui::SameLine();
 //    ImGui::TextDisabled("(?)");
@@ -221,18 +237,22 @@ void UpscalerFsr31Module::on_draw_ui() {
     ImGui::TreePop();
 }
 
-void UpscalerFsr31Module::on_config_load(const utility::Config& cfg, bool set_defaults) {
+void UpscalerFsr31Module::on_config_load(const utility::ConfigStore& cfg, bool set_defaults) {
     for (auto& opt : m_options) {
         opt.get().config_load(cfg, set_defaults);
     }
 }
 
-void UpscalerFsr31Module::on_config_save(utility::Config& cfg) {
+void UpscalerFsr31Module::on_config_save(utility::ConfigStore& cfg) {
     for (auto& opt : m_options) {
         opt.get().config_save(cfg);
     }
 }
 
+uint32_t UpscalerFsr31Module::on_config_reload(const utility::ConfigStore& cfg) {
+    return apply_config_changes(m_options, cfg);
+}
+
 void UpscalerFsr31Module::on_d3d12_initialize(ID3D12Device4* pDevice4, D3D12_RESOURCE_DESC& desc)
 {
     m_motion_vector_reprojection.on_d3d12_initialize(pDevice4, desc);
@@ -240,7 +260,7 @@ void UpscalerFsr31Module::on_d3d12_initialize(ID3D12Device4* pDevice4, D3D12_RES
 
 void UpscalerFsr31Module::on_device_reset() {
     spdlog::info("[FSR3.1] Device reset - cleaning up contexts");
-    m_context_right = {nullptr};
+    m_eyes.clear_extra();
     m_primary_context_ptr = {nullptr};
     m_motion_vector_reprojection.on_device_reset();
 }
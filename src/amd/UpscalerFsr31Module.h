@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Mod.hpp>
+#include <aer/EyeContexts.hpp>
 #include <memory/FunctionHook.h>
 #include <mods/VR.hpp>
 #include <ffx_api/ffx_api.h>
@@ -33,8 +34,9 @@ public:
     
     std::optional<std::string> on_initialize() override;
     void on_draw_ui() override;
-    void on_config_load(const utility::Config& cfg, bool set_defaults) override;
-    void on_config_save(utility::Config& cfg) override;
+    void on_config_load(const utility::ConfigStore& cfg, bool set_defaults) override;
+    void on_config_save(utility::ConfigStore& cfg) override;
+    uint32_t on_config_reload(const utility::ConfigStore& cfg) override;
     void on_device_reset() override;
     void on_d3d12_initialize(ID3D12Device4* pDevice4, D3D12_RESOURCE_DESC& desc) override;
 
@@ -42,15 +44,17 @@ public:
     ~UpscalerFsr31Module() override;
 
 private:
-    bool install_hooks();
+    bool install_hooks(HMODULE m_fsr3_module);
     void remove_hooks();
 
     static ffxReturnCode_t on_ffxCreateContext(ffxContext* context, const struct ffxApiHeader* desc, const struct ffxAllocationCallbacks* allocators);
     static ffxReturnCode_t on_ffxDispatch(ffxContext* context, const struct ffxApiHeader* desc);
     static ffxReturnCode_t on_ffxDestroyContext(ffxContext* context, const ffxAllocationCallbacks* allocators);
 
-    ffxContext m_context_right{nullptr};
-    
+    // Even frames stay on the game's context, odd ones go to the right eye context we create next to it
+    using EyeContexts = aer::EyeContexts<ffxContext>;
+    EyeContexts m_eyes{0};
+
     ffxContext m_primary_context_ptr{nullptr};
 
     MotionVectorReprojection m_motion_vector_reprojection{};
@@ -62,10 +66,13 @@ private:
 
     const ModToggle::Ptr m_enabled{ ModToggle::create(generate_name("Enabled"), true) };
     const ModToggle::Ptr m_motion_vector_fix{ ModToggle::create(generate_name("MotionVectorFix"), true) };
+    // Camera movement between two frames of one eye that throws its history away, in game units. Off by default, scales differ per game.
+    const ModSlider::Ptr m_history_reset_distance{ ModSlider::create(generate_name("HistoryResetDistance"), 0.0f, 1000.0f, 0.0f) };
 
     ValueList m_options{
         *m_enabled,
-        *m_motion_vector_fix
+        *m_motion_vector_fix,
+        *m_history_reset_distance
     };
     void      ReprojectMotionVectors(struct ffxDispatchDescUpscale* upscalerDesc);
 };
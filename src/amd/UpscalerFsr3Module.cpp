@@ -218,13 +218,13 @@
 //    ImGui::TreePop();
 //}
 //
-//void UpscalerFsr3Module::on_config_load(const utility::Config& cfg, bool set_defaults) {
+//void UpscalerFsr3Module::on_config_load(const utility::ConfigStore& cfg, bool set_defaults) {
 //    for (auto& opt : m_options) {
 //        opt.get().config_load(cfg, set_defaults);
 //    }
 //}
 //
-//void UpscalerFsr3Module::on_config_save(utility::Config& cfg) {
+//void UpscalerFsr3Module::on_config_save(utility::ConfigStore& cfg) {
 //    for (auto& opt : m_options) {
 //        opt.get().config_save(cfg);
 //    }
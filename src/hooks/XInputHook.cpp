@@ -6,95 +6,59 @@
 #include <SafetyHook.hpp>
 
 #include "Framework.hpp"
+#include "ModuleWatcher.hpp"
 #include "Mods.hpp"
 #include "XInputHook.hpp"
 
 XInputHook* g_hook{ nullptr };
 
-XInputHook::XInputHook()
-{
-    g_hook = this;
-    spdlog::info("[XInputHook] Entry");
-
-    static auto find_dll = [](const std::string& name) -> HMODULE {
-        const auto start_time = std::chrono::system_clock::now();
-        auto       found_dll  = GetModuleHandleA(name.c_str());
-
-        while (found_dll == nullptr) {
-            if (found_dll = GetModuleHandleA(name.c_str()); found_dll != nullptr) {
-                // Load it from the system directory instead, it might be hooked
-                /*wchar_t system_dir[MAX_PATH]{};
-                if (GetSystemDirectoryW(system_dir, MAX_PATH) != 0) {
-                    const auto new_dir =
-                 * (std::wstring{system_dir} + L"\\" + utility::widen(name));
-
-                    spdlog::info("[XInputHook] Loading {} from {}", name, utility::narrow(new_dir));
-
-                 * const auto new_dll = LoadLibraryW(new_dir.c_str());
-
-                    if (new_dll != nullptr) {
-                        found_dll =
-                 * LoadLibraryW(new_dir.c_str());
-                    }
-                }*/
-
-                break;
-            }
-
-            const auto elapsed_time = std::chrono::system_clock::now() - start_time;
-
-            if (elapsed_time > std::chrono::seconds(10)) {
-                spdlog::error("[XInputHook] Failed to find {} after 10 seconds", name);
-                return nullptr;
-            }
-
-            std::this_thread::yield();
-        }
-
-        return found_dll;
-    };
+static uintptr_t recursive_resolve_jmp(uint8_t* instr) {
+    try {
+        const auto decoded = utility::decode_one(instr);
 
-    std::function<uintptr_t(uint8_t*)> recursive_resolve_jmp;
+        if (decoded) {
+            const auto mnem = std::string_view{ decoded->Mnemonic };
 
-    recursive_resolve_jmp = [&](uint8_t* instr) -> uintptr_t {
-        try {
-            const auto decoded = utility::decode_one(instr);
+            if (mnem.starts_with("JMP")) {
+                const auto target = utility::resolve_displacement((uintptr_t)instr);
 
-            if (decoded) {
-                const auto mnem = std::string_view{ decoded->Mnemonic };
+                if (target.has_value()) {
+                    if (instr[0] == 0xFF && instr[1] == 0x25) {
+                        const auto real_target = *(uintptr_t*)*target;
 
-                if (mnem.starts_with("JMP")) {
-                    const auto target = utility::resolve_displacement((uintptr_t)instr);
-
-                    if (target.has_value()) {
-                        if (instr[0] == 0xFF && instr[1] == 0x25) {
-                            const auto real_target = *(uintptr_t*)*target;
-
-                            if (real_target == 0) {
-                                return (uintptr_t)instr;
-                            }
-
-                            return recursive_resolve_jmp((uint8_t*)real_target);
+                        if (real_target == 0) {
+                            return (uintptr_t)instr;
                         }
 
-                        return recursive_resolve_jmp((uint8_t*)target.value());
+                        return recursive_resolve_jmp((uint8_t*)real_target);
                     }
+
+                    return recursive_resolve_jmp((uint8_t*)target.value());
                 }
             }
         }
-        catch (...) {
-            SPDLOG_ERROR("[XInputHook] recursive_resolve_jmp exception");
-        }
+    }
+    catch (...) {
+        SPDLOG_ERROR("[XInputHook] recursive_resolve_jmp exception");
+    }
 
-        return (uintptr_t)instr;
-    };
+    return (uintptr_t)instr;
+}
 
-    auto perform_hooks_1_4 = [&]() {
-        const auto xinput_1_4_dll = find_dll("xinput1_4.dll");
+XInputHook::XInputHook()
+{
+    g_hook = this;
+    spdlog::info("[XInputHook] Entry");
 
+    auto perform_hooks_1_4 = [this](HMODULE xinput_1_4_dll) {
         if (xinput_1_4_dll != nullptr) {
             std::scoped_lock _{ g_framework->get_hook_monitor_mutex() };
 
+            // The watcher may fire after this XInputHook was replaced by a new one (g_hook always points at the newest)
+            if (g_hook != this || m_xinput_1_4_get_state_hook) {
+                return;
+            }
+
             const auto get_state_fn        = (void*)GetProcAddress(xinput_1_4_dll, "XInputGetState");
             const auto set_state_fn        = (void*)GetProcAddress(xinput_1_4_dll, "XInputSetState");
             const auto get_capabilities_fn = (void*)GetProcAddress(xinput_1_4_dll, "XInputGetCapabilities");
@@ -175,12 +139,15 @@ XInputHook::XInputHook()
         spdlog::info("[XInputHook] Done (1_4)");
     };
 
-    auto perform_hooks_1_3 = [&]() {
-        const auto xinput_1_3_dll = find_dll("xinput1_3.dll");
-
+    auto perform_hooks_1_3 = [this](HMODULE xinput_1_3_dll) {
         if (xinput_1_3_dll != nullptr) {
             std::scoped_lock _{ g_framework->get_hook_monitor_mutex() };
 
+            // The watcher may fire after this XInputHook was replaced by a new one (g_hook always points at the newest)
+            if (g_hook != this || m_xinput_1_3_get_state_hook) {
+                return;
+            }
+
             const auto get_state_fn        = (void*)GetProcAddress(xinput_1_3_dll, "XInputGetState");
             const auto set_state_fn        = (void*)GetProcAddress(xinput_1_3_dll, "XInputSetState");
             const auto get_capabilities_fn = (void*)GetProcAddress(xinput_1_3_dll, "XInputGetCapabilities");
@@ -261,12 +228,9 @@ XInputHook::XInputHook()
         spdlog::info("[XInputHook] Done (1_3)");
     };
 
-    // We use a thread because this may possibly take a while to search for the DLLs
-    // and it shouldn't cause any issues anyway
-    spdlog::info("[XInputHook] Starting hook thread");
-    m_hook_thread_1_4 = std::make_unique<std::jthread>(perform_hooks_1_4);
-    m_hook_thread_1_3 = std::make_unique<std::jthread>(perform_hooks_1_3);
-    spdlog::info("[XInputHook] Hook thread started");
+    // The game may load either DLL late (or never), the watcher hooks them whenever they show up
+    ModuleWatcher::get().on_load("xinput1_4.dll", perform_hooks_1_4);
+    ModuleWatcher::get().on_load("xinput1_3.dll", perform_hooks_1_3);
 }
 
 uint32_t XInputHook::get_capabilities_1_3(uint32_t dwUserIndex, uint32_t dwFlags, XINPUT_CAPABILITIES* pCapabilities)
@@ -1,4 +1,10 @@
+#include <chrono>
+#include <mutex>
+
+#include <Framework.hpp>
+#include <memory/memory_mul.h>
 #include <utility/Module.hpp>
+#include <utility/PatternProfile.hpp>
 #include <utility/RTTI.hpp>
 #include <utility/Scan.hpp>
 
@@ -7,90 +13,252 @@ namespace memory {
     size_t mod_size = utility::get_module_size(g_mod).value_or(0);
     size_t mod_end  = (uintptr_t)g_mod + mod_size - 0x100;
 
-    uintptr_t VTable(const char* hook_name, const char* table, uintptr_t static_offset)
-    {
-        uintptr_t val = 0;
-#if defined _DEBUG || defined SIGNATURE_SCAN
-        auto ref = utility::rtti::find_vtable(g_mod, table);
-        if (!ref) {
-            spdlog::error("VTable pattern not found for id={}", hook_name );
-            return 0;
+    namespace {
+        // Enough of a function to tell it apart after a game update. Inline hooks overwrite the start with a
+        // jump, utility::validate_profile_entry then compares the bytes after it, so this has to reach well past one.
+        constexpr size_t FUNCTION_PROLOGUE_SIZE = 32;
+
+        // Offsets earlier scans resolved on this exact build of the game, see utility::PatternProfileDb
+        struct Profiles {
+            std::mutex mtx{};
+            utility::ImageView image{};
+            std::optional<utility::ImageIdentity> identity{};
+            utility::PatternProfileDb db{};
+            std::filesystem::path path{};
+            bool dirty{false}; // written by SaveProfiles, not per resolution
+
+            std::mutex save_mtx{}; // keeps snapshots in order, the disk I/O happens outside of mtx
+            uint64_t last_hash{0};
+        };
+
+        Profiles& get_profiles() {
+            static Profiles profiles{};
+            static std::once_flag once{};
+
+            std::call_once(once, [] {
+                profiles.image = utility::ImageView{(uintptr_t)g_mod, mod_size};
+                profiles.identity = utility::read_image_identity(profiles.image);
+                profiles.path = Framework::get_persistent_dir() / "pattern_profiles.txt";
+                profiles.db.load(profiles.path);
+                profiles.last_hash = utility::fnv1a_64(profiles.db.serialize());
+
+                if (profiles.identity) {
+                    spdlog::info("Pattern profile for build {}", profiles.identity->to_string());
+                } else {
+                    spdlog::warn("Failed to identify the game executable, pattern profiles disabled");
+                }
+            });
+
+            return profiles;
         }
-        val = ref.value();
-        if(static_offset > 0) {
-            auto offset = val - (uintptr_t)g_mod;
-            if(offset != static_offset) {
-                spdlog::info("FuncRelocation offset does not match static offset for id={} offset={:x} reference={:x}", hook_name, offset, static_offset);
+
+        utility::ProfileEntry describe(const utility::ImageView& image, uintptr_t address, size_t prologue_size) {
+            utility::ProfileEntry out{address - image.base};
+
+            if (const auto bytes = image.at(address, prologue_size)) {
+                out.prologue.assign(bytes, bytes + prologue_size);
             }
+
+            return out;
         }
+
+        // The profile stores the site a pattern finds (the function, the vtable, the instruction referring
+        // to the target), `scan` looks for it and describes it, `finish` turns it into the address handed out.
+        template <typename Scan, typename Finish>
+        uintptr_t resolve(const char* kind, const char* hook_name, uintptr_t static_offset, Scan&& scan, Finish&& finish) {
+            const auto start = std::chrono::high_resolution_clock::now();
+            auto& profiles = get_profiles();
+            std::scoped_lock _{profiles.mtx};
+
+            uintptr_t val = 0;
+            const char* source = "profile";
+            bool dirty = false;
+
+            if (profiles.identity) {
+                if (const auto entry = profiles.db.find(*profiles.identity, hook_name)) {
+                    const auto check = utility::validate_profile_entry(profiles.image, *entry);
+
+                    if (check == utility::ProfileCheck::Ok) {
+                        val = finish(profiles.image.base + entry->offset);
+                    } else {
+                        spdlog::warn("{} profile entry rejected for id={}: {}", kind, hook_name, utility::to_string(check));
+                        profiles.db.erase(*profiles.identity, hook_name);
+                        dirty = true;
+                    }
+                }
+            }
+
+#if defined _DEBUG || defined SIGNATURE_SCAN
+            if (val == 0) {
+                source = "pattern";
+
+                if (const auto entry = scan(profiles.image)) {
+                    val = finish(profiles.image.base + entry->offset);
+                    dirty |= profiles.identity && profiles.db.put(*profiles.identity, hook_name, *entry);
+                } else {
+                    spdlog::error("{} pattern not found for id={}", kind, hook_name);
+                }
+            }
 #else
-        spdlog::info("Using static offset for VTable id={}", hook_name);
-        val =  static_offset + (uintptr_t)mod;
+            if (val == 0) {
+                spdlog::info("Using static offset for {} id={}", kind, hook_name);
+                source = "static offset";
+                val = static_offset + (uintptr_t)g_mod;
+            }
 #endif
-        return val;
+
+            if (val != 0 && static_offset > 0) {
+                auto offset = val - (uintptr_t)g_mod;
+                if(offset != static_offset) {
+                    spdlog::info("{} offset does not match static offset for id={} offset={:x} reference={:x}", kind, hook_name, offset, static_offset);
+                }
+            }
+
+            profiles.dirty |= dirty;
+
+            const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+            spdlog::info("{} id={} resolved from {} in {:.1f}us", kind, hook_name, source, elapsed);
+
+            return val;
+        }
+    }
+
+    uintptr_t VTable(const char* hook_name, const char* table, uintptr_t static_offset)
+    {
+        return resolve("VTable", hook_name, static_offset,
+            [&](const utility::ImageView& image) -> std::optional<utility::ProfileEntry> {
+                auto ref = utility::rtti::find_vtable(g_mod, table);
+                if (!ref) {
+                    return std::nullopt;
+                }
+                // vtable contents are relocated pointers, the type it belongs to is what has to match
+                auto entry = describe(image, ref.value(), 0);
+                entry.rtti_name = utility::read_rtti_name(image, ref.value()).value_or("");
+                return entry;
+            },
+            [](uintptr_t site) { return site; });
     };
 
     uintptr_t FuncRelocation(const char* hook_name, const char* pattern, uintptr_t static_offset) {
 #ifndef SIGNATURE_SCAN
-        spdlog::warn("FuncRelocation called without SIGNATURE_SCAN enabled, using static offsets only. id={}", hook_name);
-#endif
-        uintptr_t val = 0;
-#if defined _DEBUG || defined SIGNATURE_SCAN
-        auto ref = utility::scan(g_mod, pattern);
-        if (!ref) {
-            spdlog::error("FuncRelocation pattern not found for id={}", hook_name );
-            return 0;
-        }
-        val = ref.value();
-        if(static_offset > 0) {
-            auto offset = val - (uintptr_t)g_mod;
-            if(offset != static_offset) {
-                spdlog::info("FuncRelocation offset does not match static offset for id={} offset={:x} reference={:x}", hook_name, offset, static_offset);
-            }
-        }
-#else
-        spdlog::info("Using static offset for VTable id={}", hook_name);
-        val =  static_offset + (uintptr_t)mod;
+        spdlog::warn("FuncRelocation called without SIGNATURE_SCAN enabled, using profiled or static offsets only. id={}", hook_name);
 #endif
-        return val;
+        return resolve("FuncRelocation", hook_name, static_offset,
+            [&](const utility::ImageView& image) -> std::optional<utility::ProfileEntry> {
+                auto ref = utility::scan(g_mod, pattern);
+                if (!ref) {
+                    return std::nullopt;
+                }
+                return describe(image, ref.value(), FUNCTION_PROLOGUE_SIZE);
+            },
+            [](uintptr_t site) { return site; });
     };
+
     uintptr_t InstructionRelocation(const char* hook_name, const char* pattern, UINT offset_begin, UINT instruction_size,  uintptr_t static_offset) {
-        uintptr_t val = 0;
-#if defined _DEBUG || defined SIGNATURE_SCAN
-        auto ref = utility::scan(g_mod, pattern);
-        if (!ref) {
-            spdlog::error("AsmCodeRelocation pattern not found for id={}", hook_name);
-            return 0;
-        }
-        auto addr = ref.value();
-        val = addr + *(int32_t*)(addr + offset_begin) + instruction_size;
-        if(static_offset > 0) {
-            auto offset = val - (uintptr_t)g_mod;
-            if(offset != static_offset) {
-                spdlog::info("AsmCodeRelocation offset does not match static offset for id={} offset={:x} reference={:x}", hook_name, offset, static_offset);
+        return resolve("AsmCodeRelocation", hook_name, static_offset,
+            [&](const utility::ImageView& image) -> std::optional<utility::ProfileEntry> {
+                auto ref = utility::scan(g_mod, pattern);
+                if (!ref) {
+                    return std::nullopt;
+                }
+                // the opcode bytes in front of the displacement
+                return describe(image, ref.value(), offset_begin);
+            },
+            [&](uintptr_t site) { return site + *(int32_t*)(site + offset_begin) + instruction_size; });
+    };
+
+    bool SaveProfiles() {
+        auto& profiles = get_profiles();
+        std::scoped_lock save_lock{profiles.save_mtx};
+        std::string text{};
+
+        {
+            std::scoped_lock _{profiles.mtx};
+
+            if (!profiles.dirty) {
+                return true;
             }
+
+            text = profiles.db.serialize();
+            profiles.dirty = false;
         }
-#else
-        spdlog::info("Using static offset for VTable id={}", hook_name);
-        val = static_offset + (uintptr_t)mod;
-#endif
-        return val;
-    };
+
+        if (utility::commit_file(text, profiles.path, profiles.last_hash) == utility::CommitResult::FAILED) {
+            spdlog::error("Failed to save pattern profiles to {}", profiles.path.string());
+
+            std::scoped_lock _{profiles.mtx};
+            profiles.dirty = true;
+            return false;
+        }
+
+        return true;
+    }
+
+    namespace {
+        class ProcessMemoryBackend : public utility::PatchMemoryBackend {
+        public:
+            size_t page_size() const override {
+                static const auto size = [] {
+                    SYSTEM_INFO info{};
+                    GetSystemInfo(&info);
+                    return (size_t)info.dwPageSize;
+                }();
+
+                return size;
+            }
+
+            std::optional<uint32_t> unprotect(uintptr_t page) override {
+                DWORD old_protect{};
+
+                if (!VirtualProtect((LPVOID)page, page_size(), PAGE_EXECUTE_READWRITE, &old_protect)) {
+                    spdlog::error("VirtualProtect failed for page {:x}: {}", page, GetLastError());
+                    return std::nullopt;
+                }
+
+                return old_protect;
+            }
+
+            bool protect(uintptr_t page, uint32_t protection) override {
+                DWORD old_protect{};
+                return VirtualProtect((LPVOID)page, page_size(), protection, &old_protect) != FALSE;
+            }
+
+            bool read(uintptr_t address, uint8_t* out, size_t size) override {
+                memcpy(out, (const void*)address, size);
+                return true;
+            }
+
+            bool write(uintptr_t address, const uint8_t* data, size_t size) override {
+                memcpy((void*)address, data, size);
+                return true;
+            }
+
+            void flush_instruction_cache(uintptr_t address, size_t size) override {
+                FlushInstructionCache(GetCurrentProcess(), (LPCVOID)address, size);
+            }
+        };
+    }
+
+    utility::PatchMemoryBackend& ProcessMemory() {
+        static ProcessMemoryBackend backend{};
+        return backend;
+    }
 
     bool PatchMemory(uintptr_t address, const unsigned char* patch, size_t patchSize) {
         if (patchSize == 0) {
             return false;
         }
 
-        DWORD oldProtect;
-        if (!VirtualProtect((LPVOID)address, patchSize, PAGE_EXECUTE_READWRITE, &oldProtect)) {
+        utility::PatchTransaction transaction{ProcessMemory()};
+        transaction.add(address, std::vector<uint8_t>{patch, patch + patchSize});
+
+        if (!transaction.commit()) {
+            spdlog::error("Failed to patch {} bytes at {:x}", patchSize, address);
             return false;
         }
 
-        memcpy((LPVOID)address, patch, patchSize);
-        DWORD tempProtect;
-        VirtualProtect((LPVOID)address, patchSize, oldProtect, &tempProtect);
-
+        const auto& stats = transaction.get_stats();
+        spdlog::debug("Patched {} bytes at {:x}, {} pages, {} protection changes", patchSize, address, stats.pages, stats.protection_changes);
         return true;
     }
 
@@ -65,6 +65,8 @@ and place the openxr_loader.dll in the same folder.)";
         m_has_hw_scheduling = *hw_schedule_value == 2;
     }
 
+    setup_runtime_recovery();
+
     m_init_finished = true;
 
     // all OK
@@ -341,65 +343,11 @@ std::optional<std::string> VR::initialize_openxr() {
         spdlog::info("[VR] Found existing openxr system");
     }
 
-    // Step 3: Create a session
-    spdlog::info("[VR] Initializing graphics info");
-
-    XrSessionCreateInfo session_create_info{XR_TYPE_SESSION_CREATE_INFO};
-
-    if (g_framework->is_dx12()) {
-        m_d3d12.openxr().initialize(session_create_info);
-    } else {
-        m_d3d11.openxr().initialize(session_create_info);
-    }
-
-    spdlog::info("[VR] Creating OpenXR session");
-    session_create_info.systemId = m_openxr->system;
-    result = xrCreateSession(m_openxr->instance, &session_create_info, &m_openxr->session);
-
-    if (result != XR_SUCCESS) {
-        m_openxr->error = "Could not create openxr session: " + m_openxr->get_result_string(result);
-        spdlog::error("[VR] {}", m_openxr->error.value());
-
+    // Step 3 and 4: Create a session and its spaces
+    if (initialize_openxr_session()) {
         return std::nullopt;
     }
 
-    // Step 4: Create a space
-    spdlog::info("[VR] Creating OpenXR space");
-
-    // We may just be restarting OpenXR, so try to find an existing space first
-
-    if (m_openxr->stage_space == XR_NULL_HANDLE) {
-        XrReferenceSpaceCreateInfo space_create_info{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
-        space_create_info.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
-        space_create_info.poseInReferenceSpace = {};
-        space_create_info.poseInReferenceSpace.orientation.w = 1.0f;
-
-        result = xrCreateReferenceSpace(m_openxr->session, &space_create_info, &m_openxr->stage_space);
-
-        if (result != XR_SUCCESS) {
-            m_openxr->error = "Could not create openxr stage space: " + m_openxr->get_result_string(result);
-            spdlog::error("[VR] {}", m_openxr->error.value());
-
-            return std::nullopt;
-        }
-    }
-
-    if (m_openxr->view_space == XR_NULL_HANDLE) {
-        XrReferenceSpaceCreateInfo space_create_info{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
-        space_create_info.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_VIEW;
-        space_create_info.poseInReferenceSpace = {};
-        space_create_info.poseInReferenceSpace.orientation.w = 1.0f;
-
-        result = xrCreateReferenceSpace(m_openxr->session, &space_create_info, &m_openxr->view_space);
-
-        if (result != XR_SUCCESS) {
-            m_openxr->error = "Could not create openxr view space: " + m_openxr->get_result_string(result);
-            spdlog::error("[VR] {}", m_openxr->error.value());
-
-            return std::nullopt;
-        }
-    }
-
     // Step 5: Get the system properties
     spdlog::info("[VR] Getting OpenXR system properties");
 
@@ -458,6 +406,67 @@ std::optional<std::string> VR::initialize_openxr() {
     return std::nullopt;
 }
 
+std::optional<std::string> VR::initialize_openxr_session() {
+    spdlog::info("[VR] Initializing graphics info");
+
+    XrSessionCreateInfo session_create_info{XR_TYPE_SESSION_CREATE_INFO};
+
+    if (g_framework->is_dx12()) {
+        m_d3d12.openxr().initialize(session_create_info);
+    } else {
+        m_d3d11.openxr().initialize(session_create_info);
+    }
+
+    spdlog::info("[VR] Creating OpenXR session");
+    session_create_info.systemId = m_openxr->system;
+    auto result = xrCreateSession(m_openxr->instance, &session_create_info, &m_openxr->session);
+
+    if (result != XR_SUCCESS) {
+        m_openxr->error = "Could not create openxr session: " + m_openxr->get_result_string(result);
+        spdlog::error("[VR] {}", m_openxr->error.value());
+
+        return m_openxr->error;
+    }
+
+    spdlog::info("[VR] Creating OpenXR space");
+
+    // We may just be restarting OpenXR, so try to find an existing space first
+
+    if (m_openxr->stage_space == XR_NULL_HANDLE) {
+        XrReferenceSpaceCreateInfo space_create_info{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+        space_create_info.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_LOCAL;
+        space_create_info.poseInReferenceSpace = {};
+        space_create_info.poseInReferenceSpace.orientation.w = 1.0f;
+
+        result = xrCreateReferenceSpace(m_openxr->session, &space_create_info, &m_openxr->stage_space);
+
+        if (result != XR_SUCCESS) {
+            m_openxr->error = "Could not create openxr stage space: " + m_openxr->get_result_string(result);
+            spdlog::error("[VR] {}", m_openxr->error.value());
+
+            return m_openxr->error;
+        }
+    }
+
+    if (m_openxr->view_space == XR_NULL_HANDLE) {
+        XrReferenceSpaceCreateInfo space_create_info{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
+        space_create_info.referenceSpaceType = XR_REFERENCE_SPACE_TYPE_VIEW;
+        space_create_info.poseInReferenceSpace = {};
+        space_create_info.poseInReferenceSpace.orientation.w = 1.0f;
+
+        result = xrCreateReferenceSpace(m_openxr->session, &space_create_info, &m_openxr->view_space);
+
+        if (result != XR_SUCCESS) {
+            m_openxr->error = "Could not create openxr view space: " + m_openxr->get_result_string(result);
+            spdlog::error("[VR] {}", m_openxr->error.value());
+
+            return m_openxr->error;
+        }
+    }
+
+    return std::nullopt;
+}
+
 std::optional<std::string> VR::initialize_openxr_input() {
     if (auto err = m_openxr->initialize_actions(VR::actions_json)) {
         m_openxr->error = err.value();
@@ -513,6 +522,82 @@ std::optional<std::string> VR::initialize_openxr_swapchains() {
     return std::nullopt;
 }
 
+void VR::setup_runtime_recovery() {
+    using Stage = vrmod::RuntimeRecovery::Stage;
+
+    m_recovery.cancel();
+    m_recovery.clear_handlers();
+
+    if (get_runtime()->is_openvr()) {
+        m_recovery.set_handler(Stage::RESYNC_ACTIONS, [this]() {
+            if (auto err = initialize_openvr_input()) {
+                spdlog::error("[VR] Failed to resync OpenVR input: {}", *err);
+                return false;
+            }
+
+            // the action state update is what stalled in the first place, make sure it's healthy again
+            const auto start_time = std::chrono::high_resolution_clock::now();
+            const auto error = vr::VRInput()->UpdateActionState(&m_active_action_set, sizeof(m_active_action_set), 1);
+            const auto time_delta = std::chrono::high_resolution_clock::now() - start_time;
+
+            return error == vr::VRInputError_None && time_delta < std::chrono::milliseconds(30);
+        });
+
+        // OpenVR has no separate session or swapchain objects, the next step is a full restart
+        m_recovery.set_handler(Stage::REINITIALIZE, [this]() {
+            reinitialize_openvr();
+            return m_openvr != nullptr && m_openvr->loaded;
+        });
+    } else if (get_runtime()->is_openxr()) {
+        m_recovery.set_handler(Stage::RESYNC_ACTIONS, [this]() {
+            return m_openxr->update_input() == VRRuntime::Error::SUCCESS;
+        });
+
+        m_recovery.set_handler(Stage::RECREATE_SWAPCHAINS, [this]() {
+            if (m_is_d3d12) {
+                m_d3d12.openxr().destroy_swapchains();
+            } else {
+                m_d3d11.openxr().destroy_swapchains();
+            }
+
+            return !initialize_openxr_swapchains() && m_openxr->loaded;
+        });
+
+        // OpenXR::instance, the system id and the action set survive this, only the session and what hangs off it is rebuilt
+        m_recovery.set_handler(Stage::RECREATE_SESSION, [this]() {
+            std::scoped_lock _{m_openvr_mtx};
+
+            if (m_is_d3d12) {
+                m_d3d12.openxr().destroy_swapchains();
+            } else {
+                m_d3d11.openxr().destroy_swapchains();
+            }
+
+            m_openxr->destroy_session();
+            m_openxr->needs_pose_update = true;
+            m_openxr->got_first_poses = false;
+
+            if (initialize_openxr_session()) {
+                return false;
+            }
+
+            if (auto err = m_openxr->attach_actions()) {
+                m_openxr->error = err.value();
+                spdlog::error("[VR] {}", m_openxr->error.value());
+                return false;
+            }
+
+            return !initialize_openxr_swapchains() && m_openxr->loaded;
+        });
+
+        m_recovery.set_handler(Stage::REINITIALIZE, [this]() {
+            m_openxr->destroy();
+            reinitialize_openxr();
+            return m_openxr != nullptr && m_openxr->loaded;
+        });
+    }
+}
+
 std::optional<std::string> VR::hijack_resolution() {
     // moved to global hook class
     return std::nullopt;
@@ -646,7 +731,7 @@ void VR::update_action_states() {
     SCOPE_PROFILER();
     auto runtime = get_runtime();
 
-    if (runtime->wants_reinitialize) {
+    if (runtime->wants_recovery() || m_recovery.is_recovering()) {
         return;
     }
 
@@ -668,8 +753,7 @@ void VR::update_action_states() {
         if ((end_time - start_time) >= std::chrono::milliseconds(30)) {
             spdlog::warn("VRInput update action state took too long: {}ms", std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count());
 
-            //reinitialize_openvr();
-            runtime->wants_reinitialize = true;
+            runtime->request_recovery(vrmod::RuntimeRecovery::Stage::RESYNC_ACTIONS);
         }   
     } else {
         get_runtime()->update_input();
@@ -890,9 +974,9 @@ void VR::on_present() {
 
             openvr->is_hmd_active = hmd_active;
 
-            // upon headset re-entry, reinitialize OpenVR
+            // upon headset re-entry, resync OpenVR input, escalates to a full reinit if that doesn't help
             if (openvr->is_hmd_active && !openvr->was_hmd_active) {
-                openvr->wants_reinitialize = true;
+                openvr->request_recovery(vrmod::RuntimeRecovery::Stage::RESYNC_ACTIONS);
             }
 
             openvr->was_hmd_active = openvr->is_hmd_active;
@@ -995,16 +1079,13 @@ void VR::on_post_present() {
         }
     }
 
-    if (runtime->wants_reinitialize) {
-        std::scoped_lock _{m_openvr_mtx};
+    if (const auto stage = runtime->consume_recovery_request(); stage != vrmod::RuntimeRecovery::Stage::NONE) {
+        m_recovery.request(stage);
+    }
 
-        if (runtime->is_openvr()) {
-            m_openvr->wants_reinitialize = false;
-            reinitialize_openvr();
-        } else if (runtime->is_openxr()) {
-            m_openxr->wants_reinitialize = false;
-            reinitialize_openxr();
-        }
+    if (m_recovery.is_recovering()) {
+        std::scoped_lock _{m_openvr_mtx};
+        m_recovery.update();
     }
 }
 
@@ -1161,6 +1242,14 @@ void VR::on_draw_ui() {
 
     if (get_runtime()->is_openvr()) {
         ImGui::TextWrapped("Resolution can be changed in SteamVR");
+
+        if (g_framework->is_dx12()) {
+            m_openvr_submit_ring_depth->draw("Eye Textures In Flight");
+
+            if (ImGui::IsItemDeactivatedAfterEdit()) {
+                m_d3d12.set_openvr_ring_depth(m_openvr_submit_ring_depth->value());
+            }
+        }
     } else if (get_runtime()->is_openxr()) {
         if (ImGui::TreeNode("Bindings")) {
             m_openxr->display_bindings_editor();
@@ -1203,7 +1292,7 @@ void VR::on_draw_ui() {
     }
 
     if (ImGui::Button("Reinitialize Runtime")) {
-        get_runtime()->wants_reinitialize = true;
+        get_runtime()->request_recovery(vrmod::RuntimeRecovery::Stage::REINITIALIZE);
     }
 
     //ImGui::DragFloat4("Right Bounds", (float*)&m_right_bounds, 0.005f, -2.0f, 2.0f);
@@ -1277,6 +1366,44 @@ void VR::on_draw_ui() {
 
     ImGui::DragFloat("Avg Input Processing Delay (MS)", &duration_float, 0.00001f);
 
+    if (ImGui::TreeNode("Runtime Recovery")) {
+        const auto& metrics = m_recovery.get_metrics();
+        const auto to_ms = [](std::chrono::nanoseconds t) { return std::chrono::duration<float, std::milli>(t).count(); };
+
+        ImGui::Text("Current Stage: %s (attempt %u)", vrmod::RuntimeRecovery::to_string(m_recovery.get_stage()).data(), m_recovery.get_attempts());
+        ImGui::Text("Recoveries: %u, Failures: %u, Attempts: %u", metrics.recoveries, metrics.failures, metrics.attempts);
+
+        for (auto i = (size_t)vrmod::RuntimeRecovery::Stage::RESYNC_ACTIONS; i < metrics.resolved_at.size(); ++i) {
+            ImGui::Text("  Resolved at %s: %u", vrmod::RuntimeRecovery::to_string((vrmod::RuntimeRecovery::Stage)i).data(), metrics.resolved_at[i]);
+        }
+
+        ImGui::Text("Last: %s, %.2f ms", vrmod::RuntimeRecovery::to_string(metrics.last_stage).data(), to_ms(metrics.last_recovery_time));
+        ImGui::Text("Max: %.2f ms", to_ms(metrics.max_recovery_time));
+
+        ImGui::TreePop();
+    }
+
+    if (g_framework->is_dx12() && get_runtime()->is_openvr() && ImGui::TreeNode("OpenVR Submit Ring")) {
+        for (const auto left : {true, false}) {
+            const auto& stats = m_d3d12.get_openvr_ring_stats(left);
+
+            ImGui::Text("%s: Acquires: %llu, Starved: %llu, Waited: %.2f ms (max %.2f ms)", left ? "Left" : "Right",
+                stats.acquires, stats.starved, stats.total_wait_ms, stats.max_wait_ms);
+        }
+
+        ImGui::TreePop();
+    }
+
+    if (g_framework->is_dx12() && ImGui::TreeNode("UI Render Cache")) {
+        const auto& stats = g_framework->get_ui_cache_stats();
+
+        ImGui::Text("Frames: %llu, Skipped: %llu, Partial: %llu, Full: %llu", stats.frames, stats.skipped, stats.partial, stats.full);
+        ImGui::Text("Submissions: %llu, Skipped Submissions: %llu", stats.submissions, stats.skipped_submissions);
+        ImGui::Text("Full Record: %.3f ms, Saved: %.1f ms", stats.avg_record_ms, stats.saved_ms);
+
+        ImGui::TreePop();
+    }
+
     m_overlay_component.on_draw_ui();
 
 }
@@ -1299,7 +1426,7 @@ void VR::on_device_reset() {
     m_overlay_component.on_reset();
 }
 
-void VR::on_config_load(const utility::Config& cfg, bool set_defaults) {
+void VR::on_config_load(const utility::ConfigStore& cfg, bool set_defaults) {
     for (IModValue& option : m_options) {
         option.config_load(cfg, set_defaults);
     }
@@ -1319,6 +1446,7 @@ void VR::on_config_load(const utility::Config& cfg, bool set_defaults) {
         get_runtime()->m_flat_screen_distance = m_flat_screen_distance->value();
     }
     m_overlay_component.on_config_load(cfg, set_defaults);
+    m_d3d12.set_openvr_ring_depth(m_openvr_submit_ring_depth->value());
 
 
     if (m_motion_controls_inactivity_timer->value() <= 10.0f) {
@@ -1326,13 +1454,67 @@ void VR::on_config_load(const utility::Config& cfg, bool set_defaults) {
     }
 }
 
-void VR::on_config_save(utility::Config& cfg) {
+void VR::on_config_save(utility::ConfigStore& cfg) {
     for (IModValue& option : m_options) {
         option.config_save(cfg);
     }
     m_overlay_component.on_config_save(cfg);
 }
 
+uint32_t VR::on_config_reload(const utility::ConfigStore& cfg) {
+    return apply_config_changes(m_options, cfg) | m_overlay_component.on_config_reload(cfg);
+}
+
+void VR::on_config_rebuild() {
+    // Swapchains are sized from the resolution scale, the runtime recovery recreates them between frames
+    if (get_runtime()->is_openxr() && get_runtime()->loaded) {
+        get_runtime()->request_recovery(vrmod::RuntimeRecovery::Stage::RECREATE_SWAPCHAINS);
+    }
+}
+
+// Same as what on_draw_ui does after an edit, for values changed in vr_config.txt while running
+void VR::add_config_callbacks() {
+    m_resolution_scale->on_change([this](IModValue&) {
+        if (get_runtime()->is_openxr() && get_runtime()->loaded) {
+            m_openxr->resolution_scale = m_resolution_scale->value();
+        }
+    }).requires_rebuild(IModValue::REBUILD_RESOURCES);
+
+    m_sync_interval->on_change([this](IModValue&) {
+        if (get_runtime()->loaded) {
+            *(int*)&get_runtime()->custom_stage = m_sync_interval->value();
+        }
+    });
+
+    m_horizontal_fov_scale->on_change([this](IModValue&) {
+        if (get_runtime()->loaded) {
+            get_runtime()->m_horizontal_fov_scale = m_horizontal_fov_scale->value();
+        }
+    });
+
+    m_vertical_fov_scale->on_change([this](IModValue&) {
+        if (get_runtime()->loaded) {
+            get_runtime()->m_vertical_fov_scale = m_vertical_fov_scale->value();
+        }
+    });
+
+    m_extended_fov_rage->on_change([this](IModValue&) {
+        if (get_runtime()->loaded) {
+            get_runtime()->m_extended_fov_range = m_extended_fov_rage->value();
+        }
+    });
+
+    m_openvr_submit_ring_depth->on_change([this](IModValue&) {
+        m_d3d12.set_openvr_ring_depth(m_openvr_submit_ring_depth->value());
+    });
+
+    m_flat_screen_distance->on_change([this](IModValue&) {
+        if (get_runtime()->loaded) {
+            get_runtime()->m_flat_screen_distance = m_flat_screen_distance->value();
+        }
+    });
+}
+
 Vector4f VR::get_position(uint32_t index) const {
     if (index >= vr::k_unMaxTrackedDeviceCount) {
         return Vector4f{};
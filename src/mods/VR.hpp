@@ -17,6 +17,7 @@
 #include "vr/D3D11Component.hpp"
 #include "vr/D3D12Component.hpp"
 #include "vr/OverlayComponent.hpp"
+#include "vr/RuntimeRecovery.hpp"
 #include "vr/runtimes/OpenXR.hpp"
 #include "vr/runtimes/OpenVR.hpp"
 
@@ -30,6 +31,7 @@ class VR : public Mod {
 public:
     inline VR() {
         add_components_vr();
+        add_config_callbacks();
     }
 
     static const inline std::string s_action_trigger = "/actions/default/in/Trigger";
@@ -81,8 +83,10 @@ public:
     void on_draw_ui() override;
     void on_device_reset() override;
 
-    void on_config_load(const utility::Config& cfg, bool set_defaults) override;
-    void on_config_save(utility::Config& cfg) override;
+    void on_config_load(const utility::ConfigStore& cfg, bool set_defaults) override;
+    void on_config_save(utility::ConfigStore& cfg) override;
+    uint32_t on_config_reload(const utility::ConfigStore& cfg) override;
+    void on_config_rebuild() override;
 
     // Application entries
     void on_pre_update_hid(void* entry);
@@ -340,6 +344,7 @@ private:
     std::optional<std::string> initialize_openvr();
     std::optional<std::string> initialize_openvr_input();
     std::optional<std::string> initialize_openxr();
+    std::optional<std::string> initialize_openxr_session();
     std::optional<std::string> initialize_openxr_input();
     std::optional<std::string> initialize_openxr_swapchains();
     std::optional<std::string> hijack_resolution();
@@ -394,6 +399,9 @@ private:
         return e;
     }
 
+    // Installs the per-stage recovery handlers for whichever runtime got loaded.
+    void setup_runtime_recovery();
+
     bool detect_controllers();
     bool is_any_action_down();
 public:
@@ -439,6 +447,8 @@ private:
     std::shared_ptr<runtimes::OpenVR> m_openvr{std::make_shared<runtimes::OpenVR>()};
     std::shared_ptr<runtimes::OpenXR> m_openxr{std::make_shared<runtimes::OpenXR>()};
 
+    vrmod::RuntimeRecovery m_recovery{};
+
     Matrix4x4f m_transform_offset{ glm::identity<Matrix4x4f>() };
     glm::quat m_gui_rotation_offset{ glm::identity<glm::quat>() };
 
@@ -548,6 +558,8 @@ protected:
         };
     }
 
+    void add_config_callbacks();
+
 
     // options
 public:
@@ -624,6 +636,7 @@ private:
     const ModSlider::Ptr m_vertical_fov_scale{ ModSlider::create(generate_name("VerticalFOVScale"), 0.0f, 1.0f, 1.0f) };
     const ModToggle::Ptr m_extended_fov_rage{ ModToggle::create(generate_name("ExtendedScaleFovRange"), false) };
     const ModSlider::Ptr m_flat_screen_distance{ ModSlider::create(generate_name("FlatSCreenDistance"), 0.0f, 2.0f, 1.5f) };
+    const ModSliderInt32::Ptr m_openvr_submit_ring_depth{ ModSliderInt32::create(generate_name("OpenVRSubmitRingDepth"), 2, 8, 3) };
 
     const ModToggle::Ptr m_force_fps_settings{ ModToggle::create(generate_name("ForceFPS"), true) };
     const ModToggle::Ptr m_force_aa_settings{ ModToggle::create(generate_name("ForceAntiAliasing"), true) };
@@ -677,6 +690,7 @@ private:
         *m_desktop_fix,
         *m_desktop_fix_skip_present,
         *m_sync_interval,
+        *m_openvr_submit_ring_depth,
 //        *m_enable_asynchronous_rendering
     };
 
@@ -7,6 +7,18 @@ std::shared_ptr<VRConfig>& VRConfig::get() {
 }
 
 std::optional<std::string> VRConfig::on_initialize() {
+    m_font_size->on_change([this](IModValue&) {
+        g_framework->set_font_size(m_font_size->value());
+    });
+
+    m_filtered_window_titles->on_change([this](IModValue&) {
+        WindowFilter::get().set_patterns(m_filtered_window_titles->value());
+    });
+
+    m_lazy_glyphs->on_change([this](IModValue&) {
+        g_framework->set_lazy_glyphs(m_lazy_glyphs->value());
+    });
+
     return Mod::on_initialize();
 }
 
@@ -17,6 +29,14 @@ void VRConfig::on_draw_ui() {
         m_menu_key->draw("Menu Key");
 //        m_show_cursor_key->draw("Show Cursor Key");
         m_remember_menu_state->draw("Remember Menu Open/Closed State");
+
+        if (m_lazy_glyphs->draw("Bake Only Used CJK Glyphs")) {
+            g_framework->set_lazy_glyphs(m_lazy_glyphs->value());
+        }
+
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Pictographic mode only: faster font rebuilds and a smaller atlas.\nText that was never typed or requested shows up as '?' until the next rebuild.");
+        }
 //        m_always_show_cursor->draw("Draw Cursor With Menu Open");
 
 //        if (m_font_size->draw("Font Size")) {
@@ -33,7 +53,7 @@ void VRConfig::on_frame() {
     }
 }
 
-void VRConfig::on_config_load(const utility::Config& cfg, bool set_defaults) {
+void VRConfig::on_config_load(const utility::ConfigStore& cfg, bool set_defaults) {
     for (IModValue& option : m_options) {
         option.config_load(cfg, set_defaults);
     }
@@ -43,10 +63,17 @@ void VRConfig::on_config_load(const utility::Config& cfg, bool set_defaults) {
     }
     
     g_framework->set_font_size(m_font_size->value());
+
+    WindowFilter::get().set_patterns(m_filtered_window_titles->value());
+    g_framework->set_lazy_glyphs(m_lazy_glyphs->value());
 }
 
-void VRConfig::on_config_save(utility::Config& cfg) {
+void VRConfig::on_config_save(utility::ConfigStore& cfg) {
     for (IModValue& option : m_options) {
         option.config_save(cfg);
     }
 }
+
+uint32_t VRConfig::on_config_reload(const utility::ConfigStore& cfg) {
+    return apply_config_changes(m_options, cfg);
+}
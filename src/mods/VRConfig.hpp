@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Mod.hpp"
+#include "WindowFilter.hpp"
 
 class VRConfig : public Mod {
 public:
@@ -14,8 +15,9 @@ public:
     std::optional<std::string> on_initialize() override;
     void on_draw_ui() override;
     void on_frame() override;
-    void on_config_load(const utility::Config& cfg, bool set_defaults) override;
-    void on_config_save(utility::Config& cfg) override;
+    void on_config_load(const utility::ConfigStore& cfg, bool set_defaults) override;
+    void on_config_save(utility::ConfigStore& cfg) override;
+    uint32_t on_config_reload(const utility::ConfigStore& cfg) override;
 
     auto& get_menu_key() {
         return m_menu_key;
@@ -36,12 +38,18 @@ private:
     ModToggle::Ptr m_always_show_cursor{ ModToggle::create(generate_name("DrawCursorWithMenuOpen"), false) };
     ModKey::Ptr m_show_cursor_key{ ModKey::create(generate_name("ShowCursorKey")) };
     ModInt32::Ptr m_font_size{ModInt32::create(generate_name("FontSize"), 16)};
+    // comma separated window title substrings we never hook a swapchain for
+    ModString::Ptr m_filtered_window_titles{ ModString::create(generate_name("FilteredWindowTitles"), std::string{WindowFilter::DEFAULT_PATTERNS}) };
+    // vr_pictographic.mode bakes only the CJK glyphs seen so far instead of all of them, see Framework::set_lazy_glyphs
+    ModToggle::Ptr m_lazy_glyphs{ ModToggle::create(generate_name("LazyGlyphs"), false) };
 
 
     ValueList m_options {
         *m_menu_key,
         *m_menu_open,
         *m_remember_menu_state,
+        *m_filtered_window_titles,
+        *m_lazy_glyphs,
 //        *m_always_show_cursor,
 //        *m_show_cursor_key,
 //        *m_font_size
@@ -117,6 +117,16 @@ void VariableRateShadingImage::on_frame()
 //}
 
 
+// What the RSSetShadingRate calls below bind, for skipping them when it's bound already
+static constexpr D3D12Hook::CommandListState::ShadingRate VRS_RATE{D3D12_SHADING_RATE_1X1, {D3D12_SHADING_RATE_COMBINER_MAX, D3D12_SHADING_RATE_COMBINER_MAX}};
+
+void VariableRateShadingImage::on_d3d12_attach_listeners(D3D12Listeners& listeners)
+{
+    listeners.set_render_targets();
+    listeners.set_scissor_rects();
+    listeners.create_render_target_view();
+}
+
 void VariableRateShadingImage::on_d3d12_set_render_targets(ID3D12GraphicsCommandList5* cmd_list, UINT num_rtvs, const D3D12_CPU_DESCRIPTOR_HANDLE* rtvs, BOOL single_handle,
                                                            D3D12_CPU_DESCRIPTOR_HANDLE* dsv)
 {
@@ -137,8 +147,10 @@ void VariableRateShadingImage::on_d3d12_set_render_targets(ID3D12GraphicsCommand
                 break;
             }
         }
-        cmd_list->RSSetShadingRate(D3D12_SHADING_RATE_1X1, combiners);
-        cmd_list->RSSetShadingRateImage(pVRSResource);
+        if (g_framework->get_d3d12_hook()->get_command_list_state().set_shading_rate(cmd_list, VRS_RATE, pVRSResource)) {
+            cmd_list->RSSetShadingRate(D3D12_SHADING_RATE_1X1, combiners);
+            cmd_list->RSSetShadingRateImage(pVRSResource);
+        }
     }
 }
 
@@ -172,8 +184,10 @@ void VariableRateShadingImage::on_d3d12_set_scissor_rects(ID3D12GraphicsCommandL
             break;
         }
     }
-    cmd_list->RSSetShadingRate(D3D12_SHADING_RATE_1X1, combiners);
-    cmd_list->RSSetShadingRateImage(pVRSResource);
+    if (g_framework->get_d3d12_hook()->get_command_list_state().set_shading_rate(cmd_list, VRS_RATE, pVRSResource)) {
+        cmd_list->RSSetShadingRate(D3D12_SHADING_RATE_1X1, combiners);
+        cmd_list->RSSetShadingRateImage(pVRSResource);
+    }
 }
 
 void VariableRateShadingImage::generateImagePattern(UINT tilesX, UINT tilesY, int slotIndex)
@@ -491,6 +505,8 @@ void VariableRateShadingImage::on_d3d12_initialize(ID3D12Device4* pDevice4, D3D1
 
 std::optional<std::string> VariableRateShadingImage::on_initialize()
 {
+    m_fine_radius->requires_rebuild(IModValue::REBUILD_RESOURCES);
+    m_coarse_radius->requires_rebuild(IModValue::REBUILD_RESOURCES);
     Setup(g_framework->get_d3d12_hook()->get_device());
     return Mod::on_initialize();
 }
@@ -509,9 +525,16 @@ void VariableRateShadingImage::on_draw_ui()
     if(m_coarse_radius->draw("2x2 Radius")) {
         Update();
     }
+
+    if (const auto& d3d12 = g_framework->get_d3d12_hook(); d3d12 != nullptr) {
+        const auto stats = d3d12->get_command_list_state().get_stats();
+        ImGui::Text("Redundant render target binds: %.1f%% of %llu", stats.render_targets.redundant_ratio() * 100.0, (unsigned long long)stats.render_targets.calls);
+        ImGui::Text("Redundant shading rate binds: %.1f%% of %llu", stats.shading_rate.redundant_ratio() * 100.0, (unsigned long long)stats.shading_rate.calls);
+        ImGui::Text("Untracked command list calls: %llu", (unsigned long long)stats.untracked);
+    }
 }
 
-void VariableRateShadingImage::on_config_load(const utility::Config& cfg, bool set_defaults)
+void VariableRateShadingImage::on_config_load(const utility::ConfigStore& cfg, bool set_defaults)
 {
     for (IModValue& option : m_options) {
         option.config_load(cfg, set_defaults);
@@ -519,13 +542,24 @@ void VariableRateShadingImage::on_config_load(const utility::Config& cfg, bool s
     Update();
 }
 
-void VariableRateShadingImage::on_config_save(utility::Config& cfg)
+void VariableRateShadingImage::on_config_save(utility::ConfigStore& cfg)
 {
     for (IModValue& option : m_options) {
         option.config_save(cfg);
     }
 }
 
+uint32_t VariableRateShadingImage::on_config_reload(const utility::ConfigStore& cfg)
+{
+    return apply_config_changes(m_options, cfg);
+}
+
+// Both radii changing in one edit rebuild the image once
+void VariableRateShadingImage::on_config_rebuild()
+{
+    Update();
+}
+
 
 #if defined(_DEBUG)
 const VariableRateShadingImage::ResourceSlot* VariableRateShadingImage::GetLargestDebugSlot() const {
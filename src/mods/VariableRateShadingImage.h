@@ -160,8 +160,11 @@ public:
     void on_device_reset() override;
     void on_d3d12_initialize(ID3D12Device4 *pDevice4, D3D12_RESOURCE_DESC &desc) override;
     void on_draw_ui() override;
-    void on_config_load(const utility::Config& cfg, bool set_defaults) override;
-    void on_config_save(utility::Config& cfg) override;
+    void on_config_load(const utility::ConfigStore& cfg, bool set_defaults) override;
+    void on_config_save(utility::ConfigStore& cfg) override;
+    uint32_t on_config_reload(const utility::ConfigStore& cfg) override;
+    void on_config_rebuild() override;
+    void on_d3d12_attach_listeners(D3D12Listeners& listeners) override;
     void on_d3d12_set_scissor_rects(ID3D12GraphicsCommandList5 *cmd_list, UINT num_rects, const D3D12_RECT *rects) override;
     void on_d3d12_set_render_targets(ID3D12GraphicsCommandList5 *cmd_list, UINT num_rtvs, const D3D12_CPU_DESCRIPTOR_HANDLE *rtvs, BOOL single_handle, D3D12_CPU_DESCRIPTOR_HANDLE *dsv) override;
     void on_d3d12_create_render_target_view(ID3D12Device *device, ID3D12Resource *pResource, const D3D12_RENDER_TARGET_VIEW_DESC *pDesc, D3D12_CPU_DESCRIPTOR_HANDLE DestDescriptor) override;
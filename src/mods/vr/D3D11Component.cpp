@@ -310,9 +310,9 @@ vr::EVRCompositorError D3D11Component::on_frame(VR* vr) {
             left_eye.handle = (void*)m_left_eye_tex.Get();
             left_eye.eType = vr::TextureType_DirectX;
             left_eye.eColorSpace = vr::ColorSpace_Auto;
-            left_eye.mDeviceToAbsoluteTracking = GlobalPool::get_openvr_pose(vr->m_presenter_frame_count);
+            const auto left_flags = GlobalPool::attach_openvr_pose(left_eye, GlobalPool::get_openvr_pose(vr->m_presenter_frame_count));
 
-            auto e = vr::VRCompositor()->Submit(vr::Eye_Left, (vr::Texture_t*)&left_eye, &vr->m_left_bounds, vr::Submit_TextureWithPose);
+            auto e = vr::VRCompositor()->Submit(vr::Eye_Left, (vr::Texture_t*)&left_eye, &vr->m_left_bounds, left_flags);
 
             if (e != vr::VRCompositorError_None) {
                 spdlog::error("[VR] VRCompositor failed to submit left eye: {}", (int)e);
@@ -325,9 +325,9 @@ vr::EVRCompositorError D3D11Component::on_frame(VR* vr) {
                 right_eye.handle = (void*)m_right_eye_tex.Get();
                 right_eye.eType = vr::TextureType_DirectX;
                 right_eye.eColorSpace = vr::ColorSpace_Auto;
-                right_eye.mDeviceToAbsoluteTracking = GlobalPool::get_openvr_pose(vr->m_presenter_frame_count - 1);
+                const auto right_flags = GlobalPool::attach_openvr_pose(right_eye, GlobalPool::get_openvr_pose(vr->m_presenter_frame_count - 1));
 
-                e = vr::VRCompositor()->Submit(vr::Eye_Right, (vr::Texture_t*)&right_eye, &vr->m_right_bounds, vr::Submit_TextureWithPose);
+                e = vr::VRCompositor()->Submit(vr::Eye_Right, (vr::Texture_t*)&right_eye, &vr->m_right_bounds, right_flags);
 
                 if (e != vr::VRCompositorError_None) {
                     spdlog::error("[VR] VRCompositor failed to submit right eye (resubmit): {}", (int)e);
@@ -383,9 +383,9 @@ vr::EVRCompositorError D3D11Component::on_frame(VR* vr) {
                 left_eye.handle = (void*)m_left_eye_tex.Get();
                 left_eye.eType = vr::TextureType_DirectX;
                 left_eye.eColorSpace = vr::ColorSpace_Auto;
-                left_eye.mDeviceToAbsoluteTracking = GlobalPool::get_openvr_pose(vr->m_presenter_frame_count - 1);
+                const auto left_flags = GlobalPool::attach_openvr_pose(left_eye, GlobalPool::get_openvr_pose(vr->m_presenter_frame_count - 1));
 
-                auto e = vr::VRCompositor()->Submit(vr::Eye_Left, (vr::Texture_t*)&left_eye, &vr->m_left_bounds, vr::Submit_TextureWithPose);
+                auto e = vr::VRCompositor()->Submit(vr::Eye_Left, (vr::Texture_t*)&left_eye, &vr->m_left_bounds, left_flags);
 
                 if (e != vr::VRCompositorError_None) {
                     spdlog::error("[VR] VRCompositor failed to submit left eye (resubmit): {}", (int)e);
@@ -400,9 +400,9 @@ vr::EVRCompositorError D3D11Component::on_frame(VR* vr) {
             right_eye.handle = (void*)m_right_eye_tex.Get();
             right_eye.eType = vr::TextureType_DirectX;
             right_eye.eColorSpace = vr::ColorSpace_Auto;
-            right_eye.mDeviceToAbsoluteTracking = GlobalPool::get_openvr_pose(vr->m_presenter_frame_count);
+            const auto right_flags = GlobalPool::attach_openvr_pose(right_eye, GlobalPool::get_openvr_pose(vr->m_presenter_frame_count));
 
-            auto e = vr::VRCompositor()->Submit(vr::Eye_Right, (vr::Texture_t*)&right_eye, &vr->m_right_bounds, vr::Submit_TextureWithPose);
+            auto e = vr::VRCompositor()->Submit(vr::Eye_Right, (vr::Texture_t*)&right_eye, &vr->m_right_bounds, right_flags);
 
             if (e != vr::VRCompositorError_None) {
                 spdlog::error("[VR] VRCompositor failed to submit right eye: {}", (int)e);
@@ -1,3 +1,4 @@
+#include <ModSettings.h>
 #include <openvr.h>
 #include <utility/ScopeGuard.hpp>
 #include <aer/ConstantsPool.h>
@@ -15,7 +16,7 @@ typedef HRESULT(WINAPI* PFN_D3D12_GET_DEBUG_INTERFACE)(REFIID, void**);
 
 namespace vrmod {
 vr::EVRCompositorError D3D12Component::on_frame(VR* vr) {
-    if (m_openvr.left_eye_tex[0].texture == nullptr || m_force_reset) {
+    if (!is_initialized() || m_force_reset) {
         setup();
     }
 
@@ -45,22 +46,31 @@ vr::EVRCompositorError D3D12Component::on_frame(VR* vr) {
         return vr::VRCompositorError_None;
     }
 
-    if (!m_backbuffer_is_8bit) {
-        auto command_list = m_backbuffer_copy.commands.cmd_list.Get();
-        m_backbuffer_copy.commands.wait(INFINITE);
-
-        // Copy current backbuffer into our copy so we can use it as an SRV.
-        m_backbuffer_copy.commands.copy(backbuffer.Get(), m_backbuffer_copy.texture.Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PRESENT);
+    auto runtime = vr->get_runtime();
 
-        // Convert the backbuffer to 8-bit.
-        render_srv_to_rtv(command_list, m_backbuffer_copy, m_converted_eye_tex, D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    // OpenVR eye textures are the size of the backbuffer, so the conversion can render straight into them.
+    // OpenXR swapchain images can differ in size, they still get a copy of m_converted_eye_tex.
+    const auto convert_into_openvr = !m_backbuffer_is_8bit && m_tone_map.ready() && runtime->is_openvr() && m_openvr.ready();
 
-        m_backbuffer_copy.commands.execute();
+    // Recorded on the target's own commands, m_backbuffer_copy only exists when the backbuffer can't be read directly
+    if (!m_backbuffer_is_8bit && !convert_into_openvr) {
+        m_converted_eye_tex.commands.wait(INFINITE);
+        convert_backbuffer(m_converted_eye_tex.commands, backbuffer.Get(), m_converted_eye_tex, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        m_converted_eye_tex.commands.execute();
     }
 
     auto eye_texture = m_backbuffer_is_8bit ? backbuffer : m_converted_eye_tex.texture;
 
-    auto runtime = vr->get_runtime();
+    const auto fill_openvr_eye = [&](OpenVR::Eye& eye) {
+        if (!convert_into_openvr) {
+            eye.copy(eye_texture.Get());
+            return;
+        }
+
+        auto& ctx = eye.acquire();
+        convert_backbuffer(ctx.commands, backbuffer.Get(), ctx, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+        ctx.commands.execute();
+    };
     bool is_left_eye_frame = vr->m_presenter_frame_count % 2 == vr->m_left_eye_interval;
     bool is_right_eye_frame = !is_left_eye_frame;
     
@@ -94,8 +104,8 @@ vr::EVRCompositorError D3D12Component::on_frame(VR* vr) {
 
         // OpenVR texture
         // Copy the back buffer to the left eye texture (m_left_eye_tex0 holds the intermediate frame).
-        if (runtime->is_openvr()) {
-            m_openvr.copy_left(eye_texture.Get());
+        if (runtime->is_openvr() && m_openvr.ready()) {
+            fill_openvr_eye(m_openvr.left);
 
             vr::D3D12TextureData_t left_tex {
                 m_openvr.get_left().texture.Get(),
@@ -107,17 +117,20 @@ vr::EVRCompositorError D3D12Component::on_frame(VR* vr) {
             left_eye.handle = (void*)&left_tex;
             left_eye.eType = vr::TextureType_DirectX12;
             left_eye.eColorSpace = vr::ColorSpace_Auto;
-            left_eye.mDeviceToAbsoluteTracking = GlobalPool::get_openvr_pose(vr->m_presenter_frame_count);
+            const auto left_pose = GlobalPool::get_openvr_pose(vr->m_presenter_frame_count);
+            const auto left_flags = GlobalPool::attach_openvr_pose(left_eye, left_pose);
 
             const auto left_bounds = vr::VRTextureBounds_t{runtime->view_bounds[0][0], runtime->view_bounds[0][2],
                                                            runtime->view_bounds[0][1], runtime->view_bounds[0][3]};
-            auto e = vr::VRCompositor()->Submit(vr::Eye_Left, (vr::Texture_t*)&left_eye, &left_bounds, vr::Submit_TextureWithPose);
+            auto e = vr::VRCompositor()->Submit(vr::Eye_Left, (vr::Texture_t*)&left_eye, &left_bounds, left_flags);
 
             if (e != vr::VRCompositorError_None) {
                 spdlog::error("[VR] VRCompositor failed to submit left eye: {}", (int)e);
                 return e;
             }
 
+            m_openvr.left.submitted(left_pose);
+
             if (vr->is_using_async_aer()) {
                 vr::D3D12TextureData_t right_tex {
                     m_openvr.get_right(true).texture.Get(),
@@ -129,11 +142,11 @@ vr::EVRCompositorError D3D12Component::on_frame(VR* vr) {
                 right_eye.handle = (void*)&right_tex;
                 right_eye.eType = vr::TextureType_DirectX12;
                 right_eye.eColorSpace = vr::ColorSpace_Auto;
-                right_eye.mDeviceToAbsoluteTracking = GlobalPool::get_openvr_pose(vr->m_presenter_frame_count-1);
+                const auto right_flags = GlobalPool::attach_openvr_pose(right_eye, m_openvr.right.get_past_pose());
 
                 const auto right_bounds = vr::VRTextureBounds_t{runtime->view_bounds[1][0], runtime->view_bounds[1][2],
                                                                  runtime->view_bounds[1][1], runtime->view_bounds[1][3]};
-                e = vr::VRCompositor()->Submit(vr::Eye_Right, (vr::Texture_t*)&right_eye, &right_bounds, vr::Submit_TextureWithPose);
+                e = vr::VRCompositor()->Submit(vr::Eye_Right, (vr::Texture_t*)&right_eye, &right_bounds, right_flags);
                 if (e != vr::VRCompositorError_None) {
                     spdlog::error("[VR] VRCompositor failed to submit right eye (resubmit): {}", (int)e);
                     return e;
@@ -160,10 +173,10 @@ vr::EVRCompositorError D3D12Component::on_frame(VR* vr) {
 
         // OpenVR texture
         // Copy the back buffer to the right eye texture.
-        if (runtime->is_openvr()) {
+        if (runtime->is_openvr() && m_openvr.ready()) {
             if (vr->is_using_async_aer()) {
                 vr::D3D12TextureData_t left_tex {
-                    m_openvr.get_left().texture.Get(),
+                    m_openvr.get_left(true).texture.Get(),
                     command_queue,
                     0
                 };
@@ -172,18 +185,18 @@ vr::EVRCompositorError D3D12Component::on_frame(VR* vr) {
                 left_eye.handle = (void*)&left_tex;
                 left_eye.eType = vr::TextureType_DirectX12;
                 left_eye.eColorSpace = vr::ColorSpace_Auto;
-                left_eye.mDeviceToAbsoluteTracking = GlobalPool::get_openvr_pose(vr->m_presenter_frame_count - 1);
+                const auto left_flags = GlobalPool::attach_openvr_pose(left_eye, m_openvr.left.get_past_pose());
 
                 const auto left_bounds = vr::VRTextureBounds_t{runtime->view_bounds[0][0], runtime->view_bounds[0][2],
                                                                runtime->view_bounds[0][1], runtime->view_bounds[0][3]};
-                auto e = vr::VRCompositor()->Submit(vr::Eye_Left, &left_eye, &left_bounds, vr::Submit_TextureWithPose); /*, vr::Submit_Default);*/
+                auto e = vr::VRCompositor()->Submit(vr::Eye_Left, &left_eye, &left_bounds, left_flags);
 
                 if (e != vr::VRCompositorError_None) {
                     spdlog::error("[VR] VRCompositor failed to submit left eye (resubmit): {}", (int)e);
                     return e;
                 }
             }
-            m_openvr.copy_right(eye_texture.Get());
+            fill_openvr_eye(m_openvr.right);
 
             vr::D3D12TextureData_t right_tex {
                 m_openvr.get_right().texture.Get(),
@@ -195,16 +208,19 @@ vr::EVRCompositorError D3D12Component::on_frame(VR* vr) {
             right_eye.handle = (void*)&right_tex;
             right_eye.eType = vr::TextureType_DirectX12;
             right_eye.eColorSpace = vr::ColorSpace_Auto;
-            right_eye.mDeviceToAbsoluteTracking = GlobalPool::get_openvr_pose(vr->m_presenter_frame_count);
+            const auto right_pose = GlobalPool::get_openvr_pose(vr->m_presenter_frame_count);
+            const auto right_flags = GlobalPool::attach_openvr_pose(right_eye, right_pose);
 
             const auto right_bounds = vr::VRTextureBounds_t{runtime->view_bounds[1][0], runtime->view_bounds[1][2],
                                                              runtime->view_bounds[1][1], runtime->view_bounds[1][3]};
-            auto e = vr::VRCompositor()->Submit(vr::Eye_Right, (vr::Texture_t*)&right_eye, &right_bounds, vr::Submit_TextureWithPose);
+            auto e = vr::VRCompositor()->Submit(vr::Eye_Right, (vr::Texture_t*)&right_eye, &right_bounds, right_flags);
 
             if (e != vr::VRCompositorError_None) {
                 spdlog::error("[VR] VRCompositor failed to submit right eye: {}", (int)e);
                 return e;
             }
+
+            m_openvr.right.submitted(right_pose);
             vr->m_submitted = true;
 
             ++m_openvr.texture_counter;
@@ -297,13 +313,8 @@ void D3D12Component::on_post_present(VR* vr) {
 void D3D12Component::on_reset(VR* vr) {
     auto runtime = vr->get_runtime();
 
-    for (auto& ctx : m_openvr.left_eye_tex) {
-        ctx.reset();
-    }
-
-    for (auto& ctx : m_openvr.right_eye_tex) {
-        ctx.reset();
-    }
+    m_openvr.left.reset();
+    m_openvr.right.reset();
 
     for (auto& copier : m_generic_copiers) {
         copier.reset();
@@ -312,6 +323,7 @@ void D3D12Component::on_reset(VR* vr) {
     m_prev_backbuffer.Reset();
     m_backbuffer_copy.reset();
     m_converted_eye_tex.reset();
+    m_tone_map.reset();
     m_graphics_memory.reset();
 
     if (runtime->is_openxr() && runtime->loaded) {
@@ -363,8 +375,17 @@ void D3D12Component::setup() {
     heap_props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
     heap_props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
 
+    DXGI_SWAP_CHAIN_DESC swapchain_desc{};
+    swapchain->GetDesc(&swapchain_desc);
+
+    m_backbuffer_is_srv = (swapchain_desc.BufferUsage & DXGI_USAGE_SHADER_INPUT) != 0 && (backbuffer_desc.Flags & D3D12_RESOURCE_FLAG_DENY_SHADER_RESOURCE) == 0;
+
+    if (!m_backbuffer_is_8bit && !m_tone_map.setup(device, DXGI_FORMAT_R8G8B8A8_UNORM)) {
+        m_backbuffer_is_srv = false;
+    }
+
     // Create copy of backbuffer to use as SRV to convert from HDR to 8bit
-    if (!m_backbuffer_is_8bit) {
+    if (!m_backbuffer_is_8bit && !m_backbuffer_is_srv) {
             ComPtr<ID3D12Resource> backbuffer_copy{};
             if (FAILED(device->CreateCommittedResource(&heap_props, D3D12_HEAP_FLAG_NONE, &backbuffer_srv_desc, D3D12_RESOURCE_STATE_PRESENT, nullptr,
                                                        IID_PPV_ARGS(backbuffer_copy.GetAddressOf()))))
@@ -401,34 +422,34 @@ void D3D12Component::setup() {
         }
     }
 
-    for (auto& ctx : m_openvr.left_eye_tex) {
-        ComPtr<ID3D12Resource> left_eye_tex{};
-        if (FAILED(device->CreateCommittedResource(&heap_props, D3D12_HEAP_FLAG_NONE, &rt_desc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr,
-                IID_PPV_ARGS(left_eye_tex.GetAddressOf())))) {
-            spdlog::error("[VR] Failed to create left eye texture.");
-            return;
-        }
+    for (auto eye : {&m_openvr.left, &m_openvr.right}) {
+        const auto is_left = eye == &m_openvr.left;
 
-        left_eye_tex->SetName(L"OpenVR Left Eye Texture");
-        if (!ctx.setup(device, left_eye_tex.Get(), std::nullopt, std::nullopt)) {
-            spdlog::error("[VR] Error setting up left eye texture RTV/SRV.");
-        }
-    }
- 
-    for (auto& ctx : m_openvr.right_eye_tex) {
-        ComPtr<ID3D12Resource> right_eye_tex{};
-        if (FAILED(device->CreateCommittedResource(&heap_props, D3D12_HEAP_FLAG_NONE, &rt_desc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr,
-                IID_PPV_ARGS(right_eye_tex.GetAddressOf())))) {
-            spdlog::error("[VR] Failed to create right eye texture.");
-            return;
-        }
+        eye->textures.clear();
+        eye->current = 0;
 
-        right_eye_tex->SetName(L"OpenVR Right Eye Texture");
-        if (!ctx.setup(device, right_eye_tex.Get(), std::nullopt, std::nullopt)) {
-            spdlog::error("[VR] Error setting up right eye texture RTV/SRV.");
+        for (uint32_t i = 0; i < m_openvr.ring_depth; ++i) {
+            ComPtr<ID3D12Resource> eye_tex{};
+            if (FAILED(device->CreateCommittedResource(&heap_props, D3D12_HEAP_FLAG_NONE, &rt_desc, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, nullptr,
+                    IID_PPV_ARGS(eye_tex.GetAddressOf())))) {
+                spdlog::error("[VR] Failed to create {} eye texture.", is_left ? "left" : "right");
+                eye->ring.resize(eye->textures.size());
+                return;
+            }
+
+            eye_tex->SetName(is_left ? L"OpenVR Left Eye Texture" : L"OpenVR Right Eye Texture");
+
+            auto& ctx = eye->textures.emplace_back(std::make_unique<d3d12::TextureContext>());
+            if (!ctx->setup(device, eye_tex.Get(), std::nullopt, std::nullopt)) {
+                spdlog::error("[VR] Error setting up {} eye texture RTV/SRV.", is_left ? "left" : "right");
+            }
         }
+
+        eye->ring.resize(eye->textures.size());
     }
 
+    spdlog::info("[VR] OpenVR submit ring: {} textures per eye", m_openvr.ring_depth);
+
     for (auto& copier : m_generic_copiers) {
         copier.setup();
     }
@@ -442,6 +463,61 @@ void D3D12Component::setup() {
     m_force_reset = false;
 }
 
+d3d12::TextureContext& D3D12Component::OpenVR::Eye::acquire() {
+    const auto acquired = this->ring.acquire([this](uint32_t index, uint64_t fence_value) {
+        return this->textures[index]->commands.fence->GetCompletedValue() >= fence_value;
+    });
+
+    auto& ctx = *this->textures[acquired.index];
+
+    if (acquired.starved) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        ctx.commands.wait(INFINITE);
+        this->ring.record_wait(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+
+        if (this->ring.get_stats().starved == 1) {
+            spdlog::warn("[VR] OpenVR submit ring starved, all {} textures still in use by the GPU", this->ring.size());
+        }
+    } else {
+        // Already done, only resets the command list
+        ctx.commands.wait(INFINITE);
+    }
+
+    this->current = acquired.index;
+    return ctx;
+}
+
+void D3D12Component::OpenVR::Eye::copy(ID3D12Resource* src) {
+    auto& ctx = acquire();
+
+    ctx.commands.copy(src, ctx.texture.Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+    ctx.commands.execute();
+}
+
+void D3D12Component::convert_backbuffer(d3d12::CommandContext& commands, ID3D12Resource* backbuffer, const d3d12::TextureContext& dst, D3D12_RESOURCE_STATES dst_state) {
+    const auto& settings = ModSettings::g_internalSettings;
+
+    if (!m_tone_map.ready()) {
+        // Copy current backbuffer into our copy so we can use it as an SRV.
+        commands.copy(backbuffer, m_backbuffer_copy.texture.Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PRESENT);
+
+        // Convert the backbuffer to 8-bit.
+        render_srv_to_rtv(commands.cmd_list.Get(), m_backbuffer_copy, dst, D3D12_RESOURCE_STATE_PRESENT, dst_state);
+        return;
+    }
+
+    auto src = backbuffer;
+
+    if (!m_backbuffer_is_srv) {
+        commands.copy(backbuffer, m_backbuffer_copy.texture.Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PRESENT);
+        src = m_backbuffer_copy.texture.Get();
+    }
+
+    m_tone_map.draw(commands.cmd_list.Get(), src, D3D12_RESOURCE_STATE_PRESENT, dst, dst_state,
+        utility::tonemap::make_constants(settings.toneMapAlg, settings.toneMapExposure));
+    commands.has_commands = true;
+}
+
 void D3D12Component::setup_sprite_batch_pso(DXGI_FORMAT output_format) {
     spdlog::info("[D3D12] Setting up sprite batch PSO");
 
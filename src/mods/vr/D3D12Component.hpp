@@ -1,7 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <memory>
 #include <optional>
+#include <vector>
 
 #include <d3d11.h>
 #include <d3d12.h>
@@ -12,8 +15,10 @@
 #include <../../../_deps/directxtk12-src/Inc/GraphicsMemory.h>
 #include <../../../_deps/directxtk12-src/Inc/SpriteBatch.h>
 
+#include "mods/vr/SubmitRing.hpp"
 #include "mods/vr/d3d12/ResourceCopier.hpp"
 #include "mods/vr/d3d12/TextureContext.hpp"
+#include "mods/vr/d3d12/ToneMapPass.hpp"
 
 #define XR_USE_PLATFORM_WIN32
 #define XR_USE_GRAPHICS_API_D3D11
@@ -37,7 +42,21 @@ public:
 
     const auto& get_backbuffer_size() const { return m_backbuffer_size; }
 
-    auto is_initialized() const { return m_openvr.left_eye_tex[0].texture != nullptr; }
+    auto is_initialized() const { return m_openvr.ready() && m_openvr.left.textures[0]->texture != nullptr; }
+
+    // Number of textures per eye the OpenVR path cycles through, takes effect on the next setup.
+    void set_openvr_ring_depth(uint32_t depth) {
+        depth = std::clamp<uint32_t>(depth, 2, 8);
+
+        if (depth != m_openvr.ring_depth) {
+            m_openvr.ring_depth = depth;
+            m_force_reset = true;
+        }
+    }
+
+    const auto& get_openvr_ring_stats(bool left) const {
+        return left ? m_openvr.left.ring.get_stats() : m_openvr.right.ring.get_stats();
+    }
 
     auto& openxr() { return m_openxr; }
 
@@ -45,6 +64,8 @@ private:
     void setup();
     void setup_sprite_batch_pso(DXGI_FORMAT output_format);
     void render_srv_to_rtv(ID3D12GraphicsCommandList* command_list, const d3d12::TextureContext& src, const d3d12::TextureContext& dst, D3D12_RESOURCE_STATES src_state, D3D12_RESOURCE_STATES dst_state);
+    // Records the HDR to 8-bit conversion of the backbuffer into dst, doesn't execute.
+    void convert_backbuffer(d3d12::CommandContext& commands, ID3D12Resource* backbuffer, const d3d12::TextureContext& dst, D3D12_RESOURCE_STATES dst_state);
 
     template <typename T> using ComPtr = Microsoft::WRL::ComPtr<T>;
 
@@ -55,49 +76,69 @@ private:
 
     std::unique_ptr<DirectX::DX12::GraphicsMemory> m_graphics_memory{};
     std::unique_ptr<DirectX::DX12::SpriteBatch> m_sprite_batch{};
+    d3d12::ToneMapPass m_tone_map{};
 
     // Mimicking what OpenXR does.
     struct OpenVR {
-        d3d12::TextureContext& get_left(const bool past = false) {
-            const auto counter = past ? (this->texture_counter - 1) : this->texture_counter;
-            auto& ctx = this->left_eye_tex[counter % left_eye_tex.size()];
-            return ctx;
-        }
+        struct Eye {
+            d3d12::TextureContext& get(const bool past = false) {
+                const auto index = past ? this->ring.last_submitted().value_or(this->current) : this->current;
+                return *this->textures[index];
+            }
 
-        d3d12::TextureContext& get_right(const bool past = false) {
-            const auto counter = past ? (this->texture_counter - 1) : this->texture_counter;
-            auto& ctx = this->right_eye_tex[counter % right_eye_tex.size()];
-            return ctx;
-        }
+            // Picks a free texture of the ring, waits for it if needed and makes it the current one.
+            d3d12::TextureContext& acquire();
 
-        d3d12::TextureContext& acquire_left() {
-            auto& ctx = get_left();
-            ctx.commands.wait(INFINITE);
+            // Copies into a free texture of the ring and makes it the current one.
+            void copy(ID3D12Resource* src);
 
-            return ctx;
-        }
+            void submitted(const std::optional<vr::HmdMatrix34_t>& pose) {
+                this->ring.submit(this->current, this->textures[this->current]->commands.fence_value, pose);
+            }
+
+            // What the last submitted texture was submitted with, for resubmitting it
+            const std::optional<vr::HmdMatrix34_t>& get_past_pose() const {
+                return this->ring.slot(this->ring.last_submitted().value_or(this->current)).payload;
+            }
+
+            void reset() {
+                for (auto& ctx : this->textures) {
+                    ctx->reset();
+                }
+
+                this->ring.resize(this->textures.size());
+                this->current = 0;
+            }
+
+            std::vector<std::unique_ptr<d3d12::TextureContext>> textures{};
+            SubmitRing<std::optional<vr::HmdMatrix34_t>> ring{};
+            uint32_t current{0};
+        };
 
-        d3d12::TextureContext& acquire_right() {
-            auto& ctx = get_right();
-            ctx.commands.wait(INFINITE);
+        d3d12::TextureContext& get_left(const bool past = false) {
+            return this->left.get(past);
+        }
 
-            return ctx;
+        d3d12::TextureContext& get_right(const bool past = false) {
+            return this->right.get(past);
         }
 
         void copy_left(ID3D12Resource* src) {
-            auto& ctx = this->acquire_left();
-            ctx.commands.copy(src, ctx.texture.Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-            ctx.commands.execute();
+            this->left.copy(src);
         }
 
         void copy_right(ID3D12Resource* src) {
-            auto& ctx = this->acquire_right();
-            ctx.commands.copy(src, ctx.texture.Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-            ctx.commands.execute();
+            this->right.copy(src);
+        }
+
+        // Every texture of both rings got created
+        bool ready() const {
+            return this->left.textures.size() == this->ring_depth && this->right.textures.size() == this->ring_depth;
         }
 
-        std::array<d3d12::TextureContext, 3> left_eye_tex{};
-        std::array<d3d12::TextureContext, 3> right_eye_tex{};
+        Eye left{};
+        Eye right{};
+        uint32_t ring_depth{3};
         uint32_t texture_counter{0};
     } m_openvr;
 
@@ -146,6 +187,7 @@ private:
 
     uint32_t m_backbuffer_size[2]{};
     bool m_backbuffer_is_8bit{false};
+    bool m_backbuffer_is_srv{false}; // the tone map pass can read it without a copy
     bool m_force_reset{false};
     bool m_crop_copy{false};
 };
@@ -1,4 +1,3 @@
-#include <glm/gtx/intersect.hpp>
 #include <imgui_internal.h>
 
 #include "../VR.hpp"
@@ -179,13 +178,13 @@ void OverlayComponent::on_post_compositor_submit() {
 }
 
 
-void OverlayComponent::on_config_save(utility::Config& cfg) {
+void OverlayComponent::on_config_save(utility::ConfigStore& cfg) {
     for (IModValue& option : m_options) {
         option.config_save(cfg);
     }
 }
 
-void OverlayComponent::on_config_load(const utility::Config& cfg, bool set_defaults) {
+void OverlayComponent::on_config_load(const utility::ConfigStore& cfg, bool set_defaults) {
     for (IModValue& option : m_options) {
         option.config_load(cfg, set_defaults);
     }
@@ -726,66 +725,82 @@ void OverlayComponent::update_overlay_openvr() {
         }
 
         // Check if the controller pointer intersects with the quad, and we can use this to emulate the mouse
-        if (vr->is_using_controllers()) {
-            // Right only for now for testing
-            const auto controller_index = !vr->m_swap_controllers->value() ? vr->get_right_controller_index() : vr->get_left_controller_index();
-            const auto right_controller_rot = glm::quat{vr->get_rotation(controller_index)};
-            const auto right_controller_pos = glm::vec3{vr->get_position(controller_index)};
-
-            const auto start = right_controller_pos;
-            auto fwd = (right_controller_rot * glm::vec3{0.0f, 0.0f, -1.0f});
-            const auto end = right_controller_pos + (fwd * 1000.0f);
-            
-            const auto plane_pos = glm::vec3{glm_matrix[3]};
+        UiHitTester::Layer hit_layer{};
+        hit_layer.shape = UiHitTester::Shape::QUAD;
+        hit_layer.transform = glm_matrix;
+        hit_layer.size = {width_meters, height_meters};
 
-            float intersection_distance = 0.0f;
+        update_hit_testing(hit_layer);
 
-            auto& intersect_state = g_framework->is_drawing_ui() ? m_framework_intersect_state : m_intersect_state;
-            auto& other_intersect_state = g_framework->is_drawing_ui() ? m_intersect_state : m_framework_intersect_state;
-            other_intersect_state.intersecting = false;
-            if (glm::intersectRayPlane<glm::vec3>(start, fwd, plane_pos, glm::normalize(glm::vec3{glm_matrix[2]}), intersection_distance)) {
-                const auto intersection_point = start + (fwd * intersection_distance);
+        auto& intersect_state = g_framework->is_drawing_ui() ? m_framework_intersect_state : m_intersect_state;
+        auto& other_intersect_state = g_framework->is_drawing_ui() ? m_intersect_state : m_framework_intersect_state;
+        const auto& hit = m_hit_tester.get_hit(get_dominant_pointer());
 
-                const auto local_point = glm::inverse(glm_matrix) * glm::vec4{intersection_point, 1.0f};
+        other_intersect_state.intersecting = false;
+        intersect_state.intersecting = vr->is_using_controllers() && hit.hovering && hit.layer == m_framework_hit_layer;
 
-                const auto w_half = width_meters / 2.0f;
-                const auto h_half = height_meters / 2.0f;
+        if (intersect_state.intersecting) {
+            intersect_state.quad_intersection_point = hit.uv;
+            intersect_state.swapchain_intersection_point = {(int32_t)(size.x * hit.uv.x), (int32_t)(size.y * hit.uv.y)};
+        }
+    } else {
+        m_hit_tester.set_layer_enabled(m_framework_hit_layer, false);
+        vr::VROverlay()->ClearOverlayTexture(m_overlay_handle);
+        vr::VROverlay()->HideOverlay(m_overlay_handle);
+    }
+}
 
-                if (local_point.x >= -w_half && local_point.x <= w_half && local_point.y >= -h_half && local_point.y <= h_half) {
-                    const auto x = (local_point.x + w_half) / width_meters;
-                    const auto y = (height_meters - (local_point.y + h_half)) / height_meters;
+UiHitTester::Pointer OverlayComponent::get_dominant_pointer() const {
+    // Right only for now, matches the controller used for clicking
+    return !VR::get()->m_swap_controllers->value() ? UiHitTester::Pointer::RIGHT_HAND : UiHitTester::Pointer::LEFT_HAND;
+}
 
-                    intersect_state.quad_intersection_point = {x, y};
-                    intersect_state.intersecting = true;
+void OverlayComponent::update_hit_testing(const UiHitTester::Layer& framework_layer) {
+    auto& vr = VR::get();
 
-                    /*if (auto it = vr->m_openxr->swapchains.find((uint32_t)runtimes::OpenXR::SwapchainIndex::FRAMEWORK_UI); it != vr->m_openxr->swapchains.end()) {
-                        const auto client_x = (int32_t)((float)it->second.width * x);
-                        const auto client_y = (int32_t)((float)it->second.height * y);
+    if (m_framework_hit_layer == UiHitTester::INVALID_LAYER) {
+        m_framework_hit_layer = m_hit_tester.add_layer(framework_layer);
+    } else {
+        m_hit_tester.update_layer(m_framework_hit_layer, framework_layer);
+        m_hit_tester.set_layer_enabled(m_framework_hit_layer, true);
+    }
 
-                        intersect_state.swapchain_intersection_point = {client_x, client_y};
-                    }*/
-                    // Change to openvr version
-                    const auto client_x = (int32_t)(size.x * x);
-                    const auto client_y = (int32_t)(size.y * y);
+    const auto make_ray = [&](int index) {
+        UiHitTester::Ray ray{};
 
-                    intersect_state.swapchain_intersection_point = {client_x, client_y};
-                } else {
-                    intersect_state.intersecting = false;
-                }
-            }
-        } else {
-            m_framework_intersect_state.intersecting = false;
-            m_intersect_state.intersecting = false;
+        if (index < 0) {
+            return ray;
         }
-    } else {
-        vr::VROverlay()->ClearOverlayTexture(m_overlay_handle);
-        vr::VROverlay()->HideOverlay(m_overlay_handle);
+
+        const auto rotation = glm::quat{vr->get_rotation(index)};
+
+        ray.origin = glm::vec3{vr->get_position(index)};
+        ray.direction = rotation * glm::vec3{0.0f, 0.0f, -1.0f};
+        ray.valid = true;
+
+        return ray;
+    };
+
+    std::array<UiHitTester::Ray, (size_t)UiHitTester::Pointer::COUNT> rays{};
+    std::array<bool, (size_t)UiHitTester::Pointer::COUNT> pressed{};
+
+    if (vr->is_using_controllers()) {
+        rays[(size_t)UiHitTester::Pointer::LEFT_HAND] = make_ray(vr->get_left_controller_index());
+        rays[(size_t)UiHitTester::Pointer::RIGHT_HAND] = make_ray(vr->get_right_controller_index());
+
+        const auto& a_button = !vr->m_swap_controllers->value() ? VR::s_action_a_button_right : VR::s_action_a_button_left;
+        pressed[(size_t)get_dominant_pointer()] = vr->is_action_active_any_joystick(vr->get_action_handle(a_button));
     }
+
+    rays[(size_t)UiHitTester::Pointer::HEAD] = make_ray(vr::k_unTrackedDeviceIndex_Hmd);
+
+    m_hit_tester.update(rays, pressed);
 }
 
 std::optional<std::reference_wrapper<XrCompositionLayerQuad>> OverlayComponent::OpenXR::generate_framework_ui_quad() {
     if (!g_framework->is_drawing_ui()) {
         m_parent->m_framework_intersect_state.intersecting = false;
+        m_parent->m_hit_tester.set_layer_enabled(m_parent->m_framework_hit_layer, false);
         return std::nullopt;
     }
 
@@ -839,46 +854,27 @@ std::optional<std::reference_wrapper<XrCompositionLayerQuad>> OverlayComponent::
     layer.pose.position = runtimes::OpenXR::to_openxr(glm_matrix[3]);
 
     // Check if the controller pointer intersects with the quad, and we can use this to emulate the mouse
-    if (vr->is_using_controllers()) {
-        // Right only for now for testing
-        const auto controller_index = !vr->m_swap_controllers->value() ? vr->get_right_controller_index() : vr->get_left_controller_index();
-        const auto right_controller_rot = glm::quat{vr->get_rotation(controller_index)};
-        const auto right_controller_pos = glm::vec3{vr->get_position(controller_index)};
-
-        const auto start = right_controller_pos;
-        auto fwd = (right_controller_rot * glm::vec3{0.0f, 0.0f, -1.0f});
-        const auto end = right_controller_pos + (fwd * 1000.0f);
-        
-        const auto plane_pos = glm::vec3{glm_matrix[3]};
+    UiHitTester::Layer hit_layer{};
+    hit_layer.shape = UiHitTester::Shape::QUAD;
+    hit_layer.transform = glm_matrix;
+    hit_layer.size = {meters_w, meters_h};
 
-        float intersection_distance = 0.0f;
-        if (glm::intersectRayPlane<glm::vec3>(start, fwd, plane_pos, glm::normalize(glm::vec3{glm_matrix[2]}), intersection_distance)) {
-            const auto intersection_point = start + (fwd * intersection_distance);
+    m_parent->update_hit_testing(hit_layer);
 
-            const auto local_point = glm::inverse(glm_matrix) * glm::vec4{intersection_point, 1.0f};
+    auto& state = m_parent->m_framework_intersect_state;
+    const auto& hit = m_parent->m_hit_tester.get_hit(m_parent->get_dominant_pointer());
 
-            const auto w_half = meters_w / 2.0f;
-            const auto h_half = meters_h / 2.0f;
+    state.intersecting = vr->is_using_controllers() && hit.hovering && hit.layer == m_parent->m_framework_hit_layer;
 
-            if (local_point.x >= -w_half && local_point.x <= w_half && local_point.y >= -h_half && local_point.y <= h_half) {
-                const auto x = (local_point.x + w_half) / meters_w;
-                const auto y = (meters_h - (local_point.y + h_half)) / meters_h;
+    if (state.intersecting) {
+        state.quad_intersection_point = hit.uv;
 
-                m_parent->m_framework_intersect_state.quad_intersection_point = {x, y};
-                m_parent->m_framework_intersect_state.intersecting = true;
+        if (ui_swapchain.handle) {
+            const auto client_x = (int32_t)((float)ui_swapchain.width * hit.uv.x);
+            const auto client_y = (int32_t)((float)ui_swapchain.height * hit.uv.y);
 
-                if (ui_swapchain.handle) {
-                    const auto client_x = (int32_t)((float)ui_swapchain.width * x);
-                    const auto client_y = (int32_t)((float)ui_swapchain.height * y);
-
-                    m_parent->m_framework_intersect_state.swapchain_intersection_point = {client_x, client_y};
-                }
-            } else {
-                m_parent->m_framework_intersect_state.intersecting = false;
-            }
+            state.swapchain_intersection_point = {client_x, client_y};
         }
-    } else {
-        m_parent->m_framework_intersect_state.intersecting = false;
     }
 
     return layer;
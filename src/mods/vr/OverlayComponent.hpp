@@ -6,6 +6,7 @@
 #include <string>
 
 #include "Mod.hpp"
+#include "UiHitTester.hpp"
 
 #include "imgui.h"
 
@@ -21,8 +22,8 @@ public:
     void on_pre_imgui_frame() override;
     void on_post_compositor_submit();
 
-    void on_config_save(utility::Config& cfg) override;
-    void on_config_load(const utility::Config& cfg, bool set_defaults)  override;
+    void on_config_save(utility::ConfigStore& cfg) override;
+    void on_config_load(const utility::ConfigStore& cfg, bool set_defaults)  override;
     void on_draw_ui() override;
 
     auto& get_openxr() {
@@ -87,6 +88,9 @@ private:
     IntersectState m_intersect_state{};
     IntersectState m_framework_intersect_state{};
 
+    UiHitTester m_hit_tester{};
+    UiHitTester::LayerId m_framework_hit_layer{UiHitTester::INVALID_LAYER};
+
     enum OverlayType {
         DEFAULT = 0,
         QUAD = 0,
@@ -162,4 +166,7 @@ private:
     void update_input_mouse_emulation();
     void update_overlay_openvr();
     bool update_wrist_overlay_openvr();
+
+    UiHitTester::Pointer get_dominant_pointer() const;
+    void update_hit_testing(const UiHitTester::Layer& framework_layer);
 };}
\ No newline at end of file
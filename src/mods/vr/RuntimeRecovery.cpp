@@ -0,0 +1,139 @@
+#include <spdlog/spdlog.h>
+
+#include "RuntimeRecovery.hpp"
+
+namespace vrmod {
+void RuntimeRecovery::request(Stage stage, clock::time_point now) {
+    const auto resolved = resolve(stage);
+
+    if (resolved == Stage::NONE) {
+        if (stage != Stage::NONE) {
+            spdlog::warn("[VR] No recovery handler for stage {}", to_string(stage));
+        }
+
+        return;
+    }
+
+    if (!is_recovering()) {
+        spdlog::info("[VR] Starting runtime recovery at {}", to_string(resolved));
+
+        m_stage = resolved;
+        m_attempts = 0;
+        m_started = now;
+        m_next_attempt = now;
+        return;
+    }
+
+    if (resolved > m_stage) {
+        spdlog::info("[VR] Runtime recovery escalated by request {} -> {}", to_string(m_stage), to_string(resolved));
+
+        m_stage = resolved;
+        m_attempts = 0;
+        m_next_attempt = now;
+    }
+}
+
+bool RuntimeRecovery::update(clock::time_point now) {
+    if (!is_recovering() || now < m_next_attempt) {
+        return false;
+    }
+
+    const auto stage = m_stage;
+    auto& handler = m_handlers[(size_t)stage];
+
+    ++m_attempts;
+    ++m_metrics.attempts;
+
+    // Recreating a session takes a while, that's part of the recovery time and pushes the next attempt out
+    const auto handler_start = clock::now();
+    const auto recovered = handler != nullptr && handler();
+    now += clock::now() - handler_start;
+
+    // The handler may have requested a higher stage while running.
+    if (m_stage != stage) {
+        return true;
+    }
+
+    if (recovered) {
+        spdlog::info("[VR] Runtime recovered at {} after {} attempt(s)", to_string(stage), m_attempts);
+
+        ++m_metrics.resolved_at[(size_t)stage];
+        finish(now, true);
+        return true;
+    }
+
+    if (m_attempts < m_max_attempts) {
+        spdlog::warn("[VR] Recovery attempt {} at {} failed, retrying", m_attempts, to_string(stage));
+
+        // linear backoff, the runtime may just need a moment
+        m_next_attempt = now + m_retry_delay * m_attempts;
+        return true;
+    }
+
+    const auto next = resolve((Stage)((uint8_t)stage + 1));
+
+    if (next == Stage::NONE) {
+        spdlog::error("[VR] Runtime recovery failed, {} exhausted", to_string(stage));
+
+        finish(now, false);
+        return true;
+    }
+
+    spdlog::warn("[VR] Escalating runtime recovery {} -> {}", to_string(stage), to_string(next));
+
+    m_stage = next;
+    m_attempts = 0;
+    m_next_attempt = now;
+    return true;
+}
+
+void RuntimeRecovery::cancel() {
+    m_stage = Stage::NONE;
+    m_attempts = 0;
+}
+
+std::string_view RuntimeRecovery::to_string(Stage stage) {
+    switch (stage) {
+    case Stage::NONE:
+        return "None";
+    case Stage::RESYNC_ACTIONS:
+        return "ResyncActions";
+    case Stage::RECREATE_SWAPCHAINS:
+        return "RecreateSwapchains";
+    case Stage::RECREATE_SESSION:
+        return "RecreateSession";
+    case Stage::REINITIALIZE:
+        return "Reinitialize";
+    default:
+        return "Unknown";
+    }
+}
+
+RuntimeRecovery::Stage RuntimeRecovery::resolve(Stage stage) const {
+    for (auto i = (size_t)stage; i < (size_t)Stage::COUNT; ++i) {
+        if (i != (size_t)Stage::NONE && m_handlers[i] != nullptr) {
+            return (Stage)i;
+        }
+    }
+
+    return Stage::NONE;
+}
+
+void RuntimeRecovery::finish(clock::time_point now, bool recovered) {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_started);
+
+    if (recovered) {
+        ++m_metrics.recoveries;
+    } else {
+        ++m_metrics.failures;
+    }
+
+    m_metrics.last_stage = m_stage;
+    m_metrics.last_recovery_time = elapsed;
+    m_metrics.max_recovery_time = std::max(m_metrics.max_recovery_time, elapsed);
+    m_metrics.total_recovery_time += elapsed;
+
+    m_stage = Stage::NONE;
+    m_attempts = 0;
+}
+} // namespace vrmod
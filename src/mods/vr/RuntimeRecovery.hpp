@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace vrmod {
+// Staged recovery for VR runtime faults.
+// A fault requests the cheapest stage that can fix it. A stage gets a few attempts
+// before we escalate to the next, more expensive one, so a transient hiccup
+// no longer tears down the whole session.
+// Doesn't touch any runtime API itself, the VR mod installs a handler per stage.
+class RuntimeRecovery {
+public:
+    using clock = std::chrono::steady_clock;
+
+    enum class Stage : uint8_t {
+        NONE,
+        RESYNC_ACTIONS,      // re-sync input, keep everything else
+        RECREATE_SWAPCHAINS, // keep the session, rebuild swapchains/eye textures
+        RECREATE_SESSION,    // keep the instance, rebuild session, spaces, action bindings and swapchains
+        REINITIALIZE,        // full teardown
+        COUNT
+    };
+
+    // Returns true if the stage brought the runtime back.
+    using StageHandler = std::function<bool()>;
+
+    struct Metrics {
+        uint32_t recoveries{0};
+        uint32_t failures{0};
+        uint32_t attempts{0};
+        std::array<uint32_t, (size_t)Stage::COUNT> resolved_at{};
+        Stage last_stage{Stage::NONE};
+        std::chrono::nanoseconds last_recovery_time{};
+        std::chrono::nanoseconds max_recovery_time{};
+        std::chrono::nanoseconds total_recovery_time{};
+    };
+
+    void set_handler(Stage stage, StageHandler handler) {
+        m_handlers[(size_t)stage] = std::move(handler);
+    }
+
+    void clear_handlers() {
+        m_handlers = {};
+    }
+
+    void set_max_attempts(uint32_t attempts) {
+        m_max_attempts = attempts > 0 ? attempts : 1;
+    }
+
+    void set_retry_delay(clock::duration delay) {
+        m_retry_delay = delay;
+    }
+
+    // Requests recovery starting at (at least) the given stage.
+    // Requests for a stage below the one in progress are ignored.
+    void request(Stage stage, clock::time_point now = clock::now());
+
+    // Runs at most one attempt. Returns true if a handler was invoked.
+    // Time spent in the handler counts from `now` on, for the metrics and the retry delay.
+    bool update(clock::time_point now = clock::now());
+
+    void cancel();
+
+    bool is_recovering() const {
+        return m_stage != Stage::NONE;
+    }
+
+    Stage get_stage() const {
+        return m_stage;
+    }
+
+    uint32_t get_attempts() const {
+        return m_attempts;
+    }
+
+    const Metrics& get_metrics() const {
+        return m_metrics;
+    }
+
+    static std::string_view to_string(Stage stage);
+
+private:
+    // First stage >= stage that has a handler, NONE if there isn't one.
+    Stage resolve(Stage stage) const;
+    void finish(clock::time_point now, bool recovered);
+
+    std::array<StageHandler, (size_t)Stage::COUNT> m_handlers{};
+    Metrics m_metrics{};
+
+    Stage m_stage{Stage::NONE};
+    uint32_t m_attempts{0};
+    uint32_t m_max_attempts{3};
+    clock::duration m_retry_delay{std::chrono::milliseconds(100)};
+    clock::time_point m_started{};
+    clock::time_point m_next_attempt{};
+};
+} // namespace vrmod
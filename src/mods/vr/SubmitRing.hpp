@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace vrmod {
+// Picks which of N eye textures the next frame gets copied into before it's handed to the compositor.
+// A slot is free once the GPU is done with the copy last recorded into it (its fence value completed).
+// Among free slots the least recently submitted one wins, so every image stays untouched for as long
+// as possible after the compositor got it. The most recent submission is never handed out while the
+// ring has more than one slot, AER still resubmits it on the next frame.
+// When nothing is free the ring starves: the least recently submitted slot is returned anyway and the
+// caller has to wait on its fence.
+// Doesn't touch D3D, completion is asked for through `is_complete(index, fence_value)`.
+template <typename Payload>
+class SubmitRing {
+public:
+    struct Slot {
+        uint64_t fence_value{0};
+        uint64_t sequence{0}; // 0 = never submitted
+        Payload payload{};
+    };
+
+    struct Acquisition {
+        uint32_t index{0};
+        bool starved{false};
+    };
+
+    struct Stats {
+        uint64_t acquires{};
+        uint64_t starved{};
+        double total_wait_ms{};
+        double max_wait_ms{};
+    };
+
+    void resize(size_t depth) {
+        m_slots.assign(depth > 0 ? depth : 1, Slot{});
+        m_sequence = 0;
+        m_last_submitted.reset();
+        m_stats = {};
+    }
+
+    size_t size() const {
+        return m_slots.size();
+    }
+
+    template <typename IsComplete>
+    Acquisition acquire(IsComplete&& is_complete) {
+        ++m_stats.acquires;
+
+        std::optional<uint32_t> best_free{};
+        std::optional<uint32_t> oldest{};
+
+        for (uint32_t i = 0; i < (uint32_t)m_slots.size(); ++i) {
+            if (m_slots.size() > 1 && m_last_submitted == i) {
+                continue;
+            }
+
+            const auto& slot = m_slots[i];
+
+            if (!oldest || slot.sequence < m_slots[*oldest].sequence) {
+                oldest = i;
+            }
+
+            if (slot.sequence != 0 && !is_complete(i, slot.fence_value)) {
+                continue;
+            }
+
+            if (!best_free || slot.sequence < m_slots[*best_free].sequence) {
+                best_free = i;
+            }
+        }
+
+        if (best_free) {
+            return {*best_free, false};
+        }
+
+        ++m_stats.starved;
+        return {oldest.value_or(0), true};
+    }
+
+    // How long the caller blocked on a starved acquisition.
+    void record_wait(double ms) {
+        m_stats.total_wait_ms += ms;
+
+        if (ms > m_stats.max_wait_ms) {
+            m_stats.max_wait_ms = ms;
+        }
+    }
+
+    // `fence_value` is what the slot's copy signals when done, `payload` what was submitted with it (e.g. the pose).
+    void submit(uint32_t index, uint64_t fence_value, const Payload& payload) {
+        auto& slot = m_slots[index];
+        slot.fence_value = fence_value;
+        slot.sequence = ++m_sequence;
+        slot.payload = payload;
+
+        m_last_submitted = index;
+    }
+
+    std::optional<uint32_t> last_submitted() const {
+        return m_last_submitted;
+    }
+
+    const Slot& slot(uint32_t index) const {
+        return m_slots[index];
+    }
+
+    const Stats& get_stats() const {
+        return m_stats;
+    }
+
+private:
+    std::vector<Slot> m_slots{1};
+    uint64_t m_sequence{0};
+    std::optional<uint32_t> m_last_submitted{};
+    Stats m_stats{};
+};
+} // namespace vrmod
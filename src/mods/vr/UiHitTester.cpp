@@ -0,0 +1,251 @@
+#include <algorithm>
+
+#include "UiHitTester.hpp"
+
+namespace vrmod {
+UiHitTester::LayerId UiHitTester::add_layer(const Layer& layer) {
+    Entry entry{};
+    entry.id = m_next_id++;
+    entry.layer = layer;
+    update_bounds(entry);
+
+    m_layers.push_back(entry);
+    return entry.id;
+}
+
+bool UiHitTester::update_layer(LayerId id, const Layer& layer) {
+    auto entry = find(id);
+
+    if (entry == nullptr) {
+        return false;
+    }
+
+    entry->layer = layer;
+    update_bounds(*entry);
+    return true;
+}
+
+void UiHitTester::set_layer_enabled(LayerId id, bool enabled) {
+    if (auto entry = find(id); entry != nullptr) {
+        entry->layer.enabled = enabled;
+    }
+}
+
+void UiHitTester::remove_layer(LayerId id) {
+    std::erase_if(m_layers, [id](const Entry& e) { return e.id == id; });
+}
+
+void UiHitTester::update(const std::array<Ray, (size_t)Pointer::COUNT>& rays, const std::array<bool, (size_t)Pointer::COUNT>& pressed) {
+    m_stats = {};
+
+    for (size_t i = 0; i < (size_t)Pointer::COUNT; ++i) {
+        const auto prev = m_hits[i];
+        const auto& in_ray = rays[i];
+
+        std::optional<Hit> best{};
+
+        if (in_ray.valid && glm::length(in_ray.direction) > 0.0f) {
+            const Ray ray{in_ray.origin, glm::normalize(in_ray.direction), true};
+            // Captured through the frame it's released on, so the release goes where the press did
+            const auto captured = prev.pressed ? find_enabled(prev.layer) : nullptr;
+
+            if (captured != nullptr) {
+                // Dragging: only the layer the press started on can receive it
+                best = intersect(*captured, ray);
+            } else {
+                // Last frame's layer is the most likely hit, testing it first gives
+                // the bounding sphere pass a tight distance to reject everything behind it
+                if (auto last = find_enabled(prev.layer); last != nullptr) {
+                    best = intersect(*last, ray);
+                }
+
+                for (const auto& entry : m_layers) {
+                    if (!entry.layer.enabled || entry.id == prev.layer) {
+                        continue;
+                    }
+
+                    ++m_stats.sphere_tests;
+
+                    const auto to_center = entry.bounds_center - ray.origin;
+                    const auto along = glm::dot(to_center, ray.direction);
+                    const auto dist_sq = glm::dot(to_center, to_center) - along * along;
+                    const auto radius_sq = entry.bounds_radius * entry.bounds_radius;
+
+                    if (dist_sq > radius_sq || along + entry.bounds_radius < 0.0f) {
+                        continue;
+                    }
+
+                    if (best && along - entry.bounds_radius > best->distance) {
+                        continue;
+                    }
+
+                    if (auto hit = intersect(entry, ray); hit && (!best || hit->distance < best->distance)) {
+                        best = hit;
+                    }
+                }
+            }
+
+            if (!best && captured != nullptr) {
+                // Keep reporting the pressed layer so the release lands where the press did
+                best = prev;
+                best->hovering = false;
+            }
+        }
+
+        Hit hit = best.value_or(Hit{});
+        hit.hovering = best.has_value() && best->hovering;
+
+        // A press only starts on the rising edge while over a layer, holding the button
+        // and sweeping onto a layer doesn't count as a click.
+        if (prev.pressed) {
+            hit.pressed = pressed[i] && hit.layer != INVALID_LAYER;
+        } else {
+            hit.pressed = pressed[i] && !m_was_down[i] && hit.hovering;
+        }
+
+        hit.just_entered = hit.hovering && (!prev.hovering || prev.layer != hit.layer);
+        hit.just_left = prev.hovering && (!hit.hovering || prev.layer != hit.layer);
+        hit.just_pressed = hit.pressed && !prev.pressed;
+        hit.just_released = prev.pressed && !hit.pressed;
+
+        if (hit.just_released && hit.layer == INVALID_LAYER) {
+            hit.layer = prev.layer;
+            hit.uv = prev.uv;
+        }
+
+        m_hits[i] = hit;
+        m_was_down[i] = pressed[i];
+    }
+}
+
+std::optional<UiHitTester::Hit> UiHitTester::intersect_quad(const Layer& layer, const glm::mat4& inverse, const Ray& ray) {
+    const auto origin = glm::vec3{inverse * glm::vec4{ray.origin, 1.0f}};
+    const auto direction = glm::vec3{inverse * glm::vec4{ray.direction, 0.0f}};
+
+    // Only the front face (+Z) is hit, like the ray-plane test this replaced. A layer seen from
+    // behind isn't drawn by the runtime and must not catch clicks meant for what's behind it.
+    if (direction.z > -1e-6f) {
+        return std::nullopt;
+    }
+
+    // Same parameter in layer and world space since the direction was transformed linearly
+    const auto t = -origin.z / direction.z;
+
+    if (t <= 0.0f) {
+        return std::nullopt;
+    }
+
+    const auto local = origin + direction * t;
+    const auto half = layer.size * 0.5f;
+
+    if (local.x < -half.x || local.x > half.x || local.y < -half.y || local.y > half.y) {
+        return std::nullopt;
+    }
+
+    Hit hit{};
+    hit.uv = {(local.x + half.x) / layer.size.x, (half.y - local.y) / layer.size.y};
+    hit.point = ray.origin + ray.direction * t;
+    hit.distance = t;
+    hit.hovering = true;
+
+    return hit;
+}
+
+std::optional<UiHitTester::Hit> UiHitTester::intersect_cylinder(const Layer& layer, const glm::mat4& inverse, const Ray& ray) {
+    const auto origin = glm::vec3{inverse * glm::vec4{ray.origin, 1.0f}};
+    const auto direction = glm::vec3{inverse * glm::vec4{ray.direction, 0.0f}};
+
+    const auto a = direction.x * direction.x + direction.z * direction.z;
+
+    if (a < 1e-8f) {
+        return std::nullopt;
+    }
+
+    const auto b = 2.0f * (origin.x * direction.x + origin.z * direction.z);
+    const auto c = origin.x * origin.x + origin.z * origin.z - layer.radius * layer.radius;
+    const auto disc = b * b - 4.0f * a * c;
+
+    if (disc < 0.0f) {
+        return std::nullopt;
+    }
+
+    const auto sqrt_disc = glm::sqrt(disc);
+    const float roots[2]{(-b - sqrt_disc) / (2.0f * a), (-b + sqrt_disc) / (2.0f * a)};
+
+    const auto half_angle = layer.central_angle * 0.5f;
+    const auto height = layer.radius * layer.central_angle / std::max(layer.aspect_ratio, 1e-6f);
+    const auto half_height = height * 0.5f;
+
+    for (const auto t : roots) {
+        if (t <= 0.0f) {
+            continue;
+        }
+
+        const auto local = origin + direction * t;
+
+        // The visible side faces the axis, so only hits with the ray heading away from it count
+        if (local.x * direction.x + local.z * direction.z <= 0.0f) {
+            continue;
+        }
+
+        const auto angle = glm::atan(local.x, -local.z); // 0 at -Z, positive towards +X
+
+        if (glm::abs(angle) > half_angle || glm::abs(local.y) > half_height) {
+            continue;
+        }
+
+        Hit hit{};
+        hit.uv = {(angle + half_angle) / layer.central_angle, (half_height - local.y) / height};
+        hit.point = ray.origin + ray.direction * t;
+        hit.distance = t;
+        hit.hovering = true;
+
+        return hit;
+    }
+
+    return std::nullopt;
+}
+
+void UiHitTester::update_bounds(Entry& entry) {
+    const auto& layer = entry.layer;
+    const auto& m = layer.transform;
+
+    entry.inverse = glm::inverse(m);
+    entry.bounds_center = glm::vec3{m[3]};
+
+    const auto scale = std::max({glm::length(glm::vec3{m[0]}), glm::length(glm::vec3{m[1]}), glm::length(glm::vec3{m[2]})});
+
+    if (layer.shape == Shape::QUAD) {
+        entry.bounds_radius = glm::length(layer.size * 0.5f) * scale;
+    } else {
+        const auto half_height = layer.radius * layer.central_angle / std::max(layer.aspect_ratio, 1e-6f) * 0.5f;
+        entry.bounds_radius = glm::sqrt(layer.radius * layer.radius + half_height * half_height) * scale;
+    }
+}
+
+UiHitTester::Entry* UiHitTester::find(LayerId id) {
+    if (id == INVALID_LAYER) {
+        return nullptr;
+    }
+
+    const auto it = std::find_if(m_layers.begin(), m_layers.end(), [id](const Entry& e) { return e.id == id; });
+    return it != m_layers.end() ? &*it : nullptr;
+}
+
+UiHitTester::Entry* UiHitTester::find_enabled(LayerId id) {
+    const auto entry = find(id);
+    return entry != nullptr && entry->layer.enabled ? entry : nullptr;
+}
+
+std::optional<UiHitTester::Hit> UiHitTester::intersect(const Entry& entry, const Ray& ray) {
+    ++m_stats.exact_tests;
+
+    auto hit = entry.layer.shape == Shape::QUAD ? intersect_quad(entry.layer, entry.inverse, ray) : intersect_cylinder(entry.layer, entry.inverse, ray);
+
+    if (hit) {
+        hit->layer = entry.id;
+    }
+
+    return hit;
+}
+} // namespace vrmod
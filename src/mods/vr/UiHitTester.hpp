@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <math/Math.hpp>
+
+namespace vrmod {
+// Ray vs UI layer hit testing for mouse emulation and pointers.
+// Layers are flat quads or cylinder sections (as in XrCompositionLayerCylinderKHR),
+// placed by a world transform, and are only hit from their visible side.
+// Every layer keeps a bounding sphere so a pointer only runs the exact test against layers it
+// can actually reach and beat the current best hit. The sphere test still runs for every
+// enabled layer, so the cost per pointer grows with the layer count, just cheaply.
+class UiHitTester {
+public:
+    enum class Pointer : uint8_t {
+        LEFT_HAND,
+        RIGHT_HAND,
+        HEAD,
+        COUNT
+    };
+
+    enum class Shape : uint8_t {
+        QUAD,
+        CYLINDER
+    };
+
+    using LayerId = uint32_t;
+    static constexpr LayerId INVALID_LAYER = 0;
+
+    struct Layer {
+        Shape shape{Shape::QUAD};
+        // Layer space -> world. Quads lie in local XY facing +Z,
+        // cylinders are centered on the origin around local Y with the visible arc at -Z.
+        glm::mat4 transform{1.0f};
+        glm::vec2 size{1.0f, 1.0f}; // quad width/height in meters
+        float radius{1.0f};         // cylinder only
+        float central_angle{glm::half_pi<float>()};
+        float aspect_ratio{1.0f};   // cylinder only, arc length / height
+        bool enabled{true};
+    };
+
+    struct Ray {
+        glm::vec3 origin{};
+        glm::vec3 direction{0.0f, 0.0f, -1.0f};
+        bool valid{false};
+    };
+
+    struct Hit {
+        LayerId layer{INVALID_LAYER};
+        glm::vec2 uv{};             // top left origin
+        glm::vec3 point{};
+        float distance{};
+
+        bool hovering{false};
+        bool pressed{false};
+        bool just_entered{false};
+        bool just_left{false};
+        bool just_pressed{false};
+        bool just_released{false};
+    };
+
+    struct Stats {
+        uint32_t sphere_tests{};
+        uint32_t exact_tests{};
+    };
+
+    LayerId add_layer(const Layer& layer);
+    bool update_layer(LayerId id, const Layer& layer);
+    void set_layer_enabled(LayerId id, bool enabled);
+    void remove_layer(LayerId id);
+
+    // Call once per frame. Press state is per pointer, a pressed pointer stays captured
+    // by the layer it pressed on until it's released.
+    void update(const std::array<Ray, (size_t)Pointer::COUNT>& rays, const std::array<bool, (size_t)Pointer::COUNT>& pressed);
+
+    const Hit& get_hit(Pointer pointer) const {
+        return m_hits[(size_t)pointer];
+    }
+
+    const Stats& get_last_stats() const {
+        return m_stats;
+    }
+
+    // Exact tests, exposed for reuse, nullopt on a miss.
+    static std::optional<Hit> intersect_quad(const Layer& layer, const glm::mat4& inverse, const Ray& ray);
+    static std::optional<Hit> intersect_cylinder(const Layer& layer, const glm::mat4& inverse, const Ray& ray);
+
+private:
+    struct Entry {
+        LayerId id{INVALID_LAYER};
+        Layer layer{};
+        glm::mat4 inverse{1.0f};
+        glm::vec3 bounds_center{};
+        float bounds_radius{};
+    };
+
+    static void update_bounds(Entry& entry);
+    Entry* find(LayerId id);
+    Entry* find_enabled(LayerId id);
+
+    std::optional<Hit> intersect(const Entry& entry, const Ray& ray);
+
+    std::vector<Entry> m_layers{};
+    std::array<Hit, (size_t)Pointer::COUNT> m_hits{};
+    std::array<bool, (size_t)Pointer::COUNT> m_was_down{};
+    Stats m_stats{};
+    LayerId m_next_id{1};
+};
+} // namespace vrmod
@@ -0,0 +1,169 @@
+#include <spdlog/spdlog.h>
+
+#include <../../../_deps/directxtk12-src/Src/d3dx12.h>
+
+#include "ToneMapPass.hpp"
+
+#ifdef COMPILE_SHADERS
+namespace shaders::tonemap {
+    #include "debug_layer_vs.h"
+    #include "tonemap_ps.h"
+}
+#endif
+
+namespace d3d12 {
+namespace {
+    constexpr uint32_t CONSTANTS_COUNT = sizeof(utility::tonemap::Constants) / 4;
+}
+
+bool ToneMapPass::setup(ID3D12Device* device, DXGI_FORMAT output_format) {
+    reset();
+
+#ifdef COMPILE_SHADERS
+    spdlog::info("[ToneMap] Setting up tone map pass");
+
+    this->device = device;
+
+    CD3DX12_DESCRIPTOR_RANGE1 descriptor_range[1];
+    CD3DX12_ROOT_PARAMETER1 root_params[2];
+
+    descriptor_range[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 0);
+    root_params[0].InitAsDescriptorTable(1, &descriptor_range[0], D3D12_SHADER_VISIBILITY_PIXEL);
+    root_params[1].InitAsConstants(CONSTANTS_COUNT, 0, 0, D3D12_SHADER_VISIBILITY_PIXEL);
+
+    const D3D12_ROOT_SIGNATURE_FLAGS root_signature_flags = D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS | D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS
+                                                            | D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS;
+
+    CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC root_signature_desc;
+    root_signature_desc.Init_1_1(_countof(root_params), root_params, 0, nullptr, root_signature_flags);
+
+    ComPtr<ID3DBlob> signature{};
+    ComPtr<ID3DBlob> error{};
+
+    if (FAILED(D3DX12SerializeVersionedRootSignature(&root_signature_desc, D3D_ROOT_SIGNATURE_VERSION_1_1, signature.GetAddressOf(), error.GetAddressOf()))) {
+        if (error) {
+            spdlog::error("[ToneMap] Error: D3DX12SerializeVersionedRootSignature {}", static_cast<char*>(error->GetBufferPointer()));
+        }
+
+        reset();
+        return false;
+    }
+
+    if (FAILED(device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(this->root_signature.GetAddressOf())))) {
+        spdlog::error("[ToneMap] Error: CreateRootSignature failed");
+        reset();
+        return false;
+    }
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC pso_desc{};
+    pso_desc.InputLayout = {};
+    pso_desc.pRootSignature = this->root_signature.Get();
+    pso_desc.VS = CD3DX12_SHADER_BYTECODE(&shaders::tonemap::g_vs_main, sizeof(shaders::tonemap::g_vs_main));
+    pso_desc.PS = CD3DX12_SHADER_BYTECODE(&shaders::tonemap::g_ps_main, sizeof(shaders::tonemap::g_ps_main));
+    pso_desc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+    pso_desc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
+    pso_desc.DepthStencilState.DepthEnable = false;
+    pso_desc.SampleMask = UINT_MAX;
+    pso_desc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+    pso_desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    pso_desc.NumRenderTargets = 1;
+    pso_desc.RTVFormats[0] = output_format;
+    pso_desc.DSVFormat = DXGI_FORMAT_UNKNOWN;
+    pso_desc.SampleDesc.Count = 1;
+    pso_desc.SampleDesc.Quality = 0;
+
+    if (FAILED(device->CreateGraphicsPipelineState(&pso_desc, IID_PPV_ARGS(this->pso.GetAddressOf())))) {
+        spdlog::error("[ToneMap] Error: CreateGraphicsPipelineState failed");
+        reset();
+        return false;
+    }
+
+    try {
+        this->srv_heap = std::make_unique<DirectX::DescriptorHeap>(device,
+            D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
+            D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE,
+            SRV_COUNT);
+    } catch(...) {
+        spdlog::error("[ToneMap] Failed to create SRV descriptor heap");
+        reset();
+        return false;
+    }
+
+    spdlog::info("[ToneMap] Tone map pass ready");
+    return true;
+#else
+    spdlog::info("[ToneMap] Built without shaders, using SpriteBatch for HDR conversion");
+    return false;
+#endif
+}
+
+void ToneMapPass::reset() {
+    this->pso.Reset();
+    this->root_signature.Reset();
+    this->srv_heap.reset();
+    this->srv_sources.fill(nullptr);
+    this->next_srv = 0;
+    this->device.Reset();
+}
+
+uint32_t ToneMapPass::get_srv(ID3D12Resource* src) {
+    for (uint32_t i = 0; i < SRV_COUNT; ++i) {
+        if (this->srv_sources[i] == src) {
+            return i;
+        }
+    }
+
+    // Normally only the swapchain buffers (or the one copy of them) come through here, so slots
+    // get reused round robin only after a resize, and on_reset clears them before that anyway.
+    const auto index = this->next_srv;
+    this->next_srv = (this->next_srv + 1) % SRV_COUNT;
+
+    this->device->CreateShaderResourceView(src, nullptr, this->srv_heap->GetCpuHandle(index));
+    this->srv_sources[index] = src;
+
+    return index;
+}
+
+void ToneMapPass::draw(ID3D12GraphicsCommandList* cmd_list, ID3D12Resource* src, D3D12_RESOURCE_STATES src_state, const TextureContext& dst, D3D12_RESOURCE_STATES dst_state,
+    const utility::tonemap::Constants& constants)
+{
+    const auto dst_desc = dst.texture->GetDesc();
+    const auto srv = get_srv(src);
+
+    D3D12_RESOURCE_BARRIER barriers[]{
+        CD3DX12_RESOURCE_BARRIER::Transition(dst.texture.Get(), dst_state, D3D12_RESOURCE_STATE_RENDER_TARGET),
+        CD3DX12_RESOURCE_BARRIER::Transition(src, src_state, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE)
+    };
+    cmd_list->ResourceBarrier(2, barriers);
+
+    D3D12_VIEWPORT viewport{};
+    viewport.Width = (float)dst_desc.Width;
+    viewport.Height = (float)dst_desc.Height;
+    viewport.MinDepth = D3D12_MIN_DEPTH;
+    viewport.MaxDepth = D3D12_MAX_DEPTH;
+
+    D3D12_RECT scissor_rect{0, 0, (LONG)dst_desc.Width, (LONG)dst_desc.Height};
+
+    // Every pixel gets written, no clear needed
+    D3D12_CPU_DESCRIPTOR_HANDLE rtvs[] = { dst.get_rtv() };
+    cmd_list->OMSetRenderTargets(1, rtvs, FALSE, nullptr);
+    cmd_list->RSSetViewports(1, &viewport);
+    cmd_list->RSSetScissorRects(1, &scissor_rect);
+
+    ID3D12DescriptorHeap* heaps[] = { this->srv_heap->Heap() };
+    cmd_list->SetDescriptorHeaps(1, heaps);
+
+    cmd_list->SetPipelineState(this->pso.Get());
+    cmd_list->SetGraphicsRootSignature(this->root_signature.Get());
+    cmd_list->SetGraphicsRootDescriptorTable(0, this->srv_heap->GetGpuHandle(srv));
+    cmd_list->SetGraphicsRoot32BitConstants(1, CONSTANTS_COUNT, &constants, 0);
+    cmd_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    cmd_list->DrawInstanced(6, 1, 0, 0);
+
+    barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
+    barriers[0].Transition.StateAfter = dst_state;
+    barriers[1].Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    barriers[1].Transition.StateAfter = src_state;
+    cmd_list->ResourceBarrier(2, barriers);
+}
+}
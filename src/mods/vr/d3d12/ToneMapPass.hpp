@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <memory>
+
+#include <d3d12.h>
+
+#include <../../../_deps/directxtk12-src/Inc/DescriptorHeap.h>
+
+#include <utility/ToneMap.hpp>
+
+#include "ComPtr.hpp"
+#include "TextureContext.hpp"
+
+namespace d3d12 {
+// Tone maps and converts a texture into a render target with a single fullscreen draw (shaders/tonemap_ps.hlsl),
+// so an HDR backbuffer can go straight into an 8-bit eye texture without a copy and a SpriteBatch draw in between.
+// The source is read with Load() at the target's pixel position, both have to be the same size.
+struct ToneMapPass {
+    virtual ~ToneMapPass() { this->reset(); }
+
+    // False when the shaders weren't compiled in, callers keep their SpriteBatch path then.
+    bool setup(ID3D12Device* device, DXGI_FORMAT output_format);
+    void reset();
+
+    bool ready() const {
+        return this->pso != nullptr;
+    }
+
+    void draw(ID3D12GraphicsCommandList* cmd_list, ID3D12Resource* src, D3D12_RESOURCE_STATES src_state, const TextureContext& dst, D3D12_RESOURCE_STATES dst_state,
+        const utility::tonemap::Constants& constants);
+
+    static constexpr uint32_t SRV_COUNT = 8; // swapchain buffers plus the odd copy target
+
+    ComPtr<ID3D12Device> device{};
+    ComPtr<ID3D12RootSignature> root_signature{};
+    ComPtr<ID3D12PipelineState> pso{};
+
+    // SRVs by source resource, the backbuffers come around every few frames.
+    // Only valid until the next reset(), which on_reset does before any of them can go away.
+    std::unique_ptr<DirectX::DescriptorHeap> srv_heap{};
+    std::array<ID3D12Resource*, SRV_COUNT> srv_sources{};
+    uint32_t next_srv{0};
+
+private:
+    uint32_t get_srv(ID3D12Resource* src);
+};
+}
@@ -7,6 +7,7 @@
 #include <experimental/DebugUtils.h>
 #include <imgui.h>
 #include <json.hpp>
+#include <utility/HotLog.hpp>
 #include <utility/String.hpp>
 
 #include "Framework.hpp"
@@ -37,7 +38,7 @@ VRRuntime::Error OpenXR::synchronize_frame(int frame) {
     this->pipeline_state.frame_state = {XR_TYPE_FRAME_STATE};
     auto result = xrWaitFrame(this->session, &frame_wait_info, &this->pipeline_state.frame_state);
 
-    this->end_profile("xrWaitFrame");
+    this->end_profile("xrWaitFrame", this->wait_frame_log_limiter);
 
     if (result != XR_SUCCESS) {
         spdlog::error("[VR] xrWaitFrame failed: {}", this->get_result_string(result));
@@ -190,7 +191,7 @@ VRRuntime::Error OpenXR::consume_events(std::function<void(void*)> callback) {
     const auto bh = (XrEventDataBaseHeader*)&edb;
 
     while (result == XR_SUCCESS) {
-        spdlog::info("VR: xrEvent: {}", this->get_structure_string(bh->type));
+        VR_HOT_LOG(spdlog::level::info, 2.0, 20, "VR: xrEvent: {}", this->get_structure_string(bh->type));
 
         if (callback) {
             callback(&edb);
@@ -220,7 +221,8 @@ VRRuntime::Error OpenXR::consume_events(std::function<void(void*)> callback) {
                 }
             } else if (ev->state == XR_SESSION_STATE_LOSS_PENDING) {
                 spdlog::info("VR: XR_SESSION_STATE_LOSS_PENDING");
-                this->wants_reinitialize = true;
+                // the instance survives a lost session, no need to tear it down
+                this->request_recovery(vrmod::RuntimeRecovery::Stage::RECREATE_SESSION);
             } else if (ev->state == XR_SESSION_STATE_STOPPING) {
                 spdlog::info("VR: XR_SESSION_STATE_STOPPING");
 
@@ -229,10 +231,6 @@ VRRuntime::Error OpenXR::consume_events(std::function<void(void*)> callback) {
                     this->session_ready = false;
                     this->frame_synced = false;
                     this->frame_began = false;
-
-                    if (this->wants_reinitialize) {
-                        //initialize_openxr();
-                    }
                 }
             }
         } else if (bh->type == XR_TYPE_EVENT_DATA_REFERENCE_SPACE_CHANGE_PENDING) {
@@ -439,25 +437,40 @@ void OpenXR::destroy() {
 
     std::scoped_lock _{sync_mtx};
 
+    destroy_session();
+
+    if (this->instance != nullptr) {
+        xrDestroyInstance(this->instance);
+        this->instance = nullptr;
+    }
+
+    this->system = XR_NULL_SYSTEM_ID;
+//    this->internal_frame_counter = 0;
+}
+
+void OpenXR::destroy_session() {
+    std::scoped_lock _{sync_mtx};
+
     if (this->session != nullptr) {
         if (this->session_ready) {
             xrEndSession(this->session);
         }
 
+        // spaces and action bindings go away with the session
         xrDestroySession(this->session);
     }
 
-    if (this->instance != nullptr) {
-        xrDestroyInstance(this->instance);
-        this->instance = nullptr;
+    this->session = nullptr;
+    this->stage_space = XR_NULL_HANDLE;
+    this->view_space = XR_NULL_HANDLE;
+
+    for (auto& hand : this->hands) {
+        hand.space = XR_NULL_HANDLE;
     }
 
-    this->session = nullptr;
     this->session_ready = false;
-    this->system = XR_NULL_SYSTEM_ID;
     this->frame_synced = false;
     this->frame_began = false;
-//    this->internal_frame_counter = 0;
 }
 
 std::string OpenXR::get_result_string(XrResult result) const {
@@ -836,6 +849,15 @@ std::optional<std::string> OpenXR::initialize_actions(const std::string& json_st
         }
     }
 
+    return attach_actions();
+}
+
+std::optional<std::string> OpenXR::attach_actions() {
+    // initialize_actions never got as far as creating the action set
+    if (this->action_set.actions.empty()) {
+        return std::nullopt;
+    }
+
     // Create the action spaces for each hand
     for (auto i = 0; i < 2; ++i) {
         spdlog::info("[VR] Creating action space for hand {}", i);
@@ -1093,7 +1115,7 @@ void OpenXR::display_bindings_editor() {
         if (std::filesystem::exists(filename)) {
             // Delete the file
             std::filesystem::remove(filename);
-            this->wants_reinitialize = true;
+            this->request_recovery(vrmod::RuntimeRecovery::Stage::RECREATE_SESSION);
         }
     }
 
@@ -1351,7 +1373,8 @@ void OpenXR::save_bindings() {
     std::replace(filename.begin(), filename.end(), '/', '_');
     std::ofstream(filename) << j.dump(4);
 
-    this->wants_reinitialize = true;
+    // bindings are attached to the session, recreating it is enough
+    this->request_recovery(vrmod::RuntimeRecovery::Stage::RECREATE_SESSION);
 }
 
 XrResult OpenXR::begin_frame(int frame) {
@@ -1373,7 +1396,7 @@ XrResult OpenXR::begin_frame(int frame) {
     XrFrameBeginInfo frame_begin_info{XR_TYPE_FRAME_BEGIN_INFO};
     auto result = xrBeginFrame(this->session, &frame_begin_info);
 
-    this->end_profile("xrBeginFrame");
+    this->end_profile("xrBeginFrame", this->begin_frame_log_limiter);
 
     if (result != XR_SUCCESS) {
         spdlog::error("[VR] xrBeginFrame failed: {}", this->get_result_string(result));
@@ -1421,10 +1444,11 @@ XrResult OpenXR::end_frame(const std::vector<XrCompositionLayerBaseHeader*>& qua
             for (auto i = 0; i < projection_layer_views.size(); ++i) {
                 const auto& swapchain = this->swapchains[i];
                 int         actual_frame = i == 0 ? l_frame : r_frame;
-                auto& constants = GlobalPool::get_xr_constants(actual_frame);
+                // The pose the frame was rendered with, the located view if it already left the history
+                const auto pose = GlobalPool::get_openxr_pose(actual_frame);
 
                 projection_layer_views[i].type = XR_TYPE_COMPOSITION_LAYER_PROJECTION_VIEW;
-                projection_layer_views[i].pose = constants.pose;
+                projection_layer_views[i].pose = pose.value_or(current_pipeline->stage_views[i].pose);
                 projection_layer_views[i].subImage.swapchain = swapchain.handle;
                 int32_t offset_x = 0, offset_y = 0, extent_x = 0, extent_y = 0;
                 int texture_area_width = swapchain.width;
@@ -1500,7 +1524,7 @@ XrResult OpenXR::end_frame(const std::vector<XrCompositionLayerBaseHeader*>& qua
 
     this->begin_profile();
     auto result = xrEndFrame(this->session, &frame_end_info);
-    this->end_profile("xrEndFrame");
+    this->end_profile("xrEndFrame", this->end_frame_log_limiter);
     if (result != XR_SUCCESS) {
         spdlog::error("[VR] xrEndFrame failed: {}", this->get_result_string(result));
     }
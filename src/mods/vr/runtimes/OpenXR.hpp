@@ -14,6 +14,8 @@
 #include <openxr/openxr_platform.h>
 //#include <common/xr_linear.h>
 
+#include <utility/HotLog.hpp>
+
 #include "VRRuntime.hpp"
 
 namespace runtimes{
@@ -100,6 +102,8 @@ struct OpenXR final : public VRRuntime {
     VRRuntime::Error update_input() override;
 
     void destroy() override;
+    // Ends and destroys the session but keeps the instance alive.
+    void destroy_session();
 
     std::vector<DXGI_FORMAT> get_supported_swapchain_formats() const;
     bool is_supported_swapchain_format(DXGI_FORMAT format) const {
@@ -117,6 +121,8 @@ public:
     XrPath get_current_interaction_profile_path() const;
 
     std::optional<std::string> initialize_actions(const std::string& json_string);
+    // Action spaces and attachment of the action set, both belong to the session and are lost with it
+    std::optional<std::string> attach_actions();
 
     inline static glm::quat to_glm(const XrQuaternionf& q) {
     #ifndef GLM_FORCE_QUAT_DATA_XYZW
@@ -145,7 +151,7 @@ public:
         this->profiler_start_time = std::chrono::high_resolution_clock::now();
     }
 
-    void end_profile(std::string_view name) {
+    void end_profile(std::string_view name, utility::LogRateLimiter& limiter) {
         if (!this->profile_calls) {
             return;
         }
@@ -153,7 +159,7 @@ public:
         const auto end_time = std::chrono::high_resolution_clock::now();
         const auto dur = std::chrono::duration<float, std::milli>(end_time - this->profiler_start_time).count();
 
-        spdlog::info("{} took {} ms", name, dur);
+        VR_HOT_LOG_LIMITED(limiter, spdlog::level::info, "{} took {} ms", name, dur);
     }
 
     bool is_action_active(XrAction action, VRRuntime::Hand hand) const;
@@ -183,6 +189,11 @@ public:
 #endif
     std::chrono::high_resolution_clock::time_point profiler_start_time{};
 
+    // One per profiled call, a slow xrWaitFrame doesn't use up what xrEndFrame gets to log
+    utility::LogRateLimiter wait_frame_log_limiter{10.0, 30};
+    utility::LogRateLimiter begin_frame_log_limiter{10.0, 30};
+    utility::LogRateLimiter end_frame_log_limiter{10.0, 30};
+
     std::recursive_mutex sync_mtx{};
 
     // Making it static because for some reason destroying it doesn't actually completely destroy everything.
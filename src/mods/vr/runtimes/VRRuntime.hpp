@@ -7,10 +7,13 @@
 #include <shared_mutex>
 #include <optional>
 #include <array>
+#include <atomic>
 
 #include <spdlog/spdlog.h>
 #include <math/Math.hpp>
 
+#include "mods/vr/RuntimeRecovery.hpp"
+
 struct VRRuntime {
     enum class Error : int64_t {
         UNSPECIFIED = -1,
@@ -119,8 +122,24 @@ struct VRRuntime {
         return this->type() == Type::OPENVR;
     }
 
+    // Can be called from the event/input paths, the VR mod picks it up in on_post_present.
+    // Only ever escalates, a cheaper request won't downgrade a pending one.
+    void request_recovery(vrmod::RuntimeRecovery::Stage stage) {
+        auto current = m_requested_recovery.load();
+
+        while ((uint8_t)stage > current && !m_requested_recovery.compare_exchange_weak(current, (uint8_t)stage)) {
+        }
+    }
+
+    vrmod::RuntimeRecovery::Stage consume_recovery_request() {
+        return (vrmod::RuntimeRecovery::Stage)m_requested_recovery.exchange((uint8_t)vrmod::RuntimeRecovery::Stage::NONE);
+    }
+
+    bool wants_recovery() const {
+        return m_requested_recovery.load() != (uint8_t)vrmod::RuntimeRecovery::Stage::NONE;
+    }
+
     bool loaded{false};
-    bool wants_reinitialize{false};
     bool dll_missing{false};
 
     // in the case of OpenVR we always need at least one initial WaitGetPoses before the game will render
@@ -164,4 +183,7 @@ struct VRRuntime {
     float m_flat_screen_distance = 1.5f;
 
     SynchronizeStage custom_stage{SynchronizeStage::EARLY};
+
+private:
+    std::atomic<uint8_t> m_requested_recovery{(uint8_t)vrmod::RuntimeRecovery::Stage::NONE};
 };
\ No newline at end of file
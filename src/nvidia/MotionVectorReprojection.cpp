@@ -30,12 +30,12 @@ bool MotionVectorReprojection::CreateComputeRootSignature(ID3D12Device* device)
     CD3DX12_DESCRIPTOR_RANGE1 uavRange;
     CD3DX12_ROOT_PARAMETER1 rootParams[3];
 
-    // SRV descriptor table
-    srvRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, d3d12::MAX_SMALL_RING_POOL_SIZE, 0, 0); // 3 SRVs starting at slot 0
+    // SRV descriptor table, depth at t0
+    srvRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 0);
     rootParams[0].InitAsDescriptorTable(1, &srvRange, D3D12_SHADER_VISIBILITY_ALL);
 
-    // UAV descriptor table
-    uavRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, d3d12::MAX_SMALL_RING_POOL_SIZE, 0, 0); // 1 UAV at slot 0
+    // UAV descriptor table, motion vectors at u0
+    uavRange.Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 0, 0);
     rootParams[1].InitAsDescriptorTable(1, &uavRange, D3D12_SHADER_VISIBILITY_ALL);
 
     // Constants
@@ -76,6 +76,23 @@ void MotionVectorReprojection::ProcessMotionVectors(ID3D12Resource* motionVector
         return;
     }
 
+    // The correction happens in place, running it again on the same vectors would correct them twice
+    const aer::FramePassLedger::Key key{reinterpret_cast<uintptr_t>(motionVector), 0};
+
+    if (!m_processed.claim(key, frame)) {
+        return;
+    }
+
+    const auto mv_desc = motionVector->GetDesc();
+    const auto depth_handle = m_view_pool.GetGpuHandle(depth1, depth1->GetDesc(), utility::ViewType::SRV, frame);
+    const auto mv_handle = m_view_pool.GetGpuHandle(motionVector, mv_desc, utility::ViewType::UAV, frame);
+
+    if (!depth_handle || !mv_handle) {
+        // Nothing was corrected, a later evaluate of this frame may still get its views
+        m_processed.release(key, frame);
+        return;
+    }
+
     D3D12_RESOURCE_BARRIER barriers[3] = {
         CD3DX12_RESOURCE_BARRIER::Transition(depth1, depth_state, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
         CD3DX12_RESOURCE_BARRIER::Transition(motionVector, mv_state, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
@@ -86,27 +103,26 @@ void MotionVectorReprojection::ProcessMotionVectors(ID3D12Resource* motionVector
     cmd_list->SetComputeRootSignature(m_computeRootSignature.Get());
     cmd_list->SetPipelineState(m_compute_pso.Get());
 
-    auto& motionVectorResource = m_small_ring_pool.GetUAVSlot(motionVector);
-    
-    ID3D12DescriptorHeap* heaps[] = { m_small_ring_pool.m_compute_heap->Heap()};
+    ID3D12DescriptorHeap* heaps[] = { m_view_pool.m_compute_heap->Heap()};
     cmd_list->SetDescriptorHeaps(1, heaps);
-    cmd_list->SetComputeRootDescriptorTable(0, m_small_ring_pool.GetGpuSrvHandle(depth1));
-    cmd_list->SetComputeRootDescriptorTable(1, m_small_ring_pool.m_compute_heap->GetGpuHandle(motionVectorResource.heapIndex));
+    cmd_list->SetComputeRootDescriptorTable(0, *depth_handle);
+    cmd_list->SetComputeRootDescriptorTable(1, *mv_handle);
+
+    const UINT width = static_cast<UINT>(mv_desc.Width);
+    const UINT height = mv_desc.Height;
 
     MotionVectorCorrectionConstants constants{};
-    constants.texSize.x = static_cast<float>(motionVectorResource.Width);
-    constants.texSize.y = static_cast<float>(motionVectorResource.Height);
-    constants.texSize.z = 1.0f /  static_cast<float>(motionVectorResource.Width);
-    constants.texSize.w = 1.0f /  static_cast<float>(motionVectorResource.Height);
+    constants.texSize.x = static_cast<float>(width);
+    constants.texSize.y = static_cast<float>(height);
+    constants.texSize.z = 1.0f /  static_cast<float>(width);
+    constants.texSize.w = 1.0f /  static_cast<float>(height);
     constants.mvecScale = m_mvecScale;
 
+    static_assert(GlobalPool::ConstantsHistory::holds(2), "camera motion correction looks two frames back");
     constants.undoCameraMotion = GlobalPool::get_correction_matrix((int)frame, ((int)frame - 1));
     constants.cameraMotionCorrection = GlobalPool::get_correction_matrix((int)frame, ((int)frame - 2));
     cmd_list->SetComputeRoot32BitConstants(2, CONSTANTS_COUNT, &constants, 0);
 
-    const UINT width = motionVectorResource.Width;
-    const UINT height = motionVectorResource.Height;
-    
     cmd_list->Dispatch((width + 15) / 16, (height + 15) / 16, 1);
     
     barriers[0].Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
@@ -187,69 +203,65 @@ D3D12_SHADER_RESOURCE_VIEW_DESC d3d12::getSRVdesc(const D3D12_RESOURCE_DESC& des
     return srvDesc;
 }
 
-d3d12::RingResource& d3d12::SmallRingPool::GetSRVSlot(ID3D12Resource* pDepth)
+uint64_t d3d12::hashDesc(const D3D12_RESOURCE_DESC& desc)
 {
-    auto ptr = reinterpret_cast<uintptr_t>(pDepth);
-    for (auto &ring_resource : srv_pool) {
-        if (ring_resource.heapIndex > 0 && ring_resource.resource_ptr == ptr) {
-            return ring_resource;
-        }
+    uint64_t h = 0xcbf29ce484222325ull;
+
+    for (const uint64_t v : {desc.Width, (uint64_t)desc.Height, (uint64_t)desc.Format, (uint64_t)desc.MipLevels, (uint64_t)desc.DepthOrArraySize, (uint64_t)desc.Flags}) {
+        h ^= v;
+        h *= 0x100000001b3ull;
     }
-    current_srv_pool_index = (current_srv_pool_index + 1) % MAX_SMALL_RING_POOL_SIZE;
-    int index = current_srv_pool_index;
-    srv_pool[index].resource_ptr = ptr;
-    srv_pool[index].heapIndex = index + (int)SRV_HEAP_START;
-    auto desc = pDepth->GetDesc();
-    srv_pool[index].Width = static_cast<unsigned int>(desc.Width);
-    srv_pool[index].Height = desc.Height;
-    auto srv_desc = getSRVdesc(desc);
-    m_pDevice->CreateShaderResourceView(pDepth, &srv_desc, m_compute_heap->GetCpuHandle(srv_pool[index].heapIndex));
-    return srv_pool[index];
+
+    return h;
 }
 
-d3d12::RingResource& d3d12::SmallRingPool::GetUAVSlot(ID3D12Resource* pMVec)
+void d3d12::ComputeViewBackend::write(uint32_t slot, const utility::ViewKey& key)
 {
-    const auto ptr = reinterpret_cast<uintptr_t>(pMVec);
-    for (auto &ring_resource : uav_pool) {
-        if (ring_resource.heapIndex > 0 && ring_resource.resource_ptr == ptr) {
-            return ring_resource;
-        }
+    auto resource = reinterpret_cast<ID3D12Resource*>(key.resource);
+
+    if (key.type == utility::ViewType::SRV) {
+        auto srv_desc = getSRVdesc(resource->GetDesc());
+        m_pDevice->CreateShaderResourceView(resource, &srv_desc, m_heap->GetCpuHandle(slot));
+    } else {
+        m_pDevice->CreateUnorderedAccessView(resource, nullptr, nullptr, m_heap->GetCpuHandle(slot));
     }
-    current_uav_pool_index = (current_uav_pool_index + 1) % MAX_SMALL_RING_POOL_SIZE;
-    int index = current_uav_pool_index;
-    uav_pool[index].resource_ptr = ptr;
-    uav_pool[index].heapIndex = index + (int)UAV_HEAP_START;
-    auto desc = pMVec->GetDesc();
-    uav_pool[index].Width = static_cast<unsigned int>(desc.Width);
-    uav_pool[index].Height = desc.Height;
-    m_pDevice->CreateUnorderedAccessView(
-            pMVec,
-            nullptr,
-            nullptr, m_compute_heap->GetCpuHandle(uav_pool[index].heapIndex)
-    );
-    return uav_pool[index];
 }
 
-D3D12_GPU_DESCRIPTOR_HANDLE d3d12::SmallRingPool::GetGpuSrvHandle(ID3D12Resource* pResource)
+std::optional<D3D12_GPU_DESCRIPTOR_HANDLE> d3d12::ComputeViewPool::GetGpuHandle(ID3D12Resource* pResource, const D3D12_RESOURCE_DESC& desc, utility::ViewType type, uint32_t frame)
 {
-    RingResource& slot = GetSRVSlot(pResource);
-    return m_compute_heap->GetGpuHandle(slot.heapIndex);
-}
+    if (!m_compute_heap) {
+        return std::nullopt;
+    }
 
-D3D12_GPU_DESCRIPTOR_HANDLE d3d12::SmallRingPool::GetGpuUavHandle(ID3D12Resource* pResource)
-{
-    auto& slot = GetUAVSlot(pResource);
-    return m_compute_heap->GetGpuHandle(slot.heapIndex);
+    utility::ViewKey key{};
+    key.resource = reinterpret_cast<uintptr_t>(pResource);
+    key.format = type == utility::ViewType::SRV ? getCorrectDXGIFormat(desc.Format) : desc.Format;
+    key.type = type;
+    key.desc_hash = hashDesc(desc);
+
+    const auto completed = frame > VIEW_REUSE_LATENCY ? frame - VIEW_REUSE_LATENCY : 0;
+    const auto handle = m_cache.acquire(key, frame, completed);
+
+    if (!handle) {
+        if (m_cache.get_stats().stalls == 1) {
+            spdlog::warn("[VR] Motion vector view cache full, {} views all still in use", m_cache.capacity());
+        }
+
+        return std::nullopt;
+    }
+
+    return m_compute_heap->GetGpuHandle(handle->slot);
 }
 
-void d3d12::SmallRingPool::Init(ID3D12Device* pDevice)
+void d3d12::ComputeViewPool::Init(ID3D12Device* pDevice, uint32_t capacity)
 {
     try {
         m_compute_heap = std::make_unique<DescriptorHeap>(pDevice,
                                                                    D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV,
                                                                    D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE,
-                                                                   SRV_UAV_COUNT);
-        m_pDevice = pDevice;
+                                                                   capacity);
+        m_cache.resize(capacity);
+        m_cache.backend() = ComputeViewBackend{pDevice, m_compute_heap.get()};
     } catch(...) {
         spdlog::error("Failed to create SRV/RTV descriptor heap for MotionVectorFix");
     }
@@ -258,7 +270,7 @@ void d3d12::SmallRingPool::Init(ID3D12Device* pDevice)
 void MotionVectorReprojection::on_d3d12_initialize(ID3D12Device* device, const D3D12_RESOURCE_DESC& backBuffer_desc)
 {
 
-    m_small_ring_pool.Init(device);
+    m_view_pool.Init(device);
     if (!CreateComputeRootSignature(device) ||
         !CreatePipelineStates(device, DXGI_FORMAT_R10G10B10A2_UNORM))
     {
@@ -1,6 +1,8 @@
 #pragma once
 #include <DescriptorHeap.h>
 #include <Framework.hpp>
+#include <aer/FramePassLedger.hpp>
+#include <utility/DescriptorCache.hpp>
 #include <d3d12.h>
 // #include <mods/vr/d3d12/ComPtr.hpp>
 // #include "sl.h"
@@ -10,61 +12,38 @@ using namespace DirectX;
 
 namespace d3d12
 {
-    constexpr int MAX_SMALL_RING_POOL_SIZE = 5;
-    enum SRV_UAV : unsigned int
-    {
-        SRV_HEAP_START = 0,
-        UAV_HEAP_START = SRV_HEAP_START + MAX_SMALL_RING_POOL_SIZE,
-        SRV_UAV_COUNT  = UAV_HEAP_START + MAX_SMALL_RING_POOL_SIZE
-    };
-    struct RingResource
-    {
-        uintptr_t resource_ptr{};
-        int heapIndex{-1};
-        unsigned int Width{};
-        unsigned int Height{};
+    constexpr uint32_t VIEW_CACHE_CAPACITY = 32;
+    // Frames a descriptor can still be read by the GPU after the frame it was last used in
+    constexpr uint32_t VIEW_REUSE_LATENCY = 3;
 
-        void Reset()
-        {
-            resource_ptr = 0;
-            heapIndex = -1;
-            Width = 0;
-            Height = 0;
-        }
-    };
     static DXGI_FORMAT getCorrectDXGIFormat(DXGI_FORMAT Format);
     static D3D12_SHADER_RESOURCE_VIEW_DESC getSRVdesc(const D3D12_RESOURCE_DESC& desc);
-    struct SmallRingPool
+    static uint64_t hashDesc(const D3D12_RESOURCE_DESC& desc);
+
+    // Writes the views utility::DescriptorCache asks for into the compute heap
+    struct ComputeViewBackend
     {
-        RingResource srv_pool[MAX_SMALL_RING_POOL_SIZE]{};
-        int current_srv_pool_index{0};
-        RingResource uav_pool[MAX_SMALL_RING_POOL_SIZE]{};
-        int current_uav_pool_index{0};
-        std::unique_ptr<DescriptorHeap> m_compute_heap{};
         ID3D12Device* m_pDevice{nullptr};
+        DescriptorHeap* m_heap{nullptr};
 
-        RingResource& GetSRVSlot(ID3D12Resource* pDepth);
-        RingResource& GetUAVSlot(ID3D12Resource* pMVec);
-        D3D12_GPU_DESCRIPTOR_HANDLE GetGpuSrvHandle(ID3D12Resource* pResource);
-        D3D12_GPU_DESCRIPTOR_HANDLE GetGpuUavHandle(ID3D12Resource* pResource);
-        void Init(ID3D12Device* pDevice);
+        void write(uint32_t slot, const utility::ViewKey& key);
+    };
+
+    // SRVs of depth buffers and UAVs of motion vectors, whatever number of them the game cycles through
+    struct ComputeViewPool
+    {
+        std::unique_ptr<DescriptorHeap> m_compute_heap{};
+        utility::DescriptorCache<ComputeViewBackend> m_cache{ComputeViewBackend{}, VIEW_CACHE_CAPACITY};
+
+        void Init(ID3D12Device* pDevice, uint32_t capacity = VIEW_CACHE_CAPACITY);
+        std::optional<D3D12_GPU_DESCRIPTOR_HANDLE> GetGpuHandle(ID3D12Resource* pResource, const D3D12_RESOURCE_DESC& desc, utility::ViewType type, uint32_t frame);
 
         void Reset()
         {
-            for (auto& res : srv_pool) {
-                res.Reset();
-            }
-            current_srv_pool_index = 0;
-            for (auto& res : uav_pool) {
-                res.Reset();
-            }
-            current_uav_pool_index = 0;
+            m_cache.clear();
+            m_cache.backend() = ComputeViewBackend{};
             m_compute_heap.reset();
-            m_pDevice = nullptr;
-
         }
-
-
     };
 }
 
@@ -91,7 +70,8 @@ public:
         m_initialized = false;
         m_compute_pso.Reset();
         m_computeRootSignature.Reset();
-        m_small_ring_pool.Reset();
+        m_view_pool.Reset();
+        m_processed.clear();
     }
 
     // Run the compute shader to process motion vectors
@@ -99,6 +79,10 @@ public:
     void ProcessMotionVectors(ID3D12Resource* mvec, D3D12_RESOURCE_STATES mvec_state, ID3D12Resource* depth, D3D12_RESOURCE_STATES depth_state, uint32_t frame,
                               ID3D12GraphicsCommandList* cmd_list);
 
+    // Passes run and skipped because the same motion vectors were already corrected this frame
+    const aer::FramePassLedger::Stats& get_pass_stats() const { return m_processed.get_stats(); }
+    const auto& get_view_stats() const { return m_view_pool.m_cache.get_stats(); }
+
     glm::vec2 m_mvecScale {0.5f, -0.5f};
 private:
 
@@ -107,6 +91,7 @@ private:
 
     ComPtr<ID3D12RootSignature>              m_computeRootSignature;
     ComPtr<ID3D12PipelineState>              m_compute_pso;
-    d3d12::SmallRingPool                     m_small_ring_pool;
+    d3d12::ComputeViewPool                   m_view_pool;
+    aer::FramePassLedger                     m_processed;
     bool m_initialized{ false };
 };
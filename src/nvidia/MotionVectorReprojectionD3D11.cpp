@@ -28,6 +28,7 @@ void MotionVectorReprojectionD3D11::Reset() {
     m_constants_buffer.Reset();
     m_srv_cache.clear();
     m_uav_cache.clear();
+    m_last_evict_frame = 0;
     m_initialized = false;
 }
 
@@ -63,19 +64,23 @@ bool MotionVectorReprojectionD3D11::createConstantBuffer(ID3D11Device* device) {
     return true;
 }
 
-ID3D11ShaderResourceView* MotionVectorReprojectionD3D11::getDepthSRV(ID3D11Device* device, ID3D11Resource* depthResource) {
-    if (m_srv_cache.count(depthResource)) {
-        return m_srv_cache[depthResource].Get();
-    }
+uint64_t MotionVectorReprojectionD3D11::hashDesc(const D3D11_TEXTURE2D_DESC& desc) {
+    uint64_t h = 0xcbf29ce484222325ull;
 
-    ComPtr<ID3D11Texture2D> depth_texture;
-    if (FAILED(depthResource->QueryInterface(IID_PPV_ARGS(&depth_texture)))) {
-        spdlog::error("[VR] Failed to query ID3D11Texture2D from depth resource.");
-        return nullptr;
+    for (const uint64_t v : {(uint64_t)desc.Width, (uint64_t)desc.Height, (uint64_t)desc.Format, (uint64_t)desc.MipLevels, (uint64_t)desc.ArraySize, (uint64_t)desc.BindFlags}) {
+        h ^= v;
+        h *= 0x100000001b3ull;
     }
 
-    D3D11_TEXTURE2D_DESC tex_desc;
-    depth_texture->GetDesc(&tex_desc);
+    return h;
+}
+
+ID3D11ShaderResourceView* MotionVectorReprojectionD3D11::getDepthSRV(ID3D11Device* device, ID3D11Resource* depthResource, const D3D11_TEXTURE2D_DESC& tex_desc, uint32_t frame) {
+    const decltype(m_srv_cache)::Identity id{reinterpret_cast<uintptr_t>(depthResource), hashDesc(tex_desc)};
+
+    if (auto srv = m_srv_cache.find(id, frame); srv != nullptr) {
+        return srv->Get();
+    }
 
     D3D11_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
     srv_desc.Format = getCorrectDXGIFormat(tex_desc.Format);
@@ -89,24 +94,16 @@ ID3D11ShaderResourceView* MotionVectorReprojectionD3D11::getDepthSRV(ID3D11Devic
         return nullptr;
     }
 
-    m_srv_cache[depthResource] = srv;
-    return srv.Get();
+    return m_srv_cache.insert(id, std::move(srv), frame).Get();
 }
 
-ID3D11UnorderedAccessView* MotionVectorReprojectionD3D11::getMotionVectorUAV(ID3D11Device* device, ID3D11Resource* mvResource) {
-    if (m_uav_cache.count(mvResource)) {
-        return m_uav_cache[mvResource].Get();
-    }
+ID3D11UnorderedAccessView* MotionVectorReprojectionD3D11::getMotionVectorUAV(ID3D11Device* device, ID3D11Resource* mvResource, const D3D11_TEXTURE2D_DESC& tex_desc, uint32_t frame) {
+    const decltype(m_uav_cache)::Identity id{reinterpret_cast<uintptr_t>(mvResource), hashDesc(tex_desc)};
 
-    ComPtr<ID3D11Texture2D> mv_texture;
-    if (FAILED(mvResource->QueryInterface(IID_PPV_ARGS(&mv_texture)))) {
-        spdlog::error("[VR] Failed to query ID3D11Texture2D from motion vector resource.");
-        return nullptr;
+    if (auto uav = m_uav_cache.find(id, frame); uav != nullptr) {
+        return uav->Get();
     }
 
-    D3D11_TEXTURE2D_DESC tex_desc;
-    mv_texture->GetDesc(&tex_desc);
-
     D3D11_UNORDERED_ACCESS_VIEW_DESC uav_desc = {};
     uav_desc.Format = tex_desc.Format; // UAV format must match resource format
     uav_desc.ViewDimension = D3D11_UAV_DIMENSION_TEXTURE2D;
@@ -118,8 +115,7 @@ ID3D11UnorderedAccessView* MotionVectorReprojectionD3D11::getMotionVectorUAV(ID3
         return nullptr;
     }
 
-    m_uav_cache[mvResource] = uav;
-    return uav.Get();
+    return m_uav_cache.insert(id, std::move(uav), frame).Get();
 }
 
 void MotionVectorReprojectionD3D11::Process(ID3D11DeviceContext* context, ID3D11Resource* depth, ID3D11Resource* motionVectors, uint32_t frame) {
@@ -137,9 +133,28 @@ void MotionVectorReprojectionD3D11::Process(ID3D11DeviceContext* context, ID3D11
     //     return;
     // }
 
+    ComPtr<ID3D11Texture2D> depth_texture;
+    ComPtr<ID3D11Texture2D> mv_texture;
+    if (FAILED(depth->QueryInterface(IID_PPV_ARGS(&depth_texture))) || FAILED(motionVectors->QueryInterface(IID_PPV_ARGS(&mv_texture)))) {
+        spdlog::error("[VR] Failed to query ID3D11Texture2D from depth or motion vector resource.");
+        return;
+    }
+
+    D3D11_TEXTURE2D_DESC depth_desc;
+    depth_texture->GetDesc(&depth_desc);
+    D3D11_TEXTURE2D_DESC desc;
+    mv_texture->GetDesc(&desc);
+
+    // Views of resources the game stopped using get released after a while
+    if (frame != m_last_evict_frame) {
+        m_last_evict_frame = frame;
+        m_srv_cache.evict_older_than(frame);
+        m_uav_cache.evict_older_than(frame);
+    }
+
     // 1. Get Views for the resources
-    auto* depth_srv = getDepthSRV(device.Get(), depth);
-    auto* mv_uav = getMotionVectorUAV(device.Get(), motionVectors);
+    auto* depth_srv = getDepthSRV(device.Get(), depth, depth_desc, frame);
+    auto* mv_uav = getMotionVectorUAV(device.Get(), motionVectors, desc, frame);
 
     if (!depth_srv || !mv_uav) {
         return;
@@ -150,11 +165,6 @@ void MotionVectorReprojectionD3D11::Process(ID3D11DeviceContext* context, ID3D11
     if (SUCCEEDED(context->Map(m_constants_buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped_resource))) {
         auto* constants = static_cast<MotionVectorCorrectionConstants*>(mapped_resource.pData);
 
-        ComPtr<ID3D11Texture2D> mv_texture;
-        motionVectors->QueryInterface(IID_PPV_ARGS(&mv_texture));
-        D3D11_TEXTURE2D_DESC desc;
-        mv_texture->GetDesc(&desc);
-
         constants->texSize.x = (float)desc.Width;
         constants->texSize.y = (float)desc.Height;
         constants->texSize.z = 1.0f / (float)desc.Width;
@@ -192,10 +202,6 @@ void MotionVectorReprojectionD3D11::Process(ID3D11DeviceContext* context, ID3D11
     context->CSSetConstantBuffers(0, 1, m_constants_buffer.GetAddressOf()); // Constants at b0
 
     // 4. Dispatch
-    ComPtr<ID3D11Texture2D> mv_texture;
-    motionVectors->QueryInterface(IID_PPV_ARGS(&mv_texture));
-    D3D11_TEXTURE2D_DESC desc;
-    mv_texture->GetDesc(&desc);
     UINT width = desc.Width;
     UINT height = desc.Height;
     context->Dispatch((width + 15) / 16, (height + 15) / 16, 1);
@@ -5,7 +5,10 @@
 #include <DirectXMath.h>
 #include <glm/glm.hpp>
 #include <memory>
-#include <map>
+
+#include <aer/ConstantsPool.h>
+#include <utility/FlatViewCache.hpp>
+#include <utility/FrameHistory.hpp>
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -45,8 +48,9 @@ private:
     bool createConstantBuffer(ID3D11Device* device);
 
     // View caching to avoid recreating views every frame
-    ID3D11ShaderResourceView* getDepthSRV(ID3D11Device* device, ID3D11Resource* depthResource);
-    ID3D11UnorderedAccessView* getMotionVectorUAV(ID3D11Device* device, ID3D11Resource* mvResource);
+    ID3D11ShaderResourceView* getDepthSRV(ID3D11Device* device, ID3D11Resource* depthResource, const D3D11_TEXTURE2D_DESC& desc, uint32_t frame);
+    ID3D11UnorderedAccessView* getMotionVectorUAV(ID3D11Device* device, ID3D11Resource* mvResource, const D3D11_TEXTURE2D_DESC& desc, uint32_t frame);
+    static uint64_t hashDesc(const D3D11_TEXTURE2D_DESC& desc);
 
     // Constants struct for the shader
     struct alignas(16) MotionVectorCorrectionConstants {
@@ -60,18 +64,21 @@ private:
     ComPtr<ID3D11ComputeShader> m_compute_shader;
     ComPtr<ID3D11Buffer> m_constants_buffer;
 
-    // Cache for resource views
-    std::map<ID3D11Resource*, ComPtr<ID3D11ShaderResourceView>> m_srv_cache;
-    std::map<ID3D11Resource*, ComPtr<ID3D11UnorderedAccessView>> m_uav_cache;
+    // Cache for resource views, a view keeps its resource alive until it's evicted
+    static constexpr uint64_t MAX_VIEW_AGE = 120; // frames
+    utility::FlatViewCache<ComPtr<ID3D11ShaderResourceView>, 32> m_srv_cache{MAX_VIEW_AGE};
+    utility::FlatViewCache<ComPtr<ID3D11UnorderedAccessView>, 32> m_uav_cache{MAX_VIEW_AGE};
+    uint32_t m_last_evict_frame{0};
 
     // History for SL constants (assuming you have a way to get these)
     // You will need to adapt how you get/store these constants for D3D11
-    static constexpr uint32_t MAX_CONSTANTS_HISTORY = 4;
-    ProjectionConstants m_constants_history[MAX_CONSTANTS_HISTORY]{};
+    // Same depth and frame indexing as GlobalPool, which the D3D12 path reads from
+    utility::FrameHistory<ProjectionConstants, GlobalPool::CONSTANTS_HISTORY_SIZE> m_constants_history{};
     inline void submitSlConstants(const ProjectionConstants& constants, uint32_t frame) {
-        m_constants_history[frame % MAX_CONSTANTS_HISTORY] = constants;
+        m_constants_history.put(frame, constants);
     }
-    [[nodiscard]] inline const auto& getSlConstants(uint32_t frame) const {
-        return m_constants_history[frame % MAX_CONSTANTS_HISTORY];
+    // nullptr once `frame` left the history
+    [[nodiscard]] inline const ProjectionConstants* getSlConstants(uint32_t frame) const {
+        return m_constants_history.find(frame);
     }
 };
\ No newline at end of file
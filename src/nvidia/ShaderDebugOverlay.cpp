@@ -136,6 +136,15 @@ void ShaderDebugOverlay::Draw(ID3D12GraphicsCommandList* commandList, ID3D12Reso
 
 //    mvReprojection->commandContext.wait(10);
 
+    static auto vr = VR::get();
+    auto modulo_frame = vr->m_render_frame_count % 2 == 0 ? 0 : -1;
+
+    // Nothing was copied for that frame (debugShaders just got enabled, or the upscaler skipped it)
+    const auto motion_vectors = m_motion_vector_buffer.find(vr->m_render_frame_count + modulo_frame);
+    if (motion_vectors == nullptr) {
+        return;
+    }
+
     const auto render_target_desc = resource->GetDesc();
 
     {
@@ -143,10 +152,10 @@ void ShaderDebugOverlay::Draw(ID3D12GraphicsCommandList* commandList, ID3D12Reso
         {
             CD3DX12_RESOURCE_BARRIER::Transition(resource, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET),
 //            CD3DX12_RESOURCE_BARRIER::Transition(mvReprojection.m_motion_vector_buffer[3].Get(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
-            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer[0].Get(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
-            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer[1].Get(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
-            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer[2].Get(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
-            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer[3].Get(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer.slot(0).Get(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer.slot(1).Get(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer.slot(2).Get(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer.slot(3).Get(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
 //            CD3DX12_RESOURCE_BARRIER::Transition(m_depth_buffer[0].Get(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
 //            CD3DX12_RESOURCE_BARRIER::Transition(m_depth_buffer[1].Get(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE)
         };
@@ -157,13 +166,10 @@ void ShaderDebugOverlay::Draw(ID3D12GraphicsCommandList* commandList, ID3D12Reso
 
 //    const auto& depthDesc      = m_depth_buffer[0]->GetDesc();
 //    auto depth_srv_desc = getSRVdesc1(depthDesc);
-    static auto vr = VR::get();
-    const auto& mvectorDesc = m_motion_vector_buffer[vr->m_render_frame_count % 4]->GetDesc();
+    const auto& mvectorDesc = (*motion_vectors)->GetDesc();
     auto mvector_srv_desc = getSRVdesc1(mvectorDesc);
 
-    auto modulo_frame = vr->m_render_frame_count % 2 == 0 ? 0 : -1;
-
-    device->CreateShaderResourceView(m_motion_vector_buffer[(vr->m_render_frame_count + modulo_frame)% 4].Get(), &mvector_srv_desc, m_srv_heap->GetCpuHandle(SRV_HEAP::MVEC));
+    device->CreateShaderResourceView(motion_vectors->Get(), &mvector_srv_desc, m_srv_heap->GetCpuHandle(SRV_HEAP::MVEC));
 //    device->CreateShaderResourceView(mvReprojection->m_depth_buffer[0].Get(), &depth_srv_desc, m_debug_heap->GetCpuHandle(SRV_HEAP::DEPTH));
 //    device->CreateShaderResourceView(mvReprojection->m_motion_vector_buffer[2].Get(), &mvector_srv_desc, m_debug_heap->GetCpuHandle(SRV_HEAP::MVEC_PROCESSED));
 
@@ -211,10 +217,10 @@ void ShaderDebugOverlay::Draw(ID3D12GraphicsCommandList* commandList, ID3D12Reso
         {
             CD3DX12_RESOURCE_BARRIER::Transition(resource, D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
 //            CD3DX12_RESOURCE_BARRIER::Transition(mvReprojection.m_motion_vector_buffer[3].Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_GENERIC_READ),
-            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer[0].Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_GENERIC_READ),
-            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer[1].Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_GENERIC_READ),
-            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer[2].Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_GENERIC_READ),
-            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer[3].Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_GENERIC_READ),
+            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer.slot(0).Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_GENERIC_READ),
+            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer.slot(1).Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_GENERIC_READ),
+            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer.slot(2).Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_GENERIC_READ),
+            CD3DX12_RESOURCE_BARRIER::Transition(m_motion_vector_buffer.slot(3).Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_GENERIC_READ),
 //            CD3DX12_RESOURCE_BARRIER::Transition(mvReprojection.m_depth_buffer[0].Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_GENERIC_READ),
 //            CD3DX12_RESOURCE_BARRIER::Transition(mvReprojection.m_depth_buffer[1].Get(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_GENERIC_READ)
         };
@@ -223,34 +229,32 @@ void ShaderDebugOverlay::Draw(ID3D12GraphicsCommandList* commandList, ID3D12Reso
 }
 
 
-bool ShaderDebugOverlay::ValidateResource(ID3D12Resource* source, ComPtr<ID3D12Resource> buffers[4])
+bool ShaderDebugOverlay::ValidateResource(ID3D12Resource* source, MotionVectorHistory& buffers)
 {
     if (source == nullptr) {
         return false;
     }
     D3D12_RESOURCE_DESC desc = source->GetDesc();
-    if (buffers[0] != nullptr) {
-        D3D12_RESOURCE_DESC desc2 = buffers[0]->GetDesc();
+    if (buffers.slot(0) != nullptr) {
+        D3D12_RESOURCE_DESC desc2 = buffers.slot(0)->GetDesc();
         if (desc.Width != desc2.Width || desc.Height != desc2.Height || desc.Format != desc2.Format) {
-            spdlog::info("Resource size mismatch {} {} {} {} {} {} {} {}", fmt::ptr(source), desc.Width, desc.Height, desc.Format, fmt::ptr(buffers[0].Get()), desc2.Width,
+            spdlog::info("Resource size mismatch {} {} {} {} {} {} {} {}", fmt::ptr(source), desc.Width, desc.Height, desc.Format, fmt::ptr(buffers.slot(0).Get()), desc2.Width,
                          desc2.Height, desc2.Format);
-            buffers[0].Reset();
-            buffers[1].Reset();
-            buffers[2].Reset();
-            buffers[3].Reset();
+            buffers.reset();
         }
     }
     auto device = g_framework->get_d3d12_hook()->get_device();
     if (device == nullptr) {
         return false;
     }
-    if (buffers[0] == nullptr || buffers[1] == nullptr || buffers[2] == nullptr || buffers[3] == nullptr) {
+    if (buffers.slot(0) == nullptr || buffers.slot(1) == nullptr || buffers.slot(2) == nullptr || buffers.slot(3) == nullptr) {
         D3D12_HEAP_PROPERTIES heap_props = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
         spdlog::info("[VR] Creating resource copy for AFR motion vetor backbuffer. format={}", desc.Format);
-        for (int i = 0; i < 4; i++) {
+        buffers.invalidate();
+        for (size_t i = 0; i < MotionVectorHistory::CAPACITY; i++) {
             HRESULT hr = device->CreateCommittedResource(&heap_props, D3D12_HEAP_FLAG_NONE, &desc,
                                                          D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
-                                                         IID_PPV_ARGS(buffers[i].GetAddressOf()));
+                                                         IID_PPV_ARGS(buffers.slot(i).GetAddressOf()));
             if (FAILED(hr))
             {
                 spdlog::error("[VR] Failed to create resource {} HRESULT: 0x{:X}", desc.Format, static_cast<unsigned int>(hr));
@@ -5,6 +5,7 @@
 #include <Mod.hpp>
 #include <mods/vr/d3d12/ComPtr.hpp>
 #include <mods/vr/d3d12/TextureContext.hpp>
+#include <utility/FrameHistory.hpp>
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -15,6 +16,9 @@ class UpscalerAfrNvidiaModule;
 class ShaderDebugOverlay : public Mod
 {
 public:
+    // Copies of the motion vectors of the last 4 frames, tagged with the frame they were copied on
+    using MotionVectorHistory = utility::FrameHistory<ComPtr<ID3D12Resource>, 4>;
+
     inline static std::shared_ptr<ShaderDebugOverlay> &Get() {
         static auto instance = std::make_shared<ShaderDebugOverlay>();
         return instance;
@@ -32,8 +36,8 @@ public:
 
     inline bool isValid()
     {
-        for (const auto& buffer : m_motion_vector_buffer) {
-            if (!buffer)
+        for (size_t i = 0; i < MotionVectorHistory::CAPACITY; ++i) {
+            if (!m_motion_vector_buffer.slot(i))
                 return false;
         }
         //        for (const auto& buffer : m_depth_buffer) {
@@ -49,10 +53,7 @@ public:
         m_rtv_heap.reset();
         m_commandContext.reset();
         m_image1.Reset();
-        m_motion_vector_buffer[0].Reset();
-        m_motion_vector_buffer[1].Reset();
-        m_motion_vector_buffer[2].Reset();
-        m_motion_vector_buffer[3].Reset();
+        m_motion_vector_buffer.reset();
     }
 
     ShaderDebugOverlay() = default;
@@ -100,7 +101,7 @@ public:
     }
 
 
-    static bool ValidateResource(ID3D12Resource* source, ComPtr<ID3D12Resource> buffers[4]);
+    static bool ValidateResource(ID3D12Resource* source, MotionVectorHistory& buffers);
 
 
     static void CopyResource(ID3D12GraphicsCommandList* cmdList, ID3D12Resource* pSrcResource, ID3D12Resource* pDstResource, D3D12_RESOURCE_STATES srcState,
@@ -132,7 +133,7 @@ private:
     ComPtr<ID3D12Resource> m_image1{ nullptr};
 
 public:
-    ComPtr<ID3D12Resource> m_motion_vector_buffer[4]{};
+    MotionVectorHistory m_motion_vector_buffer{};
 private:
     
     UINT m_debug_width{0};
@@ -3,11 +3,14 @@
 #include <nvidia/ShaderDebugOverlay.h>
 #endif
 #include "sl_matrix_helpers.h"
+#include <aer/ConstantsPool.h>
 #include <Framework.hpp>
+#include <ModuleWatcher.hpp>
 #include <experimental/DebugUtils.h>
 #include <imgui.h>
 #include <mods/VR.hpp>
 #include <spdlog/spdlog.h>
+#include <utility/HotLog.hpp>
 
 std::optional<std::string> UpscalerAfrNvidiaModule::on_initialize()
 {
@@ -24,25 +27,43 @@ void UpscalerAfrNvidiaModule::on_draw_ui()
     m_enabled->draw("Enable NVIDIA AFR");
 #ifdef MOTION_VECTOR_REPROJECTION
     m_motion_vector_fix->draw("Motion Vector Reprojection Fix");
+
+    const auto& pass_stats = m_motion_vector_reprojection.get_pass_stats();
+    ImGui::Text("Motion vector passes: %llu run, %llu skipped", (unsigned long long)pass_stats.processed, (unsigned long long)pass_stats.skipped);
+    const auto& view_stats = m_motion_vector_reprojection.get_view_stats();
+    ImGui::Text("Motion vector views: %llu hits, %llu created", (unsigned long long)view_stats.hits, (unsigned long long)view_stats.misses);
+    const auto correction_stats = GlobalPool::get_correction_stats();
+    ImGui::Text("Correction matrices: %llu reused, %llu computed, %llu uncorrected", (unsigned long long)correction_stats.hits, (unsigned long long)correction_stats.misses,
+        (unsigned long long)correction_stats.unavailable);
 #endif
+
+    m_history_reset_distance->draw("History Reset Distance (0 = off)");
+    ImGui::Text("History resets: game viewport %llu, AFR viewport %llu",
+        (unsigned long long)m_eyes.state(EyeContexts::NATIVE).resets, (unsigned long long)m_eyes.state(EyeContexts::EXTRA).resets);
 }
 
-void UpscalerAfrNvidiaModule::on_config_load(const utility::Config& cfg, bool set_defaults)
+void UpscalerAfrNvidiaModule::on_config_load(const utility::ConfigStore& cfg, bool set_defaults)
 {
     for (IModValue& option : m_options) {
         option.config_load(cfg, set_defaults);
     }
 }
 
-void UpscalerAfrNvidiaModule::on_config_save(utility::Config& cfg)
+void UpscalerAfrNvidiaModule::on_config_save(utility::ConfigStore& cfg)
 {
     for (IModValue& option : m_options) {
         option.config_save(cfg);
     }
 }
 
+uint32_t UpscalerAfrNvidiaModule::on_config_reload(const utility::ConfigStore& cfg)
+{
+    return apply_config_changes(m_options, cfg);
+}
+
 void UpscalerAfrNvidiaModule::on_device_reset()
 {
+    m_eyes.invalidate();
 #ifdef MOTION_VECTOR_REPROJECTION
     m_motion_vector_reprojection.on_device_reset();
 #endif
@@ -57,14 +78,19 @@ void UpscalerAfrNvidiaModule::on_d3d12_initialize(ID3D12Device4* pDevice4, D3D12
 
 void UpscalerAfrNvidiaModule::InstallHooks()
 {
-    static HMODULE p_hm_sl_interposter = nullptr;
-    if (p_hm_sl_interposter) {
+    static bool s_requested = false;
+    if (s_requested) {
         return;
     }
+    s_requested = true;
+
+    // Streamline is usually loaded well after us, install the hooks whenever it shows up
+    ModuleWatcher::get().on_load("sl.interposer.dll", [this](HMODULE module) { InstallInterposerHooks(module); });
+}
+
+void UpscalerAfrNvidiaModule::InstallInterposerHooks(HMODULE p_hm_sl_interposter)
+{
     spdlog::info("Installing sl.interposer hooks");
-    while ((p_hm_sl_interposter = GetModuleHandle("sl.interposer.dll")) == nullptr) {
-        std::this_thread::yield();
-    }
 
 //    auto getNewFrameTokenFn = GetProcAddress(g_interposer, "slGetNewFrameToken");
 //    m_get_new_frame_token_hook = std::make_unique<FunctionHook>((void **)getNewFrameTokenFn, (void *) &DlssDualView::on_slGetNewFrameToken);
@@ -187,7 +213,7 @@ void UpscalerAfrNvidiaModule::ReprojectMotionVectors(const sl::FrameToken& frame
 #ifdef _DEBUG
         static auto shader_debug_overlay = ShaderDebugOverlay::Get();
         if(DebugUtils::config.debugShaders && ShaderDebugOverlay::ValidateResource(mv_native_resource, shader_debug_overlay->m_motion_vector_buffer)) {
-            ShaderDebugOverlay::CopyResource(command_list, mv_native_resource, shader_debug_overlay->m_motion_vector_buffer[vr->m_render_frame_count % 4].Get(), mv_state, D3D12_RESOURCE_STATE_GENERIC_READ);
+            ShaderDebugOverlay::CopyResource(command_list, mv_native_resource, shader_debug_overlay->m_motion_vector_buffer.retag(vr->m_render_frame_count).Get(), mv_state, D3D12_RESOURCE_STATE_GENERIC_READ);
         }
 #endif
     }
@@ -202,7 +228,7 @@ sl::Result UpscalerAfrNvidiaModule::on_slSetTag(sl::ViewportHandle& viewport, co
     static auto            vr          = VR::get();
     // spdlog::error("UNEXPECTED CALL TO slSetTag");
     // exit(1);
-    if(vr->m_render_frame_count % 2 == 0 && instance->m_enabled->value()) {
+    if(instance->m_enabled->value() && instance->m_eyes.eye_for_frame(vr->m_render_frame_count) == EyeContexts::EXTRA) {
         sl::ViewportHandle afr_viewport_handle{instance->m_afr_viewport_id};
         return original_fn(afr_viewport_handle, tags, numTags, cmdBuffer);
     }
@@ -244,8 +270,7 @@ sl::Result UpscalerAfrNvidiaModule::on_slEvaluateFeature(sl::Feature feature, co
 //
 //    uint32_t filteredNumInputs = static_cast<uint32_t>(filtered_inputs.size());
 #ifdef MOTION_VECTOR_REPROJECTION
-    //TODO might process same resource twice per frame we to track last processed resource per frame
-
+    // Safe to call on every evaluate, the same vectors are only corrected once per frame
     if(supported_afr_feature(feature)) {
         /**
         * DLSS uses per-pixel motion vectors as a key component of its core algorithm. The motion vectors map a
@@ -259,19 +284,13 @@ sl::Result UpscalerAfrNvidiaModule::on_slEvaluateFeature(sl::Feature feature, co
     }
 #endif
 
-    if(frame % 2 == 0 && supported_afr_feature(feature) && instance->m_enabled->value()) {
+    if(instance->m_eyes.eye_for_frame(frame) == EyeContexts::EXTRA && supported_afr_feature(feature) && instance->m_enabled->value()) {
         sl::ViewportHandle afr_viewport_handle{instance->m_afr_viewport_id};
-        std::vector<sl::BaseStructure*> afr_inputs{};
-        afr_inputs.resize(numInputs);
         //TODO  viewport is always at index 0
-        for (uint32_t i = 0; i < numInputs; i++) {
-            if (inputs[i]->structType == sl::ViewportHandle::s_structType) {
-                afr_inputs[i] = &afr_viewport_handle;
-            } else {
-                afr_inputs[i] = inputs[i];
-            }
-        }
-        return original_fn(feature, frame, afr_inputs.data(), numInputs, cmdBuffer);
+        auto afr_inputs = instance->m_afr_inputs.remap(inputs, numInputs, [&](sl::BaseStructure* input) -> sl::BaseStructure* {
+            return input->structType == sl::ViewportHandle::s_structType ? &afr_viewport_handle : nullptr;
+        });
+        return original_fn(feature, frame, afr_inputs, numInputs, cmdBuffer);
     }
     auto result = original_fn(feature, frame, inputs, numInputs, cmdBuffer);
     return result;
@@ -294,12 +313,28 @@ sl::Result UpscalerAfrNvidiaModule::on_slSetConstants(sl::Constants& values, con
 #endif
 
 
-    if(frame % 2 == 0 && instance->m_enabled->value()) {
+    if(!instance->m_enabled->value()) {
+        return original_fn(values, frame, viewport);
+    }
+
+    static auto vr = VR::get();
+    instance->m_eyes.thresholds().max_translation = instance->m_history_reset_distance->value();
+
+    // Repeated calls for the same frame get the decision of the first one
+    const auto dispatch = instance->m_eyes.begin(frame, GlobalPool::get_eye_pose(vr->m_render_frame_count), values.reset == sl::Boolean::eTrue,
+        values.jitterOffset.x, values.jitterOffset.y);
+
+    sl::Constants eye_values = values;
+
+    if(dispatch.should_reset()) {
+        eye_values.reset = sl::Boolean::eTrue;
+    }
+
+    if(dispatch.eye == EyeContexts::EXTRA) {
         sl::ViewportHandle afr_viewport_handle{instance->m_afr_viewport_id};
-        return original_fn(values, frame, afr_viewport_handle);
+        return original_fn(eye_values, frame, afr_viewport_handle);
     }
-    auto result = original_fn(values, frame, viewport);
-    return result;
+    return original_fn(eye_values, frame, viewport);
 }
 
 //sl::Result UpscalerAfrNvidiaModule::on_slDVCSetOptions(const sl::ViewportHandle &viewport, const sl::DeepDVCOptions &options) {
@@ -343,7 +378,7 @@ sl::Result UpscalerAfrNvidiaModule::on_slFreeResources(sl::Feature feature, cons
         sl::ViewportHandle afr_viewport_handle{instance->m_afr_viewport_id};
         original_fn(feature, afr_viewport_handle);
     }
-    spdlog::info("slFreeResources called for feature {:x} viewport {:x}", (UINT)feature, (UINT)viewport);
+    VR_HOT_LOG(spdlog::level::info, 1.0, 10, "slFreeResources called for feature {:x} viewport {:x}", (UINT)feature, (UINT)viewport);
     return original_fn(feature, viewport);
 }
 
@@ -354,7 +389,8 @@ sl::Result UpscalerAfrNvidiaModule::on_slAllocateResources(sl::CommandBuffer* cm
     if(supported_afr_feature(feature) && instance->m_enabled->value()) {
         sl::ViewportHandle afr_viewport_handle{instance->m_afr_viewport_id};
         original_fn(cmdBuffer, feature, afr_viewport_handle);
+        instance->m_eyes.invalidate();
     }
-    spdlog::info("slAllocateResources called for feature {:x} viewport {:x}", (UINT)feature, (UINT)viewport);
+    VR_HOT_LOG(spdlog::level::info, 1.0, 10, "slAllocateResources called for feature {:x} viewport {:x}", (UINT)feature, (UINT)viewport);
     return original_fn(cmdBuffer, feature, viewport);
 }
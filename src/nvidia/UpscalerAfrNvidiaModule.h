@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Mod.hpp>
+#include <aer/EyeContexts.hpp>
 #include <DescriptorHeap.h>
 #include <d3d12.h>
 #include <mods/vr/d3d12/ComPtr.hpp>
@@ -29,16 +30,18 @@ public:
     
     std::optional<std::string> on_initialize() override;
     void on_draw_ui() override;
-    void on_config_load(const utility::Config& cfg, bool set_defaults) override;
-    void on_config_save(utility::Config& cfg) override;
+    void on_config_load(const utility::ConfigStore& cfg, bool set_defaults) override;
+    void on_config_save(utility::ConfigStore& cfg) override;
+    uint32_t on_config_reload(const utility::ConfigStore& cfg) override;
     void on_device_reset() override;
     void on_d3d12_initialize(ID3D12Device4* pDevice4, D3D12_RESOURCE_DESC& desc) override;
 
-    UpscalerAfrNvidiaModule() = default;
+    UpscalerAfrNvidiaModule() { m_eyes.set_extra(m_afr_viewport_id); }
     ~UpscalerAfrNvidiaModule() override = default;
 
 private:
     void InstallHooks();
+    void InstallInterposerHooks(HMODULE p_hm_sl_interposter);
 
     // Motion vector reprojection component
 #ifdef MOTION_VECTOR_REPROJECTION
@@ -59,6 +62,11 @@ private:
 
     uint32_t m_afr_viewport_id{1024 + 1};
 
+    // Odd frames stay on the game's viewport, even ones go to m_afr_viewport_id
+    using EyeContexts = aer::EyeContexts<uint32_t>;
+    EyeContexts m_eyes{1};
+    aer::InputRemap<sl::BaseStructure> m_afr_inputs{};
+
     void ReprojectMotionVectors(const sl::FrameToken& frame, sl::BaseStructure** inputs, uint32_t numInputs, void* cmdBuffer);
 
 //    static sl::Result on_slGetNewFrameToken(sl::FrameToken*& token, const uint32_t* frameIndex = nullptr);
@@ -76,9 +84,12 @@ private:
     // ModValue settings
     const ModToggle::Ptr m_enabled{ ModToggle::create(generate_name("Enabled"), true) };
     const ModToggle::Ptr m_motion_vector_fix{ ModToggle::create(generate_name("MotionVectorFix"), true) };
+    // Camera movement between two frames of one eye that throws its history away, in game units. Off by default, scales differ per game.
+    const ModSlider::Ptr m_history_reset_distance{ ModSlider::create(generate_name("HistoryResetDistance"), 0.0f, 1000.0f, 0.0f) };
     
     ValueList m_options{
         *m_enabled,
+        *m_history_reset_distance,
 #ifdef MOTION_VECTOR_REPROJECTION
         *m_motion_vector_fix
 #endif
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+namespace utility {
+// Persists config snapshots on a worker.
+// Bursts (e.g. dragging a slider) collapse into one write once changes have been
+// quiet for `debounce`, but a write never gets delayed past `max_delay`.
+// Only the latest snapshot matters, older ones are dropped.
+// Callers either submit() a finished snapshot or request() one, which `build` then makes on
+// the worker once it's due, so the caller's thread never pays for building it.
+template <typename Snapshot>
+class AsyncConfigWriter {
+public:
+    using clock = std::chrono::steady_clock;
+    using WriteFn = std::function<void(Snapshot&)>;
+    using BuildFn = std::function<std::optional<Snapshot>()>;
+
+    AsyncConfigWriter(WriteFn write, BuildFn build = {}, clock::duration debounce = std::chrono::milliseconds(500), clock::duration max_delay = std::chrono::seconds(2))
+        : m_write{std::move(write)},
+          m_build{std::move(build)},
+          m_debounce{debounce},
+          m_max_delay{max_delay}
+    {
+        m_thread = std::jthread{[this](std::stop_token s) { run(s); }};
+    }
+
+    // Writes whatever is still pending before going away.
+    ~AsyncConfigWriter() {
+        m_thread.request_stop();
+
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    void submit(Snapshot snapshot, clock::time_point now = clock::now()) {
+        {
+            std::scoped_lock _{m_mtx};
+
+            if (!is_pending()) {
+                m_first_submit = now;
+            }
+
+            m_pending = std::move(snapshot);
+            m_requested = false;
+            m_last_submit = now;
+            ++m_submitted;
+        }
+
+        m_cv.notify_one();
+    }
+
+    // Marks the config dirty, the snapshot is built by `build` on the worker when it's due.
+    void request(clock::time_point now = clock::now()) {
+        {
+            std::scoped_lock _{m_mtx};
+
+            if (!is_pending()) {
+                m_first_submit = now;
+            }
+
+            m_pending.reset();
+            m_requested = true;
+            m_last_submit = now;
+            ++m_submitted;
+        }
+
+        m_cv.notify_one();
+    }
+
+    // Blocks until everything submitted so far is written.
+    // Not while holding anything `build` locks, the worker builds the snapshot.
+    void flush() {
+        std::unique_lock lock{m_mtx};
+        m_flush_requested = true;
+        m_cv.notify_one();
+        m_done_cv.wait(lock, [this] { return !is_pending() && !m_writing; });
+    }
+
+    // When the pending snapshot is due, for the given submit times.
+    static clock::time_point due_time(clock::time_point first_submit, clock::time_point last_submit, clock::duration debounce, clock::duration max_delay) {
+        return std::min(last_submit + debounce, first_submit + max_delay);
+    }
+
+    uint64_t get_submitted() const { return m_submitted; }
+    uint64_t get_written() const { return m_written; }
+
+private:
+    bool is_pending() const {
+        return m_pending.has_value() || m_requested;
+    }
+
+    void run(std::stop_token s) {
+        std::unique_lock lock{m_mtx};
+
+        while (true) {
+            m_cv.wait(lock, s, [this] { return is_pending(); });
+
+            if (!is_pending()) {
+                break; // stopped with nothing to write
+            }
+
+            // Keep sliding the deadline while new snapshots keep coming in
+            while (!s.stop_requested() && !m_flush_requested) {
+                const auto due = due_time(m_first_submit, m_last_submit, m_debounce, m_max_delay);
+
+                if (clock::now() >= due) {
+                    break;
+                }
+
+                m_cv.wait_until(lock, s, due, [this] { return m_flush_requested; });
+            }
+
+            auto snapshot = std::move(m_pending);
+            const auto build = std::exchange(m_requested, false);
+            m_pending.reset();
+            m_flush_requested = false;
+            m_writing = true;
+
+            lock.unlock();
+
+            if (build && m_build) {
+                snapshot = m_build();
+            }
+
+            if (snapshot) {
+                m_write(*snapshot);
+            }
+
+            lock.lock();
+
+            m_writing = false;
+            m_written += snapshot ? 1 : 0;
+            m_done_cv.notify_all();
+
+            if (s.stop_requested() && !is_pending()) {
+                break;
+            }
+        }
+
+        m_done_cv.notify_all();
+    }
+
+    WriteFn m_write;
+    BuildFn m_build;
+    clock::duration m_debounce;
+    clock::duration m_max_delay;
+
+    std::mutex m_mtx{};
+    std::condition_variable_any m_cv{};
+    std::condition_variable_any m_done_cv{};
+
+    std::optional<Snapshot> m_pending{};
+    bool m_requested{false};
+    clock::time_point m_first_submit{};
+    clock::time_point m_last_submit{};
+    bool m_flush_requested{false};
+    bool m_writing{false};
+
+    uint64_t m_submitted{0};
+    uint64_t m_written{0};
+
+    std::jthread m_thread{};
+};
+
+inline uint64_t fnv1a_64(std::string_view data) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (const auto c : data) {
+        hash ^= (uint8_t)c;
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+enum class CommitResult {
+    WRITTEN,
+    UNCHANGED,
+    FAILED
+};
+
+// Atomic save: writes `content` next to `path` and renames it over `path`, a crash mid-save leaves
+// either the old or the new file. Returns before touching the file at all if the content hash
+// matches `last_hash` and `path` is still there.
+inline CommitResult commit_file(std::string_view content, const std::filesystem::path& path, uint64_t& last_hash) {
+    std::error_code ec{};
+    const auto hash = fnv1a_64(content);
+
+    if (hash == last_hash && std::filesystem::exists(path, ec)) {
+        return CommitResult::UNCHANGED;
+    }
+
+    auto temp_path = path;
+    temp_path += ".tmp";
+
+    {
+        std::ofstream file{temp_path, std::ios::binary | std::ios::trunc};
+
+        if (!file || !file.write(content.data(), content.size()) || !file.flush()) {
+            file.close();
+            std::filesystem::remove(temp_path, ec);
+            return CommitResult::FAILED;
+        }
+    }
+
+    std::filesystem::rename(temp_path, path, ec);
+
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+        return CommitResult::FAILED;
+    }
+
+    last_hash = hash;
+    return CommitResult::WRITTEN;
+}
+} // namespace utility
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace utility {
+// Listener list for hooks that run tens of thousands of times per frame (command list setters).
+// Plain function pointers plus a user pointer in a fixed array instead of std::function, and when
+// nobody listens a dispatch is a single relaxed load.
+// Listeners can be added while other threads dispatch, a slot is written before the count that
+// publishes it. There's no removal, the owning hook is thrown away instead (see Framework::hook_d3d12).
+template <typename... Args>
+class CallbackDispatcher {
+public:
+    using Fn = void (*)(void* user, Args...);
+
+    static constexpr size_t MAX_LISTENERS = 8;
+
+    // False if it's full. Adding the same listener twice is a no-op.
+    bool add(Fn fn, void* user) {
+        const auto count = m_count.load(std::memory_order_relaxed);
+
+        for (uint32_t i = 0; i < count; ++i) {
+            if (m_listeners[i].fn == fn && m_listeners[i].user == user) {
+                return true;
+            }
+        }
+
+        if (count >= MAX_LISTENERS) {
+            return false;
+        }
+
+        m_listeners[count] = Listener{fn, user};
+        m_count.store(count + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return m_count.load(std::memory_order_relaxed) == 0;
+    }
+
+    size_t size() const {
+        return m_count.load(std::memory_order_acquire);
+    }
+
+    void operator()(Args... args) const {
+        if (empty()) {
+            return;
+        }
+
+        const auto count = m_count.load(std::memory_order_acquire);
+
+        for (uint32_t i = 0; i < count; ++i) {
+            m_listeners[i].fn(m_listeners[i].user, args...);
+        }
+    }
+
+private:
+    struct Listener {
+        Fn fn{nullptr};
+        void* user{nullptr};
+    };
+
+    std::array<Listener, MAX_LISTENERS> m_listeners{};
+    std::atomic<uint32_t> m_count{0};
+};
+} // namespace utility
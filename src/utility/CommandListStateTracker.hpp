@@ -0,0 +1,336 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace utility {
+// Shadow copy of the state that was last bound on each command list that is being recorded, so the
+// command list hooks only bother their listeners when something actually changed.
+// Keyed by the command list pointer in a fixed open addressing table. An entry is claimed with a CAS the
+// first time a list sets something and given back on Close/Reset/ClearState and when a list is created
+// (release), that keeps the table down to the lists that are recording right now and a new list at the
+// address of one that was freed mid recording doesn't inherit its state.
+// D3D12 never records one command list on two threads at once, so an entry is only ever touched by the
+// thread that claimed it and the state itself needs no synchronization. Forgetting every list (invalidate)
+// only bumps an epoch, each list drops its stale state itself on its next call.
+// Lists that don't fit (table full, probe limit hit) are untracked, every call on them counts as a change.
+// Doesn't touch D3D, the descriptor handle, viewport and rect types are compared bytewise.
+template <typename Handle, typename Viewport, typename Rect, size_t Capacity = 256>
+class CommandListStateTracker {
+public:
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity has to be a power of two");
+    static_assert(std::is_trivially_copyable_v<Handle> && std::is_trivially_copyable_v<Viewport> && std::is_trivially_copyable_v<Rect>);
+
+    static constexpr size_t MAX_RENDER_TARGETS = 8;   // D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT
+    static constexpr size_t MAX_VIEWPORTS = 16;       // D3D12_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE
+    static constexpr size_t MAX_PROBES = 16;
+
+    struct Counter {
+        uint64_t calls{};
+        uint64_t redundant{};
+
+        double redundant_ratio() const {
+            return calls > 0 ? (double)redundant / (double)calls : 0.0;
+        }
+    };
+
+    struct Stats {
+        Counter render_targets{};
+        Counter viewports{};
+        Counter scissor_rects{};
+        Counter shading_rate{};
+        uint64_t untracked{};
+    };
+
+    // RSSetShadingRate's arguments, the D3D12_SHADING_RATE and the D3D12_SHADING_RATE_COMBINERs.
+    // No combiners (nullptr) are passthrough, which is 0.
+    struct ShadingRate {
+        uint32_t rate{0};
+        std::array<uint32_t, 2> combiners{}; // D3D12_RS_SET_SHADING_RATE_COMBINER_COUNT
+
+        bool operator==(const ShadingRate&) const = default;
+    };
+
+    // All of these return true when the call changes what's bound, i.e. when listeners have work to do.
+
+    // With `single_handle` the handles are one contiguous range starting at handles[0], `dsv` is optional.
+    bool set_render_targets(const void* cmd_list, uint32_t num, const Handle* handles, bool single_handle, const Handle* dsv) {
+        auto entry = acquire(cmd_list);
+
+        if (entry == nullptr) {
+            return true;
+        }
+
+        auto& state = entry->state;
+        const auto stored = std::min<uint32_t>(handles != nullptr ? (single_handle ? std::min<uint32_t>(num, 1) : num) : 0, MAX_RENDER_TARGETS);
+        const auto redundant = state.render_targets_set && state.num_render_targets == num && state.single_handle == single_handle &&
+                               (stored == 0 || std::memcmp(state.render_targets.data(), handles, stored * sizeof(Handle)) == 0) &&
+                               state.has_depth_stencil == (dsv != nullptr) && (dsv == nullptr || std::memcmp(&state.depth_stencil, dsv, sizeof(Handle)) == 0);
+
+        count(entry->counters.render_targets, redundant);
+
+        if (redundant) {
+            return false;
+        }
+
+        state.render_targets_set = true;
+        state.num_render_targets = num;
+        state.single_handle = single_handle;
+        state.has_depth_stencil = dsv != nullptr;
+
+        if (stored > 0) {
+            std::memcpy(state.render_targets.data(), handles, stored * sizeof(Handle));
+        }
+
+        if (dsv != nullptr) {
+            std::memcpy(&state.depth_stencil, dsv, sizeof(Handle));
+        }
+
+        return true;
+    }
+
+    bool set_viewports(const void* cmd_list, uint32_t num, const Viewport* viewports) {
+        auto entry = acquire(cmd_list);
+        return entry == nullptr || update(entry->state.viewports, entry->counters.viewports, num, viewports);
+    }
+
+    bool set_scissor_rects(const void* cmd_list, uint32_t num, const Rect* rects) {
+        auto entry = acquire(cmd_list);
+        return entry == nullptr || update(entry->state.scissor_rects, entry->counters.scissor_rects, num, rects);
+    }
+
+    // The game's own RSSetShadingRate and RSSetShadingRateImage calls, recorded but not counted.
+    void observe_shading_rate(const void* cmd_list, const ShadingRate& rate) {
+        if (auto entry = acquire(cmd_list)) {
+            entry->state.shading_rate_set = true;
+            entry->state.shading_rate = rate;
+        }
+    }
+
+    void observe_shading_rate_image(const void* cmd_list, const void* image) {
+        if (auto entry = acquire(cmd_list)) {
+            entry->state.shading_rate_image_set = true;
+            entry->state.shading_rate_image = image;
+        }
+    }
+
+    // Only once the game's shading rate calls are observed (hooked) does a list's shading rate state mean
+    // anything, until then set_shading_rate reports every call as a change.
+    void set_observing_shading_rate(bool observing) {
+        m_observing_shading_rate.store(observing, std::memory_order_relaxed);
+    }
+
+    // For listeners that bind a rate and shading rate image themselves, nullptr is a valid image (VRS off).
+    bool set_shading_rate(const void* cmd_list, const ShadingRate& rate, const void* image) {
+        auto entry = acquire(cmd_list);
+
+        if (entry == nullptr) {
+            return true;
+        }
+
+        auto& state = entry->state;
+        const auto redundant = m_observing_shading_rate.load(std::memory_order_relaxed) && state.shading_rate_set && state.shading_rate == rate &&
+                               state.shading_rate_image_set && state.shading_rate_image == image;
+
+        count(entry->counters.shading_rate, redundant);
+
+        state.shading_rate_set = true;
+        state.shading_rate = rate;
+        state.shading_rate_image_set = true;
+        state.shading_rate_image = image;
+        return !redundant;
+    }
+
+    // Close, Reset and ClearState, everything that was bound is gone afterwards.
+    void release(const void* cmd_list) {
+        const auto key = (uintptr_t)cmd_list;
+        auto entry = key != 0 ? find(key) : nullptr;
+
+        if (entry == nullptr) {
+            return;
+        }
+
+        fold(entry->counters);
+        entry->state = {};
+        entry->counters = {};
+        entry->key.store(0, std::memory_order_release);
+    }
+
+    // Forgets what every list had bound, for when calls may have been missed (hooks reinstalled).
+    // Fine while lists are recording, entries stay with their lists and are reset by their own thread.
+    void invalidate() {
+        m_epoch.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    // Counters of lists that are still recording show up once they're released.
+    Stats get_stats() const {
+        Stats out{};
+        out.render_targets = m_stats.render_targets.load();
+        out.viewports = m_stats.viewports.load();
+        out.scissor_rects = m_stats.scissor_rects.load();
+        out.shading_rate = m_stats.shading_rate.load();
+        out.untracked = m_stats.untracked.load(std::memory_order_relaxed);
+        return out;
+    }
+
+private:
+    template <typename T>
+    struct Bindings {
+        bool set{false};
+        uint32_t num{0};
+        std::array<T, MAX_VIEWPORTS> values{};
+    };
+
+    struct State {
+        bool render_targets_set{false};
+        bool single_handle{false};
+        bool has_depth_stencil{false};
+        uint32_t num_render_targets{0};
+        std::array<Handle, MAX_RENDER_TARGETS> render_targets{};
+        Handle depth_stencil{};
+        Bindings<Viewport> viewports{};
+        Bindings<Rect> scissor_rects{};
+        bool shading_rate_set{false};
+        ShadingRate shading_rate{};
+        bool shading_rate_image_set{false};
+        const void* shading_rate_image{nullptr};
+    };
+
+    struct Counters {
+        Counter render_targets{};
+        Counter viewports{};
+        Counter scissor_rects{};
+        Counter shading_rate{};
+    };
+
+    struct alignas(64) Entry {
+        std::atomic<uintptr_t> key{0};
+        uint64_t epoch{0}; // m_epoch when the state was last valid, owned by the recording thread like the state
+        State state{};
+        Counters counters{};
+    };
+
+    struct SharedCounter {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> redundant{0};
+
+        void add(const Counter& c) {
+            calls.fetch_add(c.calls, std::memory_order_relaxed);
+            redundant.fetch_add(c.redundant, std::memory_order_relaxed);
+        }
+
+        Counter load() const {
+            return Counter{calls.load(std::memory_order_relaxed), redundant.load(std::memory_order_relaxed)};
+        }
+    };
+
+    struct SharedStats {
+        SharedCounter render_targets{};
+        SharedCounter viewports{};
+        SharedCounter scissor_rects{};
+        SharedCounter shading_rate{};
+        std::atomic<uint64_t> untracked{0};
+    };
+
+    static size_t home_slot(uintptr_t key) {
+        // COM objects are at least 16 byte aligned, fibonacci hashing spreads the rest
+        return (size_t)(((uint64_t)(key >> 4) * 0x9E3779B97F4A7C15ull) >> 32) & (Capacity - 1);
+    }
+
+    static void count(Counter& counter, bool redundant) {
+        ++counter.calls;
+        counter.redundant += redundant ? 1 : 0;
+    }
+
+    template <typename T>
+    static bool update(Bindings<T>& bindings, Counter& counter, uint32_t num, const T* values) {
+        const auto stored = values != nullptr ? std::min<uint32_t>(num, MAX_VIEWPORTS) : 0;
+        const auto redundant = bindings.set && bindings.num == num && (stored == 0 || std::memcmp(bindings.values.data(), values, stored * sizeof(T)) == 0);
+
+        count(counter, redundant);
+
+        if (redundant) {
+            return false;
+        }
+
+        bindings.set = true;
+        bindings.num = num;
+
+        if (stored > 0) {
+            std::memcpy(bindings.values.data(), values, stored * sizeof(T));
+        }
+
+        return true;
+    }
+
+    // Released entries leave holes in probe chains, so a lookup always walks all MAX_PROBES slots
+    // instead of stopping at the first free one.
+    Entry* find(uintptr_t key) {
+        const auto home = home_slot(key);
+
+        for (size_t i = 0; i < MAX_PROBES; ++i) {
+            auto& entry = m_entries[(home + i) & (Capacity - 1)];
+
+            if (entry.key.load(std::memory_order_acquire) == key) {
+                return &entry;
+            }
+        }
+
+        return nullptr;
+    }
+
+    Entry* acquire(const void* cmd_list) {
+        const auto key = (uintptr_t)cmd_list;
+
+        if (key == 0) {
+            return nullptr;
+        }
+
+        const auto epoch = m_epoch.load(std::memory_order_acquire);
+
+        if (auto entry = find(key)) {
+            if (entry->epoch != epoch) {
+                fold(entry->counters);
+                entry->state = {};
+                entry->counters = {};
+                entry->epoch = epoch;
+            }
+
+            return entry;
+        }
+
+        // Only the recording thread inserts its own list, so nobody else can claim `key` in the meantime
+        const auto home = home_slot(key);
+
+        for (size_t i = 0; i < MAX_PROBES; ++i) {
+            auto& entry = m_entries[(home + i) & (Capacity - 1)];
+            uintptr_t expected = 0;
+
+            if (entry.key.compare_exchange_strong(expected, key, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                entry.epoch = epoch;
+                return &entry;
+            }
+        }
+
+        m_stats.untracked.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    void fold(const Counters& counters) {
+        m_stats.render_targets.add(counters.render_targets);
+        m_stats.viewports.add(counters.viewports);
+        m_stats.scissor_rects.add(counters.scissor_rects);
+        m_stats.shading_rate.add(counters.shading_rate);
+    }
+
+    std::array<Entry, Capacity> m_entries{};
+    SharedStats m_stats{};
+    std::atomic<uint64_t> m_epoch{0};
+    std::atomic<bool> m_observing_shading_rate{false};
+};
+} // namespace utility
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+namespace utility {
+// Where a DXGI swapchain object keeps the command queue it was created with. Found once on a dummy
+// swapchain (see D3D12Hook::hook) and then used to read the queue out of the game's swapchain.
+struct CommandQueueLayout {
+    uint32_t queue_offset{0};
+    // Proton's swapchain wraps the real one, this is the offset of the pointer to it
+    std::optional<uint32_t> proton_offset{};
+};
+
+// Both functions only touch memory through `read(address) -> std::optional<uintptr_t>`, which
+// returns nullopt for anything that can't be read. Nothing here depends on Windows or D3D.
+
+// Scans the first `max_slots` pointers of `swap_chain` for `command_queue`, then the first
+// `max_slots` pointers of every object it points to, for the Proton case.
+template <typename Reader>
+std::optional<CommandQueueLayout> find_command_queue_layout(uintptr_t swap_chain, uintptr_t command_queue, Reader&& read, uint32_t max_slots = 512) {
+    const auto scan = [&](uintptr_t base) -> std::optional<uint32_t> {
+        for (uint32_t i = 0; i < max_slots * sizeof(void*); i += sizeof(void*)) {
+            const auto data = read(base + i);
+
+            // reached the end
+            if (!data) {
+                break;
+            }
+
+            if (*data == command_queue) {
+                return i;
+            }
+        }
+
+        return std::nullopt;
+    };
+
+    if (const auto offset = scan(swap_chain); offset && *offset != 0) {
+        return CommandQueueLayout{*offset};
+    }
+
+    for (uint32_t base = 0; base < max_slots * sizeof(void*); base += sizeof(void*)) {
+        const auto inner = read(swap_chain + base);
+
+        if (!inner) {
+            break;
+        }
+
+        if (*inner == 0) {
+            continue;
+        }
+
+        if (const auto offset = scan(*inner); offset && *offset != 0) {
+            return CommandQueueLayout{*offset, base};
+        }
+    }
+
+    return std::nullopt;
+}
+
+// The object a Proton swapchain wraps, nullopt without a Proton layout. When this changes under the same
+// swapchain it was wrapped again and the queue has to be resolved again.
+template <typename Reader>
+std::optional<uintptr_t> wrapped_swap_chain(uintptr_t swap_chain, const CommandQueueLayout& layout, Reader&& read) {
+    if (!layout.proton_offset) {
+        return std::nullopt;
+    }
+
+    const auto inner = read(swap_chain + *layout.proton_offset);
+
+    if (!inner || *inner == 0) {
+        return std::nullopt;
+    }
+
+    return *inner;
+}
+
+// The queue of a live swapchain, nullopt if it doesn't look like a readable object.
+// A Proton swapchain can end up wrapped twice (Starfield after alt tab), one more level is tried then.
+template <typename Reader>
+std::optional<uintptr_t> resolve_command_queue(uintptr_t swap_chain, const CommandQueueLayout& layout, Reader&& read) {
+    auto real_swap_chain = swap_chain;
+    const auto levels = layout.proton_offset ? 2 : 1;
+
+    for (auto level = 0; level < levels; ++level) {
+        if (layout.proton_offset) {
+            const auto inner = read(real_swap_chain + *layout.proton_offset);
+
+            if (!inner || *inner == 0) {
+                return std::nullopt;
+            }
+
+            real_swap_chain = *inner;
+        }
+
+        const auto queue = read(real_swap_chain + layout.queue_offset);
+
+        // The vtable has to be readable too
+        if (queue && *queue != 0 && read(*queue)) {
+            return *queue;
+        }
+    }
+
+    return std::nullopt;
+}
+} // namespace utility
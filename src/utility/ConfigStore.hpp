@@ -0,0 +1,326 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace utility {
+constexpr uint64_t hash_config_key(std::string_view name) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (const auto c : name) {
+        hash ^= (uint8_t)c;
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+// Name plus its hash, so options can hash their name once (see ModValue) instead of on every lookup.
+struct ConfigKey {
+    constexpr ConfigKey(std::string_view n) : hash{hash_config_key(n)}, name{n} {}
+    constexpr ConfigKey(const char* n) : ConfigKey{std::string_view{n}} {}
+    ConfigKey(const std::string& n) : ConfigKey{std::string_view{n}} {}
+    constexpr ConfigKey(uint64_t h, std::string_view n) : hash{h}, name{n} {}
+
+    uint64_t hash;
+    std::string_view name;
+};
+
+// vr_config.txt in memory. Same "name=value" lines as the old kananlib Config, so older builds
+// can still read what we write, but values are formatted and parsed with to_chars/from_chars
+// straight from and into two flat arenas, without a string or stream per value.
+// A "#version=N" line records the format; keys nobody asked for are kept and written back,
+// so settings of options this build doesn't know survive a round trip.
+class ConfigStore {
+public:
+    static constexpr int CURRENT_VERSION = 2;
+    static constexpr int LEGACY_VERSION = 1; // no version line
+
+    ConfigStore() = default;
+
+    explicit ConfigStore(const std::filesystem::path& path) {
+        load(path);
+    }
+
+    bool load(const std::filesystem::path& path) {
+        std::ifstream file{path, std::ios::binary | std::ios::ate};
+
+        if (!file) {
+            return false;
+        }
+
+        std::string text(file.tellg(), '\0');
+        file.seekg(0);
+
+        if (!file.read(text.data(), text.size())) {
+            return false;
+        }
+
+        parse(text);
+        return true;
+    }
+
+    bool save(const std::filesystem::path& path) const {
+        std::string text{};
+        serialize(text);
+
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        return file && file.write(text.data(), text.size());
+    }
+
+    // Merges into what's already there, later lines win.
+    void parse(std::string_view text) {
+        m_version = LEGACY_VERSION;
+
+        while (!text.empty()) {
+            const auto eol = text.find('\n');
+            auto line = trim(text.substr(0, eol));
+            text = eol == std::string_view::npos ? std::string_view{} : text.substr(eol + 1);
+
+            if (line.empty()) {
+                continue;
+            }
+
+            const auto eq = line.find('=');
+
+            if (line.front() == '#') {
+                if (eq != std::string_view::npos && trim(line.substr(1, eq - 1)) == "version") {
+                    const auto v = trim(line.substr(eq + 1));
+                    std::from_chars(v.data(), v.data() + v.size(), m_version);
+                }
+
+                continue;
+            }
+
+            if (eq == std::string_view::npos) {
+                continue;
+            }
+
+            const auto name = trim(line.substr(0, eq));
+
+            if (!name.empty()) {
+                set_text(name, trim(line.substr(eq + 1)));
+            }
+        }
+    }
+
+    void serialize(std::string& out) const {
+        out.clear();
+        out.reserve(m_names.size() + m_values.size() + m_entries.size() * 2 + 16);
+        out += "#version=";
+
+        char buf[16]{};
+        out.append(buf, std::to_chars(buf, buf + sizeof(buf), CURRENT_VERSION).ptr);
+        out += '\n';
+
+        for (const auto& e : m_entries) {
+            out.append(m_names, e.name_offset, e.name_length);
+            out += '=';
+            out.append(m_values, e.value_offset, e.value_length);
+            out += '\n';
+        }
+    }
+
+    std::optional<std::string_view> get_text(const ConfigKey& key) const {
+        const auto e = find(key);
+
+        if (e == nullptr) {
+            return std::nullopt;
+        }
+
+        return std::string_view{m_values}.substr(e->value_offset, e->value_length);
+    }
+
+    std::optional<std::string> get(const ConfigKey& key) const {
+        const auto text = get_text(key);
+        return text ? std::optional<std::string>{std::string{*text}} : std::nullopt;
+    }
+
+    template <typename T>
+    std::optional<T> get(const ConfigKey& key) const {
+        const auto text = get_text(key);
+
+        if (!text) {
+            return std::nullopt;
+        }
+
+        return parse_value<T>(*text);
+    }
+
+    void set(const ConfigKey& key, std::string_view value) {
+        set_text(key, value);
+    }
+
+    template <typename T>
+    void set(const ConfigKey& key, const T& value) {
+        if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            set_text(key, std::string_view{value});
+        } else {
+            char buf[64]{};
+            set_text(key, format_value(buf, sizeof(buf), value));
+        }
+    }
+
+    bool contains(const ConfigKey& key) const {
+        return find(key) != nullptr;
+    }
+
+    size_t size() const {
+        return m_entries.size();
+    }
+
+    int get_version() const {
+        return m_version;
+    }
+
+    // "1"/"0" for bools so older builds (stream extraction into bool) still read them.
+    template <typename T>
+    static std::string_view format_value(char* buf, size_t size, const T& value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            return value ? "1" : "0";
+        } else if constexpr (std::is_enum_v<T>) {
+            return format_value(buf, size, (std::underlying_type_t<T>)value);
+        } else {
+            const auto result = std::to_chars(buf, buf + size, value);
+            return result.ec == std::errc{} ? std::string_view{buf, (size_t)(result.ptr - buf)} : std::string_view{};
+        }
+    }
+
+    // Lenient on purpose, legacy files have std::to_string output ("0.500000") and "true"/"false".
+    template <typename T>
+    static std::optional<T> parse_value(std::string_view text) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return std::string{text};
+        } else if constexpr (std::is_same_v<T, bool>) {
+            if (text == "1" || text == "true") {
+                return true;
+            }
+
+            if (text == "0" || text == "false") {
+                return false;
+            }
+
+            return std::nullopt;
+        } else if constexpr (std::is_enum_v<T>) {
+            const auto v = parse_value<std::underlying_type_t<T>>(text);
+            return v ? std::optional<T>{(T)*v} : std::nullopt;
+        } else {
+            if (!text.empty() && text.front() == '+') {
+                text.remove_prefix(1);
+            }
+
+            T value{};
+            auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+
+            if constexpr (std::is_integral_v<T>) {
+                // Integer options saved as floats at some point, e.g. "1.000000"
+                if (result.ec == std::errc{} && result.ptr != text.data() + text.size() && *result.ptr == '.') {
+                    double d{};
+
+                    if (std::from_chars(text.data(), text.data() + text.size(), d).ec == std::errc{}) {
+                        return (T)d;
+                    }
+                }
+            }
+
+            if (result.ec != std::errc{}) {
+                return std::nullopt;
+            }
+
+            return value;
+        }
+    }
+
+private:
+    struct Entry {
+        uint64_t hash{};
+        uint32_t name_offset{};
+        uint32_t name_length{};
+        uint32_t value_offset{};
+        uint32_t value_length{};
+        uint32_t value_capacity{};
+    };
+
+    static std::string_view trim(std::string_view s) {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t' || s.front() == '\r')) {
+            s.remove_prefix(1);
+        }
+
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) {
+            s.remove_suffix(1);
+        }
+
+        return s;
+    }
+
+    std::string_view name_of(const Entry& e) const {
+        return std::string_view{m_names}.substr(e.name_offset, e.name_length);
+    }
+
+    const Entry* find(const ConfigKey& key) const {
+        if (const auto it = m_index.find(key.hash); it != m_index.end()) {
+            const auto& e = m_entries[it->second];
+
+            if (name_of(e) == key.name) {
+                return &e;
+            }
+
+            // 64 bit hash collision, practically never, but still correct
+            for (const auto& other : m_entries) {
+                if (other.hash == key.hash && name_of(other) == key.name) {
+                    return &other;
+                }
+            }
+        }
+
+        return nullptr;
+    }
+
+    void set_text(const ConfigKey& key, std::string_view value) {
+        if (value.data() >= m_values.data() && value.data() < m_values.data() + m_values.size()) {
+            const std::string copy{value}; // would dangle if m_values grows
+            set_text(key, copy);
+            return;
+        }
+
+        auto e = (Entry*)find(key);
+
+        if (e == nullptr) {
+            Entry entry{};
+            entry.hash = key.hash;
+            entry.name_offset = (uint32_t)m_names.size();
+            entry.name_length = (uint32_t)key.name.size();
+            m_names.append(key.name);
+
+            m_index.try_emplace(key.hash, (uint32_t)m_entries.size());
+            e = &m_entries.emplace_back(entry);
+        }
+
+        // Overwrite in place when it fits, the common case for numbers
+        if (value.size() > e->value_capacity) {
+            e->value_offset = (uint32_t)m_values.size();
+            e->value_capacity = (uint32_t)std::max<size_t>(value.size(), 8);
+            m_values.append(e->value_capacity, '\0');
+        }
+
+        m_values.replace(e->value_offset, value.size(), value);
+        e->value_length = (uint32_t)value.size();
+    }
+
+    std::vector<Entry> m_entries{};
+    std::unordered_map<uint64_t, uint32_t> m_index{};
+    std::string m_names{};
+    std::string m_values{};
+    int m_version{CURRENT_VERSION};
+};
+} // namespace utility
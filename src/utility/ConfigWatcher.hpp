@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include "AsyncConfigWriter.hpp"
+#include "ConfigStore.hpp"
+
+namespace utility {
+struct FileStamp {
+    bool exists{false};
+    uintmax_t size{0};
+    std::filesystem::file_time_type write_time{};
+
+    bool operator==(const FileStamp& other) const = default;
+
+    static FileStamp of(const std::filesystem::path& path) {
+        std::error_code ec{};
+        FileStamp out{};
+
+        out.write_time = std::filesystem::last_write_time(path, ec);
+
+        if (ec) {
+            return {};
+        }
+
+        out.size = std::filesystem::file_size(path, ec);
+        out.exists = !ec;
+        return out;
+    }
+};
+
+// Editors truncate, write and rename in several steps, so a change only counts
+// once the stamp has stayed the same for `debounce`.
+class ChangeDebouncer {
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit ChangeDebouncer(clock::duration debounce = std::chrono::milliseconds(300))
+        : m_debounce{debounce}
+    {
+    }
+
+    // The first stamp seen is the baseline, not a change.
+    void reset(const FileStamp& stamp) {
+        m_settled = stamp;
+        m_candidate = stamp;
+        m_pending = false;
+    }
+
+    // True once per settled change.
+    bool observe(const FileStamp& stamp, clock::time_point now) {
+        if (stamp != m_candidate) {
+            m_candidate = stamp;
+            m_candidate_since = now;
+            m_pending = stamp != m_settled;
+            return false;
+        }
+
+        if (!m_pending || now - m_candidate_since < m_debounce) {
+            return false;
+        }
+
+        m_pending = false;
+        m_settled = m_candidate;
+
+        // A deleted file isn't a config to apply
+        return m_settled.exists;
+    }
+
+    bool is_pending() const {
+        return m_pending;
+    }
+
+private:
+    clock::duration m_debounce;
+    FileStamp m_settled{};
+    FileStamp m_candidate{};
+    clock::time_point m_candidate_since{};
+    bool m_pending{false};
+};
+
+// Watches vr_config.txt for edits made outside of the UI and parses them on its own thread.
+// The frame thread picks the result up with take(), only the newest one is kept.
+// Content we wrote ourselves (see note_written) or that didn't change isn't reported.
+class ConfigWatcher {
+public:
+    using clock = std::chrono::steady_clock;
+
+    ConfigWatcher(std::filesystem::path path, clock::duration poll_interval = std::chrono::milliseconds(250), clock::duration debounce = std::chrono::milliseconds(300))
+        : m_path{std::move(path)},
+          m_poll_interval{poll_interval},
+          m_debouncer{debounce}
+    {
+        m_debouncer.reset(FileStamp::of(m_path));
+        m_thread = std::jthread{[this](std::stop_token s) { run(s); }};
+    }
+
+    ~ConfigWatcher() {
+        m_thread.request_stop();
+
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    // Cheap enough to call every frame.
+    std::optional<ConfigStore> take() {
+        if (!m_has_pending.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+
+        std::scoped_lock _{m_mtx};
+        m_has_pending.store(false, std::memory_order_relaxed);
+
+        auto out = std::move(m_pending);
+        m_pending.reset();
+        return out;
+    }
+
+    // Hash (fnv1a_64) of content just written by us, so it doesn't come back as an edit.
+    void note_written(uint64_t content_hash) {
+        m_last_hash.store(content_hash, std::memory_order_relaxed);
+    }
+
+    uint64_t get_reloads() const {
+        return m_reloads.load(std::memory_order_relaxed);
+    }
+
+private:
+    void run(std::stop_token s) {
+        std::mutex wait_mtx{};
+        std::condition_variable_any cv{};
+
+        while (!s.stop_requested()) {
+            {
+                std::unique_lock lock{wait_mtx};
+                cv.wait_for(lock, s, m_debouncer.is_pending() ? m_poll_interval / 4 : m_poll_interval, [] { return false; });
+            }
+
+            if (s.stop_requested()) {
+                break;
+            }
+
+            if (m_debouncer.observe(FileStamp::of(m_path), clock::now())) {
+                read();
+            }
+        }
+    }
+
+    void read() {
+        std::string content{};
+
+        {
+            std::ifstream file{m_path, std::ios::binary};
+
+            if (!file) {
+                return;
+            }
+
+            content.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+        }
+
+        const auto hash = fnv1a_64(content);
+
+        if (m_last_hash.exchange(hash, std::memory_order_relaxed) == hash) {
+            return;
+        }
+
+        ConfigStore cfg{};
+        cfg.parse(content);
+
+        {
+            std::scoped_lock _{m_mtx};
+            m_pending = std::move(cfg);
+            m_has_pending.store(true, std::memory_order_release);
+        }
+
+        m_reloads.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::filesystem::path m_path;
+    clock::duration m_poll_interval;
+    ChangeDebouncer m_debouncer; // watcher thread only
+
+    std::mutex m_mtx{};
+    std::optional<ConfigStore> m_pending{};
+    std::atomic<bool> m_has_pending{false};
+    std::atomic<uint64_t> m_last_hash{0};
+    std::atomic<uint64_t> m_reloads{0};
+
+    std::jthread m_thread{};
+};
+} // namespace utility
@@ -0,0 +1,286 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+#include <spdlog/fmt/fmt.h>
+
+namespace utility {
+// What the exception filter is allowed to touch: fixed size, no allocations, no symbol lookups.
+// Everything that can be slow or fault again (dbghelp, PDB loading) happens later
+// from this snapshot, see CachedSymbolizer and format_crash_report.
+struct CrashModule {
+    uint64_t base{};
+    uint64_t size{};
+    // PE TimeDateStamp + SizeOfImage, the same pair symbol servers key PDBs on
+    uint32_t timestamp{};
+    uint32_t image_size{};
+    char path[260]{};
+};
+
+struct CrashCapture {
+    static constexpr size_t MAX_FRAMES = 64;
+    static constexpr size_t MAX_MODULES = 32;
+    static constexpr size_t MAX_REGISTERS = 18;
+
+    uint32_t code{};
+    uint64_t ip{};
+    uint32_t thread_id{};
+
+    // Names are copied, the capture is written to disk as is and read back by the next process
+    struct Register {
+        char name[8]{};
+        uint64_t value{};
+    };
+
+    std::array<Register, MAX_REGISTERS> registers{};
+    uint32_t register_count{};
+
+    std::array<uint64_t, MAX_FRAMES> frames{};
+    uint32_t frame_count{};
+
+    std::array<CrashModule, MAX_MODULES> modules{};
+    uint32_t module_count{};
+
+    void reset() {
+        code = 0;
+        ip = 0;
+        thread_id = 0;
+        register_count = 0;
+        frame_count = 0;
+        module_count = 0;
+    }
+
+    void add_register(std::string_view name, uint64_t value) {
+        if (register_count < registers.size()) {
+            auto& r = registers[register_count++];
+            const auto len = std::min(name.size(), sizeof(r.name) - 1);
+            std::memcpy(r.name, name.data(), len);
+            r.name[len] = '\0';
+            r.value = value;
+        }
+    }
+
+    void add_frame(uint64_t address) {
+        if (frame_count < frames.size()) {
+            frames[frame_count++] = address;
+        }
+    }
+
+    const CrashModule* find_module(uint64_t address) const {
+        for (uint32_t i = 0; i < module_count; ++i) {
+            const auto& m = modules[i];
+
+            if (address >= m.base && address < m.base + m.size) {
+                return &m;
+            }
+        }
+
+        return nullptr;
+    }
+
+    // Returns nullptr when the table is full.
+    CrashModule* add_module(uint64_t base, uint64_t size, uint32_t timestamp, uint32_t image_size, std::string_view path) {
+        if (module_count >= modules.size()) {
+            return nullptr;
+        }
+
+        auto& m = modules[module_count++];
+        m.base = base;
+        m.size = size;
+        m.timestamp = timestamp;
+        m.image_size = image_size;
+
+        const auto len = std::min(path.size(), sizeof(m.path) - 1);
+        std::memcpy(m.path, path.data(), len);
+        m.path[len] = '\0';
+
+        return &m;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<CrashCapture>);
+
+// On disk a capture is this header followed by the CrashCapture bytes. Only read back by the
+// same build that wrote it, so anything that doesn't match exactly is thrown away.
+struct CrashCaptureHeader {
+    static constexpr uint32_t MAGIC = 0x43435256; // "VRCC"
+
+    uint32_t magic{MAGIC};
+    uint32_t size{sizeof(CrashCapture)};
+};
+
+inline std::optional<CrashCapture> read_crash_capture(const void* data, size_t size) {
+    CrashCaptureHeader header{};
+
+    if (size != sizeof(header) + sizeof(CrashCapture)) {
+        return std::nullopt;
+    }
+
+    std::memcpy(&header, data, sizeof(header));
+
+    if (header.magic != CrashCaptureHeader::MAGIC || header.size != sizeof(CrashCapture)) {
+        return std::nullopt;
+    }
+
+    CrashCapture out{};
+    std::memcpy(&out, (const uint8_t*)data + sizeof(header), sizeof(out));
+
+    out.register_count = std::min<uint32_t>(out.register_count, CrashCapture::MAX_REGISTERS);
+    out.frame_count = std::min<uint32_t>(out.frame_count, CrashCapture::MAX_FRAMES);
+    out.module_count = std::min<uint32_t>(out.module_count, CrashCapture::MAX_MODULES);
+
+    for (auto& r : out.registers) {
+        r.name[sizeof(r.name) - 1] = '\0';
+    }
+
+    for (auto& m : out.modules) {
+        m.path[sizeof(m.path) - 1] = '\0';
+    }
+
+    return out;
+}
+
+// Address -> symbol cache in front of whatever does the real lookup (dbghelp on Windows).
+class CachedSymbolizer {
+public:
+    struct Symbol {
+        std::string name{};
+        std::string file{};
+        uint32_t line{};
+        uint64_t displacement{};
+    };
+
+    using Resolver = std::function<std::optional<Symbol>(uint64_t address, const CrashModule* module)>;
+
+    explicit CachedSymbolizer(Resolver resolver)
+        : m_resolver{std::move(resolver)}
+    {
+    }
+
+    // Misses are cached too, a failed lookup is usually the most expensive one.
+    const std::optional<Symbol>& resolve(uint64_t address, const CrashModule* module = nullptr) {
+        if (auto it = m_cache.find(address); it != m_cache.end()) {
+            ++m_hits;
+            return it->second;
+        }
+
+        ++m_misses;
+        return m_cache.emplace(address, m_resolver(address, module)).first->second;
+    }
+
+    size_t get_hits() const { return m_hits; }
+    size_t get_misses() const { return m_misses; }
+
+    void clear() {
+        m_cache.clear();
+        m_hits = 0;
+        m_misses = 0;
+    }
+
+private:
+    Resolver m_resolver;
+    std::unordered_map<uint64_t, std::optional<Symbol>> m_cache{};
+    size_t m_hits{0};
+    size_t m_misses{0};
+};
+
+inline std::string_view crash_module_name(const CrashModule& module) {
+    const auto path = std::string_view{module.path};
+    const auto slash = path.find_last_of("\\/");
+
+    return slash == std::string_view::npos ? path : path.substr(slash + 1);
+}
+
+// Compact text report, one line per frame, modules listed once with their build ids
+// so the frames can be symbolized offline against the matching PDBs.
+// Without a symbolizer and with a TruncatingWriter nothing is allocated.
+template <typename Out>
+Out format_crash_report_to(Out out, const CrashCapture& capture, CachedSymbolizer* symbolizer = nullptr) {
+    out = fmt::format_to(out, "Exception 0x{:x} at 0x{:x} (thread {})\n", capture.code, capture.ip, capture.thread_id);
+
+    for (uint32_t i = 0; i < capture.register_count; ++i) {
+        out = fmt::format_to(out, "{}{}=0x{:x}", i % 6 == 0 ? "\n " : " ", capture.registers[i].name, capture.registers[i].value);
+    }
+
+    out = fmt::format_to(out, "\n\nCall stack:\n");
+
+    for (uint32_t i = 0; i < capture.frame_count; ++i) {
+        const auto address = capture.frames[i];
+        const auto module = capture.find_module(address);
+
+        if (module != nullptr) {
+            out = fmt::format_to(out, " #{:02} {}+0x{:x}", i, crash_module_name(*module), address - module->base);
+        } else {
+            out = fmt::format_to(out, " #{:02} 0x{:x}", i, address);
+        }
+
+        if (symbolizer != nullptr) {
+            if (const auto& symbol = symbolizer->resolve(address, module); symbol) {
+                out = fmt::format_to(out, " {}+0x{:x}", symbol->name, symbol->displacement);
+
+                if (!symbol->file.empty()) {
+                    out = fmt::format_to(out, " ({}:{})", symbol->file, symbol->line);
+                }
+            }
+        }
+
+        out = fmt::format_to(out, "\n");
+    }
+
+    out = fmt::format_to(out, "\nModules:\n");
+
+    for (uint32_t i = 0; i < capture.module_count; ++i) {
+        const auto& m = capture.modules[i];
+        out = fmt::format_to(out, " 0x{:x}-0x{:x} {:08X}{:x} {}\n", m.base, m.base + m.size, m.timestamp, m.image_size, m.path);
+    }
+
+    return out;
+}
+
+// Output iterator over a fixed buffer that drops whatever doesn't fit.
+struct TruncatingWriter {
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    char* pos{};
+    char* end{};
+
+    TruncatingWriter& operator*() { return *this; }
+    TruncatingWriter& operator++() { return *this; }
+    TruncatingWriter& operator++(int) { return *this; }
+
+    TruncatingWriter& operator=(char c) {
+        if (pos < end) {
+            *pos++ = c;
+        }
+
+        return *this;
+    }
+};
+
+// Allocation free, for the exception filter. Cut off at `capacity`, returns the length written.
+inline size_t format_crash_report(const CrashCapture& capture, char* buffer, size_t capacity) {
+    const auto result = format_crash_report_to(TruncatingWriter{buffer, buffer + capacity}, capture);
+    return (size_t)(result.pos - buffer);
+}
+
+inline std::string format_crash_report(const CrashCapture& capture, CachedSymbolizer* symbolizer = nullptr) {
+    std::string out{};
+    format_crash_report_to(std::back_inserter(out), capture, symbolizer);
+    return out;
+}
+} // namespace utility
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace utility {
+enum class ViewType : uint8_t {
+    SRV,
+    UAV,
+    RTV,
+    DSV,
+};
+
+// Everything that makes two views of a resource different. `desc_hash` covers the resource's own
+// desc (size, mips, array size), a resource recreated at the same address is then another view.
+struct ViewKey {
+    uintptr_t resource{};
+    uint32_t format{};
+    ViewType type{ViewType::SRV};
+    uint16_t mip{};
+    uint16_t slice{};
+    uint64_t desc_hash{};
+
+    bool operator==(const ViewKey& other) const = default;
+};
+
+struct ViewKeyHash {
+    size_t operator()(const ViewKey& key) const noexcept {
+        uint64_t h = (uint64_t)key.resource * 0x9E3779B97F4A7C15ull;
+        h ^= ((uint64_t)key.format << 32 | (uint64_t)key.type << 24 | (uint64_t)key.mip << 12 | key.slice) + 0xBF58476D1CE4E5B9ull + (h << 6) + (h >> 2);
+        h ^= key.desc_hash + 0x94D049BB133111EBull + (h << 6) + (h >> 2);
+        return (size_t)(h ^ (h >> 31));
+    }
+};
+
+// A slot plus the generation it was filled in, stale once the slot gets another view.
+struct DescriptorHandle {
+    uint32_t slot{std::numeric_limits<uint32_t>::max()};
+    uint32_t generation{};
+};
+
+// Views of game resources in a fixed number of descriptor slots, created once and found again by hash.
+// When full, the least recently used slot the GPU is done with gets the new view. "Done with" is up to
+// the caller: every acquire() says when the descriptor gets used (`epoch`, e.g. a frame or fence value)
+// and up to which epoch the GPU has finished (`completed`). A slot used after that is never overwritten,
+// if all of them are, acquire() fails instead of pulling a descriptor out from under the GPU.
+// The descriptors themselves are written by Backend::write(slot, key), a fake one makes this testable
+// without D3D.
+template <typename Backend>
+class DescriptorCache {
+public:
+    struct Stats {
+        uint64_t hits{};
+        uint64_t misses{};
+        uint64_t evictions{};
+        uint64_t stalls{}; // acquire() failed, every slot still in use
+        uint64_t stale{};  // views of a resource recreated at the same address
+    };
+
+    DescriptorCache(Backend backend, uint32_t capacity)
+        : m_backend{std::move(backend)}
+    {
+        resize(capacity);
+    }
+
+    std::optional<DescriptorHandle> acquire(const ViewKey& key, uint64_t epoch, uint64_t completed) {
+        if (const auto it = m_index.find(key); it != m_index.end()) {
+            auto& slot = m_slots[it->second];
+            slot.last_used = std::max(slot.last_used, epoch);
+            touch(it->second);
+
+            ++m_stats.hits;
+            return DescriptorHandle{it->second, slot.generation};
+        }
+
+        ++m_stats.misses;
+
+        // Same address, other desc: the old resource is gone, its views are the first to be reused
+        for (uint32_t i = 0; i < m_slots.size(); ++i) {
+            const auto& other = m_slots[i].key;
+
+            if (m_slots[i].occupied && other.resource == key.resource && other.desc_hash != key.desc_hash) {
+                make_lru(i);
+                ++m_stats.stale;
+            }
+        }
+
+        // Oldest first, the first one that's free or done with is the least recently used of those
+        auto index = m_tail;
+
+        while (index != NONE && m_slots[index].occupied && m_slots[index].last_used > completed) {
+            index = m_slots[index].prev;
+        }
+
+        if (index == NONE) {
+            ++m_stats.stalls;
+            return std::nullopt;
+        }
+
+        auto& slot = m_slots[index];
+
+        if (slot.occupied) {
+            m_index.erase(slot.key);
+            ++m_stats.evictions;
+        }
+
+        slot.key = key;
+        slot.occupied = true;
+        slot.last_used = epoch;
+        ++slot.generation;
+
+        m_index.emplace(key, index);
+        touch(index);
+
+        m_backend.write(index, key);
+
+        return DescriptorHandle{index, slot.generation};
+    }
+
+    bool is_current(const DescriptorHandle& handle) const {
+        return handle.slot < m_slots.size() && m_slots[handle.slot].occupied && m_slots[handle.slot].generation == handle.generation;
+    }
+
+    // Views of a resource that's going away. Its slots become free right away, the caller knows
+    // nothing still reads them if the resource itself can be released.
+    void invalidate(uintptr_t resource) {
+        for (uint32_t i = 0; i < m_slots.size(); ++i) {
+            auto& slot = m_slots[i];
+
+            if (slot.occupied && slot.key.resource == resource) {
+                m_index.erase(slot.key);
+                slot.occupied = false;
+                slot.last_used = 0;
+                make_lru(i);
+            }
+        }
+    }
+
+    void clear() {
+        resize((uint32_t)m_slots.size());
+    }
+
+    // Drops every view.
+    void resize(uint32_t capacity) {
+        m_index.clear();
+        m_index.reserve(capacity);
+
+        // Generations keep counting so handles from before stay stale
+        std::vector<Slot> slots(capacity);
+
+        for (uint32_t i = 0; i < capacity && i < m_slots.size(); ++i) {
+            slots[i].generation = m_slots[i].generation;
+        }
+
+        m_slots = std::move(slots);
+
+        m_head = capacity > 0 ? 0 : NONE;
+        m_tail = capacity > 0 ? capacity - 1 : NONE;
+
+        for (uint32_t i = 0; i < capacity; ++i) {
+            m_slots[i].prev = i > 0 ? i - 1 : NONE;
+            m_slots[i].next = i + 1 < capacity ? i + 1 : NONE;
+        }
+    }
+
+    uint32_t capacity() const {
+        return (uint32_t)m_slots.size();
+    }
+
+    size_t size() const {
+        return m_index.size();
+    }
+
+    const Stats& get_stats() const {
+        return m_stats;
+    }
+
+    Backend& backend() {
+        return m_backend;
+    }
+
+private:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    struct Slot {
+        ViewKey key{};
+        uint64_t last_used{};
+        uint32_t generation{};
+        uint32_t prev{NONE}; // towards the most recently used
+        uint32_t next{NONE}; // towards the least recently used
+        bool occupied{false};
+    };
+
+    void unlink(uint32_t index) {
+        auto& slot = m_slots[index];
+
+        if (slot.prev != NONE) {
+            m_slots[slot.prev].next = slot.next;
+        } else {
+            m_head = slot.next;
+        }
+
+        if (slot.next != NONE) {
+            m_slots[slot.next].prev = slot.prev;
+        } else {
+            m_tail = slot.prev;
+        }
+
+        slot.prev = NONE;
+        slot.next = NONE;
+    }
+
+    // Most recently used
+    void touch(uint32_t index) {
+        if (m_head == index) {
+            return;
+        }
+
+        unlink(index);
+
+        auto& slot = m_slots[index];
+        slot.next = m_head;
+
+        if (m_head != NONE) {
+            m_slots[m_head].prev = index;
+        }
+
+        m_head = index;
+
+        if (m_tail == NONE) {
+            m_tail = index;
+        }
+    }
+
+    void make_lru(uint32_t index) {
+        if (m_tail == index) {
+            return;
+        }
+
+        unlink(index);
+
+        auto& slot = m_slots[index];
+        slot.prev = m_tail;
+
+        if (m_tail != NONE) {
+            m_slots[m_tail].next = index;
+        }
+
+        m_tail = index;
+
+        if (m_head == NONE) {
+            m_head = index;
+        }
+    }
+
+    Backend m_backend;
+    std::vector<Slot> m_slots{};
+    std::unordered_map<ViewKey, uint32_t, ViewKeyHash> m_index{};
+    uint32_t m_head{NONE};
+    uint32_t m_tail{NONE};
+    Stats m_stats{};
+};
+} // namespace utility
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace utility {
+// Views of game resources, one per resource, in a fixed size open addressing table (linear probing).
+// An entry only matches if the resource pointer, a hash of the resource's creation desc and the cache
+// generation all match, so a resource recreated at the same address with a different desc, or anything
+// cached before clear(), is never handed out. Entries not used for `max_age` frames get evicted, and if
+// the table fills up anyway the least recently used entry makes room.
+// View is anything default constructible and movable (e.g. a ComPtr), dropping it releases the view.
+template <typename View, size_t Capacity = 64>
+class FlatViewCache {
+public:
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    // Entries beyond this count evict before inserting, keeps probe sequences short
+    static constexpr size_t MAX_LOAD = Capacity * 3 / 4;
+
+    struct Identity {
+        uintptr_t resource{};
+        uint64_t desc_hash{};
+    };
+
+    struct Stats {
+        uint64_t hits{};
+        uint64_t misses{};
+        uint64_t evictions{};
+        uint64_t stale{}; // same pointer, different desc or generation
+    };
+
+    explicit FlatViewCache(uint64_t max_age = 120)
+        : m_max_age{max_age}
+    {
+    }
+
+    View* find(const Identity& id, uint64_t frame) {
+        for (size_t i = home(id.resource), probes = 0; probes < Capacity; i = (i + 1) & MASK, ++probes) {
+            auto& e = m_entries[i];
+
+            if (!e.occupied) {
+                break;
+            }
+
+            if (e.id.resource != id.resource) {
+                continue;
+            }
+
+            if (e.id.desc_hash != id.desc_hash || e.generation != m_generation) {
+                ++m_stats.stale;
+                erase_at(i);
+                break;
+            }
+
+            e.last_used = frame;
+            ++m_stats.hits;
+            return &e.view;
+        }
+
+        ++m_stats.misses;
+        return nullptr;
+    }
+
+    // Call after find() missed.
+    View& insert(const Identity& id, View view, uint64_t frame) {
+        if (m_size >= MAX_LOAD) {
+            evict_older_than(frame);
+
+            if (m_size >= MAX_LOAD) {
+                evict_lru();
+            }
+        }
+
+        auto i = home(id.resource);
+
+        while (m_entries[i].occupied) {
+            i = (i + 1) & MASK;
+        }
+
+        auto& e = m_entries[i];
+        e.id = id;
+        e.view = std::move(view);
+        e.last_used = frame;
+        e.generation = m_generation;
+        e.occupied = true;
+        ++m_size;
+
+        return e.view;
+    }
+
+    // Cheap enough for once a frame, Capacity entries.
+    void evict_older_than(uint64_t frame) {
+        for (size_t i = 0; i < Capacity;) {
+            auto& e = m_entries[i];
+
+            // erase_at shifts a later entry into i, look at it again
+            if (e.occupied && (e.generation != m_generation || frame - e.last_used > m_max_age)) {
+                ++m_stats.evictions;
+                erase_at(i);
+                continue;
+            }
+
+            ++i;
+        }
+    }
+
+    // Views from before don't match anymore, released as soon as their slot is needed or they age out.
+    void invalidate() {
+        ++m_generation;
+    }
+
+    void clear() {
+        for (auto& e : m_entries) {
+            e = Entry{};
+        }
+
+        m_size = 0;
+        ++m_generation;
+    }
+
+    size_t size() const {
+        return m_size;
+    }
+
+    const Stats& get_stats() const {
+        return m_stats;
+    }
+
+    // Pointer bits above the alignment are what differs between resources
+    static size_t hash_pointer(uintptr_t p) {
+        uint64_t h = (uint64_t)p >> 4;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return (size_t)h;
+    }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    struct Entry {
+        Identity id{};
+        View view{};
+        uint64_t last_used{};
+        uint32_t generation{};
+        bool occupied{false};
+    };
+
+    static size_t home(uintptr_t resource) {
+        return hash_pointer(resource) & MASK;
+    }
+
+    // Backward shift deletion, no tombstones
+    void erase_at(size_t i) {
+        m_entries[i] = Entry{};
+        --m_size;
+
+        for (auto j = (i + 1) & MASK; m_entries[j].occupied; j = (j + 1) & MASK) {
+            const auto h = home(m_entries[j].id.resource);
+
+            // Can entry j move into the hole at i without leaving its probe sequence?
+            const auto dist_hole = (i - h) & MASK;
+            const auto dist_entry = (j - h) & MASK;
+
+            if (dist_hole < dist_entry) {
+                m_entries[i] = std::move(m_entries[j]);
+                m_entries[j] = Entry{};
+                i = j;
+            }
+        }
+    }
+
+    void evict_lru() {
+        size_t oldest = Capacity;
+
+        for (size_t i = 0; i < Capacity; ++i) {
+            if (m_entries[i].occupied && (oldest == Capacity || m_entries[i].last_used < m_entries[oldest].last_used)) {
+                oldest = i;
+            }
+        }
+
+        if (oldest != Capacity) {
+            ++m_stats.evictions;
+            erase_at(oldest);
+        }
+    }
+
+    std::array<Entry, Capacity> m_entries{};
+    size_t m_size{0};
+    uint32_t m_generation{0};
+    uint64_t m_max_age;
+    Stats m_stats{};
+};
+} // namespace utility
@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+#include <spdlog/fmt/fmt.h>
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "FontAtlasCache.hpp"
+
+namespace utility {
+namespace {
+constexpr uint32_t MAGIC = 0x41465256; // "VRFA"
+constexpr uint32_t FORMAT_VERSION = 1;
+
+class Writer {
+public:
+    template <typename T>
+    void put(const T& value) {
+        const auto p = (const char*)&value;
+        m_data.insert(m_data.end(), p, p + sizeof(T));
+    }
+
+    void put_bytes(const void* data, size_t size) {
+        const auto p = (const char*)data;
+        m_data.insert(m_data.end(), p, p + size);
+    }
+
+    const std::vector<char>& data() const { return m_data; }
+
+private:
+    std::vector<char> m_data{};
+};
+
+class Reader {
+public:
+    explicit Reader(const std::vector<char>& data)
+        : m_data{data}
+    {
+    }
+
+    template <typename T>
+    bool get(T& value) {
+        return get_bytes(&value, sizeof(T));
+    }
+
+    bool get_bytes(void* out, size_t size) {
+        if (m_offset + size > m_data.size()) {
+            return false;
+        }
+
+        std::memcpy(out, m_data.data() + m_offset, size);
+        m_offset += size;
+        return true;
+    }
+
+    bool at_end() const { return m_offset == m_data.size(); }
+
+private:
+    const std::vector<char>& m_data;
+    size_t m_offset{0};
+};
+
+struct GlyphRecord {
+    uint32_t codepoint;
+    float advance_x;
+    float x0, y0, x1, y1;
+    float u0, v0, u1, v1;
+};
+
+struct RectRecord {
+    uint16_t width, height, x, y;
+    uint32_t glyph_id;
+    float glyph_advance_x;
+    float glyph_offset_x, glyph_offset_y;
+    int32_t font_index;
+};
+
+int32_t index_of(const ImFontAtlas* atlas, const ImFont* font) {
+    for (int i = 0; i < atlas->Fonts.Size; ++i) {
+        if (atlas->Fonts[i] == font) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+} // namespace
+
+std::filesystem::path FontAtlasCache::get_path(uint64_t key) const {
+    return m_dir / fmt::format("atlas_{:016x}.bin", key);
+}
+
+// ImGui 1.92 moved to dynamic font textures, where none of this applies anymore.
+#ifndef IMGUI_HAS_TEXTURES
+bool FontAtlasCache::load(ImFontAtlas* atlas, uint64_t key) {
+    atlas->Clear();
+
+    std::vector<char> data{};
+
+    {
+        std::ifstream file{get_path(key), std::ios::binary | std::ios::ate};
+
+        if (!file) {
+            return false;
+        }
+
+        data.resize((size_t)file.tellg());
+        file.seekg(0);
+
+        if (!file.read(data.data(), data.size())) {
+            return false;
+        }
+    }
+
+    Reader r{data};
+
+    uint32_t magic{}, version{}, imgui_version{};
+    uint64_t file_key{};
+
+    if (!r.get(magic) || !r.get(version) || !r.get(imgui_version) || !r.get(file_key)) {
+        return false;
+    }
+
+    if (magic != MAGIC || version != FORMAT_VERSION || imgui_version != IMGUI_VERSION_NUM || file_key != key) {
+        return false;
+    }
+
+    int32_t tex_width{}, tex_height{};
+    ImVec2 uv_scale{}, uv_white{};
+    ImVec4 uv_lines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1]{};
+    int32_t pack_id_cursor{}, pack_id_lines{};
+    uint32_t rect_count{}, font_count{};
+
+    if (!r.get(tex_width) || !r.get(tex_height) || !r.get(uv_scale) || !r.get(uv_white) || !r.get(uv_lines) ||
+        !r.get(pack_id_cursor) || !r.get(pack_id_lines) || !r.get(rect_count))
+    {
+        return false;
+    }
+
+    if (tex_width <= 0 || tex_height <= 0 || tex_width > 16384 || tex_height > 16384) {
+        return false;
+    }
+
+    std::vector<RectRecord> rects(rect_count);
+
+    if (!r.get_bytes(rects.data(), rects.size() * sizeof(RectRecord)) || !r.get(font_count) || font_count == 0) {
+        return false;
+    }
+
+    struct FontRecord {
+        float size, ascent, descent;
+        uint32_t fallback_char, ellipsis_char;
+        std::vector<GlyphRecord> glyphs;
+    };
+
+    std::vector<FontRecord> fonts(font_count);
+
+    for (auto& font : fonts) {
+        uint32_t glyph_count{};
+
+        if (!r.get(font.size) || !r.get(font.ascent) || !r.get(font.descent) ||
+            !r.get(font.fallback_char) || !r.get(font.ellipsis_char) || !r.get(glyph_count))
+        {
+            return false;
+        }
+
+        font.glyphs.resize(glyph_count);
+
+        if (!r.get_bytes(font.glyphs.data(), font.glyphs.size() * sizeof(GlyphRecord))) {
+            return false;
+        }
+    }
+
+    const auto pixel_count = (size_t)tex_width * tex_height;
+    auto pixels = (unsigned char*)IM_ALLOC(pixel_count);
+
+    if (!r.get_bytes(pixels, pixel_count) || !r.at_end()) {
+        IM_FREE(pixels);
+        return false;
+    }
+
+    // Everything read and validated, from here on it can't fail halfway
+    for (const auto& record : fonts) {
+        auto font = IM_NEW(ImFont);
+        atlas->Fonts.push_back(font);
+
+        font->ContainerAtlas = atlas;
+        font->FontSize = record.size;
+        font->Ascent = record.ascent;
+        font->Descent = record.descent;
+        font->FallbackChar = (ImWchar)record.fallback_char;
+        font->EllipsisChar = (ImWchar)record.ellipsis_char;
+
+        for (const auto& g : record.glyphs) {
+            font->AddGlyph(nullptr, (ImWchar)g.codepoint, g.x0, g.y0, g.x1, g.y1, g.u0, g.v0, g.u1, g.v1, g.advance_x);
+        }
+
+        font->BuildLookupTable();
+    }
+
+    for (const auto& rect : rects) {
+        ImFontAtlasCustomRect out{};
+        out.Width = rect.width;
+        out.Height = rect.height;
+        out.X = rect.x;
+        out.Y = rect.y;
+        out.GlyphID = rect.glyph_id;
+        out.GlyphAdvanceX = rect.glyph_advance_x;
+        out.GlyphOffset = {rect.glyph_offset_x, rect.glyph_offset_y};
+        out.Font = rect.font_index >= 0 && rect.font_index < atlas->Fonts.Size ? atlas->Fonts[rect.font_index] : nullptr;
+        atlas->CustomRects.push_back(out);
+    }
+
+    atlas->PackIdMouseCursor = pack_id_cursor;
+    atlas->PackIdLines = pack_id_lines;
+    atlas->TexWidth = tex_width;
+    atlas->TexHeight = tex_height;
+    atlas->TexUvScale = uv_scale;
+    atlas->TexUvWhitePixel = uv_white;
+    std::memcpy(atlas->TexUvLines, uv_lines, sizeof(uv_lines));
+    atlas->TexPixelsAlpha8 = pixels;
+    atlas->TexReady = true;
+
+    return true;
+}
+
+bool FontAtlasCache::store(ImFontAtlas* atlas, uint64_t key, size_t keep) {
+    if (!atlas->IsBuilt() || atlas->TexPixelsAlpha8 == nullptr || atlas->TexPixelsUseColors) {
+        return false; // colored glyphs only live in the RGBA32 texture, not worth caching
+    }
+
+    Writer w{};
+    w.put(MAGIC);
+    w.put(FORMAT_VERSION);
+    w.put((uint32_t)IMGUI_VERSION_NUM);
+    w.put(key);
+
+    w.put((int32_t)atlas->TexWidth);
+    w.put((int32_t)atlas->TexHeight);
+    w.put(atlas->TexUvScale);
+    w.put(atlas->TexUvWhitePixel);
+    w.put(atlas->TexUvLines);
+    w.put((int32_t)atlas->PackIdMouseCursor);
+    w.put((int32_t)atlas->PackIdLines);
+
+    w.put((uint32_t)atlas->CustomRects.Size);
+
+    for (const auto& rect : atlas->CustomRects) {
+        RectRecord out{};
+        out.width = rect.Width;
+        out.height = rect.Height;
+        out.x = rect.X;
+        out.y = rect.Y;
+        out.glyph_id = rect.GlyphID;
+        out.glyph_advance_x = rect.GlyphAdvanceX;
+        out.glyph_offset_x = rect.GlyphOffset.x;
+        out.glyph_offset_y = rect.GlyphOffset.y;
+        out.font_index = rect.Font != nullptr ? index_of(atlas, rect.Font) : -1;
+        w.put(out);
+    }
+
+    w.put((uint32_t)atlas->Fonts.Size);
+
+    for (const auto font : atlas->Fonts) {
+        w.put(font->FontSize);
+        w.put(font->Ascent);
+        w.put(font->Descent);
+        w.put((uint32_t)font->FallbackChar);
+        w.put((uint32_t)font->EllipsisChar);
+        w.put((uint32_t)font->Glyphs.Size);
+
+        for (const auto& g : font->Glyphs) {
+            w.put(GlyphRecord{(uint32_t)g.Codepoint, g.AdvanceX, g.X0, g.Y0, g.X1, g.Y1, g.U0, g.V0, g.U1, g.V1});
+        }
+    }
+
+    w.put_bytes(atlas->TexPixelsAlpha8, (size_t)atlas->TexWidth * atlas->TexHeight);
+
+    std::error_code ec{};
+    std::filesystem::create_directories(m_dir, ec);
+
+    const auto path = get_path(key);
+    auto temp_path = path;
+    temp_path += ".tmp";
+
+    {
+        std::ofstream file{temp_path, std::ios::binary | std::ios::trunc};
+
+        if (!file || !file.write(w.data().data(), w.data().size())) {
+            file.close();
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temp_path, path, ec);
+
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+
+    prune(keep);
+    return true;
+}
+#else
+bool FontAtlasCache::load(ImFontAtlas* atlas, uint64_t key) {
+    atlas->Clear();
+    return false;
+}
+
+bool FontAtlasCache::store(ImFontAtlas* atlas, uint64_t key, size_t keep) {
+    return false;
+}
+#endif
+
+void FontAtlasCache::prune(size_t keep) {
+    std::error_code ec{};
+    std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> entries{};
+
+    for (const auto& entry : std::filesystem::directory_iterator{m_dir, ec}) {
+        const auto& path = entry.path();
+
+        if (path.extension() == ".bin" && path.filename().string().starts_with("atlas_")) {
+            entries.emplace_back(entry.last_write_time(ec), path);
+        }
+    }
+
+    if (entries.size() <= keep) {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    for (size_t i = keep; i < entries.size(); ++i) {
+        std::filesystem::remove(entries[i].second, ec);
+    }
+}
+} // namespace utility
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+struct ImFontAtlas;
+
+namespace utility {
+// Baked ImGui font atlases on disk, so a startup with an unchanged font setup
+// restores the texture and glyph tables instead of rasterizing everything again.
+// Entries are keyed by a hash of everything that went into the build (fonts, sizes, ranges, ImGui version),
+// anything unexpected in a file is treated as a miss.
+class FontAtlasCache {
+public:
+    explicit FontAtlasCache(std::filesystem::path dir)
+        : m_dir{std::move(dir)}
+    {
+    }
+
+    // Clears `atlas` and fills it from the cache. On a miss the atlas is left cleared.
+    bool load(ImFontAtlas* atlas, uint64_t key);
+
+    // `atlas` must be built. Only keeps the `keep` most recent entries around.
+    bool store(ImFontAtlas* atlas, uint64_t key, size_t keep = 4);
+
+    std::filesystem::path get_path(uint64_t key) const;
+
+    static uint64_t hash(std::string_view data, uint64_t seed = 0xcbf29ce484222325ull) {
+        for (const auto c : data) {
+            seed ^= (uint8_t)c;
+            seed *= 0x100000001b3ull;
+        }
+
+        return seed;
+    }
+
+    template <typename T>
+    static uint64_t hash_value(const T& value, uint64_t seed) {
+        return hash(std::string_view{(const char*)&value, sizeof(T)}, seed);
+    }
+
+private:
+    void prune(size_t keep);
+
+    std::filesystem::path m_dir;
+};
+} // namespace utility
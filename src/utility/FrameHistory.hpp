@@ -0,0 +1,295 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace utility {
+using FrameNumber = int64_t;
+
+inline constexpr FrameNumber NO_FRAME = std::numeric_limits<FrameNumber>::min();
+
+// Slot of `frame` in a ring of N, also for negative frames (frame - 2 right after startup).
+template <size_t N>
+constexpr size_t frame_slot(FrameNumber frame) {
+    const auto m = frame % (FrameNumber)N;
+    return (size_t)(m < 0 ? m + (FrameNumber)N : m);
+}
+
+// Opt-in for interpolating between frames: specialize with `static T lerp(const T& a, const T& b, double t)`.
+// Only for pose-like values, e.g. a position is lerped and an orientation slerped.
+template <typename T>
+struct FrameLerp;
+
+template <std::floating_point T>
+struct FrameLerp<T> {
+    static T lerp(T a, T b, double t) {
+        return a + (b - a) * (T)t;
+    }
+};
+
+template <typename T>
+concept FrameInterpolable = requires(const T& a, const T& b, double t) {
+    { FrameLerp<T>::lerp(a, b, t) } -> std::convertible_to<T>;
+};
+
+// Per-frame values of the last N frames, indexed by frame number modulo N.
+// Every slot remembers which frame wrote it, so asking for a frame that was overwritten in the
+// meantime or never written is a miss instead of another frame's data.
+// Not synchronized, see SharedFrameHistory for writers and readers on different threads.
+template <typename T, size_t N>
+class FrameHistory {
+public:
+    static_assert(N >= 2, "a frame history has to hold at least the current and the previous frame");
+
+    static constexpr size_t CAPACITY = N;
+
+    // For static_asserts at the call sites that look `depth` frames back.
+    static constexpr bool holds(size_t depth) {
+        return depth < N;
+    }
+
+    // The value of `frame`, starts out as T{} if the slot held another frame until now.
+    T& write(FrameNumber frame) {
+        auto& slot = m_slots[frame_slot<N>(frame)];
+
+        if (slot.frame != frame) {
+            slot.value = T{};
+        }
+
+        return retag(frame);
+    }
+
+    // Claims the slot for `frame` keeping what's in it, for histories that own something per slot
+    // (e.g. a copy target that gets overwritten).
+    T& retag(FrameNumber frame) {
+        auto& slot = m_slots[frame_slot<N>(frame)];
+        slot.frame = frame;
+
+        if (m_latest == NO_FRAME || frame > m_latest) {
+            m_latest = frame;
+        }
+
+        return slot.value;
+    }
+
+    void put(FrameNumber frame, const T& value) {
+        write(frame) = value;
+    }
+
+    T* find(FrameNumber frame) {
+        return const_cast<T*>(std::as_const(*this).find(frame));
+    }
+
+    const T* find(FrameNumber frame) const {
+        const auto& slot = m_slots[frame_slot<N>(frame)];
+
+        if (frame == NO_FRAME || slot.frame != frame) {
+            m_misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        return &slot.value;
+    }
+
+    std::optional<T> get(FrameNumber frame) const {
+        const auto value = find(frame);
+        return value != nullptr ? std::optional<T>{*value} : std::nullopt;
+    }
+
+    const T& get_or(FrameNumber frame, const T& fallback) const {
+        const auto value = find(frame);
+        return value != nullptr ? *value : fallback;
+    }
+
+    // Between the values of two frames, t = 0 is frame_a and t = 1 frame_b. Misses if either isn't in the history.
+    std::optional<T> interpolate(FrameNumber frame_a, FrameNumber frame_b, double t) const requires FrameInterpolable<T> {
+        const auto a = find(frame_a);
+        const auto b = find(frame_b);
+
+        if (a == nullptr || b == nullptr) {
+            return std::nullopt;
+        }
+
+        return FrameLerp<T>::lerp(*a, *b, t);
+    }
+
+    FrameNumber latest_frame() const {
+        return m_latest;
+    }
+
+    const T* latest() const {
+        return m_latest != NO_FRAME ? &m_slots[frame_slot<N>(m_latest)].value : nullptr;
+    }
+
+    // Raw slot access for histories that own something per slot (e.g. a copy target), ignores the tags.
+    T& slot(size_t index) {
+        return m_slots[index].value;
+    }
+
+    const T& slot(size_t index) const {
+        return m_slots[index].value;
+    }
+
+    FrameNumber slot_frame(size_t index) const {
+        return m_slots[index].frame;
+    }
+
+    // Every frame misses until written again, the values stay.
+    void invalidate() {
+        for (auto& slot : m_slots) {
+            slot.frame = NO_FRAME;
+        }
+
+        m_latest = NO_FRAME;
+    }
+
+    void reset() {
+        m_slots = {};
+        m_latest = NO_FRAME;
+    }
+
+    uint64_t get_misses() const {
+        return m_misses.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        FrameNumber frame{NO_FRAME};
+        T value{};
+    };
+
+    std::array<Slot, N> m_slots{};
+    FrameNumber m_latest{NO_FRAME};
+    mutable std::atomic<uint64_t> m_misses{0};
+};
+
+// FrameHistory for values written and read on different threads, each slot is a seqlock.
+// Writers take turns on a mutex, readers get copies and retry while the slot is being written,
+// they never lock or hold up a writer.
+template <typename T, size_t N>
+class SharedFrameHistory {
+public:
+    static_assert(N >= 2, "a frame history has to hold at least the current and the previous frame");
+    static_assert(std::is_trivially_copyable_v<T>, "values are copied while they may be written, they have to be trivially copyable");
+
+    static constexpr size_t CAPACITY = N;
+
+    static constexpr bool holds(size_t depth) {
+        return depth < N;
+    }
+
+    void put(FrameNumber frame, const T& value) {
+        std::scoped_lock _{m_write_mtx};
+        publish(frame, value);
+    }
+
+    // Changes part of the value of `frame` with fn(T&), which starts out as T{} if the slot held
+    // another frame until now. Runs with the other writers locked out.
+    template <typename Fn>
+    void update(FrameNumber frame, Fn&& fn) {
+        std::scoped_lock _{m_write_mtx};
+
+        // Only writers change slots, nothing can change this one while we copy it
+        const auto& slot = m_slots[frame_slot<N>(frame)];
+        T value{};
+
+        if (slot.frame.load(std::memory_order_relaxed) == frame) {
+            std::memcpy(&value, &slot.value, sizeof(T));
+        }
+
+        fn(value);
+        publish(frame, value);
+    }
+
+    std::optional<T> get(FrameNumber frame) const {
+        const auto& slot = m_slots[frame_slot<N>(frame)];
+
+        for (;;) {
+            const auto before = slot.seq.load(std::memory_order_acquire);
+
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            const auto tagged = slot.frame.load(std::memory_order_relaxed);
+
+            T out;
+            std::memcpy(&out, &slot.value, sizeof(T));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.seq.load(std::memory_order_relaxed) != before) {
+                continue;
+            }
+
+            if (frame == NO_FRAME || tagged != frame) {
+                m_misses.fetch_add(1, std::memory_order_relaxed);
+                return std::nullopt;
+            }
+
+            return out;
+        }
+    }
+
+    // See FrameHistory::interpolate
+    std::optional<T> interpolate(FrameNumber frame_a, FrameNumber frame_b, double t) const requires FrameInterpolable<T> {
+        const auto a = get(frame_a);
+        const auto b = get(frame_b);
+
+        if (!a || !b) {
+            return std::nullopt;
+        }
+
+        return FrameLerp<T>::lerp(*a, *b, t);
+    }
+
+    FrameNumber latest_frame() const {
+        return m_latest.load(std::memory_order_acquire);
+    }
+
+    uint64_t get_misses() const {
+        return m_misses.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<FrameNumber> frame{NO_FRAME};
+        T value{};
+    };
+
+    // With m_write_mtx held
+    void publish(FrameNumber frame, const T& value) {
+        auto& slot = m_slots[frame_slot<N>(frame)];
+        const auto seq = slot.seq.load(std::memory_order_relaxed);
+
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.frame.store(frame, std::memory_order_relaxed);
+        std::memcpy(&slot.value, &value, sizeof(T));
+
+        slot.seq.store(seq + 2, std::memory_order_release);
+
+        if (frame > m_latest.load(std::memory_order_relaxed)) {
+            m_latest.store(frame, std::memory_order_release);
+        }
+    }
+
+    std::array<Slot, N> m_slots{};
+    std::atomic<FrameNumber> m_latest{NO_FRAME};
+    mutable std::atomic<uint64_t> m_misses{0};
+    std::mutex m_write_mtx{};
+};
+} // namespace utility
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace utility {
+// Sorted, merged set of inclusive codepoint ranges.
+// Speaks ImGui's zero terminated {first, last, first, last, ..., 0} range format on both ends
+// without depending on ImGui, so the glyph bookkeeping can be used and checked anywhere.
+class GlyphRangeSet {
+public:
+    using Range = std::pair<uint32_t, uint32_t>;
+
+    GlyphRangeSet() = default;
+
+    template <typename T>
+    explicit GlyphRangeSet(const T* zero_terminated) {
+        add_ranges(zero_terminated);
+    }
+
+    // Returns true if anything new was added.
+    bool add_range(uint32_t first, uint32_t last) {
+        if (first > last) {
+            std::swap(first, last);
+        }
+
+        if (contains(first) && contains(last) && find(first) == find(last)) {
+            return false;
+        }
+
+        auto it = std::lower_bound(m_ranges.begin(), m_ranges.end(), first, [](const Range& r, uint32_t v) {
+            return (uint64_t)r.second + 1 < v; // ranges ending right before `first` still merge, no wrap at UINT32_MAX
+        });
+
+        auto end = it;
+
+        while (end != m_ranges.end() && end->first <= (last == UINT32_MAX ? last : last + 1)) {
+            first = std::min(first, end->first);
+            last = std::max(last, end->second);
+            ++end;
+        }
+
+        it = m_ranges.erase(it, end);
+        m_ranges.insert(it, Range{first, last});
+        return true;
+    }
+
+    bool add(uint32_t codepoint) {
+        return add_range(codepoint, codepoint);
+    }
+
+    template <typename T>
+    bool add_ranges(const T* zero_terminated) {
+        bool added = false;
+
+        for (auto p = zero_terminated; p != nullptr && p[0] != 0; p += 2) {
+            added |= add_range((uint32_t)p[0], (uint32_t)p[1]);
+        }
+
+        return added;
+    }
+
+    bool add_set(const GlyphRangeSet& other) {
+        bool added = false;
+
+        for (const auto& [first, last] : other.m_ranges) {
+            added |= add_range(first, last);
+        }
+
+        return added;
+    }
+
+    bool contains(uint32_t codepoint) const {
+        return find(codepoint) != m_ranges.end();
+    }
+
+    // Adds every codepoint of `utf8` that is inside `universe` (or anything, when it's null)
+    // and not yet in the set. Returns how many were new.
+    size_t add_text(std::string_view utf8, const GlyphRangeSet* universe = nullptr) {
+        size_t added = 0;
+
+        for_each_codepoint(utf8, [&](uint32_t cp) {
+            if (cp < 0x80 && contains(cp)) {
+                return; // ASCII is always baked, don't bother with the search
+            }
+
+            if (universe != nullptr && !universe->contains(cp)) {
+                return;
+            }
+
+            added += add(cp) ? 1 : 0;
+        });
+
+        return added;
+    }
+
+    // Flat zero terminated list for ImFontAtlas. Ranges past what T can hold get clamped or dropped.
+    template <typename T>
+    std::vector<T> to_flat() const {
+        constexpr auto max_value = (uint32_t)std::numeric_limits<T>::max();
+
+        std::vector<T> out{};
+        out.reserve(m_ranges.size() * 2 + 1);
+
+        for (const auto& [first, last] : m_ranges) {
+            if (first > max_value) {
+                break;
+            }
+
+            if (last == 0) {
+                continue; // 0 would terminate the list
+            }
+
+            out.push_back((T)std::max<uint32_t>(first, 1));
+            out.push_back((T)std::min(last, max_value));
+        }
+
+        out.push_back(0);
+        return out;
+    }
+
+    size_t glyph_count() const {
+        size_t count = 0;
+
+        for (const auto& [first, last] : m_ranges) {
+            count += (size_t)(last - first) + 1;
+        }
+
+        return count;
+    }
+
+    uint64_t hash(uint64_t seed = 0xcbf29ce484222325ull) const {
+        auto mix = [&](uint32_t v) {
+            for (int i = 0; i < 4; ++i) {
+                seed ^= (v >> (i * 8)) & 0xFF;
+                seed *= 0x100000001b3ull;
+            }
+        };
+
+        for (const auto& [first, last] : m_ranges) {
+            mix(first);
+            mix(last);
+        }
+
+        return seed;
+    }
+
+    const std::vector<Range>& ranges() const { return m_ranges; }
+    bool empty() const { return m_ranges.empty(); }
+    void clear() { m_ranges.clear(); }
+
+    bool operator==(const GlyphRangeSet& other) const = default;
+
+    // Lenient UTF-8 decoder, invalid sequences map to U+FFFD.
+    template <typename Fn>
+    static void for_each_codepoint(std::string_view utf8, Fn&& fn) {
+        const auto size = utf8.size();
+
+        for (size_t i = 0; i < size;) {
+            const auto c = (uint8_t)utf8[i];
+
+            if (c < 0x80) {
+                fn((uint32_t)c);
+                ++i;
+                continue;
+            }
+
+            const size_t len = (c & 0xE0) == 0xC0 ? 2 : (c & 0xF0) == 0xE0 ? 3 : (c & 0xF8) == 0xF0 ? 4 : 0;
+
+            if (len == 0 || i + len > size) {
+                fn(0xFFFDu);
+                ++i;
+                continue;
+            }
+
+            uint32_t cp = c & (0x7F >> len);
+            bool valid = true;
+
+            for (size_t j = 1; j < len; ++j) {
+                const auto cc = (uint8_t)utf8[i + j];
+
+                if ((cc & 0xC0) != 0x80) {
+                    valid = false;
+                    break;
+                }
+
+                cp = (cp << 6) | (cc & 0x3F);
+            }
+
+            if (!valid) {
+                fn(0xFFFDu);
+                ++i;
+                continue;
+            }
+
+            fn(cp);
+            i += len;
+        }
+    }
+
+private:
+    std::vector<Range>::const_iterator find(uint32_t codepoint) const {
+        auto it = std::lower_bound(m_ranges.begin(), m_ranges.end(), codepoint, [](const Range& r, uint32_t v) {
+            return r.second < v;
+        });
+
+        return it != m_ranges.end() && it->first <= codepoint ? it : m_ranges.end();
+    }
+
+    std::vector<Range> m_ranges{};
+};
+} // namespace utility
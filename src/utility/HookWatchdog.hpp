@@ -0,0 +1,270 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace utility {
+// Written from hot paths (present, window messages), read by the watchdog.
+// Relaxed atomics only, the watchdog just needs a recent enough value.
+class Heartbeat {
+public:
+    using clock = std::chrono::steady_clock;
+
+    void beat(clock::time_point now = clock::now()) {
+        m_last.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    clock::time_point last() const {
+        return clock::time_point{clock::duration{m_last.load(std::memory_order_relaxed)}};
+    }
+
+    uint64_t count() const {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<clock::rep> m_last{clock::now().time_since_epoch().count()};
+    std::atomic<uint64_t> m_count{0};
+};
+
+// Keeps the rehook path from tearing a hook down while a present is running through it,
+// without the present taking a lock in the common case.
+// Presents only bump a counter. The exclusive side closes the gate, waits for the count to drain
+// and runs under `mutex`; a present that arrives while the gate is closed falls back to taking
+// the mutex, which also makes it wait until the exclusive work is done.
+class PresentGate {
+public:
+    explicit PresentGate(std::recursive_mutex& mutex)
+        : m_mutex{mutex}
+    {
+    }
+
+    class Scope {
+    public:
+        Scope(PresentGate& gate)
+            : m_gate{gate}
+        {
+            m_gate.m_in_flight.fetch_add(1, std::memory_order_seq_cst);
+
+            if (m_gate.m_closed.load(std::memory_order_seq_cst)) {
+                m_gate.m_in_flight.fetch_sub(1, std::memory_order_seq_cst);
+                m_lock = std::unique_lock{m_gate.m_mutex};
+            }
+        }
+
+        ~Scope() {
+            if (!m_lock.owns_lock()) {
+                m_gate.m_in_flight.fetch_sub(1, std::memory_order_seq_cst);
+            }
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        PresentGate& m_gate;
+        std::unique_lock<std::recursive_mutex> m_lock{};
+    };
+
+    Scope enter() {
+        return Scope{*this};
+    }
+
+    // Returns false without running `fn` if presents didn't drain within `timeout` (e.g. sitting in a debugger).
+    template <typename Fn>
+    bool run_exclusive(Fn&& fn, std::chrono::milliseconds timeout = std::chrono::milliseconds(250)) {
+        std::scoped_lock _{m_mutex};
+
+        m_closed.store(true, std::memory_order_seq_cst);
+
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+        while (m_in_flight.load(std::memory_order_seq_cst) != 0) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                m_closed.store(false, std::memory_order_seq_cst);
+                return false;
+            }
+
+            std::this_thread::yield();
+        }
+
+        fn();
+
+        m_closed.store(false, std::memory_order_seq_cst);
+        return true;
+    }
+
+    uint32_t in_flight() const {
+        return m_in_flight.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::recursive_mutex& m_mutex;
+    std::atomic<uint32_t> m_in_flight{0};
+    std::atomic<bool> m_closed{false};
+};
+
+// Decides when the D3D and window message hooks look dead and need to be installed again.
+// Pure state machine over time points, the caller feeds it heartbeats and carries out the actions,
+// and sleeps until next_deadline() instead of polling.
+class HookWatchdog {
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct Timing {
+        clock::duration present_timeout{std::chrono::seconds(5)};
+        clock::duration last_chance{std::chrono::seconds(1)}; // stale for this much longer before rehooking
+        clock::duration message_timeout{std::chrono::seconds(5)};
+        clock::duration probe_timeout{std::chrono::seconds(1)};
+        clock::duration grace{std::chrono::seconds(5)}; // after any rehook
+    };
+
+    enum class PresentState : uint8_t {
+        HEALTHY,
+        LAST_CHANCE,
+    };
+
+    struct Inputs {
+        clock::time_point last_present{};
+        clock::time_point last_message{};
+        bool inside_present{false};
+        bool message_hook_active{false}; // initialized and has a window
+        bool message_hook_intact{false};
+    };
+
+    enum Action : uint32_t {
+        NONE = 0,
+        REHOOK_D3D = 1 << 0,
+        SEND_MESSAGE_PROBE = 1 << 1,
+        REHOOK_MESSAGES = 1 << 2,
+    };
+
+    HookWatchdog() = default;
+    explicit HookWatchdog(const Timing& timing)
+        : m_timing{timing}
+    {
+    }
+
+    uint32_t evaluate(const Inputs& in, clock::time_point now) {
+        uint32_t actions = NONE;
+
+        const auto last_present = std::max(in.last_present, m_grace_until);
+        const auto last_message = std::max({in.last_message, m_grace_until, m_message_reset});
+
+        m_next_deadline = clock::time_point::max();
+
+        if (in.inside_present) {
+            // Still (or stuck) inside a present, nothing is known until it returns
+            m_present_state = PresentState::HEALTHY;
+            m_probe_sent = false;
+            schedule(now + m_timing.last_chance);
+            return actions;
+        }
+
+        if (now - last_present > m_timing.present_timeout) {
+            if (m_present_state == PresentState::HEALTHY) {
+                // the purpose of this is to make sure that the game is not frozen
+                // e.g. if we are debugging the game, so we don't rehook anything on accident
+                m_present_state = PresentState::LAST_CHANCE;
+                m_last_chance_since = now;
+                ++m_stats.last_chances;
+            }
+
+            if (now - m_last_chance_since > m_timing.last_chance) {
+                actions |= REHOOK_D3D;
+                begin_grace(now);
+            } else {
+                schedule(m_last_chance_since + m_timing.last_chance + std::chrono::milliseconds(1));
+            }
+        } else {
+            m_present_state = PresentState::HEALTHY;
+            schedule(last_present + m_timing.present_timeout + std::chrono::milliseconds(1));
+        }
+
+        if (in.message_hook_active && (actions & REHOOK_D3D) == 0 && now - last_message > m_timing.message_timeout) {
+            if (in.message_hook_intact) {
+                m_message_reset = now;
+                m_probe_sent = false;
+                ++m_stats.intact_checks;
+            } else if (!m_probe_sent) {
+                actions |= SEND_MESSAGE_PROBE;
+                m_probe_sent = true;
+                m_probe_time = now;
+                ++m_stats.probes;
+            } else if (now - m_probe_time > m_timing.probe_timeout) {
+                actions |= REHOOK_MESSAGES;
+                m_probe_sent = false;
+                begin_grace(now);
+            }
+        } else if ((actions & REHOOK_D3D) == 0) {
+            m_probe_sent = false;
+        }
+
+        if (in.message_hook_active) {
+            const auto message_base = std::max({in.last_message, m_grace_until, m_message_reset});
+            schedule(m_probe_sent ? m_probe_time + m_timing.probe_timeout + std::chrono::milliseconds(1)
+                                  : message_base + m_timing.message_timeout + std::chrono::milliseconds(1));
+        }
+
+        if (actions & REHOOK_D3D) {
+            ++m_stats.d3d_rehooks;
+        }
+
+        if (actions & REHOOK_MESSAGES) {
+            ++m_stats.message_rehooks;
+        }
+
+        ++m_stats.evaluations;
+        return actions;
+    }
+
+    // Earliest time anything can change without a heartbeat, never in the past relative to the last evaluation.
+    clock::time_point next_deadline() const {
+        return m_next_deadline;
+    }
+
+    PresentState get_present_state() const {
+        return m_present_state;
+    }
+
+    struct Stats {
+        uint64_t evaluations{};
+        uint64_t last_chances{};
+        uint64_t d3d_rehooks{};
+        uint64_t probes{};
+        uint64_t intact_checks{};
+        uint64_t message_rehooks{};
+    };
+
+    const Stats& get_stats() const {
+        return m_stats;
+    }
+
+private:
+    void schedule(clock::time_point t) {
+        m_next_deadline = std::min(m_next_deadline, t);
+    }
+
+    // so we don't immediately go and hook it again
+    void begin_grace(clock::time_point now) {
+        m_grace_until = now + m_timing.grace;
+        m_present_state = PresentState::HEALTHY;
+        schedule(m_grace_until + m_timing.present_timeout + std::chrono::milliseconds(1));
+    }
+
+    Timing m_timing{};
+    PresentState m_present_state{PresentState::HEALTHY};
+    clock::time_point m_last_chance_since{};
+    clock::time_point m_grace_until{};
+    clock::time_point m_message_reset{};
+    clock::time_point m_probe_time{};
+    clock::time_point m_next_deadline{clock::time_point::max()};
+    bool m_probe_sent{false};
+    Stats m_stats{};
+};
+} // namespace utility
@@ -0,0 +1,373 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+#include <spdlog/details/log_msg.h>
+#include <spdlog/details/os.h>
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/spdlog.h>
+
+// Levels below this are compiled out of VR_HOT_LOG call sites, same numbering as SPDLOG_ACTIVE_LEVEL
+#ifndef VR_HOT_LOG_ACTIVE_LEVEL
+#define VR_HOT_LOG_ACTIVE_LEVEL SPDLOG_ACTIVE_LEVEL
+#endif
+
+namespace utility {
+// Token bucket for one log call site: `burst` messages at once, refilled at `per_second`.
+// Kept as the time the bucket is full again (GCRA) in one atomic, so callers on any number of
+// threads never wait for each other. Every call is either let through or counted as suppressed.
+class LogRateLimiter {
+public:
+    using clock = std::chrono::steady_clock;
+
+    LogRateLimiter(double per_second, uint32_t burst)
+        : m_interval{(int64_t)(1'000'000'000.0 / std::max(per_second, 1e-3))},
+          m_tolerance{m_interval * (int64_t)std::max<uint32_t>(burst, 1)}
+    {
+    }
+
+    // `suppressed` is how many calls were dropped since the last one that got through.
+    bool try_acquire(int64_t now_ns, uint64_t& suppressed) {
+        auto tat = m_tat.load(std::memory_order_relaxed);
+
+        for (;;) {
+            const auto next = std::max(tat, now_ns) + m_interval;
+
+            if (next - now_ns > m_tolerance) {
+                m_suppressed.fetch_add(1, std::memory_order_relaxed);
+                m_total_suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            if (m_tat.compare_exchange_weak(tat, next, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+        m_total_passed.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool try_acquire(uint64_t& suppressed) {
+        return try_acquire(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count(), suppressed);
+    }
+
+    uint64_t get_passed() const {
+        return m_total_passed.load(std::memory_order_relaxed);
+    }
+
+    uint64_t get_suppressed() const {
+        return m_total_suppressed.load(std::memory_order_relaxed);
+    }
+
+    // Suppressed calls not reported with a message yet
+    uint64_t get_pending() const {
+        return m_suppressed.load(std::memory_order_relaxed);
+    }
+
+private:
+    int64_t m_interval;
+    int64_t m_tolerance;
+    std::atomic<int64_t> m_tat{0};
+    std::atomic<uint64_t> m_suppressed{0};
+    std::atomic<uint64_t> m_total_passed{0};
+    std::atomic<uint64_t> m_total_suppressed{0};
+};
+
+// What the producer knew about a message besides its text: it's written out later on another thread
+struct LogRecord {
+    spdlog::level::level_enum level{spdlog::level::info};
+    spdlog::log_clock::time_point time{};
+    size_t thread_id{0};
+};
+
+// Bounded ring of formatted messages, any number of producers and one consumer.
+// A producer claims a slot with a CAS and never waits, a full ring drops the message instead.
+template <size_t Capacity, size_t MessageSize>
+class LogRing {
+public:
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity has to be a power of two");
+
+    LogRing() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            m_slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // `write(char* out, size_t capacity) -> size_t` formats the message into the slot.
+    template <typename Write>
+    bool push(const LogRecord& record, Write&& write) {
+        auto pos = m_head.load(std::memory_order_relaxed);
+        Slot* slot{nullptr};
+
+        for (;;) {
+            slot = &m_slots[pos & (Capacity - 1)];
+            const auto seq = slot->seq.load(std::memory_order_acquire);
+            const auto diff = (intptr_t)seq - (intptr_t)pos;
+
+            if (diff == 0) {
+                if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = m_head.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->record = record;
+        slot->len = (uint32_t)std::min(write(slot->text.data(), slot->text.size()), slot->text.size());
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. `fn(const LogRecord&, std::string_view)` for everything pushed so far.
+    template <typename Fn>
+    size_t drain(Fn&& fn) {
+        size_t count = 0;
+
+        for (;; ++count) {
+            auto& slot = m_slots[m_tail & (Capacity - 1)];
+
+            if (slot.seq.load(std::memory_order_acquire) != m_tail + 1) {
+                return count;
+            }
+
+            fn(slot.record, std::string_view{slot.text.data(), slot.len});
+
+            slot.seq.store(m_tail + Capacity, std::memory_order_release);
+            ++m_tail;
+        }
+    }
+
+    uint64_t get_dropped() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<size_t> seq{0};
+        LogRecord record{};
+        uint32_t len{0};
+        std::array<char, MessageSize> text{};
+    };
+
+    std::array<Slot, Capacity> m_slots{};
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) size_t m_tail{0};
+    std::atomic<uint64_t> m_dropped{0};
+};
+
+// Hands messages from hot paths (per frame, per event) to `logger` on its own thread, so a slow
+// disk never stalls the render thread. Messages keep the time and thread they were logged at.
+// Framework owns the instance and publishes it in g_hot_log.
+class HotLog {
+public:
+    static constexpr size_t CAPACITY = 1024;
+    static constexpr size_t MESSAGE_SIZE = 256 - 40;
+
+    struct Stats {
+        uint64_t written{};
+        uint64_t dropped{};
+    };
+
+    explicit HotLog(std::shared_ptr<spdlog::logger> logger, std::chrono::milliseconds flush_interval = std::chrono::milliseconds(10))
+        : m_logger{std::move(logger)},
+          m_flush_interval{flush_interval}
+    {
+        m_thread = std::jthread{[this](std::stop_token s) { run(s); }};
+    }
+
+    ~HotLog() {
+        m_thread.request_stop();
+
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    template <typename... Args>
+    void log(spdlog::level::level_enum level, uint64_t suppressed, spdlog::format_string_t<Args...> fmt, Args&&... args) {
+        const LogRecord record{level, spdlog::log_clock::now(), spdlog::details::os::thread_id()};
+
+        m_ring.push(record, [&](char* out, size_t capacity) {
+            auto end = fmt::format_to_n(out, capacity, fmt, std::forward<Args>(args)...).out;
+
+            if (suppressed > 0 && end < out + capacity) {
+                end = fmt::format_to_n(end, capacity - (end - out), " ({} similar messages suppressed)", suppressed).out;
+            }
+
+            return (size_t)(std::min(end, out + capacity) - out);
+        });
+    }
+
+    Stats get_stats() const {
+        return Stats{m_written.load(std::memory_order_relaxed), m_ring.get_dropped()};
+    }
+
+private:
+    void run(std::stop_token s) {
+        std::mutex wait_mtx{};
+        std::condition_variable_any cv{};
+
+        while (!s.stop_requested()) {
+            {
+                std::unique_lock lock{wait_mtx};
+                cv.wait_for(lock, s, m_flush_interval, [] { return false; });
+            }
+
+            write_pending();
+        }
+
+        write_pending();
+    }
+
+    // Straight to the sinks: logger::log would stamp the message with this thread and the time it's written at
+    void write_pending() {
+        bool flush = false;
+
+        const auto count = m_ring.drain([&](const LogRecord& record, std::string_view text) {
+            if (!m_logger->should_log(record.level)) {
+                return;
+            }
+
+            spdlog::details::log_msg msg{record.time, spdlog::source_loc{}, m_logger->name(), record.level, spdlog::string_view_t{text.data(), text.size()}};
+            msg.thread_id = record.thread_id;
+
+            for (const auto& sink : m_logger->sinks()) {
+                if (!sink->should_log(msg.level)) {
+                    continue;
+                }
+
+                try {
+                    sink->log(msg);
+                } catch (...) {
+                    // a sink that can't write loses the message, the thread keeps going
+                }
+            }
+
+            flush |= record.level >= m_logger->flush_level();
+        });
+
+        if (flush) {
+            for (const auto& sink : m_logger->sinks()) {
+                try {
+                    sink->flush();
+                } catch (...) {
+                }
+            }
+        }
+
+        m_written.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    std::shared_ptr<spdlog::logger> m_logger;
+    std::chrono::milliseconds m_flush_interval;
+    LogRing<CAPACITY, MESSAGE_SIZE> m_ring{};
+    std::atomic<uint64_t> m_written{0};
+    std::jthread m_thread{};
+};
+
+// Where Framework publishes its HotLog. Callers pin it while they push, so unpublish() can wait for the
+// ones that already loaded it before the HotLog is destroyed.
+class HotLogSlot {
+public:
+    void publish(HotLog* hot_log) {
+        m_hot_log.store(hot_log);
+    }
+
+    // Nobody uses the previous HotLog anymore once this returns. Pushing never blocks, so neither does this for long.
+    void unpublish() {
+        m_hot_log.store(nullptr);
+
+        while (m_users.load() != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    // `fn(HotLog&)` if one is published, false if not
+    template <typename Fn>
+    bool use(Fn&& fn) {
+        // seq_cst on both sides: either unpublish sees us counted, or we see the nullptr
+        m_users.fetch_add(1);
+
+        const auto hot_log = m_hot_log.load();
+
+        if (hot_log != nullptr) {
+            fn(*hot_log);
+        }
+
+        m_users.fetch_sub(1, std::memory_order_release);
+        return hot_log != nullptr;
+    }
+
+private:
+    std::atomic<HotLog*> m_hot_log{nullptr};
+    std::atomic<uint32_t> m_users{0};
+};
+
+inline HotLogSlot g_hot_log{};
+
+// Use VR_HOT_LOG, it gives every call site its own limiter, or VR_HOT_LOG_LIMITED with one per logged thing.
+template <typename... Args>
+void hot_log(LogRateLimiter& limiter, spdlog::level::level_enum level, spdlog::format_string_t<Args...> fmt, Args&&... args) {
+    const auto logger = spdlog::default_logger_raw();
+
+    if (!logger->should_log(level)) {
+        return;
+    }
+
+    uint64_t suppressed = 0;
+
+    if (!limiter.try_acquire(suppressed)) {
+        return;
+    }
+
+    const auto queued = g_hot_log.use([&](HotLog& hot_log) {
+        hot_log.log(level, suppressed, fmt, std::forward<Args>(args)...);
+    });
+
+    if (queued) {
+        return;
+    }
+
+    // Before Framework set the async path up or after it tore it down
+    logger->log(level, fmt, std::forward<Args>(args)...);
+
+    if (suppressed > 0) {
+        logger->log(level, "({} similar messages suppressed)", suppressed);
+    }
+}
+} // namespace utility
+
+// Rate limited, asynchronous spdlog for paths that run every frame or every event:
+//   VR_HOT_LOG(spdlog::level::info, 2.0, 10, "VR: xrEvent: {}", name);
+// lets 10 messages through at once and then 2 per second, the rest is counted and reported with the next one.
+#define VR_HOT_LOG(level, per_second, burst, ...)                                         \
+    do {                                                                                  \
+        if constexpr ((int)(level) >= VR_HOT_LOG_ACTIVE_LEVEL) {                          \
+            static utility::LogRateLimiter s_hot_log_limiter{(per_second), (burst)};      \
+            utility::hot_log(s_hot_log_limiter, (level), __VA_ARGS__);                    \
+        }                                                                                 \
+    } while (0)
+
+// Same with a utility::LogRateLimiter the caller owns, for a helper that logs for several callers
+#define VR_HOT_LOG_LIMITED(limiter, level, ...)                                           \
+    do {                                                                                  \
+        if constexpr ((int)(level) >= VR_HOT_LOG_ACTIVE_LEVEL) {                          \
+            utility::hot_log((limiter), (level), __VA_ARGS__);                            \
+        }                                                                                 \
+    } while (0)
@@ -25,4 +25,90 @@ bool is_point_intersecting_any(float x, float y) {
 
     return false;
 }
+
+utility::UiDrawCache::Decision digest_draw_data(const ImDrawData* draw_data, utility::UiDrawCache& cache) {
+    using Rect = utility::UiDrawCache::Rect;
+
+    const auto& pos = draw_data->DisplayPos;
+    const auto& size = draw_data->DisplaySize;
+    const Rect display{pos.x, pos.y, pos.x + size.x, pos.y + size.y};
+
+    cache.begin_frame(display);
+
+#ifdef IMGUI_HAS_TEXTURES
+    cache.set_static_texture((uintptr_t)ImGui::GetIO().Fonts->TexRef.GetTexID());
+#else
+    cache.set_static_texture((uintptr_t)ImGui::GetIO().Fonts->TexID);
+#endif
+
+    for (int i = 0; i < draw_data->CmdListsCount; ++i) {
+        const auto list = draw_data->CmdLists[i];
+
+        if (list->CmdBuffer.Size == 0 || list->IdxBuffer.Size == 0) {
+            continue;
+        }
+
+        utility::UiDrawCache::ListDigest digest{};
+        digest.id = (uintptr_t)list;
+
+        auto hash = utility::UiDrawCache::hash_bytes(list->VtxBuffer.Data, list->VtxBuffer.size_in_bytes(), 0);
+        hash = utility::UiDrawCache::hash_bytes(list->IdxBuffer.Data, list->IdxBuffer.size_in_bytes(), hash);
+
+        for (const auto& cmd : list->CmdBuffer) {
+            if (cmd.UserCallback != nullptr && cmd.UserCallback != ImDrawCallback_ResetRenderState) {
+                digest.volatile_content = true;
+            }
+
+            const auto texture = cmd.GetTexID();
+
+            // e.g. ShaderDebugOverlay's live motion vector view: same id and vertices every frame, new contents
+            if (cmd.ElemCount > 0 && !cache.is_static_texture((uintptr_t)texture)) {
+                digest.live_texture = true;
+            }
+
+            hash = utility::UiDrawCache::hash_bytes(&cmd.ClipRect, sizeof(cmd.ClipRect), hash);
+            hash = utility::UiDrawCache::hash_bytes(&texture, sizeof(texture), hash);
+            hash = utility::UiDrawCache::hash_bytes(&cmd.VtxOffset, sizeof(cmd.VtxOffset), hash);
+            hash = utility::UiDrawCache::hash_bytes(&cmd.IdxOffset, sizeof(cmd.IdxOffset), hash);
+            hash = utility::UiDrawCache::hash_bytes(&cmd.ElemCount, sizeof(cmd.ElemCount), hash);
+
+            if (cmd.ElemCount > 0) {
+                digest.bounds.merge(Rect{cmd.ClipRect.x, cmd.ClipRect.y, cmd.ClipRect.z, cmd.ClipRect.w}.intersect(display));
+            }
+        }
+
+        digest.hash = hash;
+        cache.add_list(digest);
+    }
+
+    return cache.end_frame();
+}
+
+void clip_draw_data(ImDrawData* draw_data, const utility::UiDrawCache::Rect& rect, std::vector<ImVec4>& saved) {
+    saved.clear();
+
+    for (int i = 0; i < draw_data->CmdListsCount; ++i) {
+        for (auto& cmd : draw_data->CmdLists[i]->CmdBuffer) {
+            saved.push_back(cmd.ClipRect);
+
+            // An empty result makes the backend skip the command
+            cmd.ClipRect.x = std::max(cmd.ClipRect.x, rect.min_x);
+            cmd.ClipRect.y = std::max(cmd.ClipRect.y, rect.min_y);
+            cmd.ClipRect.z = std::min(cmd.ClipRect.z, rect.max_x);
+            cmd.ClipRect.w = std::min(cmd.ClipRect.w, rect.max_y);
+        }
+    }
+}
+
+void restore_clip_rects(ImDrawData* draw_data, const std::vector<ImVec4>& saved) {
+    size_t index = 0;
+
+    for (int i = 0; i < draw_data->CmdListsCount; ++i) {
+        for (auto& cmd : draw_data->CmdLists[i]->CmdBuffer) {
+            if (index < saved.size()) {
+                cmd.ClipRect = saved[index++];
+            }
+        }
+    }
+}
 }
\ No newline at end of file
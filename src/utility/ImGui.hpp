@@ -1,5 +1,20 @@
 #pragma once
 
+#include <vector>
+
+#include "UiDrawCache.hpp"
+
+struct ImDrawData;
+struct ImVec4;
+
 namespace imgui {
 bool is_point_intersecting_any(float x, float y);
-}
\ No newline at end of file
+
+// Feeds this frame's draw data to `cache` and returns whether the UI needs to be recorded again.
+utility::UiDrawCache::Decision digest_draw_data(const ImDrawData* draw_data, utility::UiDrawCache& cache);
+
+// Clamps every command's clip rect to `rect` so the backend only draws inside it,
+// the original rects go to `saved` for restore_clip_rects.
+void clip_draw_data(ImDrawData* draw_data, const utility::UiDrawCache::Rect& rect, std::vector<ImVec4>& saved);
+void restore_clip_rects(ImDrawData* draw_data, const std::vector<ImVec4>& saved);
+}
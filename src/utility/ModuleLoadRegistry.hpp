@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace utility {
+// Platform-neutral part of the ModuleWatcher.
+// Holds "run this once module X is loaded" callbacks and dispatches them exactly once,
+// either right away if the module is already there or when a load is reported.
+class ModuleLoadRegistry {
+public:
+    using Handle = void*;
+    using Callback = std::function<void(Handle)>;
+    using Query = std::function<Handle(std::string_view)>; // returns nullptr if the module isn't loaded
+    using clock = std::chrono::steady_clock;
+
+    explicit ModuleLoadRegistry(Query query)
+        : m_query{std::move(query)}
+    {
+    }
+
+    // Returns true if the callback ran immediately.
+    bool on_load(std::string_view name, Callback callback) {
+        uint64_t id{};
+
+        {
+            std::scoped_lock _{m_mtx};
+            id = ++m_next_id;
+            m_pending.push_back(Pending{id, std::string{name}, std::move(callback), clock::now()});
+        }
+
+        // Registered first and checked second, so a load reported in between
+        // is caught by either notify_loaded or this check, and take() makes sure only one of them runs it.
+        if (const auto handle = m_query(name); handle != nullptr) {
+            if (auto pending = take(id)) {
+                pending->callback(handle);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Returns the amount of callbacks that ran.
+    size_t notify_loaded(std::string_view name, Handle handle) {
+        std::vector<Pending> ready{};
+
+        {
+            std::scoped_lock _{m_mtx};
+
+            const auto it = std::stable_partition(m_pending.begin(), m_pending.end(), [&](const Pending& p) { return !name_equals(p.name, name); });
+
+            std::move(it, m_pending.end(), std::back_inserter(ready));
+            m_pending.erase(it, m_pending.end());
+
+            for (const auto& pending : ready) {
+                m_last_wait = clock::now() - pending.registered;
+            }
+        }
+
+        for (auto& pending : ready) {
+            pending.callback(handle);
+        }
+
+        return ready.size();
+    }
+
+    size_t pending() const {
+        std::scoped_lock _{m_mtx};
+        return m_pending.size();
+    }
+
+    bool is_pending(std::string_view name) const {
+        std::scoped_lock _{m_mtx};
+        return std::any_of(m_pending.begin(), m_pending.end(), [&](const Pending& p) { return name_equals(p.name, name); });
+    }
+
+    // How long the last deferred callback waited for its module.
+    clock::duration get_last_wait() const {
+        std::scoped_lock _{m_mtx};
+        return m_last_wait;
+    }
+
+    // Module names on Windows are case insensitive, they're always ASCII in practice.
+    static bool name_equals(std::string_view a, std::string_view b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+            const auto lower = [](char c) { return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c; };
+            return lower(x) == lower(y);
+        });
+    }
+
+private:
+    struct Pending {
+        uint64_t id{};
+        std::string name{};
+        Callback callback{};
+        clock::time_point registered{};
+    };
+
+    std::optional<Pending> take(uint64_t id) {
+        std::scoped_lock _{m_mtx};
+
+        const auto it = std::find_if(m_pending.begin(), m_pending.end(), [id](const Pending& p) { return p.id == id; });
+
+        if (it == m_pending.end()) {
+            return std::nullopt;
+        }
+
+        auto out = std::move(*it);
+        m_pending.erase(it);
+        return out;
+    }
+
+    Query m_query;
+
+    mutable std::mutex m_mtx{};
+    std::vector<Pending> m_pending{};
+    uint64_t m_next_id{0};
+    clock::duration m_last_wait{};
+};
+} // namespace utility
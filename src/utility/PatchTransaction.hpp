@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace utility {
+// What a PatchTransaction needs from the process. The Windows one lives in memory_mul.cpp,
+// anything else (a plain buffer) works as long as addresses mean the same to every call.
+class PatchMemoryBackend {
+public:
+    virtual ~PatchMemoryBackend() = default;
+
+    virtual size_t page_size() const = 0;
+    // Makes the page writable, returns its previous protection to hand back to protect()
+    virtual std::optional<uint32_t> unprotect(uintptr_t page) = 0;
+    virtual bool protect(uintptr_t page, uint32_t protection) = 0;
+    virtual bool read(uintptr_t address, uint8_t* out, size_t size) = 0;
+    virtual bool write(uintptr_t address, const uint8_t* data, size_t size) = 0;
+    virtual void flush_instruction_cache(uintptr_t address, size_t size) = 0;
+};
+
+// Patches collected first and then written all or nothing: every touched page is made writable
+// once, the original bytes of every patch are captured after that (code pages may not be readable
+// before) but before anything is written, and if any step fails everything written so far is put
+// back. Rollback undoes a committed transaction the same way. One instruction cache flush covers
+// the whole range either way.
+// Not synchronized, and other threads may execute the code while it's written.
+class PatchTransaction {
+public:
+    struct Stats {
+        uint64_t patches{};
+        uint64_t pages{};
+        uint64_t protection_changes{};           // unprotect + protect calls made
+        uint64_t unbatched_protection_changes{}; // what PatchMemory on each of them would have made
+        uint64_t flushes{};
+    };
+
+    explicit PatchTransaction(PatchMemoryBackend& backend)
+        : m_backend{&backend}
+    {
+    }
+
+    // False if it overlaps an earlier patch or the transaction was already committed.
+    bool add(uintptr_t address, std::vector<uint8_t> bytes) {
+        if (m_committed || bytes.empty()) {
+            return false;
+        }
+
+        const auto end = address + bytes.size();
+
+        for (const auto& patch : m_patches) {
+            if (address < patch.address + patch.bytes.size() && patch.address < end) {
+                return false;
+            }
+        }
+
+        m_patches.push_back(Entry{address, std::move(bytes), {}});
+        return true;
+    }
+
+    bool commit() {
+        if (m_committed || m_patches.empty()) {
+            return false;
+        }
+
+        std::sort(m_patches.begin(), m_patches.end(), [](const auto& a, const auto& b) { return a.address < b.address; });
+
+        m_committed = apply(false);
+        return m_committed;
+    }
+
+    // Puts the original bytes back, false if the transaction isn't committed or that failed.
+    bool rollback() {
+        if (!m_committed) {
+            return false;
+        }
+
+        m_committed = !apply(true);
+        return !m_committed;
+    }
+
+    bool is_committed() const {
+        return m_committed;
+    }
+
+    size_t size() const {
+        return m_patches.size();
+    }
+
+    const Stats& get_stats() const {
+        return m_stats;
+    }
+
+private:
+    struct Entry {
+        uintptr_t address{};
+        std::vector<uint8_t> bytes{};
+        std::vector<uint8_t> original{};
+    };
+
+    struct Page {
+        uintptr_t address{};
+        uint32_t protection{};
+    };
+
+    // Writes the patch bytes (or the originals with `restore`) of every patch, pages sorted by address.
+    // Without `restore` the originals are read first, once the pages are unprotected.
+    bool apply(bool restore) {
+        const auto page_size = m_backend->page_size();
+        std::vector<Page> pages{};
+
+        for (const auto& patch : m_patches) {
+            const auto first = patch.address & ~(uintptr_t)(page_size - 1);
+            const auto last = (patch.address + patch.bytes.size() - 1) & ~(uintptr_t)(page_size - 1);
+
+            for (auto page = first; page <= last; page += page_size) {
+                if (pages.empty() || pages.back().address < page) {
+                    pages.push_back(Page{page});
+                }
+            }
+        }
+
+        m_stats.patches += m_patches.size();
+        m_stats.pages += pages.size();
+        m_stats.unbatched_protection_changes += m_patches.size() * 2;
+
+        size_t unprotected = 0;
+        size_t written = 0;
+        bool ok = true;
+
+        for (; unprotected < pages.size(); ++unprotected) {
+            ++m_stats.protection_changes;
+            const auto previous = m_backend->unprotect(pages[unprotected].address);
+
+            if (!previous) {
+                ok = false;
+                break;
+            }
+
+            pages[unprotected].protection = *previous;
+        }
+
+        if (ok && !restore) {
+            for (auto& patch : m_patches) {
+                patch.original.resize(patch.bytes.size());
+
+                if (!m_backend->read(patch.address, patch.original.data(), patch.original.size())) {
+                    ok = false;
+                    break;
+                }
+            }
+        }
+
+        for (; ok && written < m_patches.size(); ++written) {
+            const auto& patch = m_patches[written];
+            ok = m_backend->write(patch.address, restore ? patch.original.data() : patch.bytes.data(), patch.bytes.size());
+        }
+
+        // Half written, undo what got through (the failed one included, it may be partially written)
+        if (!ok) {
+            for (size_t i = 0; i < written; ++i) {
+                const auto& patch = m_patches[i];
+                m_backend->write(patch.address, restore ? patch.bytes.data() : patch.original.data(), patch.bytes.size());
+            }
+        }
+
+        for (size_t i = 0; i < unprotected; ++i) {
+            ++m_stats.protection_changes;
+            m_backend->protect(pages[i].address, pages[i].protection);
+        }
+
+        if (written > 0) {
+            ++m_stats.flushes;
+            const auto begin = m_patches.front().address;
+            const auto& back = m_patches.back();
+            m_backend->flush_instruction_cache(begin, back.address + back.bytes.size() - begin);
+        }
+
+        return ok;
+    }
+
+    PatchMemoryBackend* m_backend;
+    std::vector<Entry> m_patches{};
+    bool m_committed{false};
+    Stats m_stats{};
+};
+} // namespace utility
@@ -0,0 +1,403 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "AsyncConfigWriter.hpp"
+
+namespace utility {
+// A mapped PE image (or any copy of one), reads outside of it fail instead of faulting.
+struct ImageView {
+    uintptr_t base{};
+    size_t size{};
+
+    const uint8_t* at(uintptr_t address, size_t len) const {
+        if (address < base || len > size || address - base > size - len) {
+            return nullptr;
+        }
+
+        return (const uint8_t*)address;
+    }
+
+    template <typename T>
+    std::optional<T> read(uintptr_t address) const {
+        const auto p = at(address, sizeof(T));
+
+        if (p == nullptr) {
+            return std::nullopt;
+        }
+
+        T out{};
+        std::memcpy(&out, p, sizeof(T));
+        return out;
+    }
+};
+
+// Which build of the game an offset belongs to. TimeDateStamp and SizeOfImage are what symbol
+// servers key on (see CrashModule), the header hash catches builds that were re-stamped.
+struct ImageIdentity {
+    uint32_t timestamp{};
+    uint32_t image_size{};
+    uint64_t header_hash{};
+
+    bool operator==(const ImageIdentity& other) const = default;
+
+    std::string to_string() const {
+        char buf[64]{};
+        const auto len = std::snprintf(buf, sizeof(buf), "%08x-%08x-%016llx", timestamp, image_size, (unsigned long long)header_hash);
+        return std::string{buf, (size_t)len};
+    }
+};
+
+// Nothing but the headers is touched, a synthetic image only needs the DOS and NT headers.
+inline std::optional<ImageIdentity> read_image_identity(const ImageView& image) {
+    const auto b = image.base;
+
+    if (image.read<uint16_t>(b) != 0x5A4D) { // MZ
+        return std::nullopt;
+    }
+
+    const auto e_lfanew = image.read<uint32_t>(b + 0x3C);
+
+    if (!e_lfanew || image.read<uint32_t>(b + *e_lfanew) != 0x00004550) { // PE\0\0
+        return std::nullopt;
+    }
+
+    const auto nt = b + *e_lfanew;
+    const auto optional_header = nt + 24;
+    // Same offsets in PE32 and PE32+
+    const auto timestamp = image.read<uint32_t>(nt + 8);
+    const auto image_size = image.read<uint32_t>(optional_header + 56);
+    const auto header_size = image.read<uint32_t>(optional_header + 60);
+
+    if (!timestamp || !image_size || !header_size) {
+        return std::nullopt;
+    }
+
+    const auto hashed = std::min<size_t>(*header_size, 0x1000);
+    const auto headers = image.at(b, hashed);
+
+    if (headers == nullptr) {
+        return std::nullopt;
+    }
+
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (size_t i = 0; i < hashed; ++i) {
+        hash ^= headers[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return ImageIdentity{*timestamp, *image_size, hash};
+}
+
+// Decorated name (".?AVFoo@@") of the type a vtable belongs to, read from the complete object
+// locator in front of it. x64 only, the locator there refers to everything by RVA.
+inline std::optional<std::string> read_rtti_name(const ImageView& image, uintptr_t vtable) {
+    const auto locator = image.read<uint64_t>(vtable - sizeof(void*));
+
+    if (!locator || image.read<uint32_t>(*locator) != 1) {
+        return std::nullopt;
+    }
+
+    const auto type_descriptor_rva = image.read<int32_t>(*locator + 12);
+
+    if (!type_descriptor_rva) {
+        return std::nullopt;
+    }
+
+    // vftable pointer, spare pointer, then the name
+    const auto name = image.base + *type_descriptor_rva + 16;
+    std::string out{};
+
+    for (size_t i = 0; i < 512; ++i) {
+        const auto c = image.read<char>(name + i);
+
+        if (!c) {
+            return std::nullopt;
+        }
+
+        if (*c == '\0') {
+            return out;
+        }
+
+        out.push_back(*c);
+    }
+
+    return std::nullopt;
+}
+
+// What a pattern scan resolved to once, plus what has to hold for it to be trusted on the next start.
+struct ProfileEntry {
+    uint64_t offset{};               // from the image base
+    std::vector<uint8_t> prologue{}; // bytes expected at the address, empty = not checked
+    std::string rtti_name{};         // decorated name of a vtable's type, empty = not checked
+
+    bool operator==(const ProfileEntry& other) const = default;
+};
+
+enum class ProfileCheck {
+    Ok,
+    OutOfImage,
+    PrologueMismatch,
+    RttiMismatch,
+};
+
+inline const char* to_string(ProfileCheck check) {
+    switch (check) {
+    case ProfileCheck::Ok:
+        return "ok";
+    case ProfileCheck::OutOfImage:
+        return "outside of the image";
+    case ProfileCheck::PrologueMismatch:
+        return "prologue mismatch";
+    case ProfileCheck::RttiMismatch:
+        return "RTTI mismatch";
+    }
+
+    return "unknown";
+}
+
+// Length of the jump an inline hook (ours, MinHook's, another mod's) put at the start of a function, 0 if
+// `code` doesn't start with one. The bytes after it are still the function's own.
+inline size_t inline_hook_jump_size(const uint8_t* code, size_t size) {
+    if (size >= 5 && code[0] == 0xE9) { // jmp rel32
+        return 5;
+    }
+
+    if (size >= 14 && code[0] == 0xFF && code[1] == 0x25 && code[2] == 0 && code[3] == 0 && code[4] == 0 && code[5] == 0) { // jmp [rip+0], address
+        return 14;
+    }
+
+    if (size >= 12 && code[0] == 0x48 && code[1] == 0xB8 && code[10] == 0xFF && code[11] == 0xE0) { // mov rax, imm64; jmp rax
+        return 12;
+    }
+
+    return 0;
+}
+
+// What has to be left of a prologue after a hook's jump for it to still tell functions apart
+constexpr size_t MIN_HOOKED_PROLOGUE_MATCH = 8;
+
+inline ProfileCheck validate_profile_entry(const ImageView& image, const ProfileEntry& entry) {
+    const auto address = image.base + entry.offset;
+
+    if (entry.offset == 0 || image.at(address, std::max<size_t>(entry.prologue.size(), 1)) == nullptr) {
+        return ProfileCheck::OutOfImage;
+    }
+
+    if (!entry.prologue.empty()) {
+        const auto code = image.at(address, entry.prologue.size());
+        const auto size = entry.prologue.size();
+
+        if (std::memcmp(code, entry.prologue.data(), size) != 0) {
+            // hooked since it was profiled, compare what follows the jump
+            const auto skip = inline_hook_jump_size(code, size);
+
+            if (skip == 0 || size - skip < MIN_HOOKED_PROLOGUE_MATCH || std::memcmp(code + skip, entry.prologue.data() + skip, size - skip) != 0) {
+                return ProfileCheck::PrologueMismatch;
+            }
+        }
+    }
+
+    if (!entry.rtti_name.empty() && read_rtti_name(image, address) != entry.rtti_name) {
+        return ProfileCheck::RttiMismatch;
+    }
+
+    return ProfileCheck::Ok;
+}
+
+// Resolved offsets per game build, so a build that was scanned once starts without scanning.
+// Text file, one section per build:
+//   [<ImageIdentity::to_string()>]
+//   <id>=<offset hex> [prologue=<hex bytes>] [rtti=<decorated name>]
+// Unknown fields and malformed lines are skipped.
+class PatternProfileDb {
+public:
+    bool load(const std::filesystem::path& path) {
+        std::ifstream file{path, std::ios::binary};
+
+        if (!file) {
+            return false;
+        }
+
+        parse(std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}});
+        return true;
+    }
+
+    // Atomic like the config (tmp + rename), skipped when it's what `last_hash` says was written last.
+    CommitResult save(const std::filesystem::path& path, uint64_t& last_hash) const {
+        return commit_file(serialize(), path, last_hash);
+    }
+
+    void parse(std::string_view text) {
+        m_profiles.clear();
+        Profile* profile{nullptr};
+
+        while (!text.empty()) {
+            const auto eol = text.find('\n');
+            auto line = trim(text.substr(0, eol));
+            text = eol == std::string_view::npos ? std::string_view{} : text.substr(eol + 1);
+
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+
+            if (line.front() == '[' && line.back() == ']') {
+                profile = &m_profiles[std::string{line.substr(1, line.size() - 2)}];
+                continue;
+            }
+
+            const auto eq = line.find('=');
+
+            if (profile == nullptr || eq == std::string_view::npos || eq == 0) {
+                continue;
+            }
+
+            if (auto entry = parse_entry(line.substr(eq + 1))) {
+                (*profile)[std::string{line.substr(0, eq)}] = std::move(*entry);
+            }
+        }
+    }
+
+    std::string serialize() const {
+        std::string out{};
+
+        for (const auto& [identity, profile] : m_profiles) {
+            out += '[';
+            out += identity;
+            out += "]\n";
+
+            for (const auto& [id, entry] : profile) {
+                char offset[32]{};
+                std::snprintf(offset, sizeof(offset), "%llx", (unsigned long long)entry.offset);
+
+                out += id;
+                out += '=';
+                out += offset;
+
+                if (!entry.prologue.empty()) {
+                    out += " prologue=";
+
+                    for (const auto b : entry.prologue) {
+                        out += "0123456789abcdef"[b >> 4];
+                        out += "0123456789abcdef"[b & 0xF];
+                    }
+                }
+
+                if (!entry.rtti_name.empty()) {
+                    out += " rtti=";
+                    out += entry.rtti_name;
+                }
+
+                out += '\n';
+            }
+        }
+
+        return out;
+    }
+
+    const ProfileEntry* find(const ImageIdentity& identity, std::string_view id) const {
+        const auto profile = m_profiles.find(identity.to_string());
+
+        if (profile == m_profiles.end()) {
+            return nullptr;
+        }
+
+        const auto entry = profile->second.find(id);
+        return entry != profile->second.end() ? &entry->second : nullptr;
+    }
+
+    // False if the same entry was already there, i.e. nothing to save.
+    bool put(const ImageIdentity& identity, std::string_view id, const ProfileEntry& entry) {
+        auto& slot = m_profiles[identity.to_string()][std::string{id}];
+
+        if (slot == entry) {
+            return false;
+        }
+
+        slot = entry;
+        return true;
+    }
+
+    void erase(const ImageIdentity& identity, std::string_view id) {
+        if (const auto profile = m_profiles.find(identity.to_string()); profile != m_profiles.end()) {
+            if (const auto entry = profile->second.find(id); entry != profile->second.end()) {
+                profile->second.erase(entry);
+            }
+        }
+    }
+
+    size_t size() const {
+        return m_profiles.size();
+    }
+
+private:
+    using Profile = std::map<std::string, ProfileEntry, std::less<>>;
+
+    static std::string_view trim(std::string_view s) {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t' || s.front() == '\r')) {
+            s.remove_prefix(1);
+        }
+
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) {
+            s.remove_suffix(1);
+        }
+
+        return s;
+    }
+
+    static std::optional<ProfileEntry> parse_entry(std::string_view value) {
+        ProfileEntry out{};
+        bool first = true;
+
+        while (!value.empty()) {
+            const auto space = value.find(' ');
+            const auto field = value.substr(0, space);
+            value = space == std::string_view::npos ? std::string_view{} : trim(value.substr(space + 1));
+
+            if (first) {
+                first = false;
+
+                if (std::from_chars(field.data(), field.data() + field.size(), out.offset, 16).ec != std::errc{}) {
+                    return std::nullopt;
+                }
+            } else if (field.starts_with("prologue=")) {
+                const auto hex = field.substr(9);
+
+                if (hex.size() % 2 != 0) {
+                    return std::nullopt;
+                }
+
+                for (size_t i = 0; i < hex.size(); i += 2) {
+                    uint8_t b{};
+
+                    if (std::from_chars(hex.data() + i, hex.data() + i + 2, b, 16).ec != std::errc{}) {
+                        return std::nullopt;
+                    }
+
+                    out.prologue.push_back(b);
+                }
+            } else if (field.starts_with("rtti=")) {
+                out.rtti_name = std::string{field.substr(5)};
+            }
+        }
+
+        return first ? std::nullopt : std::optional<ProfileEntry>{std::move(out)};
+    }
+
+    std::map<std::string, Profile> m_profiles{};
+};
+} // namespace utility
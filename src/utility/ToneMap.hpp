@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace utility::tonemap {
+// Same order as DirectX::ToneMapPostProcess::Operator, which ModSettings::toneMapAlg indexes.
+enum Operator : uint32_t {
+    NONE,
+    SATURATE,
+    REINHARD,
+    ACES_FILMIC,
+    COUNT
+};
+
+// Root constants of shaders/tonemap_ps.hlsl, keep both in sync.
+struct Constants {
+    uint32_t op{NONE};
+    float exposure_scale{1.0f};
+    uint32_t srgb{0};
+    uint32_t pad{0};
+};
+static_assert(sizeof(Constants) == 16);
+
+// Matches ToneMapPostProcess as the D3D11 path sets it up: exposure in stops, then the operator,
+// linear transfer function. NONE is a plain copy there too (PSCopy), without exposure or sRGB.
+inline Constants make_constants(int alg, float exposure, bool srgb = false) {
+    Constants out{};
+    out.op = (uint32_t)std::clamp<int>(alg, NONE, COUNT - 1);
+    out.exposure_scale = std::exp2(exposure);
+    out.srgb = srgb ? 1 : 0;
+    return out;
+}
+
+struct Rgb {
+    float r{};
+    float g{};
+    float b{};
+};
+
+inline float saturate(float x) {
+    return std::clamp(x, 0.0f, 1.0f);
+}
+
+inline float reinhard(float x) {
+    return x / (1.0f + x);
+}
+
+// Krzysztof Narkowicz's fit, as in DirectXTK's ToneMap.fxh
+inline float aces_filmic(float x) {
+    constexpr float a = 2.51f;
+    constexpr float b = 0.03f;
+    constexpr float c = 2.43f;
+    constexpr float d = 0.59f;
+    constexpr float e = 0.14f;
+
+    return saturate((x * (a * x + b)) / (x * (c * x + d) + e));
+}
+
+// DirectXTK's LinearToSRGBEst
+inline float linear_to_srgb(float x) {
+    return std::pow(std::abs(x), 1.0f / 2.2f);
+}
+
+// CPU reference of what tonemap_ps.hlsl does to one pixel.
+inline float apply(const Constants& constants, float x) {
+    if (constants.op == NONE) {
+        return x;
+    }
+
+    x *= constants.exposure_scale;
+
+    switch (constants.op) {
+    case SATURATE:
+        x = saturate(x);
+        break;
+    case REINHARD:
+        x = reinhard(x);
+        break;
+    case ACES_FILMIC:
+        x = aces_filmic(x);
+        break;
+    default:
+        break;
+    }
+
+    return constants.srgb != 0 ? linear_to_srgb(x) : x;
+}
+
+inline Rgb apply(const Constants& constants, const Rgb& rgb) {
+    return {apply(constants, rgb.r), apply(constants, rgb.g), apply(constants, rgb.b)};
+}
+} // namespace utility::tonemap
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace utility {
+// Decides whether the UI render target needs to be re-recorded this frame.
+// The UI is described as a sequence of draw lists, each with a stable id, a content hash and
+// the screen bounds it can touch. Comparing against the previous frame yields nothing to do,
+// a redraw of just the region covered by the lists that changed, or a full redraw.
+// Knows nothing about ImGui or D3D, see imgui::digest_draw_data for the ImGui side.
+class UiDrawCache {
+public:
+    struct Rect {
+        float min_x{0.0f};
+        float min_y{0.0f};
+        float max_x{0.0f};
+        float max_y{0.0f};
+
+        bool empty() const {
+            return max_x <= min_x || max_y <= min_y;
+        }
+
+        float area() const {
+            return empty() ? 0.0f : (max_x - min_x) * (max_y - min_y);
+        }
+
+        void merge(const Rect& other) {
+            if (other.empty()) {
+                return;
+            }
+
+            if (empty()) {
+                *this = other;
+                return;
+            }
+
+            min_x = std::min(min_x, other.min_x);
+            min_y = std::min(min_y, other.min_y);
+            max_x = std::max(max_x, other.max_x);
+            max_y = std::max(max_y, other.max_y);
+        }
+
+        Rect intersect(const Rect& other) const {
+            return Rect{std::max(min_x, other.min_x), std::max(min_y, other.min_y), std::min(max_x, other.max_x), std::min(max_y, other.max_y)};
+        }
+
+        bool operator==(const Rect& other) const = default;
+    };
+
+    struct ListDigest {
+        uintptr_t id{};
+        uint64_t hash{};
+        Rect bounds{};
+        bool volatile_content{false}; // e.g. user callbacks, can't be compared by hash
+        bool live_texture{false};     // samples a texture that changes without the draw data changing, redrawn every frame
+    };
+
+    enum class Action : uint8_t {
+        SKIP,          // identical to what's already in the render target
+        REDRAW_DIRTY,  // only `dirty` needs to be cleared and drawn again
+        REDRAW_FULL,
+    };
+
+    struct Decision {
+        Action action{Action::REDRAW_FULL};
+        Rect dirty{};
+        bool empty{false}; // nothing to draw at all this frame
+    };
+
+    struct Stats {
+        uint64_t frames{};
+        uint64_t skipped{};
+        uint64_t partial{};
+        uint64_t full{};
+        uint64_t submissions{};         // command lists actually executed for the UI
+        uint64_t skipped_submissions{}; // ones that would have been without the cache
+        double avg_record_ms{};         // moving average of a full record
+        double saved_ms{};              // avg_record_ms summed over skipped frames
+    };
+
+    // Dirty regions covering more than this fraction of the display are just redrawn fully.
+    static constexpr float FULL_REDRAW_FRACTION = 0.6f;
+
+    void begin_frame(const Rect& display) {
+        m_current.clear();
+        m_display = display;
+    }
+
+    void add_list(const ListDigest& digest) {
+        m_current.push_back(digest);
+    }
+
+    Decision end_frame() {
+        Decision out{};
+        out.empty = m_current.empty();
+
+        ++m_stats.frames;
+
+        if (m_invalidated || m_display != m_prev_display || has_volatile(m_current) || has_volatile(m_previous)) {
+            out.action = Action::REDRAW_FULL;
+        } else {
+            out = diff(m_previous, m_current, m_display);
+        }
+
+        switch (out.action) {
+        case Action::SKIP:
+            ++m_stats.skipped;
+            m_stats.saved_ms += m_stats.avg_record_ms;
+            break;
+        case Action::REDRAW_DIRTY:
+            ++m_stats.partial;
+            break;
+        default:
+            ++m_stats.full;
+            break;
+        }
+
+        m_invalidated = false;
+        m_prev_display = m_display;
+        m_previous.swap(m_current);
+
+        return out;
+    }
+
+    // Next frame gets fully redrawn, e.g. the render target or a texture the UI samples was recreated.
+    void invalidate() {
+        m_invalidated = true;
+    }
+
+    // The font atlas, the one texture whose contents only change along with an invalidate().
+    // A list sampling anything else (a live debug view, a game render target) is a live_texture list.
+    void set_static_texture(uintptr_t texture) {
+        m_static_texture = texture;
+    }
+
+    bool is_static_texture(uintptr_t texture) const {
+        return texture == m_static_texture;
+    }
+
+    void record_submission() {
+        ++m_stats.submissions;
+    }
+
+    void record_skipped_submission() {
+        ++m_stats.skipped_submissions;
+    }
+
+    // CPU time of a full re-record, what a skipped frame saves
+    void record_full_time(double ms) {
+        m_stats.avg_record_ms = m_stats.avg_record_ms == 0.0 ? ms : m_stats.avg_record_ms * 0.95 + ms * 0.05;
+    }
+
+    const Stats& get_stats() const {
+        return m_stats;
+    }
+
+    // Pure comparison of two frames of digests, same display.
+    static Decision diff(const std::vector<ListDigest>& previous, const std::vector<ListDigest>& current, const Rect& display) {
+        Decision out{};
+        out.empty = current.empty();
+
+        // Reordered lists change what's drawn on top of what, not worth tracking
+        bool same_order = previous.size() == current.size();
+
+        for (size_t i = 0; same_order && i < current.size(); ++i) {
+            same_order = previous[i].id == current[i].id;
+        }
+
+        Rect dirty{};
+
+        const auto changed = [](const ListDigest& p, const ListDigest& c) {
+            return p.hash != c.hash || p.bounds != c.bounds || c.live_texture;
+        };
+
+        if (same_order) {
+            for (size_t i = 0; i < current.size(); ++i) {
+                if (changed(previous[i], current[i])) {
+                    dirty.merge(previous[i].bounds);
+                    dirty.merge(current[i].bounds);
+                }
+            }
+        } else {
+            const auto order_change_is_append_or_remove = [&]() {
+                // Windows appearing or disappearing without the rest changing order is common (popups, tooltips)
+                size_t p = 0, c = 0;
+
+                while (p < previous.size() && c < current.size()) {
+                    if (previous[p].id == current[c].id) {
+                        if (changed(previous[p], current[c])) {
+                            dirty.merge(previous[p].bounds);
+                            dirty.merge(current[c].bounds);
+                        }
+
+                        ++p;
+                        ++c;
+                    } else if (std::none_of(current.begin() + c, current.end(), [&](const ListDigest& d) { return d.id == previous[p].id; })) {
+                        dirty.merge(previous[p++].bounds); // removed
+                    } else if (std::none_of(previous.begin() + p, previous.end(), [&](const ListDigest& d) { return d.id == current[c].id; })) {
+                        dirty.merge(current[c++].bounds); // added
+                    } else {
+                        return false;
+                    }
+                }
+
+                for (; p < previous.size(); ++p) {
+                    dirty.merge(previous[p].bounds);
+                }
+
+                for (; c < current.size(); ++c) {
+                    dirty.merge(current[c].bounds);
+                }
+
+                return true;
+            };
+
+            if (!order_change_is_append_or_remove()) {
+                out.action = Action::REDRAW_FULL;
+                return out;
+            }
+        }
+
+        dirty = dirty.intersect(display);
+
+        if (dirty.empty()) {
+            out.action = Action::SKIP;
+        } else if (dirty.area() > display.area() * FULL_REDRAW_FRACTION) {
+            out.action = Action::REDRAW_FULL;
+        } else {
+            out.action = Action::REDRAW_DIRTY;
+            out.dirty = dirty;
+        }
+
+        return out;
+    }
+
+    // Word at a time hash, the vertex buffers of a busy UI are around a megabyte per frame.
+    static uint64_t hash_bytes(const void* data, size_t size, uint64_t seed) {
+        constexpr uint64_t k = 0x9E3779B97F4A7C15ull;
+
+        auto h = seed ^ (size * k);
+        auto p = (const uint8_t*)data;
+
+        const auto mix = [&](uint64_t v) {
+            h ^= v * k;
+            h = (h << 31) | (h >> 33);
+            h *= 0xBF58476D1CE4E5B9ull;
+        };
+
+        for (; size >= 8; size -= 8, p += 8) {
+            uint64_t v{};
+            std::memcpy(&v, p, 8);
+            mix(v);
+        }
+
+        if (size > 0) {
+            uint64_t v{};
+            std::memcpy(&v, p, size);
+            mix(v);
+        }
+
+        h ^= h >> 29;
+        return h;
+    }
+
+private:
+    static bool has_volatile(const std::vector<ListDigest>& lists) {
+        return std::any_of(lists.begin(), lists.end(), [](const ListDigest& d) { return d.volatile_content; });
+    }
+
+    std::vector<ListDigest> m_previous{};
+    std::vector<ListDigest> m_current{};
+    Rect m_display{};
+    Rect m_prev_display{};
+    uintptr_t m_static_texture{0};
+    bool m_invalidated{true};
+    Stats m_stats{};
+};
+} // namespace utility
@@ -0,0 +1,348 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace utility {
+// Platform-neutral core of the WindowFilter.
+// Verdicts live in a fixed open addressing table guarded by a sequence lock: readers only load
+// (no shared counters, no copies, no snapshots to retire) and retry in the rare case a writer
+// got in between. Writers (window create/destroy/rename notifications, pattern changes) take
+// m_write_mtx and bump the sequence around every change to the table.
+// Windows that don't fit into the table go to an overflow map behind the write lock.
+class WindowFilterSet {
+public:
+    using WindowId = const void*;
+    using TitleSource = std::function<std::string(WindowId)>;
+
+    static constexpr size_t CAPACITY = 512;
+    static constexpr size_t MAX_PROBES = 16;
+
+    // With `on_pending` set, windows seen for the first time in is_filtered are queued and
+    // `on_pending` is called to get classify_pending() run on another thread. Without it they
+    // are classified synchronously.
+    explicit WindowFilterSet(TitleSource source, std::vector<std::string> patterns = {}, std::function<void()> on_pending = {})
+        : m_source{std::move(source)},
+          m_patterns{std::move(patterns)},
+          m_on_pending{std::move(on_pending)}
+    {
+    }
+
+    WindowFilterSet(const WindowFilterSet&) = delete;
+    WindowFilterSet& operator=(const WindowFilterSet&) = delete;
+
+    // Lock-free unless the window overflowed the table, nullopt if it hasn't been classified yet.
+    std::optional<bool> lookup(WindowId window) const {
+        if (window == nullptr) {
+            return std::nullopt;
+        }
+
+        Verdict verdict{};
+
+        for (;;) {
+            const auto before = m_sequence.load(std::memory_order_acquire);
+
+            if ((before & 1) != 0) {
+                continue;
+            }
+
+            verdict = find_verdict(window);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (m_sequence.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+
+        if (verdict == Verdict::NONE && m_overflowed.load(std::memory_order_acquire) > 0) {
+            std::scoped_lock _{m_write_mtx};
+
+            if (const auto it = m_overflow.find(window); it != m_overflow.end()) {
+                verdict = it->second;
+            }
+        }
+
+        if (verdict == Verdict::NONE) {
+            return std::nullopt;
+        }
+
+        return verdict != Verdict::ALLOWED;
+    }
+
+    // Windows seen for the first time count as filtered until classify_pending() got to them,
+    // reading a title from the present thread can take a while.
+    bool is_filtered(WindowId window) {
+        if (auto result = lookup(window)) {
+            return *result;
+        }
+
+        if (!m_on_pending) {
+            return classify(window);
+        }
+
+        bool queued = false;
+
+        {
+            std::scoped_lock _{m_write_mtx};
+
+            if (std::find(m_pending.begin(), m_pending.end(), window) == m_pending.end()) {
+                m_pending.push_back(window);
+                queued = true;
+            }
+        }
+
+        if (queued) {
+            m_on_pending();
+        }
+
+        return true;
+    }
+
+    // Classifies everything is_filtered queued up, returns how many windows that was.
+    size_t classify_pending() {
+        std::vector<WindowId> pending{};
+
+        {
+            std::scoped_lock _{m_write_mtx};
+            pending.swap(m_pending);
+        }
+
+        for (const auto window : pending) {
+            classify(window);
+        }
+
+        return pending.size();
+    }
+
+    // Re-reads the title and updates the table only if the classification changed,
+    // so windows that keep updating their title don't make readers retry.
+    bool classify(WindowId window) {
+        const auto title = m_source(window);
+
+        std::scoped_lock _{m_write_mtx};
+        const auto current = get_verdict(window);
+
+        if (current == Verdict::FORCED) {
+            return true;
+        }
+
+        const auto filtered = matches(title);
+        const auto verdict = filtered ? Verdict::FILTERED : Verdict::ALLOWED;
+
+        if (current != verdict) {
+            set_verdict(window, verdict);
+        }
+
+        return filtered;
+    }
+
+    // Filters the window regardless of its title, survives pattern changes.
+    void force_filter(WindowId window) {
+        std::scoped_lock _{m_write_mtx};
+
+        if (get_verdict(window) != Verdict::FORCED) {
+            set_verdict(window, Verdict::FORCED);
+        }
+    }
+
+    void forget(WindowId window) {
+        std::scoped_lock _{m_write_mtx};
+
+        std::erase(m_pending, window);
+
+        if (get_verdict(window) != Verdict::NONE) {
+            set_verdict(window, Verdict::NONE);
+        }
+    }
+
+    // Case sensitive substring patterns. Everything already known gets reclassified, until then
+    // it keeps its old verdict.
+    void set_patterns(std::vector<std::string> patterns) {
+        std::vector<WindowId> known{};
+
+        {
+            std::scoped_lock _{m_write_mtx};
+            m_patterns = std::move(patterns);
+
+            for (const auto& slot : m_slots) {
+                const auto window = slot.window.load(std::memory_order_relaxed);
+
+                if (window != nullptr && slot.verdict.load(std::memory_order_relaxed) != Verdict::FORCED) {
+                    known.push_back(window);
+                }
+            }
+
+            for (const auto& [window, verdict] : m_overflow) {
+                if (verdict != Verdict::FORCED) {
+                    known.push_back(window);
+                }
+            }
+        }
+
+        // titles are fetched without holding the write lock
+        for (const auto window : known) {
+            classify(window);
+        }
+    }
+
+    std::vector<std::string> get_patterns() const {
+        std::scoped_lock _{m_write_mtx};
+        return m_patterns;
+    }
+
+    // Splits a comma separated config string, trimming spaces and dropping empty entries.
+    static std::vector<std::string> parse_patterns(std::string_view str) {
+        std::vector<std::string> out{};
+
+        while (!str.empty()) {
+            const auto comma = str.find(',');
+            auto token = str.substr(0, comma);
+
+            while (!token.empty() && token.front() == ' ') {
+                token.remove_prefix(1);
+            }
+
+            while (!token.empty() && token.back() == ' ') {
+                token.remove_suffix(1);
+            }
+
+            if (!token.empty()) {
+                out.emplace_back(token);
+            }
+
+            if (comma == std::string_view::npos) {
+                break;
+            }
+
+            str.remove_prefix(comma + 1);
+        }
+
+        return out;
+    }
+
+private:
+    enum class Verdict : uint8_t {
+        NONE,
+        ALLOWED,
+        FILTERED,
+        FORCED,
+    };
+
+    struct Slot {
+        std::atomic<WindowId> window{nullptr};
+        std::atomic<Verdict> verdict{Verdict::NONE};
+    };
+
+    static size_t home_slot(WindowId window) {
+        return (size_t)(((uint64_t)(uintptr_t)window * 0x9E3779B97F4A7C15ull) >> 32) & (CAPACITY - 1);
+    }
+
+    // Removed windows leave holes in probe chains, so a lookup always walks all MAX_PROBES slots.
+    Verdict find_verdict(WindowId window) const {
+        const auto home = home_slot(window);
+
+        for (size_t i = 0; i < MAX_PROBES; ++i) {
+            const auto& slot = m_slots[(home + i) & (CAPACITY - 1)];
+
+            if (slot.window.load(std::memory_order_relaxed) == window) {
+                return slot.verdict.load(std::memory_order_relaxed);
+            }
+        }
+
+        return Verdict::NONE;
+    }
+
+    // Must hold m_write_mtx.
+    Verdict get_verdict(WindowId window) const {
+        if (const auto verdict = find_verdict(window); verdict != Verdict::NONE) {
+            return verdict;
+        }
+
+        const auto it = m_overflow.find(window);
+        return it != m_overflow.end() ? it->second : Verdict::NONE;
+    }
+
+    // Must hold m_write_mtx. NONE removes the window.
+    void set_verdict(WindowId window, Verdict verdict) {
+        const auto home = home_slot(window);
+        Slot* existing{nullptr};
+        Slot* free{nullptr};
+
+        for (size_t i = 0; i < MAX_PROBES; ++i) {
+            auto& slot = m_slots[(home + i) & (CAPACITY - 1)];
+            const auto occupant = slot.window.load(std::memory_order_relaxed);
+
+            if (occupant == window) {
+                existing = &slot;
+                break;
+            }
+
+            if (occupant == nullptr && free == nullptr) {
+                free = &slot;
+            }
+        }
+
+        if (existing == nullptr && (free == nullptr || m_overflow.contains(window))) {
+            if (verdict == Verdict::NONE) {
+                m_overflow.erase(window);
+            } else {
+                m_overflow[window] = verdict;
+            }
+
+            m_overflowed.store(m_overflow.size(), std::memory_order_release);
+            return;
+        }
+
+        if (existing == nullptr && verdict == Verdict::NONE) {
+            return;
+        }
+
+        const auto sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto& slot = existing != nullptr ? *existing : *free;
+
+        if (verdict == Verdict::NONE) {
+            slot.window.store(nullptr, std::memory_order_relaxed);
+            slot.verdict.store(Verdict::NONE, std::memory_order_relaxed);
+        } else {
+            slot.verdict.store(verdict, std::memory_order_relaxed);
+            slot.window.store(window, std::memory_order_relaxed);
+        }
+
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    bool matches(std::string_view title) const {
+        for (const auto& pattern : m_patterns) {
+            if (title.find(pattern) != std::string_view::npos) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    TitleSource m_source;
+    std::vector<std::string> m_patterns{};
+    std::function<void()> m_on_pending{};
+
+    std::array<Slot, CAPACITY> m_slots{};
+    std::atomic<uint64_t> m_sequence{0};
+    std::atomic<size_t> m_overflowed{0};
+
+    mutable std::mutex m_write_mtx{};
+    std::unordered_map<WindowId, Verdict> m_overflow{};
+    std::vector<WindowId> m_pending{};
+};
+} // namespace utility
@@ -0,0 +1,254 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <utility/AsyncConfigWriter.hpp>
+#include <utility/ConfigStore.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using namespace std::chrono_literals;
+using Writer = utility::AsyncConfigWriter<std::string>;
+
+void test_due_time() {
+    const Writer::clock::time_point t0{};
+
+    // quiet after one change
+    CHECK(Writer::due_time(t0, t0, 500ms, 2s) == t0 + 500ms);
+    // still changing, but never later than max_delay after the first change
+    CHECK(Writer::due_time(t0, t0 + 1s, 500ms, 2s) == t0 + 1500ms);
+    CHECK(Writer::due_time(t0, t0 + 1900ms, 500ms, 2s) == t0 + 2s);
+}
+
+void test_requests_collapse_into_one_build() {
+    std::atomic<int> builds{0};
+    std::string written{};
+
+    Writer writer{
+        [&](std::string& snapshot) { written = snapshot; },
+        [&]() -> std::optional<std::string> { return "build " + std::to_string(++builds); },
+        50ms, 1s
+    };
+
+    for (int i = 0; i < 100; ++i) {
+        writer.request();
+    }
+
+    // nothing is built on the requesting thread
+    CHECK(builds.load() == 0);
+
+    writer.flush();
+    CHECK(builds.load() == 1);
+    CHECK(written == "build 1");
+    CHECK(writer.get_submitted() == 100);
+    CHECK(writer.get_written() == 1);
+
+    // a submitted snapshot replaces an outstanding request and vice versa
+    writer.request();
+    writer.submit("submitted");
+    writer.flush();
+    CHECK(builds.load() == 1);
+    CHECK(written == "submitted");
+
+    writer.submit("dropped");
+    writer.request();
+    writer.flush();
+    CHECK(builds.load() == 2);
+    CHECK(written == "build 2");
+}
+
+void test_nothing_built_is_nothing_written() {
+    int writes = 0;
+    Writer writer{[&](std::string&) { ++writes; }, [] { return std::optional<std::string>{}; }, 1ms, 10ms};
+
+    writer.request();
+    writer.flush();
+    CHECK(writes == 0);
+    CHECK(writer.get_written() == 0);
+}
+
+void test_destructor_writes_pending() {
+    std::string written{};
+
+    {
+        Writer writer{[&](std::string& snapshot) { written = snapshot; }, {}, 10s, 10s};
+        writer.submit("last");
+    }
+
+    CHECK(written == "last");
+}
+
+void test_commit_file() {
+    const auto dir = std::filesystem::temp_directory_path() / ("vrframework_commit_file_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    std::filesystem::create_directories(dir);
+
+    const auto path = dir / "vr_config.txt";
+    auto temp_path = path;
+    temp_path += ".tmp";
+
+    const auto read = [&] {
+        std::ifstream file{path, std::ios::binary};
+        return std::string{std::istreambuf_iterator<char>{file}, {}};
+    };
+
+    uint64_t last_hash = 0;
+
+    CHECK(utility::commit_file("a=1\n", path, last_hash) == utility::CommitResult::WRITTEN);
+    CHECK(read() == "a=1\n");
+    CHECK(last_hash == utility::fnv1a_64("a=1\n"));
+    CHECK(!std::filesystem::exists(temp_path));
+
+    // unchanged content doesn't touch the file, not even through the temp file
+    const auto time = std::filesystem::last_write_time(path);
+    std::ofstream{temp_path} << "marker";
+    CHECK(utility::commit_file("a=1\n", path, last_hash) == utility::CommitResult::UNCHANGED);
+    CHECK(std::filesystem::last_write_time(path) == time);
+    CHECK(std::filesystem::exists(temp_path));
+    std::filesystem::remove(temp_path);
+
+    // deleted behind our back, written again
+    std::filesystem::remove(path);
+    CHECK(utility::commit_file("a=1\n", path, last_hash) == utility::CommitResult::WRITTEN);
+    CHECK(read() == "a=1\n");
+
+    CHECK(utility::commit_file("a=2\n", path, last_hash) == utility::CommitResult::WRITTEN);
+    CHECK(read() == "a=2\n");
+
+    // the temp file can't be created, the old file stays
+    CHECK(utility::commit_file("a=3\n", dir / "missing" / "vr_config.txt", last_hash) == utility::CommitResult::FAILED);
+    CHECK(last_hash == utility::fnv1a_64("a=2\n"));
+
+    std::filesystem::remove_all(dir);
+}
+
+void bench_unchanged_commit() {
+    const auto dir = std::filesystem::temp_directory_path() / ("vrframework_commit_bench_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    std::filesystem::create_directories(dir);
+
+    std::string content{};
+
+    for (int i = 0; i < 500; ++i) {
+        content += "Option_" + std::to_string(i) + "=" + std::to_string(i * 3) + "\n";
+    }
+
+    uint64_t last_hash = 0;
+    utility::commit_file(content, dir / "vr_config.txt", last_hash);
+
+    size_t unchanged = 0;
+    check::bench("commit_file, unchanged 500 line config", 10'000, [&](size_t) {
+        unchanged += utility::commit_file(content, dir / "vr_config.txt", last_hash) == utility::CommitResult::UNCHANGED ? 1 : 0;
+    });
+
+    CHECK(unchanged == 10'000);
+    std::filesystem::remove_all(dir);
+}
+// Frame thread cost of dragging a slider for 240 frames, 500 options from all mods.
+// Before: every frame built the config (each mod's on_config_save) and wrote it, under the frame lock.
+// After: every frame only requests a save, the writer builds and writes once the drag settles.
+// The writer still builds under the frame lock (Framework::build_config takes m_imgui_mtx), so a frame
+// that lands on a build waits for it; that wait is what `max` shows.
+void bench_slider_drag() {
+    const auto dir = std::filesystem::temp_directory_path() / ("vrframework_drag_bench_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    std::filesystem::create_directories(dir);
+    const auto path = dir / "vr_config.txt";
+
+    std::vector<std::string> names{};
+
+    for (int i = 0; i < 500; ++i) {
+        names.push_back("Mod" + std::to_string(i / 25) + "_Option_" + std::to_string(i));
+    }
+
+    std::mutex frame_mtx{};
+    float slider = 0.0f;
+
+    // what every mod's on_config_save amounts to
+    const auto build = [&] {
+        utility::ConfigStore cfg{};
+
+        for (size_t i = 0; i < names.size(); ++i) {
+            cfg.set(names[i], i == 0 ? slider : (float)i * 0.5f);
+        }
+
+        return cfg;
+    };
+
+    uint64_t last_hash = 0;
+
+    const auto write = [&](utility::ConfigStore& cfg) {
+        std::string text{};
+        cfg.serialize(text);
+        utility::commit_file(text, path, last_hash);
+    };
+
+    constexpr size_t FRAMES = 240;
+
+    const auto drag = [&](const char* name, auto&& on_frame) {
+        double total = 0.0;
+        double max = 0.0;
+
+        for (size_t frame = 0; frame < FRAMES; ++frame) {
+            const auto start = std::chrono::steady_clock::now();
+
+            {
+                std::scoped_lock _{frame_mtx};
+                slider = (float)frame / FRAMES;
+                on_frame();
+            }
+
+            const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            total += elapsed;
+            max = std::max(max, elapsed);
+
+            // the rest of the frame, ~2ms so the writer gets to run mid drag
+            std::this_thread::sleep_for(2ms);
+        }
+
+        std::printf("[bench] %s: %.1f us/frame mean, %.1f us max (%zu frames)\n", name, total / FRAMES, max, FRAMES);
+    };
+
+    drag("slider drag, save_config inline (before)", [&] {
+        auto cfg = build();
+        write(cfg);
+    });
+
+    {
+        utility::AsyncConfigWriter<utility::ConfigStore> writer{
+            write,
+            [&]() -> std::optional<utility::ConfigStore> {
+                std::scoped_lock _{frame_mtx};
+                return build();
+            },
+            20ms, 100ms
+        };
+
+        drag("slider drag, AsyncConfigWriter::request (after)", [&] {
+            writer.request();
+        });
+
+        writer.flush();
+        CHECK(writer.get_written() >= 1 && writer.get_written() < FRAMES / 4);
+    }
+
+    std::filesystem::remove_all(dir);
+}
+} // namespace
+
+int main() {
+    test_due_time();
+    test_requests_collapse_into_one_build();
+    test_nothing_built_is_nothing_written();
+    test_destructor_writes_pending();
+    test_commit_file();
+    bench_unchanged_commit();
+    bench_slider_drag();
+
+    return check::result();
+}
@@ -0,0 +1,156 @@
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <utility/CallbackDispatcher.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using Dispatcher = utility::CallbackDispatcher<int, const float*>;
+
+struct Listener {
+    int calls{0};
+    int sum{0};
+
+    static void on_call(void* user, int value, const float*) {
+        auto self = (Listener*)user;
+        ++self->calls;
+        self->sum += value;
+    }
+};
+
+void test_add_and_dispatch() {
+    Dispatcher dispatcher{};
+    CHECK(dispatcher.empty());
+
+    // nobody listening
+    dispatcher(1, nullptr);
+
+    Listener a{};
+    Listener b{};
+    CHECK(dispatcher.add(&Listener::on_call, &a));
+    CHECK(dispatcher.add(&Listener::on_call, &b));
+
+    // the same listener again is a no-op
+    CHECK(dispatcher.add(&Listener::on_call, &a));
+    CHECK(dispatcher.size() == 2);
+
+    dispatcher(3, nullptr);
+    dispatcher(4, nullptr);
+    CHECK(a.calls == 2 && a.sum == 7);
+    CHECK(b.calls == 2 && b.sum == 7);
+}
+
+void test_full() {
+    Dispatcher dispatcher{};
+    Listener listeners[Dispatcher::MAX_LISTENERS + 1]{};
+
+    for (size_t i = 0; i < Dispatcher::MAX_LISTENERS; ++i) {
+        CHECK(dispatcher.add(&Listener::on_call, &listeners[i]));
+    }
+
+    CHECK(!dispatcher.add(&Listener::on_call, &listeners[Dispatcher::MAX_LISTENERS]));
+    CHECK(dispatcher.size() == Dispatcher::MAX_LISTENERS);
+
+    dispatcher(1, nullptr);
+    CHECK(listeners[0].calls == 1);
+    CHECK(listeners[Dispatcher::MAX_LISTENERS].calls == 0);
+}
+
+// mods attach from their init thread while the render thread already dispatches
+void test_add_while_dispatching() {
+    Dispatcher dispatcher{};
+    std::atomic<bool> done{false};
+    Listener listeners[Dispatcher::MAX_LISTENERS]{};
+
+    std::thread render{[&] {
+        while (!done.load()) {
+            dispatcher(1, nullptr);
+        }
+    }};
+
+    for (auto& listener : listeners) {
+        dispatcher.add(&Listener::on_call, &listener);
+    }
+
+    done = true;
+    render.join();
+
+    // whatever was published was complete, so nothing called a null function
+    CHECK(dispatcher.size() == Dispatcher::MAX_LISTENERS);
+    dispatcher(1, nullptr);
+
+    bool all_called = true;
+
+    for (const auto& listener : listeners) {
+        all_called &= listener.calls >= 1;
+    }
+
+    CHECK(all_called);
+}
+
+// What a hooked OMSetRenderTargets pays before the original runs
+void bench() {
+    Dispatcher empty{};
+    Dispatcher one{};
+    Listener listener{};
+    one.add(&Listener::on_call, &listener);
+
+    const float arg{};
+
+    check::bench("CallbackDispatcher, no listeners", 10'000'000, [&](size_t i) {
+        empty((int)i, &arg);
+    });
+
+    check::bench("CallbackDispatcher, 1 listener", 10'000'000, [&](size_t i) {
+        one((int)(i & 1), &arg);
+    });
+
+    CHECK(listener.calls == 10'000'000);
+
+    // what it replaced: a std::function into a loop over every mod's virtual
+    struct Mod {
+        virtual ~Mod() = default;
+        virtual void on_call(int, const float*) {}
+    };
+
+    struct ListeningMod : Mod {
+        Listener* listener{};
+        void on_call(int value, const float* arg) override { Listener::on_call(listener, value, arg); }
+    };
+
+    std::vector<std::unique_ptr<Mod>> mods{};
+
+    for (int i = 0; i < 7; ++i) {
+        mods.push_back(std::make_unique<Mod>());
+    }
+
+    auto listening = std::make_unique<ListeningMod>();
+    listening->listener = &listener;
+    mods.push_back(std::move(listening));
+
+    std::function<void(int, const float*)> fn = [&](int value, const float* arg) {
+        for (auto& mod : mods) {
+            mod->on_call(value, arg);
+        }
+    };
+
+    check::bench("std::function over 8 mods (before)", 10'000'000, [&](size_t i) {
+        fn((int)(i & 1), &arg);
+    });
+
+    CHECK(listener.calls == 20'000'000);
+}
+} // namespace
+
+int main() {
+    test_add_and_dispatch();
+    test_full();
+    test_add_while_dispatching();
+    bench();
+
+    return check::result();
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+// Just enough of a test framework for the platform-neutral pieces of src/utility and friends.
+// Every test is its own executable, main() calls the cases and returns check::result().
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace check {
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+inline int result() {
+    if (failures() > 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// Runs `fn` `iterations` times and prints the time per iteration, for the benchmark cases.
+template <typename Fn>
+double bench(const char* name, size_t iterations, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < iterations; ++i) {
+        fn(i);
+    }
+
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    const auto per_iteration = elapsed / (double)(iterations > 0 ? iterations : 1);
+
+    std::printf("[bench] %s: %.1f ns/iter (%zu iterations)\n", name, per_iteration, iterations);
+    return per_iteration;
+}
+} // namespace check
+
+#define CHECK(expr)                                                                     \
+    do {                                                                                \
+        if (!(expr)) {                                                                  \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr); \
+            ++check::failures();                                                        \
+        }                                                                               \
+    } while (0)
+
+#define CHECK_NEAR(a, b, eps)                                                                              \
+    do {                                                                                                   \
+        const double check_a_ = (double)(a);                                                               \
+        const double check_b_ = (double)(b);                                                               \
+        if (!(check_a_ - check_b_ <= (eps) && check_b_ - check_a_ <= (eps))) {                             \
+            std::fprintf(stderr, "%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g\n", __FILE__, __LINE__, #a, #b, \
+                         check_a_, check_b_);                                                              \
+            ++check::failures();                                                                           \
+        }                                                                                                  \
+    } while (0)
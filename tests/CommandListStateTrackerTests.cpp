@@ -0,0 +1,303 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <utility/CommandListStateTracker.hpp>
+
+#include "Check.hpp"
+
+namespace {
+// Same layout as the D3D12 types the hook instantiates it with
+struct Handle {
+    size_t ptr{};
+};
+
+struct Viewport {
+    float x{}, y{}, width{}, height{}, min_depth{}, max_depth{};
+};
+
+struct Rect {
+    long left{}, top{}, right{}, bottom{};
+};
+
+using Tracker = utility::CommandListStateTracker<Handle, Viewport, Rect, 64>;
+using ShadingRate = Tracker::ShadingRate;
+
+constexpr ShadingRate VRS_RATE{0, {2, 2}};
+
+// Command list objects, 16 byte aligned like COM objects
+const void* list(uintptr_t i) {
+    return (const void*)(0x10000 + i * 0x40);
+}
+
+void test_render_targets() {
+    Tracker tracker{};
+    const auto cmd = list(0);
+
+    const Handle rts[] = {{0x100}, {0x200}};
+    const Handle other[] = {{0x100}, {0x300}};
+    const Handle dsv{0x900};
+    const Handle other_dsv{0xA00};
+
+    CHECK(tracker.set_render_targets(cmd, 2, rts, false, &dsv));
+    CHECK(!tracker.set_render_targets(cmd, 2, rts, false, &dsv));
+    CHECK(tracker.set_render_targets(cmd, 2, other, false, &dsv));
+    CHECK(tracker.set_render_targets(cmd, 1, other, false, &dsv));
+
+    // same render targets with another depth buffer, or none, is a change too
+    CHECK(tracker.set_render_targets(cmd, 1, other, false, &other_dsv));
+    CHECK(!tracker.set_render_targets(cmd, 1, other, false, &other_dsv));
+    CHECK(tracker.set_render_targets(cmd, 1, other, false, nullptr));
+    CHECK(!tracker.set_render_targets(cmd, 1, other, false, nullptr));
+
+    // a single handle range only compares its start
+    CHECK(tracker.set_render_targets(cmd, 2, rts, true, nullptr));
+    CHECK(!tracker.set_render_targets(cmd, 2, rts, true, nullptr));
+
+    // depth only
+    CHECK(tracker.set_render_targets(cmd, 0, nullptr, false, &dsv));
+    CHECK(!tracker.set_render_targets(cmd, 0, nullptr, false, &dsv));
+
+    tracker.release(cmd);
+    const auto stats = tracker.get_stats();
+    CHECK(stats.render_targets.calls == 12);
+    CHECK(stats.render_targets.redundant == 5);
+}
+
+void test_viewports_and_rects() {
+    Tracker tracker{};
+    const auto cmd = list(0);
+
+    const Viewport full{0, 0, 1920, 1080, 0, 1};
+    const Viewport half{0, 0, 960, 1080, 0, 1};
+    const Rect rect{0, 0, 1920, 1080};
+
+    CHECK(tracker.set_viewports(cmd, 1, &full));
+    CHECK(!tracker.set_viewports(cmd, 1, &full));
+    CHECK(tracker.set_viewports(cmd, 1, &half));
+    CHECK(tracker.set_scissor_rects(cmd, 1, &rect));
+    CHECK(!tracker.set_scissor_rects(cmd, 1, &rect));
+
+    // lists don't share state
+    CHECK(tracker.set_viewports(list(1), 1, &half));
+}
+
+void test_release() {
+    Tracker tracker{};
+    const auto cmd = list(0);
+    const Handle rt{0x100};
+
+    // Close, Reset, ClearState, or a new list created at the address of one that was freed while recording
+    CHECK(tracker.set_render_targets(cmd, 1, &rt, false, nullptr));
+    tracker.release(cmd);
+    CHECK(tracker.set_render_targets(cmd, 1, &rt, false, nullptr));
+    CHECK(!tracker.set_render_targets(cmd, 1, &rt, false, nullptr));
+
+    // releasing what was never tracked is fine
+    tracker.release(list(7));
+    tracker.release(nullptr);
+
+    // the hooks were reinstalled, calls in between weren't seen
+    tracker.invalidate();
+    CHECK(tracker.set_render_targets(cmd, 1, &rt, false, nullptr));
+    CHECK(!tracker.set_render_targets(cmd, 1, &rt, false, nullptr));
+    CHECK(tracker.get_stats().render_targets.calls == 3);
+
+    tracker.release(cmd);
+    CHECK(tracker.get_stats().render_targets.calls == 5);
+}
+
+// hooks are reinstalled while game threads keep recording, no list may see another one's state
+void test_invalidate_while_recording() {
+    Tracker tracker{};
+    constexpr size_t THREADS = 4;
+    constexpr size_t CALLS = 200'000;
+
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> wrong{0};
+    std::vector<std::thread> threads{};
+
+    for (size_t t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            // every call binds something else than the one before, none of them is redundant.
+            // Half the threads are out of phase, a list seeing another one's state would find its own next bind there.
+            const Handle rts[] = {{0x1000}, {0x2000}};
+            const auto cmd = list(t);
+
+            for (size_t i = 0; i < CALLS; ++i) {
+                wrong += tracker.set_render_targets(cmd, 1, &rts[(i + t) & 1], false, nullptr) ? 0 : 1;
+
+                if (i % 1000 == 999) {
+                    tracker.release(cmd);
+                }
+            }
+
+            tracker.release(cmd);
+        });
+    }
+
+    std::thread hook{[&] {
+        while (!done.load()) {
+            tracker.invalidate();
+            std::this_thread::yield();
+        }
+    }};
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    done = true;
+    hook.join();
+
+    CHECK(wrong.load() == 0);
+    CHECK(tracker.get_stats().render_targets.calls == THREADS * CALLS);
+    CHECK(tracker.get_stats().render_targets.redundant == 0);
+}
+
+void test_shading_rate_needs_observing() {
+    Tracker tracker{};
+    const auto cmd = list(0);
+    const auto image = (const void*)0x5000;
+
+    // the game's own calls aren't hooked: nothing is skipped
+    CHECK(tracker.set_shading_rate(cmd, VRS_RATE, image));
+    CHECK(tracker.set_shading_rate(cmd, VRS_RATE, image));
+
+    tracker.set_observing_shading_rate(true);
+    CHECK(!tracker.set_shading_rate(cmd, VRS_RATE, image));
+    CHECK(tracker.set_shading_rate(cmd, VRS_RATE, nullptr));
+    CHECK(!tracker.set_shading_rate(cmd, VRS_RATE, nullptr));
+
+    // the game binds its own image, or just its own rate, in between
+    tracker.observe_shading_rate_image(cmd, (const void*)0x6000);
+    CHECK(tracker.set_shading_rate(cmd, VRS_RATE, nullptr));
+    tracker.observe_shading_rate(cmd, ShadingRate{});
+    CHECK(tracker.set_shading_rate(cmd, VRS_RATE, nullptr));
+
+    // and the same thing we bound, observed through the hook, changes nothing
+    tracker.observe_shading_rate(cmd, VRS_RATE);
+    tracker.observe_shading_rate_image(cmd, nullptr);
+    CHECK(!tracker.set_shading_rate(cmd, VRS_RATE, nullptr));
+
+    // an unknown rate on a list that only saw an image
+    const auto fresh = list(1);
+    tracker.observe_shading_rate_image(fresh, image);
+    CHECK(tracker.set_shading_rate(fresh, VRS_RATE, image));
+
+    tracker.release(cmd);
+    tracker.release(fresh);
+    const auto stats = tracker.get_stats();
+    CHECK(stats.shading_rate.calls == 9);
+    CHECK(stats.shading_rate.redundant == 3);
+}
+
+// A recorded frame: a few lists, render passes that rebind the same targets, the game's shading rate calls
+// and VRS binding its image on every render target change
+void test_stream() {
+    Tracker tracker{};
+    tracker.set_observing_shading_rate(true);
+
+    const auto image = (const void*)0x5000;
+    uint64_t listener_calls = 0;
+    uint64_t vrs_binds = 0;
+
+    for (uint32_t frame = 0; frame < 3; ++frame) {
+        for (uintptr_t l = 0; l < 4; ++l) {
+            const auto cmd = list(l);
+            tracker.release(cmd); // Reset
+
+            for (size_t pass = 0; pass < 8; ++pass) {
+                const Handle rt{0x1000 + (pass / 2) * 0x10};
+                const Handle dsv{0x9000 + (pass % 2) * 0x10};
+
+                // every draw rebinds the pass targets
+                for (int draw = 0; draw < 10; ++draw) {
+                    if (tracker.set_render_targets(cmd, 1, &rt, false, &dsv)) {
+                        ++listener_calls;
+
+                        if (tracker.set_shading_rate(cmd, VRS_RATE, image)) {
+                            ++vrs_binds;
+                            tracker.observe_shading_rate(cmd, VRS_RATE);
+                            tracker.observe_shading_rate_image(cmd, image);
+                        }
+                    }
+                }
+
+                // the game turns VRS off for its UI pass
+                if (pass == 6) {
+                    tracker.observe_shading_rate_image(cmd, nullptr);
+                }
+            }
+
+            tracker.release(cmd); // Close
+        }
+    }
+
+    // one listener call per pass, VRS binds once per recording and again after the game's own bind
+    CHECK(listener_calls == 3 * 4 * 8);
+    CHECK(vrs_binds == 3 * 4 * 2);
+
+    const auto stats = tracker.get_stats();
+    CHECK(stats.render_targets.calls == 3 * 4 * 8 * 10);
+    CHECK(stats.render_targets.redundant == 3 * 4 * 8 * 9);
+    CHECK(stats.untracked == 0);
+}
+
+void test_table_full() {
+    Tracker tracker{};
+    const Handle rt{0x100};
+
+    size_t untracked = 0;
+
+    for (uintptr_t i = 0; i < 128; ++i) {
+        tracker.set_render_targets(list(i), 1, &rt, false, nullptr);
+    }
+
+    // untracked lists report every call as a change
+    for (uintptr_t i = 0; i < 128; ++i) {
+        untracked += tracker.set_render_targets(list(i), 1, &rt, false, nullptr) ? 1 : 0;
+    }
+
+    CHECK(untracked >= 64);
+    CHECK(tracker.get_stats().untracked == untracked * 2);
+}
+
+void bench() {
+    Tracker tracker{};
+    tracker.set_observing_shading_rate(true);
+
+    std::vector<Handle> rts(64);
+
+    for (size_t i = 0; i < rts.size(); ++i) {
+        rts[i].ptr = 0x1000 + i * 0x10;
+    }
+
+    const Handle dsv{0x9000};
+    uint64_t changes = 0;
+
+    check::bench("set_render_targets, 8 lists, 1 change in 8", 1'000'000, [&](size_t i) {
+        changes += tracker.set_render_targets(list(i & 7), 1, &rts[(i >> 6) & 63], false, &dsv) ? 1 : 0;
+    });
+
+    check::bench("set_shading_rate, 8 lists", 1'000'000, [&](size_t i) {
+        changes += tracker.set_shading_rate(list(i & 7), VRS_RATE, (const void*)(uintptr_t)((i >> 6) & 1)) ? 1 : 0;
+    });
+
+    CHECK(changes > 0);
+}
+} // namespace
+
+int main() {
+    test_render_targets();
+    test_viewports_and_rects();
+    test_release();
+    test_invalidate_while_recording();
+    test_shading_rate_needs_observing();
+    test_stream();
+    test_table_full();
+    bench();
+
+    return check::result();
+}
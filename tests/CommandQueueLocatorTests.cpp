@@ -0,0 +1,193 @@
+#include <cstdint>
+#include <map>
+#include <optional>
+
+#include <utility/CommandQueueLocator.hpp>
+
+#include "Check.hpp"
+
+namespace {
+
+constexpr uintptr_t PTR = sizeof(void*);
+
+// A fake address space: every object is a run of pointer slots, anything not mapped can't be read.
+// Objects are laid out far apart so scans run off their end instead of into the next one.
+struct Memory {
+    std::map<uintptr_t, uintptr_t> slots{};
+    uint64_t reads{0};
+
+    uintptr_t object(uintptr_t base, uint32_t num_slots) {
+        for (uint32_t i = 0; i < num_slots; ++i) {
+            slots[base + i * PTR] = 0;
+        }
+
+        return base;
+    }
+
+    void set(uintptr_t address, uintptr_t value) {
+        slots[address] = value;
+    }
+
+    void unmap(uintptr_t base) {
+        slots.erase(slots.lower_bound(base), slots.lower_bound(base + 0x10000));
+    }
+
+    auto reader() {
+        return [this](uintptr_t address) -> std::optional<uintptr_t> {
+            ++reads;
+
+            if (const auto it = slots.find(address); it != slots.end()) {
+                return it->second;
+            }
+
+            return std::nullopt;
+        };
+    }
+};
+
+// vtable first, like every COM object
+uintptr_t make_queue(Memory& memory, uintptr_t base) {
+    const auto vtable = memory.object(base + 0x8000, 4);
+    memory.object(base, 4);
+    memory.set(base, vtable);
+    return base;
+}
+
+void test_direct_layout() {
+    Memory memory{};
+    const auto queue = make_queue(memory, 0x100000);
+    const auto swap_chain = memory.object(0x200000, 32);
+    memory.set(swap_chain + 0x48, queue);
+
+    const auto layout = utility::find_command_queue_layout(swap_chain, queue, memory.reader());
+    CHECK(layout.has_value());
+    CHECK(layout && layout->queue_offset == 0x48 && !layout->proton_offset);
+
+    // the game's swapchain has the same layout, with its own queue
+    const auto game_queue = make_queue(memory, 0x300000);
+    const auto game_swap_chain = memory.object(0x400000, 32);
+    memory.set(game_swap_chain + 0x48, game_queue);
+
+    CHECK(utility::resolve_command_queue(game_swap_chain, *layout, memory.reader()) == game_queue);
+    CHECK(!utility::wrapped_swap_chain(game_swap_chain, *layout, memory.reader()).has_value());
+
+    // what's found there has to be a readable object, e.g. not a queue the game released
+    memory.unmap(game_queue);
+    CHECK(!utility::resolve_command_queue(game_swap_chain, *layout, memory.reader()).has_value());
+
+    // and nothing is read past a freed swapchain
+    memory.unmap(game_swap_chain);
+    CHECK(!utility::resolve_command_queue(game_swap_chain, *layout, memory.reader()).has_value());
+}
+
+void test_offset_zero_is_not_a_match() {
+    Memory memory{};
+    const auto queue = make_queue(memory, 0x100000);
+
+    // the queue at slot 0 is the vtable slot of the swapchain, never the queue member
+    const auto swap_chain = memory.object(0x200000, 8);
+    memory.set(swap_chain, queue);
+    CHECK(!utility::find_command_queue_layout(swap_chain, queue, memory.reader()).has_value());
+
+    // not there at all, the scan stops at the end of what's readable
+    const auto other = memory.object(0x300000, 8);
+    memory.reads = 0;
+    CHECK(!utility::find_command_queue_layout(other, queue, memory.reader()).has_value());
+    CHECK(memory.reads < 32);
+}
+
+// Proton's swapchain points at the real one, which holds the queue
+struct ProtonGraph {
+    Memory memory{};
+    uintptr_t queue{};
+    uintptr_t outer{};
+    uintptr_t inner{};
+
+    ProtonGraph() {
+        queue = make_queue(memory, 0x100000);
+        inner = memory.object(0x200000, 32);
+        outer = memory.object(0x300000, 32);
+        memory.set(inner + 0x30, queue);
+        memory.set(outer + 0x18, inner);
+    }
+};
+
+void test_proton_layout() {
+    ProtonGraph graph{};
+    auto& memory = graph.memory;
+
+    const auto layout = utility::find_command_queue_layout(graph.outer, graph.queue, memory.reader());
+    CHECK(layout.has_value());
+    CHECK(layout && layout->queue_offset == 0x30 && layout->proton_offset == 0x18u);
+    CHECK(utility::resolve_command_queue(graph.outer, *layout, memory.reader()) == graph.queue);
+    CHECK(utility::wrapped_swap_chain(graph.outer, *layout, memory.reader()) == graph.inner);
+
+    // wrapped again under the same outer swapchain (alt tab): the wrapped object tells, the queue is resolved anew
+    const auto new_queue = make_queue(memory, 0x500000);
+    const auto new_inner = memory.object(0x600000, 32);
+    memory.set(new_inner + 0x30, new_queue);
+    memory.set(graph.outer + 0x18, new_inner);
+    memory.unmap(graph.inner);
+
+    CHECK(utility::wrapped_swap_chain(graph.outer, *layout, memory.reader()) == new_inner);
+    CHECK(utility::resolve_command_queue(graph.outer, *layout, memory.reader()) == new_queue);
+
+    // wrapper gone
+    memory.set(graph.outer + 0x18, 0);
+    CHECK(!utility::wrapped_swap_chain(graph.outer, *layout, memory.reader()).has_value());
+    CHECK(!utility::resolve_command_queue(graph.outer, *layout, memory.reader()).has_value());
+}
+
+void test_proton_double_wrap() {
+    ProtonGraph graph{};
+    auto& memory = graph.memory;
+    const auto layout = *utility::find_command_queue_layout(graph.outer, graph.queue, memory.reader());
+
+    // one more wrapper in between, the queue slot of the middle one holds something that isn't a queue
+    const auto middle = memory.object(0x700000, 32);
+    memory.set(middle + 0x18, graph.inner);
+    memory.set(middle + 0x30, 0x12345678);
+    memory.set(graph.outer + 0x18, middle);
+
+    CHECK(utility::resolve_command_queue(graph.outer, layout, memory.reader()) == graph.queue);
+
+    // but not any deeper than that
+    const auto outermost = memory.object(0x800000, 32);
+    memory.set(outermost + 0x18, graph.outer);
+    CHECK(!utility::resolve_command_queue(outermost, layout, memory.reader()).has_value());
+}
+
+void bench() {
+    ProtonGraph graph{};
+    auto& memory = graph.memory;
+    const auto layout = *utility::find_command_queue_layout(graph.outer, graph.queue, memory.reader());
+
+    // what a present costs when the queue is cached: the wrapped object check
+    uint64_t matches = 0;
+    check::bench("wrapped_swap_chain, cached queue check", 1'000'000, [&](size_t) {
+        matches += utility::wrapped_swap_chain(graph.outer, layout, memory.reader()) == graph.inner ? 1 : 0;
+    });
+
+    check::bench("resolve_command_queue, Proton layout", 1'000'000, [&](size_t) {
+        matches += utility::resolve_command_queue(graph.outer, layout, memory.reader()) == graph.queue ? 1 : 0;
+    });
+
+    CHECK(matches == 2'000'000);
+
+    check::bench("find_command_queue_layout, Proton layout", 1'000, [&](size_t) {
+        matches += utility::find_command_queue_layout(graph.outer, graph.queue, memory.reader()).has_value() ? 1 : 0;
+    });
+
+    CHECK(matches == 2'001'000);
+}
+} // namespace
+
+int main() {
+    test_direct_layout();
+    test_offset_zero_is_not_a_match();
+    test_proton_layout();
+    test_proton_double_wrap();
+    bench();
+
+    return check::result();
+}
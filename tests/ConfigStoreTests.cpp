@@ -0,0 +1,185 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <utility/ConfigStore.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using utility::ConfigStore;
+
+enum class Mode : int {
+    OFF,
+    LEFT,
+    RIGHT,
+};
+
+void test_set_and_get() {
+    ConfigStore cfg{};
+
+    cfg.set("VR_Enabled", true);
+    cfg.set("VR_Scale", 0.75f);
+    cfg.set("VR_Mode", Mode::RIGHT);
+    cfg.set("VR_Name", "Left Eye");
+    cfg.set("VR_Count", -42);
+
+    CHECK(cfg.size() == 5);
+    CHECK(cfg.get<bool>("VR_Enabled") == true);
+    CHECK(cfg.get<float>("VR_Scale") == 0.75f);
+    CHECK(cfg.get<Mode>("VR_Mode") == Mode::RIGHT);
+    CHECK(cfg.get("VR_Name") == std::string{"Left Eye"});
+    CHECK(cfg.get<int>("VR_Count") == -42);
+    CHECK(cfg.get_text("VR_Enabled") == std::string_view{"1"});
+
+    CHECK(!cfg.contains("missing"));
+    CHECK(!cfg.get<int>("missing").has_value());
+    CHECK(!cfg.get<int>("VR_Name").has_value());
+
+    // precomputed keys find the same entries
+    constexpr utility::ConfigKey key{"VR_Scale"};
+    CHECK(cfg.get<float>(key) == 0.75f);
+}
+
+void test_overwrite() {
+    ConfigStore cfg{};
+
+    cfg.set("a", 1);
+    cfg.set("b", 2);
+    cfg.set("a", 1000);
+    cfg.set("a", std::string(100, 'x'));
+    cfg.set("b", 3);
+
+    CHECK(cfg.size() == 2);
+    CHECK(cfg.get("a") == std::string(100, 'x'));
+    CHECK(cfg.get<int>("b") == 3);
+
+    // a value taken from the store itself, which can move when the store grows
+    cfg.set("c", *cfg.get_text("a"));
+    CHECK(cfg.get("c") == std::string(100, 'x'));
+}
+
+void test_serialize_round_trip() {
+    ConfigStore cfg{};
+    cfg.set("VR_Enabled", false);
+    cfg.set("VR_Scale", 1.5);
+    cfg.set("VR_Name", "some text");
+
+    std::string text{};
+    cfg.serialize(text);
+    CHECK(text == "#version=2\nVR_Enabled=0\nVR_Scale=1.5\nVR_Name=some text\n");
+
+    ConfigStore parsed{};
+    parsed.parse(text);
+    CHECK(parsed.get_version() == ConfigStore::CURRENT_VERSION);
+    CHECK(parsed.size() == 3);
+    CHECK(parsed.get<bool>("VR_Enabled") == false);
+    CHECK(parsed.get<double>("VR_Scale") == 1.5);
+    CHECK(parsed.get("VR_Name") == std::string{"some text"});
+
+    std::string again{};
+    parsed.serialize(again);
+    CHECK(again == text);
+}
+
+void test_legacy_files() {
+    ConfigStore cfg{};
+    cfg.parse("VR_Enabled=true\r\n  VR_Scale = 0.500000 \nVR_Width=1920.000000\nVR_Off=false\nbroken line\n\n=no name\nVR_Plus=+3\n");
+
+    CHECK(cfg.get_version() == ConfigStore::LEGACY_VERSION);
+    CHECK(cfg.get<bool>("VR_Enabled") == true);
+    CHECK(cfg.get<bool>("VR_Off") == false);
+    CHECK(cfg.get<float>("VR_Scale") == 0.5f);
+    CHECK(cfg.get<int>("VR_Width") == 1920);
+    CHECK(cfg.get<int>("VR_Plus") == 3);
+    CHECK(cfg.size() == 5);
+
+    // later lines win
+    cfg.parse("VR_Scale=2\n");
+    CHECK(cfg.get<float>("VR_Scale") == 2.0f);
+}
+
+void test_unknown_keys_survive() {
+    ConfigStore cfg{};
+    cfg.parse("#version=2\nFromNewerBuild=7\nVR_Scale=1\n");
+
+    // what a save does: start from the loaded config, let the known options write theirs
+    cfg.set("VR_Scale", 0.5f);
+
+    std::string text{};
+    cfg.serialize(text);
+    CHECK(text == "#version=2\nFromNewerBuild=7\nVR_Scale=0.5\n");
+}
+
+void test_load_and_save() {
+    const auto path = std::filesystem::temp_directory_path() / ("vrframework_config_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".txt");
+
+    ConfigStore cfg{};
+    cfg.set("VR_Scale", 0.25f);
+    CHECK(cfg.save(path));
+
+    ConfigStore loaded{path};
+    CHECK(loaded.get<float>("VR_Scale") == 0.25f);
+
+    std::filesystem::remove(path);
+    CHECK(!ConfigStore{}.load(path));
+}
+
+void test_format_and_parse_value() {
+    char buf[64]{};
+    CHECK(ConfigStore::format_value(buf, sizeof(buf), true) == "1");
+    CHECK(ConfigStore::format_value(buf, sizeof(buf), 0.1f) == "0.1");
+    CHECK(ConfigStore::format_value(buf, sizeof(buf), Mode::LEFT) == "1");
+    CHECK(ConfigStore::format_value(buf, 2, 12345).empty());
+
+    CHECK(ConfigStore::parse_value<bool>("yes") == std::nullopt);
+    CHECK(ConfigStore::parse_value<int>("") == std::nullopt);
+    CHECK(ConfigStore::parse_value<uint8_t>("300") == std::nullopt);
+    CHECK(ConfigStore::parse_value<float>("-1e3") == -1000.0f);
+}
+
+void bench() {
+    ConfigStore cfg{};
+    std::string names[256]{};
+
+    for (int i = 0; i < 256; ++i) {
+        names[i] = "Option_" + std::to_string(i);
+        cfg.set(names[i], i * 0.5f);
+    }
+
+    float sum = 0.0f;
+    check::bench("ConfigStore::set + get, 256 options", 1'000'000, [&](size_t i) {
+        const auto& name = names[i & 255];
+        cfg.set(name, (float)i);
+        sum += *cfg.get<float>(name);
+    });
+
+    CHECK(sum > 0.0f);
+
+    std::string text{};
+    check::bench("ConfigStore::serialize, 256 options", 10'000, [&](size_t) {
+        cfg.serialize(text);
+    });
+
+    check::bench("ConfigStore::parse, 256 options", 10'000, [&](size_t) {
+        ConfigStore parsed{};
+        parsed.parse(text);
+    });
+
+    CHECK(!text.empty());
+}
+} // namespace
+
+int main() {
+    test_set_and_get();
+    test_overwrite();
+    test_serialize_round_trip();
+    test_legacy_files();
+    test_unknown_keys_survive();
+    test_load_and_save();
+    test_format_and_parse_value();
+    bench();
+
+    return check::result();
+}
@@ -0,0 +1,133 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <utility/ConfigWatcher.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using namespace std::chrono_literals;
+using utility::ChangeDebouncer;
+using utility::FileStamp;
+
+const auto T0 = ChangeDebouncer::clock::time_point{} + 1000s;
+
+FileStamp stamp(uintmax_t size, int time) {
+    return FileStamp{true, size, std::filesystem::file_time_type{std::chrono::seconds(time)}};
+}
+
+void test_debouncer() {
+    ChangeDebouncer debouncer{300ms};
+    debouncer.reset(stamp(10, 1));
+
+    // the baseline isn't a change
+    CHECK(!debouncer.observe(stamp(10, 1), T0));
+    CHECK(!debouncer.is_pending());
+
+    // an editor writing in several steps
+    CHECK(!debouncer.observe(stamp(0, 2), T0 + 10ms));
+    CHECK(debouncer.is_pending());
+    CHECK(!debouncer.observe(stamp(20, 3), T0 + 100ms));
+    CHECK(!debouncer.observe(stamp(20, 3), T0 + 350ms));
+    CHECK(debouncer.observe(stamp(20, 3), T0 + 400ms));
+
+    // reported once
+    CHECK(!debouncer.observe(stamp(20, 3), T0 + 800ms));
+    CHECK(!debouncer.is_pending());
+
+    // changed and changed back before it settled
+    CHECK(!debouncer.observe(stamp(30, 4), T0 + 1s));
+    CHECK(!debouncer.observe(stamp(20, 3), T0 + 1100ms));
+    CHECK(!debouncer.is_pending());
+    CHECK(!debouncer.observe(stamp(20, 3), T0 + 2s));
+
+    // deleted
+    CHECK(!debouncer.observe(FileStamp{}, T0 + 3s));
+    CHECK(!debouncer.observe(FileStamp{}, T0 + 4s));
+    CHECK(!debouncer.is_pending());
+
+    // and recreated
+    CHECK(!debouncer.observe(stamp(5, 9), T0 + 5s));
+    CHECK(debouncer.observe(stamp(5, 9), T0 + 6s));
+}
+
+void test_file_stamp() {
+    const auto path = std::filesystem::temp_directory_path() / ("vrframework_stamp_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".txt");
+
+    CHECK(!FileStamp::of(path).exists);
+
+    std::ofstream{path} << "a=1\n";
+    const auto written = FileStamp::of(path);
+    CHECK(written.exists);
+    CHECK(written.size == 4);
+    CHECK(written == FileStamp::of(path));
+
+    std::filesystem::remove(path);
+}
+
+template <typename Fn>
+bool wait_for(Fn&& fn, std::chrono::milliseconds timeout = 2s) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while (!fn()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+
+        std::this_thread::sleep_for(2ms);
+    }
+
+    return true;
+}
+
+void test_watcher() {
+    const auto dir = std::filesystem::temp_directory_path() / ("vrframework_watcher_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    std::filesystem::create_directories(dir);
+    const auto path = dir / "vr_config.txt";
+
+    uint64_t last_hash = 0;
+    utility::commit_file("VR_Scale=1\n", path, last_hash);
+
+    utility::ConfigWatcher watcher{path, 5ms, 20ms};
+    watcher.note_written(last_hash);
+
+    // edited by hand
+    std::ofstream{path, std::ios::trunc} << "VR_Scale=0.5\nOther=2\n";
+
+    std::optional<utility::ConfigStore> cfg{};
+    CHECK(wait_for([&] { return (cfg = watcher.take()).has_value(); }));
+    CHECK(cfg && cfg->get<float>("VR_Scale") == 0.5f);
+    CHECK(cfg && cfg->get<int>("Other") == 2);
+    CHECK(watcher.get_reloads() == 1);
+    CHECK(!watcher.take().has_value());
+
+    // our own save doesn't come back as an edit, also not with a different write time
+    std::this_thread::sleep_for(30ms);
+
+    if (utility::commit_file("VR_Scale=0.25\n", path, last_hash) == utility::CommitResult::WRITTEN) {
+        watcher.note_written(last_hash);
+    }
+
+    std::this_thread::sleep_for(200ms);
+    CHECK(!watcher.take().has_value());
+    CHECK(watcher.get_reloads() == 1);
+
+    // same content written again by hand
+    std::ofstream{path, std::ios::trunc} << "VR_Scale=0.25\n\n";
+    CHECK(wait_for([&] { return watcher.get_reloads() == 2; }));
+    CHECK(watcher.take().has_value());
+
+    std::filesystem::remove_all(dir);
+}
+} // namespace
+
+int main() {
+    test_debouncer();
+    test_file_stamp();
+    test_watcher();
+
+    return check::result();
+}
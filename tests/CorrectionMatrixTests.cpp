@@ -0,0 +1,305 @@
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#include <aer/CorrectionMatrix.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using DirectX::XMFLOAT4X4;
+
+// Scalar transcription of the sl_matrix_helpers.h functions get_correction_matrix used before,
+// row vector convention like sl's float4x4
+namespace sl_reference {
+struct float4x4 {
+    float m[4][4]{};
+};
+
+void normalize3(float* v) {
+    const auto len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    v[0] /= len;
+    v[1] /= len;
+    v[2] /= len;
+}
+
+float4x4 rebuildOrthogonalLHRotationMatrix(const float4x4& view) {
+    float right[3]{view.m[0][0], view.m[0][1], view.m[0][2]};
+    float fwd[3]{view.m[2][0], view.m[2][1], view.m[2][2]};
+    normalize3(right);
+    normalize3(fwd);
+
+    float up[3]{fwd[1] * right[2] - fwd[2] * right[1], fwd[2] * right[0] - fwd[0] * right[2], fwd[0] * right[1] - fwd[1] * right[0]};
+    normalize3(up);
+
+    return float4x4{{
+        {right[0], right[1], right[2], 0.0f},
+        {up[0], up[1], up[2], 0.0f},
+        {fwd[0], fwd[1], fwd[2], 0.0f},
+        {view.m[3][0], view.m[3][1], view.m[3][2], 1.0f},
+    }};
+}
+
+void matrixMul(float4x4& out, const float4x4& a, const float4x4& b) {
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            out.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] + a.m[i][2] * b.m[2][j] + a.m[i][3] * b.m[3][j];
+        }
+    }
+}
+
+// Gauss-Jordan with partial pivoting
+void matrixFullInvert(float4x4& out, const float4x4& in) {
+    double a[4][8]{};
+
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            a[r][c] = in.m[r][c];
+        }
+
+        a[r][r + 4] = 1.0;
+    }
+
+    for (int c = 0; c < 4; ++c) {
+        int pivot = c;
+
+        for (int r = c + 1; r < 4; ++r) {
+            if (std::fabs(a[r][c]) > std::fabs(a[pivot][c])) {
+                pivot = r;
+            }
+        }
+
+        for (int k = 0; k < 8; ++k) {
+            std::swap(a[c][k], a[pivot][k]);
+        }
+
+        const auto d = a[c][c];
+
+        for (int k = 0; k < 8; ++k) {
+            a[c][k] /= d;
+        }
+
+        for (int r = 0; r < 4; ++r) {
+            if (r != c) {
+                const auto f = a[r][c];
+
+                for (int k = 0; k < 8; ++k) {
+                    a[r][k] -= f * a[c][k];
+                }
+            }
+        }
+    }
+
+    for (int r = 0; r < 4; ++r) {
+        for (int c = 0; c < 4; ++c) {
+            out.m[r][c] = (float)a[r][c + 4];
+        }
+    }
+}
+
+// Translation relative to the current camera, then a full inverse of the previous camera
+void calcCameraToPrevCamera(float4x4& out, const float4x4& view_to_world, const float4x4& view_to_world_prev) {
+    auto relative = view_to_world;
+    relative.m[3][0] = relative.m[3][1] = relative.m[3][2] = 0.0f;
+
+    auto relative_prev = view_to_world_prev;
+
+    for (int i = 0; i < 3; ++i) {
+        relative_prev.m[3][i] = view_to_world_prev.m[3][i] - view_to_world.m[3][i];
+    }
+
+    float4x4 world_to_prev{};
+    matrixFullInvert(world_to_prev, relative_prev);
+    matrixMul(out, relative, world_to_prev);
+}
+
+float4x4 get_correction_matrix(const float4x4& projection, const float4x4& view, const float4x4& projection_prev, const float4x4& view_prev) {
+    float4x4 clip_to_camera{};
+    matrixFullInvert(clip_to_camera, projection);
+
+    float4x4 camera_to_prev{};
+    calcCameraToPrevCamera(camera_to_prev, rebuildOrthogonalLHRotationMatrix(view), rebuildOrthogonalLHRotationMatrix(view_prev));
+
+    float4x4 clip_to_prev_camera{};
+    matrixMul(clip_to_prev_camera, clip_to_camera, camera_to_prev);
+
+    float4x4 out{};
+    matrixMul(out, clip_to_prev_camera, projection_prev);
+    return out;
+}
+} // namespace sl_reference
+
+struct Frame {
+    XMFLOAT4X4 projection{};
+    XMFLOAT4X4 view{};
+};
+
+// LH perspective, reversed depth like most games using DLSS
+XMFLOAT4X4 perspective(float fov_y, float aspect, float near_z) {
+    const auto y = 1.0f / std::tan(fov_y * 0.5f);
+
+    XMFLOAT4X4 out{};
+    out.m[0][0] = y / aspect;
+    out.m[1][1] = y;
+    out.m[2][3] = 1.0f;
+    out.m[3][2] = near_z;
+    return out;
+}
+
+// Camera to world of a camera at `position` looking along yaw/pitch/roll, rows right, up, forward,
+// slightly off orthonormal like a game's matrices after a few frames of float math
+XMFLOAT4X4 camera(float yaw, float pitch, float roll, const float (&position)[3], float noise) {
+    const auto cy = std::cos(yaw), sy = std::sin(yaw);
+    const auto cp = std::cos(pitch), sp = std::sin(pitch);
+    const auto cr = std::cos(roll), sr = std::sin(roll);
+
+    const float fwd[3]{sy * cp, -sp, cy * cp};
+    const float right0[3]{cy, 0.0f, -sy};
+    const float up0[3]{sy * sp, cp, cy * sp};
+
+    XMFLOAT4X4 out{};
+
+    for (int i = 0; i < 3; ++i) {
+        out.m[0][i] = (cr * right0[i] + sr * up0[i]) * (1.0f + noise);
+        out.m[1][i] = -sr * right0[i] + cr * up0[i];
+        out.m[2][i] = fwd[i] * (1.0f - noise);
+        out.m[3][i] = position[i];
+    }
+
+    out.m[3][3] = 1.0f;
+    return out;
+}
+
+sl_reference::float4x4 to_sl(const XMFLOAT4X4& m) {
+    sl_reference::float4x4 out{};
+    std::memcpy(&out, &m, sizeof(out));
+    return out;
+}
+
+// Largest difference, relative to the magnitude of the reference where that's above 1
+float max_error(const XMFLOAT4X4& a, const sl_reference::float4x4& b) {
+    float error = 0.0f;
+
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            error = std::fmax(error, std::fabs(a.m[i][j] - b.m[i][j]) / std::fmax(1.0f, std::fabs(b.m[i][j])));
+        }
+    }
+
+    return error;
+}
+
+float compare(const Frame& current, const Frame& past) {
+    const auto fast = aer::correction::clip_to_prev_clip(current.projection, current.view, past.projection, past.view);
+    const auto reference = sl_reference::get_correction_matrix(to_sl(current.projection), to_sl(current.view), to_sl(past.projection), to_sl(past.view));
+    return max_error(fast, reference);
+}
+
+void test_identity_when_nothing_moved() {
+    const float position[3]{10.0f, 2.0f, -3.0f};
+    const Frame frame{perspective(1.5f, 1.0f, 0.1f), camera(0.3f, 0.1f, 0.0f, position, 0.0f)};
+
+    const auto m = aer::correction::clip_to_prev_clip(frame.projection, frame.view, frame.projection, frame.view);
+    float error = 0.0f;
+
+    for (int i = 0; i < 4; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            error = std::fmax(error, std::fabs(m.m[i][j] - (i == j ? 1.0f : 0.0f)));
+        }
+    }
+
+    CHECK(error < 1e-5f);
+}
+
+void test_matches_sl_helpers() {
+    std::mt19937 rng{1234};
+    std::uniform_real_distribution<float> angle{-3.1f, 3.1f};
+    std::uniform_real_distribution<float> small_angle{-0.05f, 0.05f};
+    std::uniform_real_distribution<float> step{-0.5f, 0.5f};
+    std::uniform_real_distribution<float> noise{-1e-3f, 1e-3f};
+
+    float worst_near = 0.0f;
+    float worst_far = 0.0f;
+
+    for (int i = 0; i < 2000; ++i) {
+        // near the origin and far out in a large open world
+        const auto scale = i % 2 == 0 ? 10.0f : 20000.0f;
+        std::uniform_real_distribution<float> coordinate{-scale, scale};
+
+        const float position[3]{coordinate(rng), coordinate(rng) * 0.1f, coordinate(rng)};
+        const float position_prev[3]{position[0] + step(rng), position[1] + step(rng), position[2] + step(rng)};
+
+        const auto yaw = angle(rng);
+        const auto pitch = angle(rng) * 0.4f;
+        const auto roll = small_angle(rng);
+
+        const Frame current{perspective(1.6f, 0.9f, 0.1f), camera(yaw, pitch, roll, position, noise(rng))};
+        const Frame past{perspective(1.6f, 0.9f, 0.1f), camera(yaw + small_angle(rng), pitch + small_angle(rng), roll, position_prev, noise(rng))};
+
+        auto& worst = i % 2 == 0 ? worst_near : worst_far;
+        worst = std::fmax(worst, compare(current, past));
+    }
+
+    // both work relative to the current camera, far out in the world is as exact as near the origin
+    CHECK(worst_near < 1e-4f);
+    CHECK(worst_far < 1e-4f);
+}
+
+void test_reprojects_points() {
+    // a point in front of the previous camera lands where the previous frame saw it
+    const float position[3]{100.0f, 0.0f, 100.0f};
+    const float position_prev[3]{99.0f, 0.0f, 100.0f};
+    const Frame current{perspective(1.5f, 1.0f, 0.1f), camera(0.2f, 0.0f, 0.0f, position, 0.0f)};
+    const Frame past{perspective(1.5f, 1.0f, 0.1f), camera(0.1f, 0.0f, 0.0f, position_prev, 0.0f)};
+
+    const auto m = aer::correction::clip_to_prev_clip(current.projection, current.view, past.projection, past.view);
+    const auto r = sl_reference::get_correction_matrix(to_sl(current.projection), to_sl(current.view), to_sl(past.projection), to_sl(past.view));
+
+    const float clip[4]{0.25f, -0.1f, 0.01f, 1.0f};
+    float a[4]{};
+    float b[4]{};
+
+    for (int j = 0; j < 4; ++j) {
+        for (int k = 0; k < 4; ++k) {
+            a[j] += clip[k] * m.m[k][j];
+            b[j] += clip[k] * r.m[k][j];
+        }
+    }
+
+    CHECK_NEAR(a[0] / a[3], b[0] / b[3], 1e-5);
+    CHECK_NEAR(a[1] / a[3], b[1] / b[3], 1e-5);
+    CHECK_NEAR(a[2] / a[3], b[2] / b[3], 1e-5);
+}
+
+void bench() {
+    const float position[3]{1234.0f, 5.0f, -4321.0f};
+    const float position_prev[3]{1233.5f, 5.0f, -4321.2f};
+    const Frame current{perspective(1.6f, 0.9f, 0.1f), camera(0.4f, 0.1f, 0.0f, position, 1e-4f)};
+    const Frame past{perspective(1.6f, 0.9f, 0.1f), camera(0.41f, 0.1f, 0.0f, position_prev, -1e-4f)};
+
+    const auto projection = to_sl(current.projection);
+    const auto view = to_sl(current.view);
+    const auto projection_prev = to_sl(past.projection);
+    const auto view_prev = to_sl(past.view);
+
+    float sink = 0.0f;
+    check::bench("correction matrix, sl helpers (scalar, full inverses)", 100'000, [&](size_t) {
+        sink += sl_reference::get_correction_matrix(projection, view, projection_prev, view_prev).m[3][3];
+    });
+
+    check::bench("correction matrix, aer::correction (DirectXMath)", 100'000, [&](size_t) {
+        sink += aer::correction::clip_to_prev_clip(current.projection, current.view, past.projection, past.view).m[3][3];
+    });
+
+    CHECK(sink != 0.0f);
+}
+} // namespace
+
+int main() {
+    test_identity_when_nothing_moved();
+    test_matches_sl_helpers();
+    test_reprojects_points();
+    bench();
+
+    return check::result();
+}
@@ -0,0 +1,116 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <utility/CrashCapture.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using utility::CrashCapture;
+
+CrashCapture make_capture() {
+    CrashCapture capture{};
+    capture.code = 0xC0000005;
+    capture.ip = 0x140001234;
+    capture.thread_id = 42;
+
+    capture.add_register("RIP", 0x140001234);
+    capture.add_register("A_VERY_LONG_NAME", 1);
+
+    capture.add_module(0x140000000, 0x100000, 0x5F000000, 0x100000, "\\Device\\HarddiskVolume3\\Games\\game.exe");
+    capture.add_frame(0x140001234);
+    capture.add_frame(0x7FF000000010);
+
+    return capture;
+}
+
+void test_registers_are_copied() {
+    const auto capture = make_capture();
+
+    CHECK(capture.register_count == 2);
+    CHECK(std::string{capture.registers[0].name} == "RIP");
+    // cut to fit, always terminated
+    CHECK(std::string{capture.registers[1].name} == "A_VERY_");
+}
+
+void test_round_trip() {
+    const auto capture = make_capture();
+    const utility::CrashCaptureHeader header{};
+
+    std::vector<char> bytes(sizeof(header) + sizeof(capture));
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    std::memcpy(bytes.data() + sizeof(header), &capture, sizeof(capture));
+
+    const auto read = utility::read_crash_capture(bytes.data(), bytes.size());
+    CHECK(read.has_value());
+    CHECK(read && utility::format_crash_report(*read) == utility::format_crash_report(capture));
+
+    // a different build (struct size) or a truncated file is thrown away
+    CHECK(!utility::read_crash_capture(bytes.data(), bytes.size() - 1).has_value());
+
+    auto bad = bytes;
+    bad[0] ^= 1;
+    CHECK(!utility::read_crash_capture(bad.data(), bad.size()).has_value());
+
+    // counts are clamped, a corrupt file can't make the formatter read past the arrays
+    auto corrupt = capture;
+    corrupt.frame_count = 100000;
+    std::memcpy(bytes.data() + sizeof(header), &corrupt, sizeof(corrupt));
+    const auto clamped = utility::read_crash_capture(bytes.data(), bytes.size());
+    CHECK(clamped && clamped->frame_count == CrashCapture::MAX_FRAMES);
+}
+
+void test_fixed_buffer_report() {
+    const auto capture = make_capture();
+    const auto full = utility::format_crash_report(capture);
+
+    CHECK(full.find("Exception 0xc0000005 at 0x140001234 (thread 42)") == 0);
+    CHECK(full.find("game.exe+0x1234") != std::string::npos);
+    CHECK(full.find("0x7ff000000010") != std::string::npos);
+
+    char buffer[4096]{};
+    const auto len = utility::format_crash_report(capture, buffer, sizeof(buffer));
+    CHECK(std::string(buffer, len) == full);
+
+    // cut off, never past the buffer
+    char small[33]{};
+    small[32] = '#';
+    const auto cut = utility::format_crash_report(capture, small, 32);
+    CHECK(cut == 32);
+    CHECK(small[32] == '#');
+    CHECK(std::string(small, cut) == full.substr(0, 32));
+}
+
+void test_symbolizer_cache() {
+    int lookups = 0;
+    utility::CachedSymbolizer symbolizer{[&](uint64_t address, const utility::CrashModule*) -> std::optional<utility::CachedSymbolizer::Symbol> {
+        ++lookups;
+
+        if (address == 0x140001234) {
+            return utility::CachedSymbolizer::Symbol{"Game::update", "game.cpp", 12, 0x34};
+        }
+
+        return std::nullopt;
+    }};
+
+    auto capture = make_capture();
+    capture.add_frame(0x140001234);
+
+    const auto report = utility::format_crash_report(capture, &symbolizer);
+
+    CHECK(report.find("Game::update+0x34 (game.cpp:12)") != std::string::npos);
+    CHECK(lookups == 2);
+    CHECK(symbolizer.get_hits() == 1);
+    CHECK(symbolizer.get_misses() == 2);
+}
+} // namespace
+
+int main() {
+    test_registers_are_copied();
+    test_round_trip();
+    test_fixed_buffer_report();
+    test_symbolizer_cache();
+
+    return check::result();
+}
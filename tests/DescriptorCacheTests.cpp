@@ -0,0 +1,221 @@
+#include <vector>
+
+#include <utility/DescriptorCache.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using utility::DescriptorHandle;
+using utility::ViewKey;
+using utility::ViewType;
+
+// Records what D3D would have been asked to create
+struct FakeBackend {
+    struct Write {
+        uint32_t slot{};
+        ViewKey key{};
+    };
+
+    std::vector<Write> writes{};
+
+    void write(uint32_t slot, const ViewKey& key) {
+        writes.push_back({slot, key});
+    }
+};
+
+using Cache = utility::DescriptorCache<FakeBackend>;
+
+ViewKey srv(uintptr_t resource) {
+    return ViewKey{resource, 10, ViewType::SRV};
+}
+
+void test_hits_and_misses() {
+    Cache cache{FakeBackend{}, 4};
+
+    const auto first = cache.acquire(srv(0x100), 1, 0);
+    CHECK(first && first->slot < 4);
+
+    // same view again: no new descriptor
+    const auto again = cache.acquire(srv(0x100), 2, 0);
+    CHECK(again && again->slot == first->slot && again->generation == first->generation);
+    CHECK(cache.backend().writes.size() == 1);
+
+    // another view type or mip of the same resource is another descriptor
+    auto uav = srv(0x100);
+    uav.type = ViewType::UAV;
+    const auto uav_handle = cache.acquire(uav, 2, 0);
+    CHECK(uav_handle && uav_handle->slot != first->slot);
+
+    auto mip = srv(0x100);
+    mip.mip = 1;
+    const auto mip_handle = cache.acquire(mip, 2, 0);
+    CHECK(mip_handle && mip_handle->slot != first->slot && mip_handle->slot != uav_handle->slot);
+
+    CHECK(cache.size() == 3);
+    CHECK(cache.get_stats().hits == 1);
+    CHECK(cache.get_stats().misses == 3);
+    CHECK(cache.backend().writes.size() == 3);
+}
+
+void test_lru_eviction() {
+    Cache cache{FakeBackend{}, 3};
+
+    DescriptorHandle slots[4]{};
+
+    // the GPU is done with everything up to epoch 10
+    for (uintptr_t r = 1; r <= 3; ++r) {
+        slots[r] = *cache.acquire(srv(r), r, 10);
+    }
+
+    // 1 used again, 2 is now the least recently used
+    cache.acquire(srv(1), 4, 10);
+
+    const auto fourth = cache.acquire(srv(4), 5, 10);
+    CHECK(fourth && fourth->slot == slots[2].slot);
+    CHECK(cache.backend().writes.back().slot == slots[2].slot && cache.backend().writes.back().key == srv(4));
+    CHECK(cache.get_stats().evictions == 1);
+
+    // then 3, then 1
+    CHECK(cache.acquire(srv(5), 6, 10)->slot == slots[3].slot);
+    CHECK(cache.acquire(srv(6), 7, 10)->slot == slots[1].slot);
+    CHECK(cache.get_stats().evictions == 3);
+
+    // evicted views come back as misses
+    const auto misses = cache.get_stats().misses;
+    cache.acquire(srv(2), 8, 10);
+    CHECK(cache.get_stats().misses == misses + 1);
+}
+
+void test_in_flight_slots_are_kept() {
+    Cache cache{FakeBackend{}, 2};
+
+    const auto one = *cache.acquire(srv(1), 5, 0);
+    const auto two = *cache.acquire(srv(2), 6, 0);
+
+    // the GPU finished epoch 4: both slots are still read by queued work
+    CHECK(!cache.acquire(srv(3), 7, 4).has_value());
+    CHECK(cache.get_stats().stalls == 1);
+    CHECK(cache.backend().writes.size() == 2);
+
+    // epoch 5 done: the least recently used one that's done with goes, even if it isn't the oldest
+    cache.acquire(srv(1), 8, 4);
+    const auto third = cache.acquire(srv(3), 9, 6);
+    CHECK(third && third->slot == two.slot);
+    CHECK(cache.acquire(srv(1), 9, 6)->slot == one.slot);
+}
+
+void test_generations() {
+    Cache cache{FakeBackend{}, 1};
+
+    const auto a = *cache.acquire(srv(1), 1, 1);
+    CHECK(cache.is_current(a));
+
+    // the slot gets another view, handles to the old one are stale
+    const auto b = *cache.acquire(srv(2), 2, 1);
+    CHECK(b.slot == a.slot);
+    CHECK(b.generation != a.generation);
+    CHECK(!cache.is_current(a));
+    CHECK(cache.is_current(b));
+
+    // the resource goes away
+    cache.invalidate(2);
+    CHECK(!cache.is_current(b));
+    CHECK(cache.size() == 0);
+
+    // the freed slot is used without an eviction, even though it was used after `completed`
+    const auto c = *cache.acquire(srv(3), 3, 0);
+    CHECK(c.slot == 0 && c.generation != b.generation);
+    CHECK(cache.get_stats().evictions == 1);
+
+    // resize drops everything, old handles don't come back to life
+    cache.resize(2);
+    CHECK(!cache.is_current(c));
+    const auto d = *cache.acquire(srv(3), 4, 4);
+    CHECK(d.slot != c.slot || d.generation != c.generation);
+
+    cache.clear();
+    CHECK(!cache.is_current(d));
+    CHECK(cache.size() == 0);
+}
+
+void test_invalidate_frees_for_reuse() {
+    Cache cache{FakeBackend{}, 3};
+
+    DescriptorHandle slots[4]{};
+
+    for (uintptr_t r = 1; r <= 3; ++r) {
+        slots[r] = *cache.acquire(srv(r), 10 + r, 0);
+    }
+
+    auto uav = srv(2);
+    uav.type = ViewType::UAV;
+    cache.invalidate(1);
+
+    // every slot is in flight, but the invalidated one is free
+    const auto reused = cache.acquire(uav, 20, 0);
+    CHECK(reused && reused->slot == slots[1].slot);
+    CHECK(cache.get_stats().stalls == 0);
+
+    // a recycled address is a new view
+    const auto recycled = cache.acquire(srv(1), 21, 0);
+    CHECK(!recycled.has_value());
+}
+
+// a depth buffer freed and recreated at the same address, e.g. after a resolution change
+void test_recreated_resource() {
+    Cache cache{FakeBackend{}, 3};
+
+    auto before = srv(0x100);
+    before.desc_hash = 1920;
+    auto after = srv(0x100);
+    after.desc_hash = 2560;
+
+    cache.acquire(srv(0x200), 1, 0);
+    const auto old_view = *cache.acquire(before, 2, 0);
+    cache.acquire(srv(0x300), 3, 0);
+
+    // never the descriptor of the old texture, even though everything else about the key matches
+    CHECK(!cache.acquire(after, 4, 0).has_value());
+    CHECK(cache.get_stats().hits == 0 && cache.get_stats().stale == 1);
+
+    // the old view goes first once the GPU is done with it, not the least recently used one
+    const auto new_view = cache.acquire(after, 4, 2);
+    CHECK(new_view && new_view->slot == old_view.slot && !cache.is_current(old_view));
+    CHECK(cache.backend().writes.back().key == after);
+    CHECK(cache.acquire(after, 5, 2)->slot == new_view->slot);
+    CHECK(cache.acquire(srv(0x200), 5, 2).has_value() && cache.get_stats().evictions == 1);
+}
+
+void bench() {
+    Cache cache{FakeBackend{}, 64};
+
+    for (uintptr_t r = 0; r < 48; ++r) {
+        cache.acquire(srv(0x1000 + r * 0x100), 0, 0);
+    }
+
+    uint64_t found = 0;
+    check::bench("DescriptorCache::acquire, hit, 48 views", 1'000'000, [&](size_t i) {
+        found += cache.acquire(srv(0x1000 + (i % 48) * 0x100), i, i).has_value() ? 1 : 0;
+    });
+
+    CHECK(found == 1'000'000);
+
+    check::bench("DescriptorCache::acquire, miss + evict, 64 slots", 1'000'000, [&](size_t i) {
+        found += cache.acquire(srv(0x100000 + i * 0x100), i, i).has_value() ? 1 : 0;
+    });
+
+    CHECK(found == 2'000'000);
+}
+} // namespace
+
+int main() {
+    test_hits_and_misses();
+    test_lru_eviction();
+    test_in_flight_slots_are_kept();
+    test_generations();
+    test_invalidate_frees_for_reuse();
+    test_recreated_resource();
+    bench();
+
+    return check::result();
+}
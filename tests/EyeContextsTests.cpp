@@ -0,0 +1,240 @@
+#include <map>
+#include <optional>
+#include <vector>
+
+#include <aer/EyeContexts.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using EyeContexts = aer::EyeContexts<uint32_t>;
+
+constexpr uint32_t GAME_VIEWPORT = 0;
+constexpr uint32_t AFR_VIEWPORT = 1024 + 1;
+
+// Stands in for Streamline/FidelityFX: one temporal history per context, thrown away on reset
+struct MockUpscaler {
+    struct History {
+        std::vector<uint64_t> frames{};
+        uint64_t resets{};
+    };
+
+    std::map<uint32_t, History> contexts{};
+
+    void dispatch(uint32_t context, uint64_t frame, bool reset) {
+        auto& history = contexts[context];
+
+        if (reset) {
+            history.frames.clear();
+            ++history.resets;
+        }
+
+        history.frames.push_back(frame);
+    }
+};
+
+// What the DLSS module does per frame
+struct Module {
+    EyeContexts eyes{1};
+    MockUpscaler upscaler{};
+
+    Module() {
+        eyes.set_extra(AFR_VIEWPORT);
+    }
+
+    EyeContexts::Dispatch set_constants(uint64_t frame, const std::optional<aer::EyePose>& pose = aer::EyePose{}, bool game_reset = false) {
+        const auto dispatch = eyes.begin(frame, pose, game_reset);
+        const auto context = dispatch.eye == EyeContexts::EXTRA ? *eyes.get_extra() : GAME_VIEWPORT;
+        upscaler.dispatch(context, frame, dispatch.should_reset());
+        return dispatch;
+    }
+
+    const MockUpscaler::History& history(uint32_t context) {
+        return upscaler.contexts[context];
+    }
+};
+
+aer::EyePose at(float x, float z = 0.0f) {
+    aer::EyePose pose{};
+    pose.position[0] = x;
+    pose.position[2] = z;
+    return pose;
+}
+
+void test_each_history_sees_one_eye() {
+    Module module{};
+
+    for (uint64_t frame = 1; frame <= 20; ++frame) {
+        module.set_constants(frame);
+    }
+
+    bool odd_only = true;
+    bool even_only = true;
+
+    for (const auto frame : module.history(GAME_VIEWPORT).frames) {
+        odd_only &= frame % 2 == 1;
+    }
+
+    for (const auto frame : module.history(AFR_VIEWPORT).frames) {
+        even_only &= frame % 2 == 0;
+    }
+
+    CHECK(odd_only && even_only);
+    CHECK(module.history(GAME_VIEWPORT).frames.size() == 10);
+    CHECK(module.history(AFR_VIEWPORT).frames.size() == 10);
+
+    // only the first frame of the context we created starts over
+    CHECK(module.history(GAME_VIEWPORT).resets == 0);
+    CHECK(module.history(AFR_VIEWPORT).resets == 1);
+    CHECK(module.eyes.state(EyeContexts::EXTRA).last_reset_reason == EyeContexts::RESET_NEW_CONTEXT);
+}
+
+void test_game_reset_reaches_both_eyes() {
+    Module module{};
+
+    for (uint64_t frame = 1; frame <= 4; ++frame) {
+        module.set_constants(frame);
+    }
+
+    CHECK(module.set_constants(5, {}, true).reset == EyeContexts::RESET_REQUESTED);
+    CHECK(module.set_constants(6).reset == EyeContexts::RESET_OTHER_EYE);
+    CHECK(!module.set_constants(7).should_reset());
+    CHECK(!module.set_constants(8).should_reset());
+
+    CHECK(module.history(GAME_VIEWPORT).frames == (std::vector<uint64_t>{5, 7}));
+    CHECK(module.history(AFR_VIEWPORT).frames == (std::vector<uint64_t>{6, 8}));
+}
+
+void test_repeated_calls_per_frame() {
+    Module module{};
+    module.eyes.thresholds().max_translation = 1.0f;
+
+    module.set_constants(1, at(0.0f));
+    module.set_constants(2, at(0.0f));
+
+    // set per viewport or per feature, same frame: the same decision every time, no self-comparison
+    CHECK(module.set_constants(3, at(5.0f)).reset == EyeContexts::RESET_TRANSLATION);
+    CHECK(module.set_constants(3, at(5.0f)).reset == EyeContexts::RESET_TRANSLATION);
+    CHECK(!module.set_constants(4, at(0.0f)).should_reset());
+    CHECK(!module.set_constants(4, at(0.0f)).should_reset());
+    CHECK(module.eyes.state(EyeContexts::NATIVE).resets == 1);
+    CHECK(module.eyes.state(EyeContexts::NATIVE).dispatches == 2);
+
+    // a reset asked for on a later call of the frame still counts, once, and reaches the other eye
+    CHECK(!module.set_constants(5, at(5.0f)).should_reset());
+    CHECK(module.set_constants(5, at(5.0f), true).reset == EyeContexts::RESET_REQUESTED);
+    CHECK(module.set_constants(5, at(5.0f), true).reset == EyeContexts::RESET_REQUESTED);
+    CHECK(module.eyes.state(EyeContexts::NATIVE).resets == 2);
+    CHECK(module.set_constants(6, at(0.0f)).reset == EyeContexts::RESET_OTHER_EYE);
+}
+
+void test_camera_jumps() {
+    Module module{};
+
+    // translation is off by default, units are game specific
+    module.set_constants(1, at(0.0f));
+    module.set_constants(3, at(10000.0f));
+    CHECK(module.eyes.state(EyeContexts::NATIVE).resets == 0);
+
+    module.eyes.thresholds().max_translation = 100.0f;
+    CHECK(!module.set_constants(5, at(10050.0f)).should_reset());
+    CHECK(module.set_constants(7, at(10200.0f)).reset == EyeContexts::RESET_TRANSLATION);
+
+    // turned around
+    auto turned = at(10200.0f);
+    turned.forward[2] = -1.0f;
+    CHECK(module.set_constants(9, turned).reset == EyeContexts::RESET_ROTATION);
+
+    auto slightly = turned;
+    slightly.forward[0] = 0.3f;
+    CHECK(!module.set_constants(11, slightly).should_reset());
+
+    module.eyes.thresholds().max_rotation_deg = 0.0f;
+    CHECK(!module.set_constants(13, at(10200.0f)).should_reset());
+}
+
+void test_missing_pose() {
+    Module module{};
+    module.eyes.thresholds().max_translation = 100.0f;
+
+    // the frame's view wasn't submitted (or already left the history): no camera checks
+    CHECK(!module.set_constants(1, std::nullopt).should_reset());
+    CHECK(!module.set_constants(3, at(5000.0f)).should_reset());
+
+    // and the last known pose stays what the next frame is compared with
+    CHECK(!module.set_constants(5, std::nullopt).should_reset());
+    CHECK(!module.set_constants(7, at(5050.0f)).should_reset());
+    CHECK(module.set_constants(9, at(0.0f)).reset == EyeContexts::RESET_TRANSLATION);
+}
+
+void test_frame_gap_and_invalidate() {
+    Module module{};
+
+    module.set_constants(1);
+    module.set_constants(2);
+    CHECK(!module.set_constants(3).should_reset());
+
+    // the AFR eye was skipped for a while (e.g. AER toggled off)
+    CHECK(module.set_constants(20).reset == EyeContexts::RESET_FRAME_GAP);
+
+    // reallocated resources
+    module.eyes.invalidate();
+    CHECK(module.set_constants(21).reset == EyeContexts::RESET_NEW_CONTEXT);
+    CHECK(module.set_constants(22).reset == EyeContexts::RESET_NEW_CONTEXT);
+    CHECK(!module.set_constants(23).should_reset());
+
+    module.eyes.clear_extra();
+    CHECK(module.eyes.get_extra() == nullptr);
+    CHECK(module.eyes.state(EyeContexts::EXTRA).dispatches == 0);
+}
+
+void test_input_remap() {
+    struct Input {
+        int type{};
+    };
+
+    Input viewport{1};
+    Input color{2};
+    Input depth{3};
+    Input afr_viewport{1};
+
+    Input* inputs[] = {&viewport, &color, &depth};
+    aer::InputRemap<Input> remap{};
+
+    const auto remapped = remap.remap(inputs, 3, [&](Input* input) { return input->type == 1 ? &afr_viewport : nullptr; });
+    CHECK(remapped[0] == &afr_viewport);
+    CHECK(remapped[1] == &color && remapped[2] == &depth);
+    CHECK(inputs[0] == &viewport);
+
+    // storage is reused once it's big enough
+    const auto again = remap.remap(inputs, 2, [](Input*) -> Input* { return nullptr; });
+    CHECK(again == remapped);
+    CHECK(again[0] == &viewport);
+}
+
+void bench() {
+    EyeContexts eyes{1};
+    eyes.set_extra(AFR_VIEWPORT);
+    eyes.thresholds().max_translation = 100.0f;
+
+    uint64_t resets = 0;
+    check::bench("EyeContexts::begin", 1'000'000, [&](size_t i) {
+        resets += eyes.begin(i + 1, at((float)(i % 16)), false).should_reset() ? 1 : 0;
+    });
+
+    CHECK(resets == 1);
+}
+} // namespace
+
+int main() {
+    test_each_history_sees_one_eye();
+    test_game_reset_reaches_both_eyes();
+    test_repeated_calls_per_frame();
+    test_camera_jumps();
+    test_missing_pose();
+    test_frame_gap_and_invalidate();
+    test_input_remap();
+    bench();
+
+    return check::result();
+}
@@ -0,0 +1,205 @@
+#include <memory>
+#include <vector>
+
+#include <utility/FlatViewCache.hpp>
+
+#include "Check.hpp"
+
+namespace {
+// Stands in for a ComPtr to a view, `alive` counts the views nothing released yet
+struct FakeView {
+    std::shared_ptr<int> ref{};
+    int id{};
+};
+
+constexpr size_t CAPACITY = 16;
+using Cache = utility::FlatViewCache<FakeView, CAPACITY>;
+using Identity = Cache::Identity;
+
+// Resource addresses (16 byte aligned, like real allocations) that all probe from `home`
+std::vector<uintptr_t> resources_at(size_t home, size_t count) {
+    std::vector<uintptr_t> out{};
+
+    for (uintptr_t p = 0x10000; out.size() < count; p += 0x10) {
+        if ((Cache::hash_pointer(p) & (CAPACITY - 1)) == home) {
+            out.push_back(p);
+        }
+    }
+
+    return out;
+}
+
+struct Fixture {
+    Cache cache{10};
+    std::shared_ptr<int> alive{std::make_shared<int>()};
+
+    FakeView& insert(uintptr_t resource, uint64_t frame, uint64_t desc = 1) {
+        return cache.insert({resource, desc}, FakeView{alive, (int)resource}, frame);
+    }
+
+    bool has(uintptr_t resource, uint64_t frame, uint64_t desc = 1) {
+        const auto view = cache.find({resource, desc}, frame);
+        return view != nullptr && view->id == (int)resource;
+    }
+
+    long views() const {
+        return alive.use_count() - 1;
+    }
+};
+
+void test_find_and_identity() {
+    Fixture f{};
+
+    CHECK(!f.has(0x1000, 1));
+    f.insert(0x1000, 1);
+    CHECK(f.has(0x1000, 2));
+    CHECK(f.cache.get_stats().hits == 1);
+    CHECK(f.cache.get_stats().misses == 1);
+
+    // recreated at the same address with another desc: the old view is released, not handed out
+    CHECK(!f.has(0x1000, 3, 2));
+    CHECK(f.cache.get_stats().stale == 1);
+    CHECK(f.cache.size() == 0);
+    CHECK(f.views() == 0);
+
+    // anything from before invalidate() doesn't match
+    f.insert(0x1000, 4);
+    f.cache.invalidate();
+    CHECK(!f.has(0x1000, 5));
+    CHECK(f.views() == 0);
+
+    f.insert(0x1000, 6);
+    f.insert(0x2000, 6);
+    f.cache.clear();
+    CHECK(f.cache.size() == 0);
+    CHECK(f.views() == 0);
+}
+
+void test_backward_shift_delete() {
+    Fixture f{};
+    const auto colliding = resources_at(3, 4);
+
+    for (const auto r : colliding) {
+        f.insert(r, 1);
+    }
+
+    // an unrelated entry right after the cluster that mustn't move
+    const auto neighbour = resources_at(7, 1)[0];
+    f.insert(neighbour, 1);
+
+    // drop the second of the chain, the ones behind it move up instead of leaving a tombstone
+    CHECK(!f.has(colliding[1], 2, 99));
+    CHECK(f.cache.size() == 4);
+
+    for (const auto r : {colliding[0], colliding[2], colliding[3], neighbour}) {
+        CHECK(f.has(r, 2));
+    }
+
+    // the slot it left is reused by the next insert from that home
+    const auto more = resources_at(3, 5)[4];
+    f.insert(more, 2);
+    CHECK(f.has(more, 3));
+    CHECK(f.has(colliding[3], 3));
+
+    // drop the head of the chain, everything is still reachable
+    CHECK(!f.has(colliding[0], 3, 99));
+
+    for (const auto r : {colliding[2], colliding[3], more, neighbour}) {
+        CHECK(f.has(r, 3));
+    }
+
+    CHECK(f.views() == (long)f.cache.size());
+}
+
+void test_wraparound() {
+    Fixture f{};
+
+    // a chain starting in the last slot continues at the front of the table
+    const auto last = resources_at(CAPACITY - 1, 3);
+    const auto first = resources_at(0, 2);
+
+    f.insert(last[0], 1);
+    f.insert(last[1], 1);
+    f.insert(first[0], 1);
+    f.insert(last[2], 1);
+    f.insert(first[1], 1);
+
+    for (const auto r : {last[0], last[1], last[2], first[0], first[1]}) {
+        CHECK(f.has(r, 2));
+    }
+
+    // deleting across the end shifts entries from the front back into the last slot,
+    // but never an entry whose home is after the hole
+    CHECK(!f.has(last[0], 3, 99));
+    CHECK(!f.has(last[1], 3, 99));
+
+    for (const auto r : {last[2], first[0], first[1]}) {
+        CHECK(f.has(r, 4));
+    }
+
+    CHECK(f.cache.size() == 3);
+    CHECK(f.views() == 3);
+}
+
+void test_eviction() {
+    Fixture f{};
+
+    f.insert(0x1000, 1);
+    f.insert(0x2000, 5);
+
+    // max_age 10
+    f.cache.evict_older_than(11);
+    CHECK(f.cache.size() == 2);
+    f.cache.evict_older_than(12);
+    CHECK(f.cache.size() == 1);
+    CHECK(f.has(0x2000, 12));
+
+    // full of recently used views: the least recently used one makes room
+    f.cache.clear();
+
+    for (uintptr_t i = 0; i < Cache::MAX_LOAD; ++i) {
+        f.insert(0x10000 + i * 0x100, i == 0 ? 199 : 200);
+    }
+
+    f.insert(0x900000, 205);
+    CHECK(f.cache.size() == Cache::MAX_LOAD);
+    CHECK(!f.has(0x10000, 205));
+    CHECK(f.has(0x10100, 205));
+    CHECK(f.has(0x900000, 205));
+    CHECK(f.views() == (long)Cache::MAX_LOAD);
+}
+
+void bench() {
+    utility::FlatViewCache<FakeView, 32> cache{120};
+    std::vector<uintptr_t> resources{};
+
+    for (uintptr_t i = 0; i < 16; ++i) {
+        resources.push_back(0x7FF000000000ull + i * 0x20000);
+        cache.insert({resources.back(), i}, FakeView{}, 0);
+    }
+
+    uint64_t found = 0;
+    check::bench("FlatViewCache::find, hit, 16 of 32", 1'000'000, [&](size_t i) {
+        const auto index = i & 15;
+        found += cache.find({resources[index], index}, i) != nullptr ? 1 : 0;
+    });
+
+    CHECK(found == 1'000'000);
+
+    check::bench("FlatViewCache::find, miss, 16 of 32", 1'000'000, [&](size_t i) {
+        found += cache.find({0x1000 + i * 0x10, 0}, i) != nullptr ? 1 : 0;
+    });
+
+    CHECK(found == 1'000'000);
+}
+} // namespace
+
+int main() {
+    test_find_and_identity();
+    test_backward_shift_delete();
+    test_wraparound();
+    test_eviction();
+    bench();
+
+    return check::result();
+}
@@ -0,0 +1,233 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <imgui.h>
+
+#include <utility/FontAtlasCache.hpp>
+#include <utility/GlyphRangeSet.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using utility::FontAtlasCache;
+using utility::GlyphRangeSet;
+
+struct TempDir {
+    std::filesystem::path path{std::filesystem::temp_directory_path() /
+        ("vrframework_font_cache_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()))};
+
+    ~TempDir() {
+        std::error_code ec{};
+        std::filesystem::remove_all(path, ec);
+    }
+};
+
+// Headless bake of ImGui's built in font, no context or device needed
+std::unique_ptr<ImFontAtlas> bake_default(float size = 13.0f) {
+    auto atlas = std::make_unique<ImFontAtlas>();
+
+    ImFontConfig config{};
+    config.SizePixels = size;
+    atlas->AddFontDefault(&config);
+    atlas->Build();
+
+    return atlas;
+}
+
+#ifndef IMGUI_HAS_TEXTURES
+void test_round_trip() {
+    TempDir dir{};
+    FontAtlasCache cache{dir.path};
+
+    const auto baked = bake_default();
+    CHECK(baked->IsBuilt() && baked->TexPixelsAlpha8 != nullptr);
+    CHECK(cache.store(baked.get(), 1));
+    CHECK(std::filesystem::exists(cache.get_path(1)));
+
+    ImFontAtlas loaded{};
+    CHECK(cache.load(&loaded, 1));
+    CHECK(loaded.IsBuilt());
+
+    // the same texture and the same glyph tables, without rasterizing anything
+    CHECK(loaded.TexWidth == baked->TexWidth && loaded.TexHeight == baked->TexHeight);
+    CHECK(std::memcmp(loaded.TexPixelsAlpha8, baked->TexPixelsAlpha8, (size_t)baked->TexWidth * baked->TexHeight) == 0);
+    CHECK(loaded.Fonts.Size == baked->Fonts.Size);
+    CHECK(loaded.CustomRects.Size == baked->CustomRects.Size);
+
+    if (loaded.Fonts.Size == 1 && baked->Fonts.Size == 1) {
+        const auto a = baked->Fonts[0];
+        const auto b = loaded.Fonts[0];
+
+        CHECK(a->FontSize == b->FontSize && a->Ascent == b->Ascent && a->Descent == b->Descent);
+        CHECK(a->Glyphs.Size == b->Glyphs.Size);
+
+        const auto ga = a->FindGlyphNoFallback('A');
+        const auto gb = b->FindGlyphNoFallback('A');
+        CHECK(ga != nullptr && gb != nullptr);
+
+        if (ga != nullptr && gb != nullptr) {
+            CHECK(ga->AdvanceX == gb->AdvanceX && ga->X0 == gb->X0 && ga->Y1 == gb->Y1 && ga->U0 == gb->U0 && ga->V1 == gb->V1);
+        }
+
+        CHECK(b->FindGlyphNoFallback(0x4E00) == nullptr);
+    }
+}
+
+void test_invalidation() {
+    TempDir dir{};
+    FontAtlasCache cache{dir.path};
+
+    // the key covers the glyph set: one more requested glyph is a miss, not a stale atlas
+    GlyphRangeSet used{};
+    used.add_range(0x20, 0xFF);
+    const auto key = used.hash(FontAtlasCache::hash("roboto"));
+
+    CHECK(cache.store(bake_default().get(), key));
+
+    used.add(0x8BBE);
+    const auto new_key = used.hash(FontAtlasCache::hash("roboto"));
+    CHECK(new_key != key);
+
+    // a miss leaves the atlas cleared for the caller to build
+    auto atlas = bake_default();
+    CHECK(!cache.load(atlas.get(), new_key));
+    CHECK(atlas->Fonts.Size == 0 && !atlas->IsBuilt());
+
+    // other font size, other key
+    CHECK(FontAtlasCache::hash_value(16, key) != FontAtlasCache::hash_value(18, key));
+
+    // a file under another key's name is rejected by the key stored inside it
+    std::filesystem::copy_file(cache.get_path(key), cache.get_path(new_key));
+    CHECK(!cache.load(atlas.get(), new_key));
+
+    // truncated, e.g. the game was killed while it was written by an older build
+    const auto size = std::filesystem::file_size(cache.get_path(key));
+    std::filesystem::resize_file(cache.get_path(key), size / 2);
+    CHECK(!cache.load(atlas.get(), key));
+    CHECK(atlas->Fonts.Size == 0);
+}
+
+void test_prune() {
+    TempDir dir{};
+    FontAtlasCache cache{dir.path};
+    const auto baked = bake_default();
+
+    const auto now = std::filesystem::file_time_type::clock::now();
+
+    for (uint64_t key = 1; key <= 3; ++key) {
+        CHECK(cache.store(baked.get(), key, 2));
+        std::filesystem::last_write_time(cache.get_path(key), now - std::chrono::hours(10 - key));
+    }
+
+    CHECK(cache.store(baked.get(), 4, 2));
+
+    // the two most recent survive
+    CHECK(!std::filesystem::exists(cache.get_path(1)) && !std::filesystem::exists(cache.get_path(2)));
+    CHECK(std::filesystem::exists(cache.get_path(3)) && std::filesystem::exists(cache.get_path(4)));
+}
+
+// A CJK font to bake, VRFRAMEWORK_TESTS_CJK_FONT or a common system one
+std::filesystem::path find_cjk_font() {
+    if (const auto env = std::getenv("VRFRAMEWORK_TESTS_CJK_FONT"); env != nullptr && std::filesystem::exists(env)) {
+        return env;
+    }
+
+    for (const auto candidate : {
+        "C:/Windows/Fonts/msyh.ttc",
+        "C:/Windows/Fonts/simhei.ttf",
+        "/usr/share/fonts/opentype/noto/NotoSansCJK-Regular.ttc",
+        "/usr/share/fonts/noto-cjk/NotoSansCJK-Regular.ttc",
+        "/usr/share/fonts/truetype/wqy/wqy-microhei.ttc",
+    }) {
+        if (std::filesystem::exists(candidate)) {
+            return candidate;
+        }
+    }
+
+    return {};
+}
+
+void report(const char* name, const ImFontAtlas& atlas) {
+    const auto glyphs = atlas.Fonts.Size > 0 ? atlas.Fonts[0]->Glyphs.Size : 0;
+    const auto bytes = (size_t)atlas.TexWidth * atlas.TexHeight * 4 + (size_t)glyphs * sizeof(ImFontGlyph); // RGBA32 upload
+
+    std::printf("[bench] %s: %dx%d texture, %d glyphs, %.1f MB\n", name, atlas.TexWidth, atlas.TexHeight, glyphs, (double)bytes / (1024.0 * 1024.0));
+}
+
+// What Framework::update_fonts bakes for vr_pictographic.mode: all of GetGlyphRangesChineseFull,
+// or with lazy glyphs only ImGui's always-on CJK blocks plus what the UI asked for so far
+void bench_full_vs_lazy() {
+    const auto font = find_cjk_font();
+
+    if (font.empty()) {
+        std::printf("[bench] no CJK font found (set VRFRAMEWORK_TESTS_CJK_FONT), full vs lazy bake skipped\n");
+        return;
+    }
+
+    ImFontAtlas ranges_source{};
+    const auto full_ranges = ranges_source.GetGlyphRangesChineseFull();
+
+    GlyphRangeSet lazy{};
+    const ImWchar base_ranges[] = {0x0020, 0x00FF, 0x2000, 0x206F, 0x3000, 0x30FF, 0x31F0, 0x31FF, 0xFF00, 0xFFEF, 0xFFFD, 0xFFFD, 0};
+    lazy.add_ranges(base_ranges);
+
+    // a menu's worth of strings: "设置 界面 分辨率 渲染 控制器 确定 取消 恢复默认"
+    lazy.add_text("\xE8\xAE\xBE\xE7\xBD\xAE \xE7\x95\x8C\xE9\x9D\xA2 \xE5\x88\x86\xE8\xBE\xA8\xE7\x8E\x87 \xE6\xB8\xB2\xE6\x9F\x93 "
+                  "\xE6\x8E\xA7\xE5\x88\xB6\xE5\x99\xA8 \xE7\xA1\xAE\xE5\xAE\x9A \xE5\x8F\x96\xE6\xB6\x88 \xE6\x81\xA2\xE5\xA4\x8D\xE9\xBB\x98\xE8\xAE\xA4",
+        nullptr);
+
+    const auto lazy_ranges = lazy.to_flat<ImWchar>();
+
+    const auto bake = [&](const ImWchar* ranges) {
+        auto atlas = std::make_unique<ImFontAtlas>();
+        atlas->AddFontFromFileTTF(font.string().c_str(), 16.0f, nullptr, ranges);
+        atlas->Build();
+        return atlas;
+    };
+
+    std::unique_ptr<ImFontAtlas> full{};
+    std::unique_ptr<ImFontAtlas> lazy_atlas{};
+
+    check::bench("bake GetGlyphRangesChineseFull, 16px", 3, [&](size_t) { full = bake(full_ranges); });
+    check::bench("bake lazy glyph set, 16px", 3, [&](size_t) { lazy_atlas = bake(lazy_ranges.data()); });
+
+    report("atlas, full CJK", *full);
+    report("atlas, lazy", *lazy_atlas);
+
+    CHECK(lazy_atlas->Fonts[0]->Glyphs.Size < full->Fonts[0]->Glyphs.Size);
+
+    // and what a restart with an unchanged setup pays instead
+    TempDir dir{};
+    FontAtlasCache cache{dir.path};
+    CHECK(cache.store(full.get(), 1));
+
+    ImFontAtlas loaded{};
+    bool hit = true;
+    check::bench("FontAtlasCache::load, full CJK", 10, [&](size_t) { hit &= cache.load(&loaded, 1); });
+    CHECK(hit);
+}
+#endif
+} // namespace
+
+int main() {
+#ifndef IMGUI_HAS_TEXTURES
+    test_round_trip();
+    test_invalidation();
+    test_prune();
+    bench_full_vs_lazy();
+#else
+    // dynamic font textures, nothing is cached
+    auto atlas = bake_default();
+    FontAtlasCache cache{std::filesystem::temp_directory_path()};
+    CHECK(!cache.store(atlas.get(), 1));
+#endif
+
+    return check::result();
+}
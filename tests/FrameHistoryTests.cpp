@@ -0,0 +1,328 @@
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <utility/FrameHistory.hpp>
+
+#include "Check.hpp"
+
+// Pose-like: position lerped, heading blended the shorter way around
+struct Pose {
+    float position[3]{};
+    float heading{}; // degrees
+};
+
+namespace utility {
+template <>
+struct FrameLerp<Pose> {
+    static Pose lerp(const Pose& a, const Pose& b, double t) {
+        Pose out{};
+
+        for (int i = 0; i < 3; ++i) {
+            out.position[i] = FrameLerp<float>::lerp(a.position[i], b.position[i], t);
+        }
+
+        auto delta = b.heading - a.heading;
+        delta = delta > 180.0f ? delta - 360.0f : delta < -180.0f ? delta + 360.0f : delta;
+        out.heading = std::fmod(a.heading + delta * (float)t + 360.0f, 360.0f);
+        return out;
+    }
+};
+} // namespace utility
+
+namespace {
+using utility::FrameNumber;
+using utility::NO_FRAME;
+
+// Like GlobalPool::Constants: parts written by different callers, a mask of what was written
+struct Constants {
+    float projection[16]{};
+    float view[16]{};
+    float pose[12]{};
+    uint64_t revision{};
+    uint32_t submitted{};
+};
+
+constexpr uint32_t PROJECTION = 1;
+constexpr uint32_t VIEW = 2;
+constexpr uint32_t POSE = 4;
+
+void test_tags() {
+    utility::FrameHistory<int, 4> history{};
+
+    CHECK(history.find(0) == nullptr);
+    CHECK(history.latest() == nullptr);
+    CHECK(history.latest_frame() == NO_FRAME);
+
+    history.put(5, 50);
+    history.put(6, 60);
+    CHECK(history.get(5) == 50);
+    CHECK(*history.latest() == 60);
+
+    // frame 9 reuses frame 5's slot
+    history.put(9, 90);
+    CHECK(!history.get(5).has_value());
+    CHECK(history.get_or(5, -1) == -1);
+    CHECK(history.get(9) == 90);
+
+    // frame - 2 right after startup
+    history.put(-1, 10);
+    CHECK(history.get(-1) == 10);
+    CHECK(!history.get(3).has_value());
+    CHECK(history.latest_frame() == 9);
+
+    CHECK(!history.find(NO_FRAME));
+    CHECK(history.get_misses() == 5);
+
+    history.invalidate();
+    CHECK(!history.get(9).has_value());
+    CHECK(history.slot(utility::frame_slot<4>(9)) == 90);
+    CHECK(history.latest() == nullptr);
+
+    static_assert(utility::FrameHistory<int, 4>::holds(3));
+    static_assert(!utility::FrameHistory<int, 4>::holds(4));
+}
+
+void test_write_clears_on_retag() {
+    utility::FrameHistory<Constants, 4> history{};
+
+    auto& first = history.write(1);
+    first.projection[0] = 2.0f;
+    first.submitted |= PROJECTION;
+    history.write(1).view[0] = 3.0f;
+    history.write(1).submitted |= VIEW;
+
+    // parts written for the same frame add up
+    CHECK(history.find(1)->projection[0] == 2.0f);
+    CHECK(history.find(1)->view[0] == 3.0f);
+    CHECK(history.find(1)->submitted == (PROJECTION | VIEW));
+
+    // frame 5 takes the slot over: only what was written for frame 5 is there
+    history.write(5).pose[0] = 7.0f;
+    history.write(5).submitted |= POSE;
+    CHECK(history.find(5)->projection[0] == 0.0f);
+    CHECK(history.find(5)->view[0] == 0.0f);
+    CHECK(history.find(5)->submitted == POSE);
+}
+
+void test_retag_keeps_the_slot() {
+    // a copy target per slot, like the debug overlay's motion vector copies
+    utility::FrameHistory<std::vector<int>, 2> targets{};
+    targets.slot(0).resize(16);
+    targets.slot(1).resize(16);
+
+    targets.retag(2)[0] = 1;
+    targets.retag(4)[1] = 2;
+    CHECK(targets.find(4)->size() == 16);
+    CHECK((*targets.find(4))[0] == 1 && (*targets.find(4))[1] == 2);
+    CHECK(targets.find(2) == nullptr);
+}
+
+template <typename History>
+concept HasInterpolate = requires(const History& h) { h.interpolate(0, 1, 0.5); };
+
+void test_interpolate() {
+    // only for types that opt in
+    static_assert(utility::FrameInterpolable<Pose> && utility::FrameInterpolable<double>);
+    static_assert(!utility::FrameInterpolable<Constants> && !utility::FrameInterpolable<int>);
+    static_assert(HasInterpolate<utility::FrameHistory<Pose, 4>> && HasInterpolate<utility::SharedFrameHistory<Pose, 4>>);
+    static_assert(!HasInterpolate<utility::FrameHistory<Constants, 4>> && !HasInterpolate<utility::SharedFrameHistory<Constants, 4>>);
+
+    utility::FrameHistory<Pose, 4> history{};
+    history.put(10, Pose{{0.0f, 1.0f, 2.0f}, 350.0f});
+    history.put(11, Pose{{2.0f, 1.0f, -2.0f}, 10.0f});
+
+    const auto mid = history.interpolate(10, 11, 0.5);
+    CHECK(mid.has_value());
+
+    if (mid) {
+        CHECK_NEAR(mid->position[0], 1.0, 1e-6);
+        CHECK_NEAR(mid->position[1], 1.0, 1e-6);
+        CHECK_NEAR(mid->position[2], 0.0, 1e-6);
+        CHECK_NEAR(mid->heading, 0.0, 1e-4);
+    }
+
+    // the ends are the frames themselves
+    CHECK_NEAR(history.interpolate(10, 11, 0.0)->position[2], 2.0, 1e-6);
+    CHECK_NEAR(history.interpolate(10, 11, 1.0)->heading, 10.0, 1e-4);
+
+    // a frame that's gone or never written is a miss, not a blend with another frame's pose
+    history.put(14, Pose{});
+    CHECK(!history.interpolate(10, 11, 0.5).has_value());
+    CHECK(!history.interpolate(11, 12, 0.5).has_value());
+
+    utility::SharedFrameHistory<double, 4> shared{};
+    shared.put(1, 2.0);
+    shared.put(2, 4.0);
+    CHECK_NEAR(*shared.interpolate(1, 2, 0.25), 2.5, 1e-9);
+    CHECK(!shared.interpolate(2, 3, 0.5).has_value());
+}
+
+void test_shared_update() {
+    utility::SharedFrameHistory<Constants, 4> history{};
+
+    history.update(1, [](Constants& c) { c.projection[0] = 2.0f; c.submitted |= PROJECTION; });
+    history.update(1, [](Constants& c) { c.view[0] = 3.0f; c.submitted |= VIEW; });
+
+    const auto one = history.get(1);
+    CHECK(one && one->projection[0] == 2.0f && one->view[0] == 3.0f);
+    CHECK(one && one->submitted == (PROJECTION | VIEW));
+
+    // the slot's previous frame doesn't leak into the new one
+    history.update(5, [](Constants& c) { c.pose[0] = 1.0f; c.submitted |= POSE; });
+    const auto five = history.get(5);
+    CHECK(five && five->projection[0] == 0.0f && five->submitted == POSE);
+    CHECK(!history.get(1).has_value());
+    CHECK(history.get_misses() == 1);
+    CHECK(history.latest_frame() == 5);
+
+    Constants whole{};
+    whole.revision = 42;
+    history.put(6, whole);
+    CHECK(history.get(6)->revision == 42);
+}
+
+// Every float of a frame's value is the frame number, a reader seeing anything else saw a torn write
+void fill(Constants& c, FrameNumber frame, uint32_t part) {
+    auto* values = part == PROJECTION ? c.projection : c.view;
+
+    for (int i = 0; i < 16; ++i) {
+        values[i] = (float)frame;
+    }
+
+    c.submitted |= part;
+}
+
+bool consistent(const Constants& c, FrameNumber frame) {
+    for (int i = 0; i < 16; ++i) {
+        if (((c.submitted & PROJECTION) && c.projection[i] != (float)frame) || ((c.submitted & VIEW) && c.view[i] != (float)frame)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void test_shared_threads() {
+    utility::SharedFrameHistory<Constants, 4> history{};
+    std::atomic<FrameNumber> written{0};
+    std::atomic<FrameNumber> view_written{0};
+    std::atomic<bool> done{false};
+    constexpr FrameNumber FRAMES = 2'000;
+
+    // the game's render thread and the VR thread write different parts of the same frames,
+    // never more than a frame apart (further and the ring would drop frames under them)
+    std::thread projection_writer{[&] {
+        for (FrameNumber frame = 1; frame <= FRAMES; ++frame) {
+            while (view_written.load(std::memory_order_acquire) < frame - 1) {
+                std::this_thread::yield();
+            }
+
+            history.update(frame, [&](Constants& c) { fill(c, frame, PROJECTION); });
+            written.store(frame, std::memory_order_release);
+        }
+    }};
+
+    std::thread view_writer{[&] {
+        for (FrameNumber frame = 1; frame <= FRAMES; ++frame) {
+            while (written.load(std::memory_order_acquire) < frame - 1) {
+                std::this_thread::yield();
+            }
+
+            history.update(frame, [&](Constants& c) { fill(c, frame, VIEW); });
+            view_written.store(frame, std::memory_order_release);
+        }
+    }};
+
+    std::atomic<uint64_t> torn{0};
+    std::atomic<uint64_t> reads{0};
+    std::vector<std::thread> readers{};
+
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&] {
+            while (!done.load(std::memory_order_acquire)) {
+                const auto frame = written.load(std::memory_order_acquire);
+
+                for (FrameNumber f = frame; f > frame - 3; --f) {
+                    if (const auto value = history.get(f); value && !consistent(*value, f)) {
+                        torn.fetch_add(1);
+                    }
+
+                    reads.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+
+    projection_writer.join();
+    view_writer.join();
+    done.store(true, std::memory_order_release);
+
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    CHECK(torn == 0);
+    CHECK(reads > 0);
+
+    // both writers got their part in, whichever came first
+    const auto last = history.get(FRAMES);
+    CHECK(last && last->submitted == (PROJECTION | VIEW) && consistent(*last, FRAMES));
+}
+
+void bench() {
+    utility::FrameHistory<Constants, 10> history{};
+    utility::SharedFrameHistory<Constants, 10> shared{};
+
+    for (FrameNumber frame = 0; frame < 10; ++frame) {
+        history.write(frame).revision = (uint64_t)frame;
+        shared.update(frame, [&](Constants& c) { c.revision = (uint64_t)frame; });
+    }
+
+    uint64_t sum = 0;
+    check::bench("FrameHistory::find", 1'000'000, [&](size_t i) {
+        const auto value = history.find((FrameNumber)(i % 10));
+        sum += value != nullptr ? value->revision : 0;
+    });
+
+    check::bench("SharedFrameHistory::get, no writer", 1'000'000, [&](size_t i) {
+        sum += shared.get((FrameNumber)(i % 10))->revision;
+    });
+
+    check::bench("SharedFrameHistory::update", 1'000'000, [&](size_t i) {
+        shared.update((FrameNumber)(10 + i % 10), [&](Constants& c) { c.revision = i; });
+    });
+
+    // a writer thread publishing frames as fast as it can while we read
+    std::atomic<bool> done{false};
+    std::thread writer{[&] {
+        for (FrameNumber frame = 20; !done.load(std::memory_order_relaxed); ++frame) {
+            shared.update(frame, [&](Constants& c) { c.revision = (uint64_t)frame; });
+        }
+    }};
+
+    check::bench("SharedFrameHistory::get, busy writer", 1'000'000, [&](size_t) {
+        const auto frame = shared.latest_frame();
+        const auto value = shared.get(frame);
+        sum += value ? value->revision : 0;
+    });
+
+    done = true;
+    writer.join();
+
+    CHECK(sum > 0);
+}
+} // namespace
+
+int main() {
+    test_tags();
+    test_write_clears_on_retag();
+    test_retag_keeps_the_slot();
+    test_interpolate();
+    test_shared_update();
+    test_shared_threads();
+    bench();
+
+    return check::result();
+}
@@ -0,0 +1,94 @@
+#include <aer/FramePassLedger.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using Ledger = aer::FramePassLedger;
+
+void test_once_per_frame() {
+    Ledger ledger{};
+    const Ledger::Key mv{0x1000, 0};
+    const Ledger::Key other{0x2000, 0};
+
+    // DLSS and DLSS-RR evaluating on the same vectors
+    CHECK(ledger.claim(mv, 1));
+    CHECK(!ledger.claim(mv, 1));
+    CHECK(ledger.claim(other, 1));
+    CHECK(ledger.was_processed(mv, 1));
+
+    // subresources are separate
+    CHECK(ledger.claim({0x1000, 1}, 1));
+
+    // a new frame forgets the old one
+    CHECK(!ledger.was_processed(mv, 2));
+    CHECK(ledger.claim(mv, 2));
+    CHECK(!ledger.was_processed(other, 2));
+
+    CHECK(ledger.get_stats().processed == 4);
+    CHECK(ledger.get_stats().skipped == 1);
+
+    ledger.clear();
+    CHECK(!ledger.was_processed(mv, 2));
+    CHECK(ledger.claim(mv, 2));
+}
+
+void test_release_on_failure() {
+    Ledger ledger{};
+    const Ledger::Key mv{0x1000, 0};
+    const Ledger::Key other{0x2000, 0};
+
+    // the views couldn't be created on the first evaluate, the second one still has to run the pass
+    CHECK(ledger.claim(other, 7));
+    CHECK(ledger.claim(mv, 7));
+    ledger.release(mv, 7);
+    CHECK(!ledger.was_processed(mv, 7));
+    CHECK(ledger.was_processed(other, 7));
+    CHECK(ledger.claim(mv, 7));
+    CHECK(!ledger.claim(mv, 7));
+
+    CHECK(ledger.get_stats().processed == 2);
+    CHECK(ledger.get_stats().skipped == 1);
+
+    // a stale release doesn't touch the current frame
+    ledger.release(mv, 6);
+    CHECK(ledger.was_processed(mv, 7));
+
+    // releasing something never claimed is a no-op
+    ledger.release({0x3000, 0}, 7);
+    CHECK(ledger.get_stats().processed == 2);
+}
+
+void test_overflow() {
+    Ledger ledger{};
+
+    for (uintptr_t i = 0; i < Ledger::MAX_ENTRIES + 4; ++i) {
+        CHECK(ledger.claim({i, 0}, 1));
+    }
+
+    // untracked resources still run, tracked ones are still deduplicated
+    CHECK(ledger.get_stats().overflowed == 4);
+    CHECK(!ledger.claim({0, 0}, 1));
+    CHECK(ledger.claim({Ledger::MAX_ENTRIES + 1, 0}, 1));
+}
+
+void bench() {
+    Ledger ledger{};
+    uint64_t ran = 0;
+
+    // two evaluates per frame on the same motion vectors
+    check::bench("FramePassLedger::claim, 2 per frame", 1'000'000, [&](size_t i) {
+        ran += ledger.claim({0x1000, 0}, i / 2) ? 1 : 0;
+    });
+
+    CHECK(ran == 500'000);
+}
+} // namespace
+
+int main() {
+    test_once_per_frame();
+    test_release_on_failure();
+    test_overflow();
+    bench();
+
+    return check::result();
+}
@@ -0,0 +1,168 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <utility/GlyphRangeSet.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using utility::GlyphRangeSet;
+using Range = GlyphRangeSet::Range;
+
+void test_merging() {
+    GlyphRangeSet set{};
+
+    CHECK(set.add_range(0x100, 0x1FF));
+    CHECK(set.add_range(0x400, 0x4FF));
+
+    // already covered
+    CHECK(!set.add_range(0x120, 0x130));
+    CHECK(!set.add(0x4FF));
+
+    // adjacent ranges merge, reversed bounds are fine
+    CHECK(set.add_range(0x2FF, 0x200));
+    CHECK(set.ranges() == (std::vector<Range>{{0x100, 0x2FF}, {0x400, 0x4FF}}));
+
+    // one range swallowing everything in between
+    CHECK(set.add_range(0x50, 0x450));
+    CHECK(set.ranges() == (std::vector<Range>{{0x50, 0x4FF}}));
+
+    CHECK(set.add(0x10));
+    CHECK(set.contains(0x10) && !set.contains(0x11) && set.contains(0x4FF) && !set.contains(0x500));
+    CHECK(set.glyph_count() == 1 + 0x4FF - 0x50 + 1);
+
+    // up to the very end of the codepoint space
+    CHECK(set.add_range(0xFFFFFFF0u, 0xFFFFFFFFu));
+    CHECK(set.add_range(0xFFFFFF00u, 0xFFFFFFF0u));
+    CHECK(set.ranges().back() == (Range{0xFFFFFF00u, 0xFFFFFFFFu}));
+}
+
+void test_imgui_format() {
+    const uint16_t ranges[] = {0x0020, 0x00FF, 0x3000, 0x30FF, 0x0080, 0x0100, 0};
+
+    const GlyphRangeSet set{ranges};
+    CHECK(set.ranges() == (std::vector<Range>{{0x20, 0x100}, {0x3000, 0x30FF}}));
+    CHECK(set.to_flat<uint16_t>() == (std::vector<uint16_t>{0x20, 0x100, 0x3000, 0x30FF, 0}));
+
+    // a 16 bit ImWchar can't hold what's past the BMP, and 0 would end the list
+    GlyphRangeSet wide{};
+    wide.add_range(0, 0x10);
+    wide.add_range(0xFFF0, 0x10010);
+    wide.add_range(0x1F600, 0x1F64F);
+    CHECK(wide.to_flat<uint16_t>() == (std::vector<uint16_t>{1, 0x10, 0xFFF0, 0xFFFF, 0}));
+    CHECK(wide.to_flat<uint32_t>() == (std::vector<uint32_t>{1, 0x10, 0xFFF0, 0x10010, 0x1F600, 0x1F64F, 0}));
+
+    CHECK(GlyphRangeSet{(const uint16_t*)nullptr}.empty());
+    CHECK(GlyphRangeSet{}.to_flat<uint16_t>() == std::vector<uint16_t>{0});
+}
+
+void test_add_text() {
+    const uint16_t cjk[] = {0x4E00, 0x9FFF, 0};
+    const GlyphRangeSet universe{cjk};
+
+    GlyphRangeSet set{};
+    set.add_range(0x20, 0x7E);
+
+    // "设置 设置 OK": two new CJK glyphs, the repeats, the space and ASCII are already there
+    CHECK(set.add_text("\xE8\xAE\xBE\xE7\xBD\xAE \xE8\xAE\xBE\xE7\xBD\xAE OK", &universe) == 2);
+    CHECK(set.contains(0x8BBE) && set.contains(0x7F6E));
+    CHECK(set.add_text("\xE8\xAE\xBE\xE7\xBD\xAE", &universe) == 0);
+
+    // what the font can't provide isn't asked for: an emoji outside the universe
+    CHECK(set.add_text("\xF0\x9F\x98\x80", &universe) == 0);
+    CHECK(set.add_text("\xF0\x9F\x98\x80") == 1);
+    CHECK(set.contains(0x1F600));
+
+    // broken sequences decode to U+FFFD
+    std::vector<uint32_t> decoded{};
+    GlyphRangeSet::for_each_codepoint("a\xE8\xAE" "b\xFF", [&](uint32_t cp) { decoded.push_back(cp); });
+    CHECK(decoded == (std::vector<uint32_t>{'a', 0xFFFD, 0xFFFD, 'b', 0xFFFD}));
+}
+
+void test_hash() {
+    GlyphRangeSet a{};
+    a.add_range(0x20, 0x7E);
+    a.add(0x8BBE);
+    a.add(0x7F6E);
+
+    // same glyphs in another order, merged the same way, is the same atlas
+    GlyphRangeSet b{};
+    b.add(0x7F6E);
+    b.add_range(0x20, 0x50);
+    b.add(0x8BBE);
+    b.add_range(0x51, 0x7E);
+
+    CHECK(a == b);
+    CHECK(a.hash() == b.hash());
+    CHECK(a.hash(1) == b.hash(1));
+    CHECK(a.hash(1) != a.hash(2));
+
+    // one more glyph is another atlas
+    b.add(0x8BBF);
+    CHECK(a.hash() != b.hash());
+
+    // sets that only differ in one bound
+    GlyphRangeSet c{};
+    c.add_range(1, 2);
+    c.add_range(4, 5);
+    GlyphRangeSet d{};
+    d.add_range(1, 1);
+    d.add_range(4, 5);
+    CHECK(c.hash() != d.hash());
+    CHECK(GlyphRangeSet{}.hash() != c.hash());
+}
+
+void bench() {
+    // a UI's worth of CJK strings, most glyphs repeat
+    std::string text{};
+
+    for (uint32_t i = 0; i < 4096; ++i) {
+        const auto cp = 0x4E00 + (i * 7919) % 600 * 3;
+        text += (char)(0xE0 | (cp >> 12));
+        text += (char)(0x80 | ((cp >> 6) & 0x3F));
+        text += (char)(0x80 | (cp & 0x3F));
+        text += i % 8 == 0 ? " " : "";
+    }
+
+    const uint16_t cjk[] = {0x4E00, 0x9FFF, 0};
+    const GlyphRangeSet universe{cjk};
+
+    size_t added = 0;
+
+    check::bench("GlyphRangeSet::add_text, 4096 CJK chars", 1'000, [&](size_t) {
+        GlyphRangeSet set{};
+        set.add_range(0x20, 0xFF);
+        added = set.add_text(text, &universe);
+    });
+
+    CHECK(added == 600);
+
+    // the per frame case: everything in it was seen before
+    GlyphRangeSet seen{};
+    seen.add_text(text, &universe);
+
+    check::bench("GlyphRangeSet::add_text, 4096 CJK chars already in the set", 1'000, [&](size_t) {
+        added += seen.add_text(text, &universe);
+    });
+
+    CHECK(added == 600);
+
+    size_t flat_size = 0;
+    check::bench("GlyphRangeSet::to_flat + hash, 600 scattered glyphs", 10'000, [&](size_t i) {
+        flat_size = seen.to_flat<uint16_t>().size() + (seen.hash(i) == 0 ? 1 : 0);
+    });
+
+    CHECK(flat_size > 2);
+}
+} // namespace
+
+int main() {
+    test_merging();
+    test_imgui_format();
+    test_add_text();
+    test_hash();
+    bench();
+
+    return check::result();
+}
@@ -0,0 +1,223 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include <utility/HookWatchdog.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using namespace std::chrono_literals;
+using utility::HookWatchdog;
+
+// Far enough from the epoch that the initial grace/reset times don't matter
+const auto T0 = HookWatchdog::clock::time_point{} + 1000s;
+
+HookWatchdog::Inputs presenting(HookWatchdog::clock::time_point last_present) {
+    HookWatchdog::Inputs in{};
+    in.last_present = last_present;
+    return in;
+}
+
+void test_heartbeat() {
+    utility::Heartbeat heartbeat{};
+    CHECK(heartbeat.count() == 0);
+
+    heartbeat.beat(T0);
+    heartbeat.beat(T0 + 5ms);
+    CHECK(heartbeat.count() == 2);
+    CHECK(heartbeat.last() == T0 + 5ms);
+}
+
+void test_present_timeout_and_last_chance() {
+    HookWatchdog watchdog{};
+
+    CHECK(watchdog.evaluate(presenting(T0), T0 + 1s) == HookWatchdog::NONE);
+    CHECK(watchdog.next_deadline() == T0 + 5s + 1ms);
+
+    // stale, but gets one more second in case the game is just paused in a debugger
+    CHECK(watchdog.evaluate(presenting(T0), T0 + 6s) == HookWatchdog::NONE);
+    CHECK(watchdog.get_present_state() == HookWatchdog::PresentState::LAST_CHANCE);
+    CHECK(watchdog.next_deadline() == T0 + 7s + 1ms);
+
+    CHECK(watchdog.evaluate(presenting(T0), T0 + 6500ms) == HookWatchdog::NONE);
+    CHECK(watchdog.evaluate(presenting(T0), T0 + 7s + 1ms) == HookWatchdog::REHOOK_D3D);
+    CHECK(watchdog.get_present_state() == HookWatchdog::PresentState::HEALTHY);
+
+    // grace period, no rehook storm while the new hook comes up
+    CHECK(watchdog.evaluate(presenting(T0), T0 + 8s) == HookWatchdog::NONE);
+    CHECK(watchdog.evaluate(presenting(T0), T0 + 12s) == HookWatchdog::NONE);
+    CHECK(watchdog.next_deadline() == T0 + 7s + 1ms + 5s + 5s + 1ms);
+
+    CHECK(watchdog.get_stats().last_chances == 1);
+    CHECK(watchdog.get_stats().d3d_rehooks == 1);
+    CHECK(watchdog.get_stats().evaluations == 6);
+}
+
+void test_present_recovers_during_last_chance() {
+    HookWatchdog watchdog{};
+
+    watchdog.evaluate(presenting(T0), T0 + 6s);
+    CHECK(watchdog.get_present_state() == HookWatchdog::PresentState::LAST_CHANCE);
+
+    CHECK(watchdog.evaluate(presenting(T0 + 6500ms), T0 + 7500ms) == HookWatchdog::NONE);
+    CHECK(watchdog.get_present_state() == HookWatchdog::PresentState::HEALTHY);
+    CHECK(watchdog.get_stats().d3d_rehooks == 0);
+}
+
+void test_stuck_inside_present_never_rehooks() {
+    HookWatchdog watchdog{};
+    auto in = presenting(T0);
+    in.inside_present = true;
+
+    CHECK(watchdog.evaluate(in, T0 + 60s) == HookWatchdog::NONE);
+    CHECK(watchdog.get_present_state() == HookWatchdog::PresentState::HEALTHY);
+    CHECK(watchdog.next_deadline() == T0 + 61s);
+}
+
+void test_message_probe_and_rehook() {
+    HookWatchdog watchdog{};
+
+    const auto messages = [](HookWatchdog::clock::time_point now, HookWatchdog::clock::time_point last_message) {
+        auto in = presenting(now);
+        in.last_message = last_message;
+        in.message_hook_active = true;
+        return in;
+    };
+
+    CHECK(watchdog.evaluate(messages(T0 + 4s, T0), T0 + 4s) == HookWatchdog::NONE);
+    CHECK(watchdog.next_deadline() == T0 + 5s + 1ms);
+
+    // quiet for too long, poke the window first
+    CHECK(watchdog.evaluate(messages(T0 + 6s, T0), T0 + 6s) == HookWatchdog::SEND_MESSAGE_PROBE);
+    CHECK(watchdog.next_deadline() == T0 + 7s + 1ms);
+    CHECK(watchdog.evaluate(messages(T0 + 6500ms, T0), T0 + 6500ms) == HookWatchdog::NONE);
+
+    // the probe never arrived
+    CHECK(watchdog.evaluate(messages(T0 + 7100ms, T0), T0 + 7100ms) == HookWatchdog::REHOOK_MESSAGES);
+    CHECK(watchdog.get_stats().probes == 1);
+    CHECK(watchdog.get_stats().message_rehooks == 1);
+
+    // within the grace period
+    CHECK(watchdog.evaluate(messages(T0 + 12s, T0), T0 + 12s) == HookWatchdog::NONE);
+}
+
+void test_message_probe_answered() {
+    HookWatchdog watchdog{};
+
+    auto in = presenting(T0 + 6s);
+    in.last_message = T0;
+    in.message_hook_active = true;
+    CHECK(watchdog.evaluate(in, T0 + 6s) == HookWatchdog::SEND_MESSAGE_PROBE);
+
+    in.last_present = T0 + 6500ms;
+    in.last_message = T0 + 6200ms;
+    CHECK(watchdog.evaluate(in, T0 + 6500ms) == HookWatchdog::NONE);
+
+    // a later quiet period probes again instead of rehooking right away
+    in.last_present = T0 + 12s;
+    CHECK(watchdog.evaluate(in, T0 + 12s) == HookWatchdog::SEND_MESSAGE_PROBE);
+    CHECK(watchdog.get_stats().message_rehooks == 0);
+}
+
+void test_intact_message_hook_isnt_probed() {
+    HookWatchdog watchdog{};
+
+    auto in = presenting(T0 + 6s);
+    in.last_message = T0;
+    in.message_hook_active = true;
+    in.message_hook_intact = true;
+
+    // a game that just doesn't get messages (e.g. fullscreen, no input)
+    CHECK(watchdog.evaluate(in, T0 + 6s) == HookWatchdog::NONE);
+    CHECK(watchdog.get_stats().intact_checks == 1);
+
+    in.last_present = T0 + 8s;
+    CHECK(watchdog.evaluate(in, T0 + 8s) == HookWatchdog::NONE);
+    CHECK(watchdog.get_stats().intact_checks == 1);
+    CHECK(watchdog.next_deadline() == T0 + 11s + 1ms);
+}
+
+void test_present_gate() {
+    std::recursive_mutex mutex{};
+    utility::PresentGate gate{mutex};
+
+    // exclusive work waits for presents in flight, and gives up on a stuck one
+    {
+        auto scope = gate.enter();
+        CHECK(gate.in_flight() == 1);
+
+        bool ran = false;
+        std::jthread rehook{[&] { CHECK(!gate.run_exclusive([&] { ran = true; }, 20ms)); }};
+        rehook.join();
+        CHECK(!ran);
+    }
+
+    CHECK(gate.in_flight() == 0);
+
+    bool ran = false;
+    CHECK(gate.run_exclusive([&] { ran = true; }));
+    CHECK(ran);
+
+    // a present arriving during exclusive work waits for it
+    std::atomic<bool> started{false};
+    std::atomic<bool> done{false};
+
+    std::jthread rehook{[&] {
+        gate.run_exclusive([&] {
+            started = true;
+            std::this_thread::sleep_for(30ms);
+            done = true;
+        });
+    }};
+
+    while (!started.load()) {
+        std::this_thread::yield();
+    }
+
+    {
+        auto scope = gate.enter();
+        CHECK(done.load());
+        CHECK(gate.in_flight() == 0); // went through the mutex
+    }
+
+    rehook.join();
+}
+
+void bench() {
+    HookWatchdog watchdog{};
+    uint32_t actions = 0;
+
+    check::bench("HookWatchdog::evaluate", 1'000'000, [&](size_t i) {
+        const auto now = T0 + std::chrono::milliseconds(i);
+        auto in = presenting(now);
+        in.last_message = now;
+        in.message_hook_active = true;
+        actions |= watchdog.evaluate(in, now);
+    });
+
+    CHECK(actions == HookWatchdog::NONE);
+
+    std::recursive_mutex mutex{};
+    utility::PresentGate gate{mutex};
+
+    check::bench("PresentGate::enter, open gate", 1'000'000, [&](size_t) {
+        auto scope = gate.enter();
+    });
+}
+} // namespace
+
+int main() {
+    test_heartbeat();
+    test_present_timeout_and_last_chance();
+    test_present_recovers_during_last_chance();
+    test_stuck_inside_present_never_rehooks();
+    test_message_probe_and_rehook();
+    test_message_probe_answered();
+    test_intact_message_hook_isnt_probed();
+    test_present_gate();
+    bench();
+
+    return check::result();
+}
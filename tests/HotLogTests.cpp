@@ -0,0 +1,400 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include <utility/HotLog.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using utility::LogRateLimiter;
+
+constexpr int64_t SECOND = 1'000'000'000;
+constexpr int64_t MS = 1'000'000;
+
+struct Captured {
+    spdlog::level::level_enum level{};
+    spdlog::log_clock::time_point time{};
+    size_t thread_id{};
+    std::string text{};
+};
+
+class CaptureSink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+    std::vector<Captured> messages{};
+    size_t flushes{0};
+
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override {
+        messages.push_back(Captured{msg.level, msg.time, msg.thread_id, std::string{msg.payload.data(), msg.payload.size()}});
+    }
+
+    void flush_() override {
+        ++flushes;
+    }
+};
+
+std::shared_ptr<spdlog::logger> make_logger(std::shared_ptr<CaptureSink> sink) {
+    auto logger = std::make_shared<spdlog::logger>("hot_log_test", sink);
+    logger->set_level(spdlog::level::trace);
+    logger->flush_on(spdlog::level::err);
+    return logger;
+}
+
+void test_burst_and_refill() {
+    // 10 per second, 3 at once
+    LogRateLimiter limiter{10.0, 3};
+    const auto t = 100 * SECOND;
+    uint64_t suppressed = 0;
+
+    for (int i = 0; i < 3; ++i) {
+        CHECK(limiter.try_acquire(t, suppressed));
+        CHECK(suppressed == 0);
+    }
+
+    for (int i = 0; i < 7; ++i) {
+        CHECK(!limiter.try_acquire(t, suppressed));
+    }
+
+    CHECK(limiter.get_pending() == 7);
+
+    // one interval later one more gets through and reports what was dropped before it
+    CHECK(!limiter.try_acquire(t + 99 * MS, suppressed));
+    CHECK(limiter.try_acquire(t + 100 * MS, suppressed));
+    CHECK(suppressed == 8);
+    CHECK(limiter.get_pending() == 0);
+    CHECK(!limiter.try_acquire(t + 100 * MS, suppressed));
+
+    // idle long enough and the whole burst is back, not more
+    size_t passed = 0;
+
+    for (int i = 0; i < 10; ++i) {
+        passed += limiter.try_acquire(t + 60 * SECOND, suppressed) ? 1 : 0;
+    }
+
+    CHECK(passed == 3);
+
+    // every call is accounted for once
+    CHECK(limiter.get_passed() == 3 + 1 + 3);
+    CHECK(limiter.get_suppressed() == 7 + 1 + 1 + 7);
+}
+
+void test_steady_rate() {
+    LogRateLimiter limiter{10.0, 3};
+    const auto t = 100 * SECOND;
+    uint64_t suppressed = 0;
+    uint64_t reported = 0;
+
+    // a call every millisecond for 10 seconds: the burst, then 10 per second
+    for (int64_t ms = 0; ms < 10'000; ++ms) {
+        if (limiter.try_acquire(t + ms * MS, suppressed)) {
+            reported += suppressed;
+        }
+    }
+
+    CHECK(limiter.get_passed() >= 102 && limiter.get_passed() <= 104);
+    CHECK(limiter.get_passed() + limiter.get_suppressed() == 10'000);
+    CHECK(reported + limiter.get_pending() == limiter.get_suppressed());
+}
+
+void test_concurrent_accounting() {
+    LogRateLimiter limiter{1000.0, 10};
+    constexpr size_t THREADS = 8;
+    constexpr size_t CALLS = 100'000;
+
+    std::atomic<uint64_t> passed{0};
+    std::atomic<uint64_t> reported{0};
+    std::vector<std::thread> threads{};
+
+    for (size_t i = 0; i < THREADS; ++i) {
+        threads.emplace_back([&] {
+            for (size_t j = 0; j < CALLS; ++j) {
+                uint64_t suppressed = 0;
+
+                if (limiter.try_acquire(suppressed)) {
+                    passed.fetch_add(1);
+                    reported.fetch_add(suppressed);
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // nothing lost or counted twice between the threads
+    CHECK(limiter.get_passed() == passed.load());
+    CHECK(limiter.get_passed() + limiter.get_suppressed() == THREADS * CALLS);
+    CHECK(reported.load() + limiter.get_pending() == limiter.get_suppressed());
+
+    // all at the same instant: exactly the burst
+    LogRateLimiter instant{1.0, 10};
+    threads.clear();
+
+    for (size_t i = 0; i < THREADS; ++i) {
+        threads.emplace_back([&] {
+            uint64_t suppressed = 0;
+
+            for (size_t j = 0; j < 1000; ++j) {
+                instant.try_acquire(SECOND, suppressed);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(instant.get_passed() == 10);
+    CHECK(instant.get_suppressed() == THREADS * 1000 - 10);
+}
+
+void test_ring() {
+    utility::LogRing<4, 16> ring{};
+    const auto now = spdlog::log_clock::now();
+
+    for (size_t i = 0; i < 4; ++i) {
+        const utility::LogRecord record{spdlog::level::warn, now + std::chrono::seconds(i), 100 + i};
+
+        CHECK(ring.push(record, [&](char* out, size_t capacity) {
+            return (size_t)(fmt::format_to_n(out, capacity, "message {} that is cut off", i).out - out);
+        }));
+    }
+
+    // full, the producer doesn't wait
+    CHECK(!ring.push(utility::LogRecord{}, [](char*, size_t) { return (size_t)0; }));
+    CHECK(ring.get_dropped() == 1);
+
+    size_t i = 0;
+    bool in_order = true;
+
+    ring.drain([&](const utility::LogRecord& record, std::string_view text) {
+        in_order &= record.level == spdlog::level::warn && record.time == now + std::chrono::seconds(i) && record.thread_id == 100 + i;
+        in_order &= text == fmt::format("message {} that is cut off", i).substr(0, 16);
+        ++i;
+    });
+
+    CHECK(i == 4 && in_order);
+    CHECK(ring.push(utility::LogRecord{}, [](char*, size_t) { return (size_t)0; }));
+}
+
+void test_keeps_producer_time_and_thread() {
+    auto sink = std::make_shared<CaptureSink>();
+    auto logger = make_logger(sink);
+    auto hot_log = std::make_unique<utility::HotLog>(logger, std::chrono::milliseconds(1));
+
+    size_t producer_id = 0;
+    spdlog::log_clock::time_point before{};
+    spdlog::log_clock::time_point after{};
+
+    std::thread producer{[&] {
+        producer_id = spdlog::details::os::thread_id();
+        before = spdlog::log_clock::now();
+        hot_log->log(spdlog::level::info, 0, "frame {}", 1);
+        hot_log->log(spdlog::level::err, 5, "frame {}", 2);
+        after = spdlog::log_clock::now();
+    }};
+
+    producer.join();
+
+    // the worker writes it later, the time and thread are still the producer's
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    hot_log.reset();
+
+    CHECK(sink->messages.size() == 2);
+
+    if (sink->messages.size() == 2) {
+        const auto& first = sink->messages[0];
+        const auto& second = sink->messages[1];
+
+        CHECK(first.thread_id == producer_id && second.thread_id == producer_id);
+        CHECK(producer_id != spdlog::details::os::thread_id());
+        CHECK(first.time >= before && first.time <= second.time && second.time <= after);
+        CHECK(first.level == spdlog::level::info && first.text == "frame 1");
+        CHECK(second.level == spdlog::level::err && second.text == "frame 2 (5 similar messages suppressed)");
+    }
+
+    // the error was flushed, like the logger would have
+    CHECK(sink->flushes >= 1);
+}
+
+// ~Framework unpublishes and destroys its HotLog while other threads are still logging
+void test_unpublish_while_logging() {
+    auto sink = std::make_shared<CaptureSink>();
+    auto logger = make_logger(sink);
+    const auto previous = spdlog::default_logger();
+    spdlog::set_default_logger(logger);
+
+    auto hot_log = std::make_unique<utility::HotLog>(logger, std::chrono::milliseconds(1));
+    utility::g_hot_log.publish(hot_log.get());
+
+    // effectively no limit, every call gets through
+    LogRateLimiter limiter{1e9, 1'000'000};
+    std::atomic<bool> done{false};
+    std::vector<std::thread> producers{};
+
+    for (int i = 0; i < 4; ++i) {
+        producers.emplace_back([&] {
+            while (!done.load()) {
+                utility::hot_log(limiter, spdlog::level::info, "message");
+            }
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    utility::g_hot_log.unpublish();
+
+    // nothing can push anymore, what's left is written out on destruction
+    const auto dropped = hot_log->get_stats().dropped;
+    hot_log.reset();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    done = true;
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    spdlog::set_default_logger(previous);
+
+    // queued, dropped by a full ring, or logged directly after unpublish: every message that passed is one of them.
+    // Logged directly, a suppressed count comes as a line of its own.
+    size_t logged = 0;
+
+    for (const auto& message : sink->messages) {
+        logged += message.text.starts_with("message") ? 1 : 0;
+    }
+
+    CHECK(logged + dropped == limiter.get_passed());
+}
+
+// N threads calling `fn` at once, time per call like check::bench plus the latency distribution.
+// Every SAMPLE_EVERY-th call is timed on its own, the percentiles include one clock read.
+template <typename Fn>
+void bench_contended(const char* name, size_t threads, size_t iterations, Fn&& fn) {
+    constexpr size_t SAMPLE_EVERY = 8;
+
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers{};
+    std::vector<std::vector<int64_t>> samples(threads);
+
+    for (size_t t = 0; t < threads; ++t) {
+        samples[t].reserve(iterations / SAMPLE_EVERY + 1);
+
+        workers.emplace_back([&, t] {
+            auto& out = samples[t];
+
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+
+            for (size_t i = 0; i < iterations; ++i) {
+                if (i % SAMPLE_EVERY != 0) {
+                    fn(i);
+                    continue;
+                }
+
+                const auto call_start = std::chrono::steady_clock::now();
+                fn(i);
+                out.push_back((std::chrono::steady_clock::now() - call_start).count());
+            }
+        });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    go = true;
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<int64_t> all{};
+
+    for (const auto& thread_samples : samples) {
+        all.insert(all.end(), thread_samples.begin(), thread_samples.end());
+    }
+
+    std::sort(all.begin(), all.end());
+
+    const auto percentile = [&](double p) {
+        const auto ns_per_tick = 1e9 * std::chrono::steady_clock::period::num / std::chrono::steady_clock::period::den;
+        return all.empty() ? 0.0 : (double)all[std::min(all.size() - 1, (size_t)(p * (double)all.size()))] * ns_per_tick;
+    };
+
+    std::printf("[bench] %s: %.1f ns/iter, p50 %.0f ns, p99 %.0f ns, p99.9 %.0f ns, max %.0f ns (%zu threads x %zu iterations)\n", name,
+        elapsed / (double)iterations, percentile(0.5), percentile(0.99), percentile(0.999), percentile(1.0), threads, iterations);
+}
+
+void bench() {
+    // what a hot path pays when its message is suppressed, the common case
+    LogRateLimiter single{10.0, 30};
+    uint64_t suppressed = 0;
+
+    check::bench("LogRateLimiter::try_acquire, 1 thread", 1'000'000, [&](size_t) {
+        single.try_acquire(suppressed);
+    });
+
+    const auto threads = std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+
+    // every thread on the same call site, e.g. the per event log of several workers
+    LogRateLimiter shared{10.0, 30};
+    bench_contended("LogRateLimiter::try_acquire, shared limiter", threads, 1'000'000, [&](size_t) {
+        uint64_t s = 0;
+        shared.try_acquire(s);
+    });
+
+    CHECK(shared.get_passed() + shared.get_suppressed() == (uint64_t)threads * 1'000'000);
+
+    // and the messages that do get through, pushed from all threads into one HotLog
+    auto logger = std::make_shared<spdlog::logger>("hot_log_bench", std::make_shared<spdlog::sinks::null_sink_mt>());
+    utility::HotLog hot_log{logger};
+
+    bench_contended("HotLog::log, contended push", threads, 100'000, [&](size_t i) {
+        hot_log.log(spdlog::level::info, 0, "frame {} took {} ms", i, 1.5f);
+    });
+
+    // the whole VR_HOT_LOG path, every thread on one call site like the per frame OpenXR logs
+    const auto previous = spdlog::default_logger();
+    spdlog::set_default_logger(logger);
+
+    auto published = std::make_unique<utility::HotLog>(logger);
+    utility::g_hot_log.publish(published.get());
+
+    bench_contended("VR_HOT_LOG, 10/s, contended", threads, 1'000'000, [&](size_t i) {
+        VR_HOT_LOG(spdlog::level::info, 10.0, 30, "frame {} took {} ms", i, 1.5f);
+    });
+
+    // nothing suppressed, every call formats and queues
+    bench_contended("VR_HOT_LOG, unlimited, contended", threads, 100'000, [&](size_t i) {
+        VR_HOT_LOG(spdlog::level::info, 1e9, 1'000'000, "frame {} took {} ms", i, 1.5f);
+    });
+
+    utility::g_hot_log.unpublish();
+    published.reset();
+    spdlog::set_default_logger(previous);
+}
+} // namespace
+
+int main() {
+    test_burst_and_refill();
+    test_steady_rate();
+    test_concurrent_accounting();
+    test_ring();
+    test_keeps_producer_time_and_thread();
+    test_unpublish_while_logging();
+    bench();
+
+    return check::result();
+}
@@ -0,0 +1,125 @@
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <utility/ModuleLoadRegistry.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using utility::ModuleLoadRegistry;
+
+// Stands in for GetModuleHandle plus the loader notification
+struct FakeLoader {
+    std::mutex mtx{};
+    std::set<std::string> loaded{};
+
+    ModuleLoadRegistry::Query query() {
+        return [this](std::string_view name) -> ModuleLoadRegistry::Handle {
+            std::scoped_lock _{mtx};
+
+            for (const auto& module : loaded) {
+                if (ModuleLoadRegistry::name_equals(module, name)) {
+                    return handle(module);
+                }
+            }
+
+            return nullptr;
+        };
+    }
+
+    static ModuleLoadRegistry::Handle handle(std::string_view name) {
+        return (ModuleLoadRegistry::Handle)(0x10000 + name.size() * 0x1000);
+    }
+
+    size_t load(ModuleLoadRegistry& registry, const std::string& name) {
+        {
+            std::scoped_lock _{mtx};
+            loaded.insert(name);
+        }
+
+        return registry.notify_loaded(name, handle(name));
+    }
+};
+
+void test_name_equals() {
+    CHECK(ModuleLoadRegistry::name_equals("XInput1_4.dll", "xinput1_4.DLL"));
+    CHECK(!ModuleLoadRegistry::name_equals("xinput1_4.dll", "xinput1_3.dll"));
+    CHECK(!ModuleLoadRegistry::name_equals("xinput1_4.dll", "xinput1_4.dl"));
+}
+
+void test_already_loaded_runs_immediately() {
+    FakeLoader loader{};
+    loader.loaded.insert("sl.interposer.dll");
+
+    ModuleLoadRegistry registry{loader.query()};
+    ModuleLoadRegistry::Handle got{};
+
+    CHECK(registry.on_load("SL.Interposer.dll", [&](ModuleLoadRegistry::Handle h) { got = h; }));
+    CHECK(got == FakeLoader::handle("sl.interposer.dll"));
+    CHECK(registry.pending() == 0);
+}
+
+void test_deferred_until_loaded() {
+    FakeLoader loader{};
+    ModuleLoadRegistry registry{loader.query()};
+    int xinput = 0;
+    int ffx = 0;
+
+    CHECK(!registry.on_load("xinput1_4.dll", [&](ModuleLoadRegistry::Handle) { ++xinput; }));
+    CHECK(!registry.on_load("xinput1_4.dll", [&](ModuleLoadRegistry::Handle) { ++xinput; }));
+    CHECK(!registry.on_load("amd_fidelityfx_dx12.dll", [&](ModuleLoadRegistry::Handle) { ++ffx; }));
+    CHECK(registry.pending() == 3);
+    CHECK(registry.is_pending("XINPUT1_4.DLL"));
+
+    CHECK(loader.load(registry, "unrelated.dll") == 0);
+    CHECK(loader.load(registry, "XInput1_4.dll") == 2);
+    CHECK(xinput == 2);
+    CHECK(ffx == 0);
+    CHECK(!registry.is_pending("xinput1_4.dll"));
+
+    // a second load notification (unload + reload) has nothing left to run
+    CHECK(loader.load(registry, "xinput1_4.dll") == 0);
+    CHECK(xinput == 2);
+
+    CHECK(loader.load(registry, "amd_fidelityfx_dx12.dll") == 1);
+    CHECK(ffx == 1);
+    CHECK(registry.pending() == 0);
+}
+
+// A load reported while on_load is between registering and querying must run the callback exactly once
+void test_racing_load_runs_once() {
+    for (int round = 0; round < 200; ++round) {
+        FakeLoader loader{};
+        ModuleLoadRegistry registry{loader.query()};
+        std::atomic<int> calls{0};
+        std::atomic<bool> go{false};
+
+        std::jthread loader_thread{[&] {
+            while (!go.load()) {
+            }
+
+            loader.load(registry, "late.dll");
+        }};
+
+        go = true;
+        registry.on_load("late.dll", [&](ModuleLoadRegistry::Handle) { ++calls; });
+        loader_thread.join();
+
+        CHECK(calls.load() == 1);
+        CHECK(registry.pending() == 0);
+    }
+}
+} // namespace
+
+int main() {
+    test_name_equals();
+    test_already_loaded_runs_immediately();
+    test_deferred_until_loaded();
+    test_racing_load_runs_once();
+
+    return check::result();
+}
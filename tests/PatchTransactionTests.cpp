@@ -0,0 +1,294 @@
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <utility/PatchTransaction.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using utility::PatchTransaction;
+
+constexpr uint32_t NO_ACCESS = 0;
+constexpr uint32_t EXECUTE = 1;      // execute only, can't be read until unprotected
+constexpr uint32_t EXECUTE_READ = 2;
+constexpr uint32_t READ_WRITE = 3;
+
+// A plain buffer standing in for the process, with page protections that are enforced
+class BufferBackend : public utility::PatchMemoryBackend {
+public:
+    static constexpr uintptr_t BASE = 0x140000000;
+    static constexpr size_t PAGE_SIZE = 0x1000;
+
+    std::vector<uint8_t> memory{};
+    std::map<uintptr_t, uint32_t> protection{};
+
+    std::optional<uintptr_t> fail_unprotect_page{};
+    std::optional<size_t> fail_write_call{};
+
+    size_t unprotects{0};
+    size_t protects{0};
+    size_t writes{0};
+    size_t flushes{0};
+    uintptr_t flushed_begin{0};
+    size_t flushed_size{0};
+
+    explicit BufferBackend(size_t pages = 8, uint32_t initial = EXECUTE_READ) : memory(pages * PAGE_SIZE) {
+        for (size_t i = 0; i < pages; ++i) {
+            protection[BASE + i * PAGE_SIZE] = initial;
+        }
+
+        for (size_t i = 0; i < memory.size(); ++i) {
+            memory[i] = (uint8_t)(i * 31);
+        }
+    }
+
+    size_t page_size() const override {
+        return PAGE_SIZE;
+    }
+
+    std::optional<uint32_t> unprotect(uintptr_t page) override {
+        ++unprotects;
+
+        if (fail_unprotect_page == page || !protection.contains(page)) {
+            return std::nullopt;
+        }
+
+        return std::exchange(protection[page], READ_WRITE);
+    }
+
+    bool protect(uintptr_t page, uint32_t value) override {
+        ++protects;
+        protection[page] = value;
+        return true;
+    }
+
+    bool read(uintptr_t address, uint8_t* out, size_t size) override {
+        if (!accessible(address, size, false)) {
+            return false;
+        }
+
+        std::copy_n(&memory[address - BASE], size, out);
+        return true;
+    }
+
+    bool write(uintptr_t address, const uint8_t* data, size_t size) override {
+        if (writes++ == fail_write_call) {
+            // partially written, like a fault in the middle of the copy
+            std::copy_n(data, size / 2, &memory[address - BASE]);
+            return false;
+        }
+
+        if (!accessible(address, size, true)) {
+            return false;
+        }
+
+        std::copy_n(data, size, &memory[address - BASE]);
+        return true;
+    }
+
+    void flush_instruction_cache(uintptr_t address, size_t size) override {
+        ++flushes;
+        flushed_begin = address;
+        flushed_size = size;
+    }
+
+    bool all_protected(uint32_t value) const {
+        for (const auto& [page, p] : protection) {
+            if (p != value) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::vector<uint8_t> bytes(uintptr_t address, size_t size) const {
+        return std::vector<uint8_t>{memory.begin() + (address - BASE), memory.begin() + (address - BASE) + size};
+    }
+
+private:
+    bool accessible(uintptr_t address, size_t size, bool write) const {
+        for (auto page = address & ~(PAGE_SIZE - 1); page < address + size; page += PAGE_SIZE) {
+            const auto it = protection.find(page);
+
+            if (it == protection.end() || it->second == NO_ACCESS || it->second == EXECUTE || (write && it->second != READ_WRITE)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
+constexpr uintptr_t at(size_t page, size_t offset) {
+    return BufferBackend::BASE + page * BufferBackend::PAGE_SIZE + offset;
+}
+
+void test_commit_and_rollback() {
+    BufferBackend backend{};
+    const auto before = backend.memory;
+
+    PatchTransaction transaction{backend};
+    CHECK(transaction.add(at(2, 0x10), {0xC3}));
+    CHECK(transaction.add(at(0, 0x20), {0x90, 0x90}));
+    CHECK(transaction.add(at(0, 0x40), {0xEB, 0xFE}));
+
+    // overlapping and empty patches are refused
+    CHECK(!transaction.add(at(0, 0x21), {0xCC}));
+    CHECK(!transaction.add(at(1, 0), {}));
+
+    CHECK(transaction.commit());
+    CHECK(transaction.is_committed());
+    CHECK(backend.bytes(at(2, 0x10), 1) == std::vector<uint8_t>{0xC3});
+    CHECK(backend.bytes(at(0, 0x20), 2) == (std::vector<uint8_t>{0x90, 0x90}));
+    CHECK(backend.all_protected(EXECUTE_READ));
+
+    // one flush over everything, from the lowest patch to the end of the highest
+    CHECK(backend.flushes == 1);
+    CHECK(backend.flushed_begin == at(0, 0x20));
+    CHECK(backend.flushed_size == at(2, 0x11) - at(0, 0x20));
+
+    // two pages, each made writable and put back once
+    const auto stats = transaction.get_stats();
+    CHECK(stats.patches == 3 && stats.pages == 2);
+    CHECK(stats.protection_changes == 4);
+    CHECK(stats.unbatched_protection_changes == 6);
+    CHECK(stats.flushes == 1);
+    CHECK(backend.unprotects == 2 && backend.protects == 2);
+
+    CHECK(!transaction.add(at(3, 0), {0xC3}));
+    CHECK(!transaction.commit());
+
+    CHECK(transaction.rollback());
+    CHECK(backend.memory == before);
+    CHECK(backend.all_protected(EXECUTE_READ));
+    CHECK(!transaction.rollback());
+}
+
+void test_execute_only_pages() {
+    // the originals can only be read once the page is unprotected
+    BufferBackend backend{4, EXECUTE};
+    const auto before = backend.memory;
+
+    PatchTransaction transaction{backend};
+    transaction.add(at(1, 0x100), {0xC3, 0xCC});
+    CHECK(transaction.commit());
+    CHECK(backend.all_protected(EXECUTE));
+
+    CHECK(transaction.rollback());
+    CHECK(backend.memory == before);
+}
+
+void test_page_straddling_patch() {
+    BufferBackend backend{};
+
+    PatchTransaction transaction{backend};
+    transaction.add(at(3, BufferBackend::PAGE_SIZE - 2), {1, 2, 3, 4, 5});
+    CHECK(transaction.commit());
+    CHECK(transaction.get_stats().pages == 2);
+    CHECK(backend.bytes(at(3, BufferBackend::PAGE_SIZE - 2), 5) == (std::vector<uint8_t>{1, 2, 3, 4, 5}));
+}
+
+void test_failed_write_undoes_everything() {
+    BufferBackend backend{};
+    const auto before = backend.memory;
+    backend.fail_write_call = 2;
+
+    PatchTransaction transaction{backend};
+    transaction.add(at(0, 0x10), {0xC3, 0xC3, 0xC3, 0xC3});
+    transaction.add(at(1, 0x10), {0xC3, 0xC3, 0xC3, 0xC3});
+    transaction.add(at(2, 0x10), {0xC3, 0xC3, 0xC3, 0xC3});
+    transaction.add(at(3, 0x10), {0xC3, 0xC3, 0xC3, 0xC3});
+
+    // the third one fails half way
+    CHECK(!transaction.commit());
+    CHECK(!transaction.is_committed());
+    CHECK(backend.memory == before);
+    CHECK(backend.all_protected(EXECUTE_READ));
+    CHECK(!transaction.rollback());
+}
+
+void test_failed_unprotect_writes_nothing() {
+    BufferBackend backend{};
+    const auto before = backend.memory;
+    backend.fail_unprotect_page = at(2, 0);
+
+    PatchTransaction transaction{backend};
+    transaction.add(at(0, 0x10), {0xC3});
+    transaction.add(at(2, 0x10), {0xC3});
+
+    CHECK(!transaction.commit());
+    CHECK(backend.writes == 0);
+    CHECK(backend.flushes == 0);
+    CHECK(backend.memory == before);
+
+    // the page that did get unprotected was put back
+    CHECK(backend.protects == 1);
+    CHECK(backend.all_protected(EXECUTE_READ));
+}
+
+void test_unmapped_memory() {
+    BufferBackend backend{};
+    backend.protection.erase(at(6, 0));
+
+    PatchTransaction transaction{backend};
+    transaction.add(at(6, 0x10), {0xC3});
+    CHECK(!transaction.commit());
+    CHECK(backend.writes == 0);
+}
+
+void bench() {
+    // 64 patches in 8 pages, e.g. a mod disabling a batch of checks at startup
+    std::vector<std::pair<uintptr_t, std::vector<uint8_t>>> patches{};
+
+    for (size_t i = 0; i < 64; ++i) {
+        patches.emplace_back(at(i % 8, 0x40 * (i / 8)), std::vector<uint8_t>{0x90, 0x90, 0xC3});
+    }
+
+    uint64_t batched_changes = 0;
+    uint64_t unbatched_changes = 0;
+
+    check::bench("PatchTransaction, 64 patches in one commit", 10'000, [&](size_t) {
+        BufferBackend backend{};
+        PatchTransaction transaction{backend};
+
+        for (const auto& [address, bytes] : patches) {
+            transaction.add(address, bytes);
+        }
+
+        transaction.commit();
+        batched_changes = transaction.get_stats().protection_changes;
+    });
+
+    check::bench("PatchTransaction, 64 single patch commits", 10'000, [&](size_t) {
+        BufferBackend backend{};
+        unbatched_changes = 0;
+
+        for (const auto& [address, bytes] : patches) {
+            PatchTransaction transaction{backend};
+            transaction.add(address, bytes);
+            transaction.commit();
+            unbatched_changes += transaction.get_stats().protection_changes;
+        }
+    });
+
+    CHECK(batched_changes == 16);
+    CHECK(unbatched_changes == 128);
+}
+} // namespace
+
+int main() {
+    test_commit_and_rollback();
+    test_execute_only_pages();
+    test_page_straddling_patch();
+    test_failed_write_undoes_everything();
+    test_failed_unprotect_writes_nothing();
+    test_unmapped_memory();
+    bench();
+
+    return check::result();
+}
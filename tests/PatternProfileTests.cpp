@@ -0,0 +1,252 @@
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <utility/PatternProfile.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using utility::ProfileCheck;
+using utility::ProfileEntry;
+
+constexpr size_t FUNCTION = 0x1000;
+constexpr size_t PROLOGUE_SIZE = 32;
+
+// A PE image as far as read_image_identity cares, plus one function
+struct Image {
+    std::vector<uint8_t> bytes{};
+
+    explicit Image(size_t size = 0x10000, uint32_t timestamp = 0x5F00AA01) : bytes(size) {
+        put<uint16_t>(0, 0x5A4D);
+        put<uint32_t>(0x3C, 0x80);
+        put<uint32_t>(0x80, 0x00004550);
+        put<uint32_t>(0x88, timestamp);
+        put<uint32_t>(0x80 + 24 + 56, (uint32_t)size);
+        put<uint32_t>(0x80 + 24 + 60, 0x400);
+
+        // push rbx; sub rsp, 20h; mov rbx, rcx; ... then something that tells it apart
+        const uint8_t prologue[] = {0x40, 0x53, 0x48, 0x83, 0xEC, 0x20, 0x48, 0x8B, 0xD9};
+        std::memcpy(&bytes[FUNCTION], prologue, sizeof(prologue));
+
+        for (size_t i = sizeof(prologue); i < PROLOGUE_SIZE; ++i) {
+            bytes[FUNCTION + i] = (uint8_t)(i * 7);
+        }
+    }
+
+    template <typename T>
+    void put(size_t offset, T value) {
+        std::memcpy(&bytes[offset], &value, sizeof(T));
+    }
+
+    utility::ImageView view() const {
+        return utility::ImageView{(uintptr_t)bytes.data(), bytes.size()};
+    }
+
+    ProfileEntry describe(size_t offset, size_t size) const {
+        return ProfileEntry{offset, std::vector<uint8_t>{bytes.begin() + offset, bytes.begin() + offset + size}};
+    }
+};
+
+void test_identity() {
+    const Image a{};
+    const Image b{0x10000, 0x5F00AA02};
+
+    const auto id = utility::read_image_identity(a.view());
+    CHECK(id.has_value());
+    CHECK(id && id->timestamp == 0x5F00AA01 && id->image_size == 0x10000);
+    CHECK(utility::read_image_identity(a.view()) == id);
+    CHECK(utility::read_image_identity(b.view()) != id);
+
+    Image broken{};
+    broken.put<uint32_t>(0x80, 0);
+    CHECK(!utility::read_image_identity(broken.view()).has_value());
+}
+
+void test_validate() {
+    Image image{};
+    const auto entry = image.describe(FUNCTION, PROLOGUE_SIZE);
+
+    CHECK(utility::validate_profile_entry(image.view(), entry) == ProfileCheck::Ok);
+
+    // the game was updated and something else lives there now
+    auto moved = entry;
+    moved.offset += 0x10;
+    CHECK(utility::validate_profile_entry(image.view(), moved) == ProfileCheck::PrologueMismatch);
+
+    auto outside = entry;
+    outside.offset = image.bytes.size() - 4;
+    CHECK(utility::validate_profile_entry(image.view(), outside) == ProfileCheck::OutOfImage);
+    CHECK(utility::validate_profile_entry(image.view(), ProfileEntry{}) == ProfileCheck::OutOfImage);
+}
+
+void test_hooked_prologue() {
+    const Image original{};
+    const auto entry = original.describe(FUNCTION, PROLOGUE_SIZE);
+
+    // MinHook style: jmp rel32 over the first instructions, the rest stays
+    {
+        Image hooked{original};
+        const uint8_t jmp[] = {0xE9, 0x11, 0x22, 0x33, 0x44};
+        std::memcpy(&hooked.bytes[FUNCTION], jmp, sizeof(jmp));
+        CHECK(utility::validate_profile_entry(hooked.view(), entry) == ProfileCheck::Ok);
+
+        // but what follows has to match
+        hooked.bytes[FUNCTION + 20] ^= 0xFF;
+        CHECK(utility::validate_profile_entry(hooked.view(), entry) == ProfileCheck::PrologueMismatch);
+    }
+
+    // jmp [rip+0] with the absolute address behind it
+    {
+        Image hooked{original};
+        const uint8_t jmp[] = {0xFF, 0x25, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8};
+        std::memcpy(&hooked.bytes[FUNCTION], jmp, sizeof(jmp));
+        CHECK(utility::validate_profile_entry(hooked.view(), entry) == ProfileCheck::Ok);
+    }
+
+    // mov rax, imm64; jmp rax
+    {
+        Image hooked{original};
+        const uint8_t jmp[] = {0x48, 0xB8, 1, 2, 3, 4, 5, 6, 7, 8, 0xFF, 0xE0};
+        std::memcpy(&hooked.bytes[FUNCTION], jmp, sizeof(jmp));
+        CHECK(utility::validate_profile_entry(hooked.view(), entry) == ProfileCheck::Ok);
+    }
+
+    // an old 16 byte profile doesn't leave enough after an absolute jump to be sure
+    {
+        Image hooked{original};
+        const uint8_t jmp[] = {0xFF, 0x25, 0, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8};
+        std::memcpy(&hooked.bytes[FUNCTION], jmp, sizeof(jmp));
+        CHECK(utility::validate_profile_entry(hooked.view(), original.describe(FUNCTION, 16)) == ProfileCheck::PrologueMismatch);
+    }
+
+    // anything else at the start is a mismatch
+    {
+        Image patched{original};
+        patched.bytes[FUNCTION] = 0xC3;
+        CHECK(utility::validate_profile_entry(patched.view(), entry) == ProfileCheck::PrologueMismatch);
+    }
+}
+
+void test_db_round_trip() {
+    const Image image{};
+    const auto id = *utility::read_image_identity(image.view());
+
+    utility::PatternProfileDb db{};
+    CHECK(db.put(id, "Func", image.describe(FUNCTION, PROLOGUE_SIZE)));
+    CHECK(!db.put(id, "Func", image.describe(FUNCTION, PROLOGUE_SIZE)));
+    CHECK(db.put(id, "VTable", ProfileEntry{0x2000, {}, ".?AVFoo@@"}));
+
+    utility::PatternProfileDb parsed{};
+    parsed.parse(db.serialize());
+    CHECK(parsed.serialize() == db.serialize());
+    CHECK(parsed.find(id, "Func") != nullptr && *parsed.find(id, "Func") == image.describe(FUNCTION, PROLOGUE_SIZE));
+    CHECK(parsed.find(id, "VTable") != nullptr && parsed.find(id, "VTable")->rtti_name == ".?AVFoo@@");
+
+    parsed.erase(id, "Func");
+    CHECK(parsed.find(id, "Func") == nullptr);
+}
+
+void test_save() {
+    const auto dir = std::filesystem::temp_directory_path() / ("vrframework_profiles_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+    std::filesystem::create_directories(dir);
+    const auto path = dir / "pattern_profiles.txt";
+
+    const Image image{};
+    const auto id = *utility::read_image_identity(image.view());
+
+    utility::PatternProfileDb db{};
+    uint64_t last_hash = 0;
+
+    // a batch of resolutions, one write
+    for (int i = 0; i < 16; ++i) {
+        db.put(id, "Func" + std::to_string(i), ProfileEntry{FUNCTION + (uint64_t)i});
+    }
+
+    CHECK(db.save(path, last_hash) == utility::CommitResult::WRITTEN);
+    CHECK(db.save(path, last_hash) == utility::CommitResult::UNCHANGED);
+
+    // written through a temporary file that's gone afterwards
+    auto temp_path = path;
+    temp_path += ".tmp";
+    CHECK(!std::filesystem::exists(temp_path));
+
+    utility::PatternProfileDb loaded{};
+    CHECK(loaded.load(path));
+    CHECK(loaded.serialize() == db.serialize());
+
+    std::filesystem::remove_all(dir);
+}
+
+// A masked byte pattern scan like the one a profile miss falls back to
+size_t scan(const std::vector<uint8_t>& bytes, const std::vector<int>& pattern) {
+    for (size_t i = 0; i + pattern.size() <= bytes.size(); ++i) {
+        size_t j = 0;
+
+        while (j < pattern.size() && (pattern[j] < 0 || bytes[i + j] == pattern[j])) {
+            ++j;
+        }
+
+        if (j == pattern.size()) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+void bench() {
+    // pattern at the very end of 16 MB of code
+    Image image{16 << 20};
+    const auto function = image.bytes.size() - 0x100;
+    std::memcpy(&image.bytes[function], &image.bytes[FUNCTION], PROLOGUE_SIZE);
+    std::memset(&image.bytes[FUNCTION], 0xCC, PROLOGUE_SIZE);
+
+    const std::vector<int> pattern{0x40, 0x53, 0x48, 0x83, 0xEC, 0x20, 0x48, 0x8B, 0xD9, -1, 0x46};
+    const auto id = *utility::read_image_identity(image.view());
+
+    utility::PatternProfileDb db{};
+    db.put(id, "Func", image.describe(function, PROLOGUE_SIZE));
+
+    size_t found = 0;
+
+    check::bench("profile hit: find + validate", 100'000, [&](size_t) {
+        const auto entry = db.find(id, "Func");
+        found += entry != nullptr && utility::validate_profile_entry(image.view(), *entry) == ProfileCheck::Ok ? 1 : 0;
+    });
+
+    check::bench("profile miss: pattern scan, 16 MB", 10, [&](size_t) {
+        found += scan(image.bytes, pattern) == function ? 1 : 0;
+    });
+
+    CHECK(found == 100'010);
+
+    // what a batch of resolutions costs to persist, once per batch now instead of once per resolution
+    const auto path = std::filesystem::temp_directory_path() / ("vrframework_profiles_bench_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".txt");
+
+    for (int i = 0; i < 64; ++i) {
+        db.put(id, "Func" + std::to_string(i), image.describe(function - i, PROLOGUE_SIZE));
+    }
+
+    uint64_t last_hash = 0;
+    check::bench("PatternProfileDb::save, 64 entries", 100, [&](size_t) {
+        last_hash = 0;
+        db.save(path, last_hash);
+    });
+
+    std::filesystem::remove(path);
+}
+} // namespace
+
+int main() {
+    test_identity();
+    test_validate();
+    test_hooked_prologue();
+    test_db_round_trip();
+    test_save();
+    bench();
+
+    return check::result();
+}
@@ -0,0 +1,217 @@
+#include <array>
+#include <chrono>
+#include <thread>
+
+#include <mods/vr/RuntimeRecovery.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using vrmod::RuntimeRecovery;
+using Stage = RuntimeRecovery::Stage;
+using namespace std::chrono_literals;
+
+// Stands in for the OpenXR runtime: each stage fails a set number of times before it brings the runtime back
+struct FakeRuntime {
+    std::array<int, (size_t)Stage::COUNT> failures_left{};
+    std::array<int, (size_t)Stage::COUNT> calls{};
+
+    void install(RuntimeRecovery& recovery, std::initializer_list<Stage> stages) {
+        for (const auto stage : stages) {
+            recovery.set_handler(stage, [this, stage] {
+                ++calls[(size_t)stage];
+                return failures_left[(size_t)stage]-- <= 0;
+            });
+        }
+    }
+
+    void fail(Stage stage, int times) {
+        failures_left[(size_t)stage] = times;
+    }
+
+    int called(Stage stage) const {
+        return calls[(size_t)stage];
+    }
+};
+
+RuntimeRecovery make_recovery() {
+    RuntimeRecovery recovery{};
+    recovery.set_max_attempts(3);
+    recovery.set_retry_delay(100ms);
+    return recovery;
+}
+
+void test_cheapest_stage_with_a_handler() {
+    auto recovery = make_recovery();
+    FakeRuntime runtime{};
+    runtime.install(recovery, {Stage::RECREATE_SWAPCHAINS, Stage::RECREATE_SESSION});
+
+    // nothing handles input resync, the next stage up does it
+    const RuntimeRecovery::clock::time_point t{};
+    recovery.request(Stage::RESYNC_ACTIONS, t);
+    CHECK(recovery.get_stage() == Stage::RECREATE_SWAPCHAINS);
+
+    CHECK(recovery.update(t));
+    CHECK(!recovery.is_recovering());
+    CHECK(runtime.called(Stage::RECREATE_SWAPCHAINS) == 1);
+    CHECK(recovery.get_metrics().resolved_at[(size_t)Stage::RECREATE_SWAPCHAINS] == 1);
+
+    // nothing at or above it
+    RuntimeRecovery empty{};
+    empty.request(Stage::RECREATE_SESSION, t);
+    CHECK(!empty.is_recovering());
+    CHECK(!empty.update(t));
+}
+
+void test_transient_fault_retries_with_backoff() {
+    auto recovery = make_recovery();
+    FakeRuntime runtime{};
+    runtime.install(recovery, {Stage::RECREATE_SWAPCHAINS, Stage::RECREATE_SESSION});
+    runtime.fail(Stage::RECREATE_SWAPCHAINS, 2);
+
+    const RuntimeRecovery::clock::time_point t{};
+    recovery.request(Stage::RECREATE_SWAPCHAINS, t);
+
+    CHECK(recovery.update(t));
+    CHECK(recovery.get_attempts() == 1);
+
+    // linear backoff: 100ms after the first failure, 200ms after the second
+    CHECK(!recovery.update(t + 99ms));
+    CHECK(recovery.update(t + 100ms + 1ms));
+    CHECK(!recovery.update(t + 300ms));
+    CHECK(recovery.update(t + 302ms));
+
+    CHECK(!recovery.is_recovering());
+    CHECK(runtime.called(Stage::RECREATE_SWAPCHAINS) == 3);
+    CHECK(runtime.called(Stage::RECREATE_SESSION) == 0);
+
+    const auto& metrics = recovery.get_metrics();
+    CHECK(metrics.recoveries == 1 && metrics.failures == 0 && metrics.attempts == 3);
+    CHECK(metrics.last_stage == Stage::RECREATE_SWAPCHAINS);
+    CHECK(metrics.last_recovery_time >= 302ms);
+}
+
+void test_escalation() {
+    auto recovery = make_recovery();
+    FakeRuntime runtime{};
+    runtime.install(recovery, {Stage::RESYNC_ACTIONS, Stage::RECREATE_SESSION, Stage::REINITIALIZE});
+    runtime.fail(Stage::RESYNC_ACTIONS, 100);
+    runtime.fail(Stage::RECREATE_SESSION, 100);
+
+    auto t = RuntimeRecovery::clock::time_point{};
+    recovery.request(Stage::RESYNC_ACTIONS, t);
+
+    // every attempt as soon as it's due
+    for (int i = 0; i < 100 && recovery.is_recovering(); ++i) {
+        recovery.update(t);
+        t += 1s;
+    }
+
+    // three tries each, skipping the stage without a handler, then the full teardown fixes it
+    CHECK(runtime.called(Stage::RESYNC_ACTIONS) == 3);
+    CHECK(runtime.called(Stage::RECREATE_SESSION) == 3);
+    CHECK(runtime.called(Stage::REINITIALIZE) == 1);
+    CHECK(recovery.get_metrics().resolved_at[(size_t)Stage::REINITIALIZE] == 1);
+    CHECK(recovery.get_metrics().attempts == 7);
+}
+
+void test_exhausted() {
+    auto recovery = make_recovery();
+    FakeRuntime runtime{};
+    runtime.install(recovery, {Stage::RECREATE_SESSION});
+    runtime.fail(Stage::RECREATE_SESSION, 100);
+
+    auto t = RuntimeRecovery::clock::time_point{};
+    recovery.request(Stage::RECREATE_SESSION, t);
+
+    for (int i = 0; i < 10 && recovery.is_recovering(); ++i) {
+        recovery.update(t);
+        t += 1s;
+    }
+
+    CHECK(!recovery.is_recovering());
+    CHECK(runtime.called(Stage::RECREATE_SESSION) == 3);
+    CHECK(recovery.get_metrics().failures == 1 && recovery.get_metrics().recoveries == 0);
+}
+
+void test_requests_while_recovering() {
+    auto recovery = make_recovery();
+    FakeRuntime runtime{};
+    runtime.install(recovery, {Stage::RESYNC_ACTIONS, Stage::RECREATE_SWAPCHAINS, Stage::RECREATE_SESSION});
+    runtime.fail(Stage::RECREATE_SWAPCHAINS, 1);
+
+    const RuntimeRecovery::clock::time_point t{};
+    recovery.request(Stage::RECREATE_SWAPCHAINS, t);
+    CHECK(recovery.update(t));
+
+    // a cheaper request doesn't undo the stage in progress
+    recovery.request(Stage::RESYNC_ACTIONS, t);
+    CHECK(recovery.get_stage() == Stage::RECREATE_SWAPCHAINS && recovery.get_attempts() == 1);
+
+    // a more expensive one escalates right away, attempts start over
+    recovery.request(Stage::RECREATE_SESSION, t + 1ms);
+    CHECK(recovery.get_stage() == Stage::RECREATE_SESSION && recovery.get_attempts() == 0);
+    CHECK(recovery.update(t + 1ms));
+    CHECK(!recovery.is_recovering());
+    CHECK(recovery.get_metrics().last_stage == Stage::RECREATE_SESSION);
+
+    // a handler that finds the session lost while it runs
+    RuntimeRecovery nested = make_recovery();
+    int session_calls = 0;
+    nested.set_handler(Stage::RECREATE_SWAPCHAINS, [&] {
+        nested.request(Stage::RECREATE_SESSION, t);
+        return false;
+    });
+    nested.set_handler(Stage::RECREATE_SESSION, [&] {
+        ++session_calls;
+        return true;
+    });
+
+    nested.request(Stage::RECREATE_SWAPCHAINS, t);
+    CHECK(nested.update(t));
+    CHECK(nested.get_stage() == Stage::RECREATE_SESSION);
+    CHECK(nested.update(t));
+    CHECK(session_calls == 1 && !nested.is_recovering());
+
+    // cancelled, nothing else runs
+    recovery.request(Stage::RESYNC_ACTIONS, t);
+    recovery.cancel();
+    CHECK(!recovery.update(t));
+}
+
+void test_recovery_time_includes_the_handler() {
+    auto recovery = make_recovery();
+    recovery.set_handler(Stage::RECREATE_SESSION, [] {
+        std::this_thread::sleep_for(20ms);
+        return true;
+    });
+
+    const RuntimeRecovery::clock::time_point t{};
+    recovery.request(Stage::RECREATE_SESSION, t);
+    CHECK(recovery.update(t));
+    CHECK(recovery.get_metrics().last_recovery_time >= 20ms);
+
+    // and a failed attempt's retry is timed from when it returned
+    auto slow = make_recovery();
+    slow.set_handler(Stage::RECREATE_SESSION, [] {
+        std::this_thread::sleep_for(20ms);
+        return false;
+    });
+
+    slow.request(Stage::RECREATE_SESSION, t);
+    CHECK(slow.update(t));
+    CHECK(!slow.update(t + 110ms));
+    CHECK(slow.update(t + 1s));
+}
+} // namespace
+
+int main() {
+    test_cheapest_stage_with_a_handler();
+    test_transient_fault_retries_with_backoff();
+    test_escalation();
+    test_exhausted();
+    test_requests_while_recovering();
+    test_recovery_time_includes_the_handler();
+
+    return check::result();
+}
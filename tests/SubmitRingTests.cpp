@@ -0,0 +1,150 @@
+#include <cstdio>
+#include <vector>
+
+#include <mods/vr/SubmitRing.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using Ring = vrmod::SubmitRing<int>;
+
+// CPU submits a frame every `frame_ms`, the GPU finishes each copy `gpu_ms` after it was submitted.
+// Starved acquisitions block until the slot's copy is done, like the real fence wait.
+struct Timeline {
+    double frame_ms{11.1};
+    double gpu_ms{5.0};
+
+    double now{0.0};
+    uint64_t fence{0};
+    std::vector<double> done_at{0.0}; // per fence value
+    bool handed_out_last{false};
+
+    bool is_complete(uint64_t fence_value) const {
+        return fence_value < done_at.size() && done_at[fence_value] <= now;
+    }
+
+    void run(Ring& ring, size_t frames) {
+        for (size_t f = 0; f < frames; ++f) {
+            const auto acquired = ring.acquire([&](uint32_t, uint64_t value) { return is_complete(value); });
+
+            if (ring.size() > 1 && ring.last_submitted() == acquired.index) {
+                handed_out_last = true;
+            }
+
+            if (acquired.starved) {
+                const auto ready = done_at[ring.slot(acquired.index).fence_value];
+
+                if (ready > now) {
+                    ring.record_wait(ready - now);
+                    now = ready;
+                }
+            }
+
+            done_at.push_back(now + gpu_ms);
+            ring.submit(acquired.index, ++fence, (int)f);
+            now += frame_ms;
+        }
+    }
+};
+
+Ring::Stats simulate(size_t depth, double gpu_ms, size_t frames = 1000) {
+    Ring ring{};
+    ring.resize(depth);
+
+    Timeline timeline{};
+    timeline.gpu_ms = gpu_ms;
+    timeline.run(ring, frames);
+
+    CHECK(!timeline.handed_out_last);
+
+    const auto& stats = ring.get_stats();
+    std::printf("[sim] depth %zu, GPU %.1f ms behind at %.1f ms frames: %llu/%llu starved, %.1f ms waited, %.2f ms max\n",
+        depth, gpu_ms, timeline.frame_ms, (unsigned long long)stats.starved, (unsigned long long)stats.acquires, stats.total_wait_ms, stats.max_wait_ms);
+
+    return stats;
+}
+
+void test_acquire_order() {
+    Ring ring{};
+    ring.resize(3);
+
+    const auto done = [](uint32_t, uint64_t) { return true; };
+
+    // fresh slots first, then the least recently submitted
+    for (uint32_t i = 0; i < 3; ++i) {
+        const auto acquired = ring.acquire(done);
+        CHECK(acquired.index == i && !acquired.starved);
+        ring.submit(acquired.index, i + 1, (int)i * 10);
+    }
+
+    CHECK(ring.acquire(done).index == 0);
+    CHECK(ring.slot(1).payload == 10);
+    CHECK(ring.last_submitted() == 2u);
+
+    // 0 still busy, 1 is the oldest free one
+    const auto acquired = ring.acquire([](uint32_t i, uint64_t) { return i != 0; });
+    CHECK(acquired.index == 1 && !acquired.starved);
+
+    // nothing free: the oldest that isn't the last submission, to be waited on
+    const auto starved = ring.acquire([](uint32_t, uint64_t) { return false; });
+    CHECK(starved.index == 0 && starved.starved);
+    CHECK(ring.get_stats().starved == 1);
+    CHECK(ring.get_stats().acquires == 6);
+
+    ring.record_wait(2.0);
+    ring.record_wait(1.0);
+    CHECK(ring.get_stats().total_wait_ms == 3.0);
+    CHECK(ring.get_stats().max_wait_ms == 2.0);
+
+    ring.resize(0);
+    CHECK(ring.size() == 1);
+    CHECK(!ring.last_submitted().has_value());
+    CHECK(ring.get_stats().acquires == 0);
+}
+
+void test_simulated_gpu_timeline() {
+    // a single image is fine while the copy is done within the frame, and waits on every frame after that
+    CHECK(simulate(1, 5.0).starved == 0);
+
+    const auto single_slow = simulate(1, 15.0);
+    CHECK(single_slow.starved == single_slow.acquires - 1);
+    CHECK(single_slow.max_wait_ms > 3.0);
+
+    // two images: the other one was submitted two frames ago
+    CHECK(simulate(2, 15.0).starved == 0);
+    const auto double_slow = simulate(2, 30.0);
+    CHECK(double_slow.starved > 0);
+    CHECK(double_slow.total_wait_ms > 0.0);
+
+    // three images hide up to three frames of GPU latency
+    CHECK(simulate(3, 30.0).starved == 0);
+    CHECK(simulate(4, 40.0).starved == 0);
+
+    const auto overloaded = simulate(3, 50.0);
+    CHECK(overloaded.starved > 0);
+}
+
+void bench() {
+    Ring ring{};
+    ring.resize(3);
+
+    uint64_t fence = 0;
+    uint64_t completed = 0;
+
+    check::bench("SubmitRing acquire + submit, 3 slots", 1'000'000, [&](size_t i) {
+        const auto acquired = ring.acquire([&](uint32_t, uint64_t value) { return value <= completed; });
+        ring.submit(acquired.index, ++fence, (int)i);
+        completed = fence > 1 ? fence - 1 : 0;
+    });
+
+    CHECK(ring.get_stats().starved == 0);
+}
+} // namespace
+
+int main() {
+    test_acquire_order();
+    test_simulated_gpu_timeline();
+    bench();
+
+    return check::result();
+}
@@ -0,0 +1,113 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <utility/ToneMap.hpp>
+
+#include "Check.hpp"
+
+namespace {
+namespace tonemap = utility::tonemap;
+
+void test_make_constants() {
+    const auto constants = tonemap::make_constants(tonemap::REINHARD, 1.0f, true);
+    CHECK(constants.op == tonemap::REINHARD);
+    CHECK_NEAR(constants.exposure_scale, 2.0f, 1e-6);
+    CHECK(constants.srgb == 1);
+
+    CHECK_NEAR(tonemap::make_constants(tonemap::NONE, -2.0f).exposure_scale, 0.25f, 1e-6);
+
+    // out of range settings clamp instead of indexing past the operators
+    CHECK(tonemap::make_constants(-1, 0.0f).op == tonemap::NONE);
+    CHECK(tonemap::make_constants(42, 0.0f).op == tonemap::ACES_FILMIC);
+}
+
+void test_none_is_a_plain_copy() {
+    // like ToneMapPostProcess's copy shader: exposure and transfer function don't apply
+    const auto constants = tonemap::make_constants(tonemap::NONE, 3.0f, true);
+
+    for (const auto x : {0.0f, 0.25f, 1.0f, 4.0f, -1.0f}) {
+        CHECK(tonemap::apply(constants, x) == x);
+    }
+}
+
+void test_operators() {
+    const auto saturate = tonemap::make_constants(tonemap::SATURATE, 1.0f);
+    CHECK_NEAR(tonemap::apply(saturate, 0.25f), 0.5f, 1e-6);
+    CHECK(tonemap::apply(saturate, 0.75f) == 1.0f);
+    CHECK(tonemap::apply(saturate, -1.0f) == 0.0f);
+
+    const auto reinhard = tonemap::make_constants(tonemap::REINHARD, 0.0f);
+    CHECK_NEAR(tonemap::apply(reinhard, 1.0f), 0.5f, 1e-6);
+    CHECK_NEAR(tonemap::apply(reinhard, 3.0f), 0.75f, 1e-6);
+
+    // Narkowicz ACES: black stays black, 1.0 lands around 0.8, saturates for large inputs
+    const auto aces = tonemap::make_constants(tonemap::ACES_FILMIC, 0.0f);
+    CHECK_NEAR(tonemap::apply(aces, 0.0f), 0.0f, 1e-6);
+    CHECK_NEAR(tonemap::apply(aces, 1.0f), 2.54f / 3.16f, 1e-5);
+    CHECK(tonemap::apply(aces, 1000.0f) == 1.0f);
+
+    // all operators are monotonic over the HDR range
+    bool monotonic = true;
+
+    for (uint32_t op = tonemap::SATURATE; op < tonemap::COUNT; ++op) {
+        const auto constants = tonemap::make_constants((int)op, 0.0f);
+        float prev = tonemap::apply(constants, 0.0f);
+
+        for (float x = 0.01f; x < 16.0f; x += 0.01f) {
+            const auto y = tonemap::apply(constants, x);
+            monotonic &= y >= prev;
+            prev = y;
+        }
+    }
+
+    CHECK(monotonic);
+}
+
+void test_srgb_and_rgb() {
+    const auto constants = tonemap::make_constants(tonemap::SATURATE, 0.0f, true);
+    CHECK_NEAR(tonemap::apply(constants, 0.5f), std::pow(0.5f, 1.0f / 2.2f), 1e-6);
+    CHECK(tonemap::apply(constants, 1.0f) == 1.0f);
+
+    const auto rgb = tonemap::apply(tonemap::make_constants(tonemap::REINHARD, 0.0f), tonemap::Rgb{1.0f, 3.0f, 0.0f});
+    CHECK_NEAR(rgb.r, 0.5f, 1e-6);
+    CHECK_NEAR(rgb.g, 0.75f, 1e-6);
+    CHECK_NEAR(rgb.b, 0.0f, 1e-6);
+}
+
+// What the CPU reference costs per pixel, the shader does the same per fragment
+void bench() {
+    std::vector<tonemap::Rgb> pixels(1 << 16);
+
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        const auto v = (float)i / (float)pixels.size() * 8.0f;
+        pixels[i] = {v, v * 0.5f, v * 0.25f};
+    }
+
+    for (const auto op : {tonemap::SATURATE, tonemap::REINHARD, tonemap::ACES_FILMIC}) {
+        const auto constants = tonemap::make_constants(op, 0.5f, true);
+        float sink = 0.0f;
+
+        char name[64]{};
+        std::snprintf(name, sizeof(name), "tonemap::apply, operator %u, 64K pixels", (unsigned)op);
+
+        check::bench(name, 100, [&](size_t) {
+            for (const auto& pixel : pixels) {
+                sink += tonemap::apply(constants, pixel).g;
+            }
+        });
+
+        CHECK(sink > 0.0f);
+    }
+}
+} // namespace
+
+int main() {
+    test_make_constants();
+    test_none_is_a_plain_copy();
+    test_operators();
+    test_srgb_and_rgb();
+    bench();
+
+    return check::result();
+}
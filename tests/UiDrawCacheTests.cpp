@@ -0,0 +1,247 @@
+#include <vector>
+
+#include <utility/UiDrawCache.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using utility::UiDrawCache;
+using Action = UiDrawCache::Action;
+
+const UiDrawCache::Rect DISPLAY{0.0f, 0.0f, 1000.0f, 1000.0f};
+
+UiDrawCache::ListDigest list(uintptr_t id, uint64_t hash, UiDrawCache::Rect bounds) {
+    return UiDrawCache::ListDigest{id, hash, bounds};
+}
+
+UiDrawCache::Decision frame(UiDrawCache& cache, const std::vector<UiDrawCache::ListDigest>& lists, UiDrawCache::Rect display = DISPLAY) {
+    cache.begin_frame(display);
+
+    for (const auto& l : lists) {
+        cache.add_list(l);
+    }
+
+    return cache.end_frame();
+}
+
+void test_rect() {
+    UiDrawCache::Rect r{};
+    CHECK(r.empty());
+    CHECK(r.area() == 0.0f);
+
+    r.merge({10.0f, 10.0f, 20.0f, 20.0f});
+    CHECK(r == (UiDrawCache::Rect{10.0f, 10.0f, 20.0f, 20.0f}));
+
+    r.merge({});
+    r.merge({0.0f, 15.0f, 5.0f, 30.0f});
+    CHECK(r == (UiDrawCache::Rect{0.0f, 10.0f, 20.0f, 30.0f}));
+    CHECK(r.area() == 400.0f);
+
+    CHECK(r.intersect({15.0f, 0.0f, 100.0f, 12.0f}) == (UiDrawCache::Rect{15.0f, 10.0f, 20.0f, 12.0f}));
+    CHECK(r.intersect({50.0f, 50.0f, 60.0f, 60.0f}).empty());
+}
+
+void test_first_frame_and_unchanged() {
+    UiDrawCache cache{};
+    const std::vector lists{list(1, 11, {0, 0, 100, 100}), list(2, 22, {200, 200, 300, 300})};
+
+    // nothing in the render target yet
+    CHECK(frame(cache, lists).action == Action::REDRAW_FULL);
+    CHECK(frame(cache, lists).action == Action::SKIP);
+    CHECK(frame(cache, lists).action == Action::SKIP);
+
+    CHECK(cache.get_stats().frames == 3);
+    CHECK(cache.get_stats().full == 1);
+    CHECK(cache.get_stats().skipped == 2);
+
+    // an empty UI that stays empty is skipped too
+    CHECK(frame(cache, {}).action == Action::REDRAW_DIRTY);
+    const auto empty = frame(cache, {});
+    CHECK(empty.action == Action::SKIP);
+    CHECK(empty.empty);
+}
+
+void test_changed_list_is_dirty() {
+    UiDrawCache cache{};
+    frame(cache, {list(1, 11, {0, 0, 100, 100}), list(2, 22, {200, 200, 300, 300})});
+
+    const auto changed = frame(cache, {list(1, 11, {0, 0, 100, 100}), list(2, 23, {200, 200, 300, 300})});
+    CHECK(changed.action == Action::REDRAW_DIRTY);
+    CHECK(changed.dirty == (UiDrawCache::Rect{200, 200, 300, 300}));
+
+    // moved: old and new position
+    const auto moved = frame(cache, {list(1, 11, {0, 0, 100, 100}), list(2, 23, {250, 200, 350, 300})});
+    CHECK(moved.action == Action::REDRAW_DIRTY);
+    CHECK(moved.dirty == (UiDrawCache::Rect{200, 200, 350, 300}));
+
+    // clipped to the display
+    const auto offscreen = frame(cache, {list(1, 11, {0, 0, 100, 100}), list(2, 24, {950, 950, 1200, 1200})});
+    CHECK(offscreen.dirty.max_x == 1000.0f && offscreen.dirty.max_y == 1000.0f);
+
+    // most of the screen changed
+    frame(cache, {list(1, 11, {0, 0, 900, 900})});
+    CHECK(frame(cache, {list(1, 12, {0, 0, 900, 900})}).action == Action::REDRAW_FULL);
+}
+
+void test_added_removed_and_reordered() {
+    UiDrawCache cache{};
+    frame(cache, {list(1, 11, {0, 0, 100, 100}), list(2, 22, {200, 200, 300, 300})});
+
+    // tooltip appears on top
+    const auto added = frame(cache, {list(1, 11, {0, 0, 100, 100}), list(2, 22, {200, 200, 300, 300}), list(3, 33, {400, 400, 450, 420})});
+    CHECK(added.action == Action::REDRAW_DIRTY);
+    CHECK(added.dirty == (UiDrawCache::Rect{400, 400, 450, 420}));
+
+    // and goes away again
+    const auto removed = frame(cache, {list(1, 11, {0, 0, 100, 100}), list(2, 22, {200, 200, 300, 300})});
+    CHECK(removed.action == Action::REDRAW_DIRTY);
+    CHECK(removed.dirty == (UiDrawCache::Rect{400, 400, 450, 420}));
+
+    // removed from the middle
+    const auto middle = frame(cache, {list(2, 22, {200, 200, 300, 300})});
+    CHECK(middle.action == Action::REDRAW_DIRTY);
+    CHECK(middle.dirty == (UiDrawCache::Rect{0, 0, 100, 100}));
+
+    // focus change brings a window to the front
+    frame(cache, {list(1, 11, {0, 0, 100, 100}), list(2, 22, {200, 200, 300, 300})});
+    CHECK(frame(cache, {list(2, 22, {200, 200, 300, 300}), list(1, 11, {0, 0, 100, 100})}).action == Action::REDRAW_FULL);
+}
+
+void test_full_redraw_reasons() {
+    UiDrawCache cache{};
+    const std::vector lists{list(1, 11, {0, 0, 100, 100})};
+    frame(cache, lists);
+
+    cache.invalidate();
+    CHECK(frame(cache, lists).action == Action::REDRAW_FULL);
+    CHECK(frame(cache, lists).action == Action::SKIP);
+
+    CHECK(frame(cache, lists, {0, 0, 800, 600}).action == Action::REDRAW_FULL);
+    CHECK(frame(cache, lists, {0, 0, 800, 600}).action == Action::SKIP);
+
+    // callbacks can draw anything, the frame after one too since the previous content can't be compared
+    auto with_callback = lists;
+    with_callback[0].volatile_content = true;
+    CHECK(frame(cache, with_callback, {0, 0, 800, 600}).action == Action::REDRAW_FULL);
+    CHECK(frame(cache, lists, {0, 0, 800, 600}).action == Action::REDRAW_FULL);
+    CHECK(frame(cache, lists, {0, 0, 800, 600}).action == Action::SKIP);
+}
+
+// e.g. the shader debug overlay's motion vector view: same texture id and vertices, new contents every frame
+void test_live_texture_list_is_always_dirty() {
+    UiDrawCache cache{};
+    constexpr uintptr_t FONT_ATLAS = 0x1000;
+    constexpr uintptr_t MOTION_VECTORS = 0x2000;
+
+    cache.set_static_texture(FONT_ATLAS);
+    CHECK(cache.is_static_texture(FONT_ATLAS));
+    CHECK(!cache.is_static_texture(MOTION_VECTORS));
+
+    auto debug_view = list(2, 22, {200, 200, 300, 300});
+    debug_view.live_texture = true;
+    const std::vector lists{list(1, 11, {0, 0, 100, 100}), debug_view};
+
+    frame(cache, lists);
+
+    // only the list showing it, every frame, never skipped
+    for (int i = 0; i < 3; ++i) {
+        const auto live = frame(cache, lists);
+        CHECK(live.action == Action::REDRAW_DIRTY);
+        CHECK(live.dirty == (UiDrawCache::Rect{200, 200, 300, 300}));
+    }
+
+    // behind another window after a focus change, still redrawn
+    const std::vector reordered{debug_view, list(1, 11, {0, 0, 100, 100})};
+    frame(cache, reordered);
+    CHECK(frame(cache, reordered).action == Action::REDRAW_DIRTY);
+
+    // closed, the UI is font only again and can be skipped
+    const std::vector font_only{list(1, 11, {0, 0, 100, 100})};
+    CHECK(frame(cache, font_only).dirty == (UiDrawCache::Rect{200, 200, 300, 300}));
+    CHECK(frame(cache, font_only).action == Action::SKIP);
+}
+
+void test_stats() {
+    UiDrawCache cache{};
+    cache.record_full_time(2.0);
+    cache.record_full_time(4.0);
+    CHECK_NEAR(cache.get_stats().avg_record_ms, 2.1, 1e-9);
+
+    const std::vector lists{list(1, 11, {0, 0, 100, 100})};
+    frame(cache, lists);
+    frame(cache, lists);
+    frame(cache, lists);
+    CHECK_NEAR(cache.get_stats().saved_ms, 4.2, 1e-9);
+
+    cache.record_submission();
+    cache.record_skipped_submission();
+    cache.record_skipped_submission();
+    CHECK(cache.get_stats().submissions == 1);
+    CHECK(cache.get_stats().skipped_submissions == 2);
+}
+
+void test_hash_bytes() {
+    std::vector<uint8_t> data(1000);
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = (uint8_t)(i * 7);
+    }
+
+    const auto hash = UiDrawCache::hash_bytes(data.data(), data.size(), 0);
+    CHECK(hash == UiDrawCache::hash_bytes(data.data(), data.size(), 0));
+    CHECK(hash != UiDrawCache::hash_bytes(data.data(), data.size(), 1));
+    CHECK(hash != UiDrawCache::hash_bytes(data.data(), data.size() - 1, 0));
+
+    // a flipped bit anywhere, the tail included
+    bool all_differ = true;
+
+    for (const auto at : {0, 7, 8, 500, 996, 999}) {
+        data[at] ^= 1;
+        all_differ &= UiDrawCache::hash_bytes(data.data(), data.size(), 0) != hash;
+        data[at] ^= 1;
+    }
+
+    CHECK(all_differ);
+}
+
+void bench() {
+    std::vector<UiDrawCache::ListDigest> lists{};
+
+    for (uintptr_t i = 0; i < 32; ++i) {
+        lists.push_back(list(i + 1, i * 31, {(float)i * 20, 0, (float)i * 20 + 100, 100}));
+    }
+
+    UiDrawCache cache{};
+    frame(cache, lists);
+
+    size_t skipped = 0;
+    check::bench("UiDrawCache frame, 32 unchanged lists", 100'000, [&](size_t) {
+        skipped += frame(cache, lists).action == Action::SKIP ? 1 : 0;
+    });
+
+    CHECK(skipped == 100'000);
+
+    // about the vertex data of a busy UI
+    std::vector<uint8_t> vertices(1 << 20);
+    uint64_t sink = 0;
+    check::bench("UiDrawCache::hash_bytes, 1 MB", 200, [&](size_t i) {
+        sink += UiDrawCache::hash_bytes(vertices.data(), vertices.size(), i);
+    });
+
+    CHECK(sink != 0);
+}
+} // namespace
+
+int main() {
+    test_rect();
+    test_first_frame_and_unchanged();
+    test_changed_list_is_dirty();
+    test_added_removed_and_reordered();
+    test_full_redraw_reasons();
+    test_live_texture_list_is_always_dirty();
+    test_stats();
+    test_hash_bytes();
+    bench();
+
+    return check::result();
+}
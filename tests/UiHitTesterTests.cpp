@@ -0,0 +1,205 @@
+#include <array>
+#include <vector>
+
+#include <mods/vr/UiHitTester.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using vrmod::UiHitTester;
+using Rays = std::array<UiHitTester::Ray, (size_t)UiHitTester::Pointer::COUNT>;
+using Pressed = std::array<bool, (size_t)UiHitTester::Pointer::COUNT>;
+
+constexpr auto RIGHT = (size_t)UiHitTester::Pointer::RIGHT_HAND;
+
+UiHitTester::Layer quad_at(glm::vec3 position, glm::vec2 size = {1.0f, 1.0f}) {
+    UiHitTester::Layer layer{};
+    layer.shape = UiHitTester::Shape::QUAD;
+    layer.transform = glm::translate(glm::mat4{1.0f}, position);
+    layer.size = size;
+    return layer;
+}
+
+UiHitTester::Ray ray(glm::vec3 origin, glm::vec3 direction) {
+    return UiHitTester::Ray{origin, glm::normalize(direction), true};
+}
+
+void test_quad_front_face() {
+    const auto layer = quad_at({0.0f, 0.0f, -2.0f}, {2.0f, 1.0f});
+    const auto inverse = glm::inverse(layer.transform);
+
+    const auto center = UiHitTester::intersect_quad(layer, inverse, ray({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}));
+    CHECK(center.has_value());
+    CHECK(center && center->hovering);
+    CHECK_NEAR(center ? center->distance : 0.0f, 2.0f, 1e-5);
+    CHECK_NEAR(center ? center->uv.x : 0.0f, 0.5f, 1e-5);
+    CHECK_NEAR(center ? center->uv.y : 0.0f, 0.5f, 1e-5);
+
+    // uv origin is the top left corner
+    const auto corner = UiHitTester::intersect_quad(layer, inverse, ray({-0.9f, 0.4f, 0.0f}, {0.0f, 0.0f, -1.0f}));
+    CHECK_NEAR(corner ? corner->uv.x : 1.0f, 0.05f, 1e-5);
+    CHECK_NEAR(corner ? corner->uv.y : 1.0f, 0.1f, 1e-5);
+
+    // outside, parallel, pointing away
+    CHECK(!UiHitTester::intersect_quad(layer, inverse, ray({1.1f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f})));
+    CHECK(!UiHitTester::intersect_quad(layer, inverse, ray({0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f})));
+    CHECK(!UiHitTester::intersect_quad(layer, inverse, ray({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f})));
+}
+
+void test_quad_back_face_is_culled() {
+    const auto layer = quad_at({0.0f, 0.0f, -2.0f});
+    const auto inverse = glm::inverse(layer.transform);
+
+    // behind the quad looking at its back
+    CHECK(!UiHitTester::intersect_quad(layer, inverse, ray({0.0f, 0.0f, -4.0f}, {0.0f, 0.0f, 1.0f})));
+
+    // turned around it's visible from there
+    auto flipped = layer;
+    flipped.transform = glm::rotate(layer.transform, glm::pi<float>(), glm::vec3{0.0f, 1.0f, 0.0f});
+    CHECK(UiHitTester::intersect_quad(flipped, glm::inverse(flipped.transform), ray({0.0f, 0.0f, -4.0f}, {0.0f, 0.0f, 1.0f})).has_value());
+}
+
+void test_cylinder() {
+    UiHitTester::Layer layer{};
+    layer.shape = UiHitTester::Shape::CYLINDER;
+    layer.radius = 2.0f;
+    layer.central_angle = glm::half_pi<float>();
+    layer.aspect_ratio = 1.0f;
+
+    const auto inverse = glm::inverse(layer.transform);
+
+    // from the axis, straight at the middle of the arc
+    const auto hit = UiHitTester::intersect_cylinder(layer, inverse, ray({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f}));
+    CHECK(hit.has_value());
+    CHECK_NEAR(hit ? hit->distance : 0.0f, 2.0f, 1e-4);
+    CHECK_NEAR(hit ? hit->uv.x : 0.0f, 0.5f, 1e-4);
+    CHECK_NEAR(hit ? hit->uv.y : 0.0f, 0.5f, 1e-4);
+
+    // towards +X is the right side of the arc
+    const auto right = UiHitTester::intersect_cylinder(layer, inverse, ray({0.0f, 0.0f, 0.0f}, {0.5f, 0.0f, -1.0f}));
+    CHECK(right && right->uv.x > 0.5f);
+
+    // outside the arc
+    CHECK(!UiHitTester::intersect_cylinder(layer, inverse, ray({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f})));
+    CHECK(!UiHitTester::intersect_cylinder(layer, inverse, ray({0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, -0.1f})));
+
+    // from outside in front of the arc only its back (convex side) faces the ray
+    CHECK(!UiHitTester::intersect_cylinder(layer, inverse, ray({0.0f, 0.0f, -5.0f}, {0.0f, 0.0f, 1.0f})));
+}
+
+void test_nearest_layer_wins_and_press_capture() {
+    UiHitTester tester{};
+    const auto far = tester.add_layer(quad_at({0.0f, 0.0f, -3.0f}, {4.0f, 4.0f}));
+    const auto near = tester.add_layer(quad_at({0.0f, 0.0f, -1.0f}));
+
+    Rays rays{};
+    Pressed pressed{};
+    rays[RIGHT] = ray({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f});
+
+    tester.update(rays, pressed);
+    auto hit = tester.get_hit(UiHitTester::Pointer::RIGHT_HAND);
+    CHECK(hit.layer == near);
+    CHECK(hit.hovering && hit.just_entered);
+
+    // press on the near layer, then drag off it onto the far one: stays captured
+    pressed[RIGHT] = true;
+    tester.update(rays, pressed);
+    hit = tester.get_hit(UiHitTester::Pointer::RIGHT_HAND);
+    CHECK(hit.just_pressed && hit.layer == near);
+
+    rays[RIGHT] = ray({1.5f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f});
+    tester.update(rays, pressed);
+    hit = tester.get_hit(UiHitTester::Pointer::RIGHT_HAND);
+    CHECK(hit.pressed && hit.layer == near && !hit.hovering);
+
+    // released off the layer, the release still lands on it
+    pressed[RIGHT] = false;
+    tester.update(rays, pressed);
+    hit = tester.get_hit(UiHitTester::Pointer::RIGHT_HAND);
+    CHECK(hit.just_released && hit.layer == near);
+
+    tester.update(rays, pressed);
+    hit = tester.get_hit(UiHitTester::Pointer::RIGHT_HAND);
+    CHECK(hit.layer == far && hit.hovering);
+
+    // holding the button while sweeping onto a layer isn't a click
+    rays[RIGHT] = ray({5.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f});
+    pressed[RIGHT] = true;
+    tester.update(rays, pressed);
+    rays[RIGHT] = ray({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f});
+    tester.update(rays, pressed);
+    hit = tester.get_hit(UiHitTester::Pointer::RIGHT_HAND);
+    CHECK(hit.hovering && !hit.pressed);
+
+    // disabled layers don't catch anything
+    pressed[RIGHT] = false;
+    tester.set_layer_enabled(near, false);
+    tester.update(rays, pressed);
+    CHECK(tester.get_hit(UiHitTester::Pointer::RIGHT_HAND).layer == far);
+
+    tester.remove_layer(far);
+    tester.update(rays, pressed);
+    CHECK(tester.get_hit(UiHitTester::Pointer::RIGHT_HAND).layer == UiHitTester::INVALID_LAYER);
+}
+
+void test_bounding_spheres_skip_exact_tests() {
+    UiHitTester tester{};
+
+    // a row of small quads far off to the side plus the one the ray points at
+    for (int i = 0; i < 32; ++i) {
+        tester.add_layer(quad_at({10.0f + (float)i * 2.0f, 0.0f, -2.0f}));
+    }
+
+    const auto target = tester.add_layer(quad_at({0.0f, 0.0f, -2.0f}));
+
+    Rays rays{};
+    Pressed pressed{};
+    rays[RIGHT] = ray({0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, -1.0f});
+
+    tester.update(rays, pressed);
+    CHECK(tester.get_hit(UiHitTester::Pointer::RIGHT_HAND).layer == target);
+    CHECK(tester.get_last_stats().sphere_tests == 33);
+    CHECK(tester.get_last_stats().exact_tests == 1);
+
+    // next frame the last layer is tested first and the rest never reach the exact test
+    tester.update(rays, pressed);
+    CHECK(tester.get_last_stats().sphere_tests == 32);
+    CHECK(tester.get_last_stats().exact_tests == 1);
+}
+
+void bench_update() {
+    for (const auto count : {4, 64}) {
+        UiHitTester tester{};
+
+        for (int i = 0; i < count; ++i) {
+            tester.add_layer(quad_at({(float)(i % 8) * 1.5f - 5.0f, (float)(i / 8) * 1.5f - 5.0f, -2.0f - (float)i * 0.01f}));
+        }
+
+        Rays rays{};
+        Pressed pressed{};
+
+        for (auto& r : rays) {
+            r = ray({0.0f, 0.0f, 0.0f}, {0.1f, 0.05f, -1.0f});
+        }
+
+        char name[64]{};
+        std::snprintf(name, sizeof(name), "UiHitTester::update, 3 pointers, %d layers", count);
+
+        check::bench(name, 100'000, [&](size_t i) {
+            rays[RIGHT].direction = glm::normalize(glm::vec3{(float)(i % 100) * 0.01f - 0.5f, 0.0f, -1.0f});
+            tester.update(rays, pressed);
+        });
+    }
+}
+} // namespace
+
+int main() {
+    test_quad_front_face();
+    test_quad_back_face_is_culled();
+    test_cylinder();
+    test_nearest_layer_wins_and_press_capture();
+    test_bounding_spheres_skip_exact_tests();
+    bench_update();
+
+    return check::result();
+}
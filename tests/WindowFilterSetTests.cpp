@@ -0,0 +1,232 @@
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <utility/WindowFilterSet.hpp>
+
+#include "Check.hpp"
+
+namespace {
+using utility::WindowFilterSet;
+
+// Window ids are only compared, any distinct non-null pointer values do
+WindowFilterSet::WindowId window(uintptr_t i) {
+    return (WindowFilterSet::WindowId)(0x10000 + i * 0x10);
+}
+
+struct Titles {
+    std::mutex mtx{};
+    std::map<WindowFilterSet::WindowId, std::string> titles{};
+    std::atomic<int> reads{0};
+
+    void set(WindowFilterSet::WindowId id, std::string title) {
+        std::scoped_lock _{mtx};
+        titles[id] = std::move(title);
+    }
+
+    WindowFilterSet::TitleSource source() {
+        return [this](WindowFilterSet::WindowId id) {
+            ++reads;
+            std::scoped_lock _{mtx};
+            const auto it = titles.find(id);
+            return it != titles.end() ? it->second : std::string{};
+        };
+    }
+};
+
+void test_parse_patterns() {
+    const auto patterns = WindowFilterSet::parse_patterns(" UE4SS , ,PimaxXR,");
+
+    CHECK(patterns.size() == 2);
+    CHECK(patterns[0] == "UE4SS");
+    CHECK(patterns[1] == "PimaxXR");
+    CHECK(WindowFilterSet::parse_patterns("").empty());
+}
+
+void test_classify_and_lookup() {
+    Titles titles{};
+    titles.set(window(1), "Game");
+    titles.set(window(2), "UE4SS Debugging Tools");
+
+    WindowFilterSet filter{titles.source(), {"UE4SS"}};
+
+    CHECK(!filter.lookup(window(1)).has_value());
+    CHECK(!filter.is_filtered(window(1)));
+    CHECK(filter.is_filtered(window(2)));
+    CHECK(filter.lookup(window(1)) == false);
+    CHECK(filter.lookup(window(2)) == true);
+
+    // known windows are lookups only
+    const auto reads = titles.reads.load();
+    filter.is_filtered(window(1));
+    filter.is_filtered(window(2));
+    CHECK(titles.reads.load() == reads);
+
+    // rename
+    titles.set(window(1), "UE4SS");
+    CHECK(filter.classify(window(1)));
+    CHECK(filter.lookup(window(1)) == true);
+}
+
+void test_force_forget_and_patterns() {
+    Titles titles{};
+    titles.set(window(1), "Game");
+    titles.set(window(2), "PimaxXR");
+
+    WindowFilterSet filter{titles.source(), {"PimaxXR"}};
+    CHECK(!filter.is_filtered(window(1)));
+    CHECK(filter.is_filtered(window(2)));
+
+    filter.force_filter(window(1));
+    CHECK(filter.lookup(window(1)) == true);
+    CHECK(filter.classify(window(1)));
+
+    // forced windows survive pattern changes, the rest is reclassified
+    filter.set_patterns({"Game"});
+    CHECK(filter.lookup(window(1)) == true);
+    CHECK(filter.lookup(window(2)) == false);
+    CHECK(filter.get_patterns().size() == 1);
+
+    // a recycled handle doesn't inherit the old verdict
+    filter.forget(window(1));
+    CHECK(!filter.lookup(window(1)).has_value());
+    titles.set(window(1), "Other");
+    CHECK(!filter.is_filtered(window(1)));
+}
+
+void test_pending_is_deferred() {
+    Titles titles{};
+    titles.set(window(1), "Game");
+
+    int wakes = 0;
+    WindowFilterSet filter{titles.source(), {"UE4SS"}, [&] { ++wakes; }};
+
+    // filtered until classified, queued once, title not read on the calling thread
+    CHECK(filter.is_filtered(window(1)));
+    CHECK(filter.is_filtered(window(1)));
+    CHECK(wakes == 1);
+    CHECK(titles.reads.load() == 0);
+    CHECK(!filter.lookup(window(1)).has_value());
+
+    CHECK(filter.classify_pending() == 1);
+    CHECK(titles.reads.load() == 1);
+    CHECK(!filter.is_filtered(window(1)));
+    CHECK(filter.classify_pending() == 0);
+
+    // forgotten before the worker got to it
+    filter.is_filtered(window(2));
+    filter.forget(window(2));
+    CHECK(filter.classify_pending() == 0);
+}
+
+void test_overflow() {
+    Titles titles{};
+    WindowFilterSet filter{titles.source(), {"x"}};
+
+    constexpr size_t count = WindowFilterSet::CAPACITY * 2;
+
+    for (size_t i = 1; i <= count; ++i) {
+        titles.set(window(i), i % 3 == 0 ? "x" : "y");
+        filter.classify(window(i));
+    }
+
+    bool all_known = true;
+
+    for (size_t i = 1; i <= count; ++i) {
+        all_known &= filter.lookup(window(i)) == (i % 3 == 0);
+    }
+
+    CHECK(all_known);
+
+    for (size_t i = 1; i <= count; i += 2) {
+        filter.forget(window(i));
+    }
+
+    bool forgotten = true;
+
+    for (size_t i = 1; i <= count; ++i) {
+        const auto result = filter.lookup(window(i));
+        forgotten &= (i % 2 == 1) ? !result.has_value() : result == (i % 3 == 0);
+    }
+
+    CHECK(forgotten);
+}
+
+// Readers must only ever see a verdict that was actually published for the window
+void test_concurrent_readers() {
+    Titles titles{};
+
+    for (size_t i = 1; i <= 64; ++i) {
+        titles.set(window(i), (i & 1) != 0 ? "filtered" : "allowed");
+    }
+
+    WindowFilterSet filter{titles.source(), {"filtered"}};
+
+    for (size_t i = 1; i <= 64; ++i) {
+        filter.classify(window(i));
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<int> wrong{0};
+    std::vector<std::jthread> readers{};
+
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            while (!stop.load()) {
+                for (size_t i = 1; i <= 64; ++i) {
+                    const auto result = filter.lookup(window(i));
+
+                    // odd windows never change, even ones flip between allowed and gone
+                    if ((i & 1) != 0 && result != true) {
+                        ++wrong;
+                    } else if ((i & 1) == 0 && result == true) {
+                        ++wrong;
+                    }
+                }
+            }
+        });
+    }
+
+    for (int round = 0; round < 2000; ++round) {
+        const auto id = window(2 + (round % 32) * 2);
+        filter.forget(id);
+        filter.classify(id);
+    }
+
+    stop = true;
+    readers.clear();
+
+    CHECK(wrong.load() == 0);
+}
+
+void bench_lookup() {
+    Titles titles{};
+    WindowFilterSet filter{titles.source(), {"x"}};
+
+    for (size_t i = 1; i <= 32; ++i) {
+        filter.classify(window(i));
+    }
+
+    size_t hits = 0;
+    check::bench("WindowFilterSet::lookup", 1'000'000, [&](size_t i) {
+        hits += filter.lookup(window(1 + (i & 31))).has_value() ? 1 : 0;
+    });
+
+    CHECK(hits == 1'000'000);
+}
+} // namespace
+
+int main() {
+    test_parse_patterns();
+    test_classify_and_lookup();
+    test_force_forget_and_patterns();
+    test_pending_is_deferred();
+    test_overflow();
+    test_concurrent_readers();
+    bench_lookup();
+
+    return check::result();
+}